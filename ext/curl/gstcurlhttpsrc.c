@@ -55,6 +55,18 @@
  * for HTTP/2 support for this functionality. HTTPS support is dependent on
  * cURL being built with SSL support (OpenSSL/PolarSSL/NSS/GnuTLS).
  *
+ * All instances drive their transfers from one shared libcurl multi handle,
+ * so connections are kept alive and reused across elements, and with HTTP/2
+ * requests to the same server are multiplexed as streams on a single
+ * connection. The DNS cache and TLS sessions are shared between all
+ * instances as well.
+ *
+ * The body is copied once, from the receive buffer of libcurl into blocks of
+ * #GstBaseSrc:blocksize bytes taken from a buffer pool. The streaming thread
+ * pushes full blocks, and takes the partially filled block when no full one
+ * is waiting, so slow or endless responses are not held back. Raising the
+ * block size reduces the per-buffer overhead for high bitrate downloads.
+ *
  * An HTTP proxy must be specified by URL.
  * If the "http_proxy" environment variable is set, its value is used.
  * The #GstCurlHttpSrc:proxy property can be used to override the default.
@@ -138,6 +150,10 @@ static size_t gst_curl_http_src_get_header (void *header, size_t size,
 static size_t gst_curl_http_src_get_chunks (void *chunk, size_t size,
     size_t nmemb, void *src);
 static void gst_curl_http_src_request_remove (GstCurlHttpSrc * src);
+static GstMessage *gst_curl_http_src_update_stats (GstCurlHttpSrc * src);
+static gboolean gst_curl_http_src_ensure_pool (GstCurlHttpSrc * src);
+static void gst_curl_http_src_flush_fill_buffer (GstCurlHttpSrc * src);
+static void gst_curl_http_src_clear_buffers (GstCurlHttpSrc * src);
 static char *gst_curl_http_src_strcasestr (const char *haystack,
     const char *needle);
 
@@ -165,6 +181,57 @@ gst_curl_http_version_get_type (void)
   return gtype;
 }
 
+static void
+gst_curl_http_src_share_lock (CURL * handle, curl_lock_data data,
+    curl_lock_access access, void *userptr)
+{
+  GstCurlHttpSrcMultiTaskContext *context = userptr;
+
+  g_mutex_lock (&context->share_locks[data]);
+}
+
+static void
+gst_curl_http_src_share_unlock (CURL * handle, curl_lock_data data,
+    void *userptr)
+{
+  GstCurlHttpSrcMultiTaskContext *context = userptr;
+
+  g_mutex_unlock (&context->share_locks[data]);
+}
+
+/*
+ * Set up the share handle used by every easy handle, so that a new request
+ * doesn't have to resolve the host or do a full TLS handshake again. Open
+ * connections are pooled by the multi handle already. The share handle lives
+ * as long as the class, as easy handles can outlive the multi loop.
+ */
+static void
+gst_curl_http_src_init_share (GstCurlHttpSrcMultiTaskContext * context)
+{
+  gint i;
+
+  for (i = 0; i < CURL_LOCK_DATA_LAST; i++)
+    g_mutex_init (&context->share_locks[i]);
+
+  context->share_handle = curl_share_init ();
+  if (context->share_handle == NULL) {
+    GSTCURL_WARNING_PRINT ("Couldn't create curl share handle");
+    return;
+  }
+
+  curl_share_setopt (context->share_handle, CURLSHOPT_LOCKFUNC,
+      gst_curl_http_src_share_lock);
+  curl_share_setopt (context->share_handle, CURLSHOPT_UNLOCKFUNC,
+      gst_curl_http_src_share_unlock);
+  curl_share_setopt (context->share_handle, CURLSHOPT_USERDATA, context);
+  curl_share_setopt (context->share_handle, CURLSHOPT_SHARE,
+      CURL_LOCK_DATA_DNS);
+  if (curl_share_setopt (context->share_handle, CURLSHOPT_SHARE,
+          CURL_LOCK_DATA_SSL_SESSION) != CURLSHE_OK) {
+    GSTCURL_INFO_PRINT ("TLS session sharing unsupported by libcurl");
+  }
+}
+
 #define gst_curl_http_src_parent_class parent_class
 G_DEFINE_TYPE_WITH_CODE (GstCurlHttpSrc, gst_curl_http_src, GST_TYPE_PUSH_SRC,
     G_IMPLEMENT_INTERFACE (GST_TYPE_URI_HANDLER,
@@ -382,6 +449,22 @@ gst_curl_http_src_class_init (GstCurlHttpSrcClass * klass)
           GST_TYPE_CURL_HTTP_VERSION, pref_http_ver,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstCurlHttpSrc:stats:
+   *
+   * Timing of the last completed request: the time spent on name lookup,
+   * connecting, the TLS handshake, until the first byte and in total, whether
+   * an existing connection was reused and the HTTP version used. The same
+   * structure is posted as an element message named "curlhttpsrc-stats" when
+   * a request completes.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Timing statistics of the last completed request",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   /* Add a debugging task so it's easier to debug in the Multi worker thread */
   GST_DEBUG_CATEGORY_INIT (gst_curl_loop_debug, "curl_multi_loop", 0,
       "libcURL loop thread debugging");
@@ -394,6 +477,8 @@ gst_curl_http_src_class_init (GstCurlHttpSrcClass * klass)
   g_cond_init (&klass->multi_task_context.signal);
   g_rec_mutex_init (&klass->multi_task_context.task_rec_mutex);
 
+  gst_curl_http_src_init_share (&klass->multi_task_context);
+
   gst_element_class_set_static_metadata (gstelement_class,
       "HTTP Client Source using libcURL",
       "Source/Network",
@@ -570,6 +655,11 @@ gst_curl_http_src_get_property (GObject * object, guint prop_id,
     case PROP_HTTPVERSION:
       g_value_set_enum (value, source->preferred_http_version);
       break;
+    case PROP_STATS:
+      g_mutex_lock (&source->buffer_mutex);
+      gst_value_set_structure (value, source->stats);
+      g_mutex_unlock (&source->buffer_mutex);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -619,8 +709,12 @@ gst_curl_http_src_init (GstCurlHttpSrc * source)
   g_mutex_init (&source->buffer_mutex);
   g_cond_init (&source->signal);
 
-  source->buffer = NULL;
-  source->buffer_len = 0;
+  source->pool = NULL;
+  source->fill_buffer = NULL;
+  source->fill_offset = 0;
+  g_queue_init (&source->filled_buffers);
+  /* one block per curl write callback at most */
+  gst_base_src_set_blocksize (GST_BASE_SRC (source), CURL_MAX_WRITE_SIZE);
   source->state = GSTCURL_NONE;
   source->pending_state = GSTCURL_NONE;
   source->status_code = 0;
@@ -629,6 +723,7 @@ gst_curl_http_src_init (GstCurlHttpSrc * source)
   source->hdrs_updated = FALSE;
 
   source->curl_result = CURLE_OK;
+  source->stats = NULL;
 
   GSTCURL_FUNCTION_EXIT (source);
 }
@@ -658,11 +753,21 @@ gst_curl_http_src_ref_multi (GstCurlHttpSrc * src)
     /* set up curl */
     klass->multi_task_context.multi_handle = curl_multi_init ();
 
+    /* Multiplex HTTP/2 requests to the same server on one connection. HTTP/1
+     * pipelining is not used, it is broken on too many servers and proxies,
+     * HTTP/1 requests get connections of their own instead. */
+#ifdef CURLPIPE_MULTIPLEX
+    curl_multi_setopt (klass->multi_task_context.multi_handle,
+        CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#else
     curl_multi_setopt (klass->multi_task_context.multi_handle,
         CURLMOPT_PIPELINING, 1);
+#endif
 #ifdef CURLMOPT_MAX_HOST_CONNECTIONS
     curl_multi_setopt (klass->multi_task_context.multi_handle,
-        CURLMOPT_MAX_HOST_CONNECTIONS, 1);
+        CURLMOPT_MAX_HOST_CONNECTIONS, (long) src->max_conns_per_server);
+    curl_multi_setopt (klass->multi_task_context.multi_handle,
+        CURLMOPT_MAX_TOTAL_CONNECTIONS, (long) src->max_conns_global);
 #endif
 
     /* Start the thread */
@@ -748,6 +853,7 @@ gst_curl_http_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
   GstCurlHttpSrc *src = GST_CURLHTTPSRC (psrc);
   GstCurlHttpSrcClass *klass;
   GstStructure *empty_headers;
+  GstMessage *stats_msg = NULL;
 
   klass = G_TYPE_INSTANCE_GET_CLASS (src, GST_TYPE_CURL_HTTP_SRC,
       GstCurlHttpSrcClass);
@@ -764,6 +870,11 @@ gst_curl_http_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
 retry:
   if (!src->transfer_begun) {
     GST_DEBUG_OBJECT (src, "Starting new request for URI %s", src->uri);
+    if (!gst_curl_http_src_ensure_pool (src)) {
+      ret = GST_FLOW_ERROR;
+      goto escape;
+    }
+
     /* Create the Easy Handle and set up the session. */
     src->curl_handle = gst_curl_http_src_create_easy_handle (src);
     if (src->curl_handle == NULL) {
@@ -800,21 +911,23 @@ retry:
     GST_INFO_OBJECT (src, "Created a new headers object");
   }
 
-  /* Wait for data to become available, then punt it downstream */
-  while ((src->buffer_len == 0) && (src->state == GSTCURL_OK)) {
+  /* Wait for any data to become available, then punt it downstream */
+  while (g_queue_is_empty (&src->filled_buffers) && src->fill_offset == 0 &&
+      (src->state == GSTCURL_OK)) {
     g_cond_wait (&src->signal, &src->buffer_mutex);
   }
 
   if (src->state == GSTCURL_UNLOCK) {
-    if (src->buffer_len > 0) {
-      g_free (src->buffer);
-      src->buffer = NULL;
-      src->buffer_len = 0;
-    }
+    gst_curl_http_src_clear_buffers (src);
     ret = GST_FLOW_FLUSHING;
     goto escape;
   }
 
+  /* Without a full block, take what was received so far instead of waiting
+   * for the block to fill up, which can take long on slow responses */
+  if (g_queue_is_empty (&src->filled_buffers))
+    gst_curl_http_src_flush_fill_buffer (src);
+
   ret = gst_curl_http_src_handle_response (src);
   switch (ret) {
     case GST_FLOW_ERROR:
@@ -840,6 +953,7 @@ retry:
         goto escape;
       }
       GST_INFO_OBJECT (src, "Attempting retry for URI %s", src->uri);
+      gst_curl_http_src_clear_buffers (src);
       src->state = GSTCURL_NONE;
       src->transfer_begun = FALSE;
       src->status_code = 0;
@@ -857,22 +971,19 @@ retry:
   }
 
   if (((src->state == GSTCURL_OK) || (src->state == GSTCURL_DONE)) &&
-      (src->buffer_len > 0)) {
+      !g_queue_is_empty (&src->filled_buffers)) {
 
-    GST_DEBUG_OBJECT (src, "Pushing %u bytes of transfer for URI %s to pad",
-        src->buffer_len, src->uri);
-    *outbuf = gst_buffer_new_allocate (NULL, src->buffer_len, NULL);
-    gst_buffer_fill (*outbuf, 0, src->buffer, src->buffer_len);
-
-    g_free (src->buffer);
-    src->buffer = NULL;
-    src->buffer_len = 0;
+    *outbuf = g_queue_pop_head (&src->filled_buffers);
+    GST_DEBUG_OBJECT (src, "Pushing %" G_GSIZE_FORMAT " bytes of transfer "
+        "for URI %s to pad", gst_buffer_get_size (*outbuf), src->uri);
     src->data_received = TRUE;
 
     /* ret should still be GST_FLOW_OK */
-  } else if ((src->state == GSTCURL_DONE) && (src->buffer_len == 0)) {
+  } else if ((src->state == GSTCURL_DONE) &&
+      g_queue_is_empty (&src->filled_buffers)) {
     GST_INFO_OBJECT (src, "Full body received, signalling EOS for URI %s.",
         src->uri);
+    stats_msg = gst_curl_http_src_update_stats (src);
     src->state = GSTCURL_NONE;
     src->transfer_begun = FALSE;
     src->status_code = 0;
@@ -907,6 +1018,9 @@ retry:
 escape:
   g_mutex_unlock (&src->buffer_mutex);
 
+  if (stats_msg != NULL)
+    gst_element_post_message (GST_ELEMENT_CAST (src), stats_msg);
+
   GSTCURL_FUNCTION_EXIT (src);
   return ret;
 }
@@ -939,6 +1053,7 @@ static CURL *
 gst_curl_http_src_create_easy_handle (GstCurlHttpSrc * s)
 {
   CURL *handle;
+  GstCurlHttpSrcClass *klass;
   gint i;
   GSTCURL_FUNCTION_ENTRY (s);
 
@@ -1022,6 +1137,11 @@ gst_curl_http_src_create_easy_handle (GstCurlHttpSrc * s)
           GST_INFO_OBJECT (s, "HTTP/2 unsupported by libcurl at this time");
         }
       }
+#if LIBCURL_VERSION_NUM >= 0x072b00
+      /* Rather wait for a connection being set up to the same server than
+       * opening another one, the request can then be multiplexed on it. */
+      gst_curl_setopt_generic (s, handle, CURLOPT_PIPEWAIT, 1L);
+#endif
       break;
 #endif
     default:
@@ -1038,6 +1158,11 @@ gst_curl_http_src_create_easy_handle (GstCurlHttpSrc * s)
 
   gst_curl_setopt_str (s, handle, CURLOPT_ERRORBUFFER, s->curl_errbuf);
 
+  klass = G_TYPE_INSTANCE_GET_CLASS (s, GST_TYPE_CURL_HTTP_SRC,
+      GstCurlHttpSrcClass);
+  gst_curl_setopt_str (s, handle, CURLOPT_SHARE,
+      klass->multi_task_context.share_handle);
+
   GSTCURL_FUNCTION_EXIT (s);
   return handle;
 }
@@ -1190,6 +1315,86 @@ gst_curl_http_src_handle_response (GstCurlHttpSrc * src)
   return ret;
 }
 
+static GstClockTime
+_curl_info_time (CURL * handle, CURLINFO info)
+{
+  gdouble secs;
+
+  if (curl_easy_getinfo (handle, info, &secs) != CURLE_OK || secs < 0)
+    return GST_CLOCK_TIME_NONE;
+
+  return (GstClockTime) (secs * GST_SECOND);
+}
+
+/*
+ * Collect the timing of the request that just completed, so applications
+ * and demuxers can see whether warm connections are being reused. Called
+ * with the buffer_mutex held, returns the message to post once it is
+ * released.
+ */
+static GstMessage *
+gst_curl_http_src_update_stats (GstCurlHttpSrc * src)
+{
+  CURL *handle = src->curl_handle;
+  GstStructure *stats;
+  glong num_connects = 0;
+  gdouble bytes = 0, speed = 0;
+  const gchar *version = "unknown";
+#if LIBCURL_VERSION_NUM >= 0x073200
+  glong http_version;
+#endif
+
+  if (handle == NULL)
+    return NULL;
+
+  curl_easy_getinfo (handle, CURLINFO_NUM_CONNECTS, &num_connects);
+  curl_easy_getinfo (handle, CURLINFO_SIZE_DOWNLOAD, &bytes);
+  curl_easy_getinfo (handle, CURLINFO_SPEED_DOWNLOAD, &speed);
+#if LIBCURL_VERSION_NUM >= 0x073200
+  if (curl_easy_getinfo (handle, CURLINFO_HTTP_VERSION,
+          &http_version) == CURLE_OK) {
+    switch (http_version) {
+      case CURL_HTTP_VERSION_1_0:
+        version = "1.0";
+        break;
+      case CURL_HTTP_VERSION_1_1:
+        version = "1.1";
+        break;
+      case CURL_HTTP_VERSION_2_0:
+        version = "2.0";
+        break;
+      default:
+        break;
+    }
+  }
+#endif
+
+  stats = gst_structure_new ("curlhttpsrc-stats",
+      "uri", G_TYPE_STRING, src->uri,
+      "http-version", G_TYPE_STRING, version,
+      "connection-reused", G_TYPE_BOOLEAN, num_connects == 0,
+      "namelookup-time", G_TYPE_UINT64,
+      _curl_info_time (handle, CURLINFO_NAMELOOKUP_TIME),
+      "connect-time", G_TYPE_UINT64,
+      _curl_info_time (handle, CURLINFO_CONNECT_TIME),
+      "appconnect-time", G_TYPE_UINT64,
+      _curl_info_time (handle, CURLINFO_APPCONNECT_TIME),
+      "starttransfer-time", G_TYPE_UINT64,
+      _curl_info_time (handle, CURLINFO_STARTTRANSFER_TIME),
+      "total-time", G_TYPE_UINT64,
+      _curl_info_time (handle, CURLINFO_TOTAL_TIME),
+      "bytes-received", G_TYPE_UINT64, (guint64) bytes,
+      "download-speed", G_TYPE_DOUBLE, speed, NULL);
+
+  GST_DEBUG_OBJECT (src, "Request stats: %" GST_PTR_FORMAT, stats);
+
+  if (src->stats != NULL)
+    gst_structure_free (src->stats);
+  src->stats = gst_structure_copy (stats);
+
+  return gst_message_new_element (GST_OBJECT_CAST (src), stats);
+}
+
 /*
  * "Negotiate" capabilities between us and the sink.
  * I.e. tell the sink device what data to expect. We can't be told what to send
@@ -1318,14 +1523,23 @@ gst_curl_http_src_cleanup_instance (GstCurlHttpSrc * src)
 
   g_cond_clear (&src->signal);
 
-  g_free (src->buffer);
-  src->buffer = NULL;
+  gst_curl_http_src_clear_buffers (src);
+  if (src->pool != NULL) {
+    gst_buffer_pool_set_active (src->pool, FALSE);
+    gst_object_unref (src->pool);
+    src->pool = NULL;
+  }
 
   if (src->http_headers != NULL) {
     gst_structure_free (src->http_headers);
     src->http_headers = NULL;
   }
 
+  if (src->stats != NULL) {
+    gst_structure_free (src->stats);
+    src->stats = NULL;
+  }
+
   gst_curl_http_src_destroy_easy_handle (src);
 }
 
@@ -1826,14 +2040,98 @@ gst_curl_http_src_strcasestr (const char *haystack, const char *needle)
 }
 
 /*
- * Receive chunks of the requested body and pass these back to the ::create()
- * loop
+ * (Re)create the pool the body is received into when the block size changed.
+ * Called from the streaming thread with the buffer_mutex held, before the
+ * request is handed to curl.
+ */
+static gboolean
+gst_curl_http_src_ensure_pool (GstCurlHttpSrc * src)
+{
+  GstStructure *config;
+  guint blocksize, size;
+
+  blocksize = gst_base_src_get_blocksize (GST_BASE_SRC (src));
+  if (blocksize == 0)
+    blocksize = CURL_MAX_WRITE_SIZE;
+
+  if (src->pool != NULL) {
+    config = gst_buffer_pool_get_config (src->pool);
+    gst_buffer_pool_config_get_params (config, NULL, &size, NULL, NULL);
+    gst_structure_free (config);
+    if (size == blocksize)
+      return TRUE;
+
+    gst_buffer_pool_set_active (src->pool, FALSE);
+    gst_object_unref (src->pool);
+  }
+
+  GST_DEBUG_OBJECT (src, "Receiving into blocks of %u bytes", blocksize);
+
+  /* No upper limit: the multi loop thread fills the blocks and must never
+   * block on the pool, that would stall the transfers of all instances. */
+  src->pool = gst_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (src->pool);
+  gst_buffer_pool_config_set_params (config, NULL, blocksize, 2, 0);
+  if (!gst_buffer_pool_set_config (src->pool, config) ||
+      !gst_buffer_pool_set_active (src->pool, TRUE)) {
+    GST_ERROR_OBJECT (src, "Failed to set up buffer pool");
+    gst_object_unref (src->pool);
+    src->pool = NULL;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/*
+ * Queue the block being filled, trimmed to the data written to it.
+ */
+static void
+gst_curl_http_src_flush_fill_buffer (GstCurlHttpSrc * src)
+{
+  if (src->fill_buffer == NULL)
+    return;
+
+  gst_buffer_unmap (src->fill_buffer, &src->fill_map);
+  if (src->fill_offset > 0) {
+    gst_buffer_set_size (src->fill_buffer, src->fill_offset);
+    g_queue_push_tail (&src->filled_buffers, src->fill_buffer);
+  } else {
+    gst_buffer_unref (src->fill_buffer);
+  }
+  src->fill_buffer = NULL;
+  src->fill_offset = 0;
+}
+
+static void
+gst_curl_http_src_clear_buffers (GstCurlHttpSrc * src)
+{
+  GstBuffer *buf;
+
+  if (src->fill_buffer != NULL) {
+    gst_buffer_unmap (src->fill_buffer, &src->fill_map);
+    gst_buffer_unref (src->fill_buffer);
+    src->fill_buffer = NULL;
+    src->fill_offset = 0;
+  }
+
+  while ((buf = g_queue_pop_head (&src->filled_buffers)))
+    gst_buffer_unref (buf);
+}
+
+/*
+ * Copy chunks of the requested body into pooled blocks and wake up the
+ * ::create() loop. It pushes the full blocks, or the partially filled one if
+ * there is no full block.
  */
 static size_t
 gst_curl_http_src_get_chunks (void *chunk, size_t size, size_t nmemb, void *src)
 {
   GstCurlHttpSrc *s = src;
   size_t chunk_len = size * nmemb;
+  const guint8 *data = chunk;
+  size_t remaining = chunk_len;
+
   GST_TRACE_OBJECT (s,
       "Received curl chunk for URI %s of size %d", s->uri, (int) chunk_len);
   g_mutex_lock (&s->buffer_mutex);
@@ -1841,14 +2139,38 @@ gst_curl_http_src_get_chunks (void *chunk, size_t size, size_t nmemb, void *src)
     g_mutex_unlock (&s->buffer_mutex);
     return chunk_len;
   }
-  s->buffer =
-      g_realloc (s->buffer, (s->buffer_len + chunk_len + 1) * sizeof (char));
-  if (s->buffer == NULL) {
-    GST_ERROR_OBJECT (s, "Realloc for cURL response message failed!\n");
-    return 0;
+
+  while (remaining > 0) {
+    size_t len;
+
+    if (s->fill_buffer == NULL) {
+      if (s->pool == NULL || gst_buffer_pool_acquire_buffer (s->pool,
+              &s->fill_buffer, NULL) != GST_FLOW_OK) {
+        GST_ERROR_OBJECT (s, "Couldn't get a buffer for the cURL response");
+        s->fill_buffer = NULL;
+        g_mutex_unlock (&s->buffer_mutex);
+        return 0;
+      }
+      if (!gst_buffer_map (s->fill_buffer, &s->fill_map, GST_MAP_WRITE)) {
+        GST_ERROR_OBJECT (s, "Couldn't map a buffer for the cURL response");
+        gst_buffer_unref (s->fill_buffer);
+        s->fill_buffer = NULL;
+        g_mutex_unlock (&s->buffer_mutex);
+        return 0;
+      }
+      s->fill_offset = 0;
+    }
+
+    len = MIN (remaining, s->fill_map.size - s->fill_offset);
+    memcpy (s->fill_map.data + s->fill_offset, data, len);
+    s->fill_offset += len;
+    data += len;
+    remaining -= len;
+
+    if (s->fill_offset == s->fill_map.size)
+      gst_curl_http_src_flush_fill_buffer (s);
   }
-  memcpy (s->buffer + s->buffer_len, chunk, chunk_len);
-  s->buffer_len += chunk_len;
+
   g_cond_signal (&s->signal);
   g_mutex_unlock (&s->buffer_mutex);
   return chunk_len;
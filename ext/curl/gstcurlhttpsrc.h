@@ -126,6 +126,10 @@ struct _GstCurlHttpSrcMultiTaskContext
 
   /* < private > */
   CURLM *multi_handle;
+
+  /* DNS cache and TLS sessions shared by all easy handles of the class */
+  CURLSH *share_handle;
+  GMutex share_locks[CURL_LOCK_DATA_LAST];
 };
 
 struct _GstCurlHttpSrcClass
@@ -201,8 +205,14 @@ struct _GstCurlHttpSrc
   CURL *curl_handle;
   GMutex buffer_mutex;
   GCond signal;
-  gchar *buffer;
-  guint buffer_len;
+  /* Received data is copied into blocks from the pool, ::create() hands out
+   * full blocks, or the one being filled if there is none. All protected by
+   * buffer_mutex. */
+  GstBufferPool *pool;
+  GstBuffer *fill_buffer;       /* block curl is currently writing to */
+  GstMapInfo fill_map;
+  gsize fill_offset;
+  GQueue filled_buffers;        /* complete blocks ready to be pushed */
   gboolean transfer_begun;
   gboolean data_received;
 
@@ -217,6 +227,9 @@ struct _GstCurlHttpSrc
   CURLcode curl_result;
   char curl_errbuf[CURL_ERROR_SIZE];
 
+  /* timing of the last completed request, protected by buffer_mutex */
+  GstStructure *stats;
+
   GstCaps *caps;
 };
 
@@ -245,6 +258,7 @@ enum
   PROP_MAXCONCURRENT_PROXY,
   PROP_MAXCONCURRENT_GLOBAL,
   PROP_HTTPVERSION,
+  PROP_STATS,
   PROP_MAX
 };
 
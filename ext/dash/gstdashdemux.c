@@ -173,6 +173,12 @@
  * advance to the next fragment (just like in the normal case) or to a
  * fragment much further away (as explained below).
  *
+ * For On-Demand profile streams the SIDX tells for each subsegment whether
+ * it starts with a SAP. For those subsegments the moof and the keyframe
+ * directly following it are requested in a single range request, and the
+ * first sample is used as keyframe even if the moof does not carry any
+ * sample flags.
+ *
  *
  * * Deciding the optimal "next" keyframe/fragment to download:
  *
@@ -436,6 +442,34 @@ SIDX_ENTRY (GstDashDemuxStream * s, gint i)
 
 #define SIDX_CURRENT_ENTRY(s) SIDX_ENTRY(s, SIDX(s)->entry_index)
 
+/* Whether the moof of the current fragment was parsed into sample tables */
+#define HAVE_MOOF(s) ((s)->moof_parser.status == GST_ISOFF_MOOF_PARSER_FINISHED)
+
+/* Whether the SIDX has an entry for the current subsegment */
+static gboolean
+gst_dash_demux_stream_has_sidx_entry (GstDashDemuxStream * dashstream)
+{
+  return dashstream->sidx_parser.status == GST_ISOFF_SIDX_PARSER_FINISHED &&
+      dashstream->sidx_position != GST_CLOCK_TIME_NONE &&
+      SIDX (dashstream)->entry_index < SIDX (dashstream)->entries_count;
+}
+
+/* Whether the SIDX entry of the current subsegment signals that it starts
+ * with a SAP of type 1 to 3, i.e. that its first sample is a keyframe */
+static gboolean
+gst_dash_demux_stream_sidx_starts_with_sap (GstDashDemuxStream * dashstream)
+{
+  GstSidxBoxEntry *entry;
+
+  if (!gst_dash_demux_stream_has_sidx_entry (dashstream))
+    return FALSE;
+
+  entry = SIDX_CURRENT_ENTRY (dashstream);
+
+  return entry->starts_with_sap && entry->sap_type >= 1 &&
+      entry->sap_type <= 3 && entry->sap_delta_time == 0;
+}
+
 static void gst_dash_demux_send_content_protection_event (gpointer cp_data,
     gpointer stream);
 
@@ -793,6 +827,7 @@ gst_dash_demux_setup_all_streams (GstDashDemux * demux)
     GstPad *srcpad;
     gchar *lang = NULL;
     GstTagList *tags = NULL;
+    guint startup_bitrate;
 
     active_stream = gst_mpdparser_get_active_stream_by_index (demux->client, i);
     if (active_stream == NULL)
@@ -805,6 +840,25 @@ gst_dash_demux_setup_all_streams (GstDashDemux * demux)
       continue;
     }
 
+    /* streams start with the lowest representation, unless a startup
+     * bitrate was configured */
+    if (gst_adaptive_demux_get_startup_bitrate (GST_ADAPTIVE_DEMUX_CAST
+            (demux), &startup_bitrate) && startup_bitrate > 0
+        && active_stream->cur_adapt_set) {
+      GList *rep_list = active_stream->cur_adapt_set->Representations;
+      gint rep_idx;
+
+      rep_idx = gst_mpdparser_get_rep_idx_with_max_bandwidth (rep_list,
+          startup_bitrate, demux->max_video_width, demux->max_video_height,
+          demux->max_video_framerate_n, demux->max_video_framerate_d);
+      if (rep_idx != -1 && rep_idx != active_stream->representation_idx) {
+        GST_INFO_OBJECT (demux, "Starting stream %d with representation %d",
+            i, rep_idx);
+        gst_mpd_client_setup_representation (demux->client, active_stream,
+            g_list_nth_data (rep_list, rep_idx));
+      }
+    }
+
     srcpad = gst_dash_demux_create_pad (demux, active_stream);
     if (srcpad == NULL)
       continue;
@@ -871,6 +925,7 @@ gst_dash_demux_setup_all_streams (GstDashDemux * demux)
     }
 
     gst_isoff_sidx_parser_init (&stream->sidx_parser);
+    gst_isoff_moof_parser_init (&stream->moof_parser);
   }
 
   return TRUE;
@@ -1482,9 +1537,7 @@ gst_dash_demux_stream_seek (GstAdaptiveDemuxStream * stream, gboolean forward,
   dashstream->isobmff_parser.current_start_offset = 0;
   dashstream->isobmff_parser.current_size = 0;
 
-  if (dashstream->moof)
-    gst_isoff_moof_box_free (dashstream->moof);
-  dashstream->moof = NULL;
+  gst_isoff_moof_parser_clear (&dashstream->moof_parser);
   if (dashstream->moof_sync_samples)
     g_array_free (dashstream->moof_sync_samples, TRUE);
   dashstream->moof_sync_samples = NULL;
@@ -2074,9 +2127,7 @@ gst_dash_demux_stream_advance_fragment (GstAdaptiveDemuxStream * stream)
   dashstream->isobmff_parser.current_start_offset = 0;
   dashstream->isobmff_parser.current_size = 0;
 
-  if (dashstream->moof)
-    gst_isoff_moof_box_free (dashstream->moof);
-  dashstream->moof = NULL;
+  gst_isoff_moof_parser_clear (&dashstream->moof_parser);
   if (dashstream->moof_sync_samples)
     g_array_free (dashstream->moof_sync_samples, TRUE);
   dashstream->moof_sync_samples = NULL;
@@ -2267,9 +2318,7 @@ gst_dash_demux_stream_select_bitrate (GstAdaptiveDemuxStream * stream,
     if (dashstream->adapter)
       gst_adapter_clear (dashstream->adapter);
 
-    if (dashstream->moof)
-      gst_isoff_moof_box_free (dashstream->moof);
-    dashstream->moof = NULL;
+    gst_isoff_moof_parser_clear (&dashstream->moof_parser);
     if (dashstream->moof_sync_samples)
       g_array_free (dashstream->moof_sync_samples, TRUE);
     dashstream->moof_sync_samples = NULL;
@@ -2691,8 +2740,20 @@ gst_dash_demux_need_another_chunk (GstAdaptiveDemuxStream * stream)
       stream->fragment.chunk_size = 8192;
       /* Do we have the first fourcc already or are we in the middle */
       if (dashstream->isobmff_parser.current_fourcc == 0) {
+        gboolean sync_sample_after_moof;
+
+        /* With a SIDX entry for this subsegment we know whether it starts
+         * with a keyframe, otherwise guess from the previous fragments */
+        if (gst_mpd_client_has_isoff_ondemand_profile (dashdemux->client) &&
+            gst_dash_demux_stream_has_sidx_entry (dashstream))
+          sync_sample_after_moof =
+              gst_dash_demux_stream_sidx_starts_with_sap (dashstream);
+        else
+          sync_sample_after_moof =
+              dashstream->first_sync_sample_always_after_moof;
+
         stream->fragment.chunk_size += dashstream->moof_average_size;
-        if (dashstream->first_sync_sample_always_after_moof) {
+        if (sync_sample_after_moof) {
           gboolean first = FALSE;
           /* Check if we'll really need that first sample */
           if (GST_CLOCK_TIME_IS_VALID (dashstream->target_time)) {
@@ -2733,7 +2794,7 @@ gst_dash_demux_need_another_chunk (GstAdaptiveDemuxStream * stream)
           stream->fragment.chunk_size = sidx_end_offset - downloaded_end_offset;
         }
       }
-    } else if (dashstream->moof && dashstream->moof_sync_samples) {
+    } else if (HAVE_MOOF (dashstream) && dashstream->moof_sync_samples) {
       /* Have the moof, either we're done now or we want to download the
        * directly following sync sample */
       if (dashstream->first_sync_sample_after_moof
@@ -2776,7 +2837,7 @@ gst_dash_demux_need_another_chunk (GstAdaptiveDemuxStream * stream)
     /* We might've decided that we can't allow key-unit only
      * trickmodes while doing chunked downloading. In that case
      * just download from here to the end now */
-    if (dashstream->moof
+    if (HAVE_MOOF (dashstream)
         && GST_ADAPTIVE_DEMUX_IN_TRICKMODE_KEY_UNITS (stream->demux)) {
       stream->fragment.chunk_size = -1;
     } else {
@@ -2861,14 +2922,25 @@ gst_dash_demux_parse_isobmff (GstAdaptiveDemux * demux,
 
     if (dash_stream->isobmff_parser.current_fourcc == GST_ISOFF_FOURCC_MOOF) {
       GstByteReader sub_reader;
+      GstIsoffParserResult res;
+      guint dummy;
 
       /* Only allow SIDX before the very first moof */
       dash_stream->allow_sidx = FALSE;
 
-      g_assert (dash_stream->moof == NULL);
+      g_assert (dash_stream->moof_parser.status == GST_ISOFF_MOOF_PARSER_INIT);
       g_assert (dash_stream->moof_sync_samples == NULL);
-      gst_byte_reader_get_sub_reader (&reader, &sub_reader, size - header_size);
-      dash_stream->moof = gst_isoff_moof_box_parse (&sub_reader);
+
+      /* The moof parser starts at the box header */
+      gst_byte_reader_set_pos (&reader,
+          gst_byte_reader_get_pos (&reader) - header_size);
+      gst_byte_reader_get_sub_reader (&reader, &sub_reader, size);
+      res = gst_isoff_moof_parser_parse (&dash_stream->moof_parser,
+          &sub_reader, &dummy);
+      if (res != GST_ISOFF_PARSER_DONE) {
+        GST_WARNING_OBJECT (stream->pad, "Failed to parse moof");
+        gst_isoff_moof_parser_clear (&dash_stream->moof_parser);
+      }
       dash_stream->moof_offset =
           dash_stream->isobmff_parser.current_start_offset;
       dash_stream->moof_size = size;
@@ -3029,10 +3101,10 @@ gst_dash_demux_find_sync_samples (GstAdaptiveDemux * demux,
   GstDashDemuxStream *dash_stream = (GstDashDemuxStream *) stream;
   guint i;
   guint32 track_id = 0;
-  guint64 prev_traf_end;
   gboolean trex_sample_flags = FALSE;
+  gboolean starts_with_sap = FALSE;
 
-  if (!dash_stream->moof) {
+  if (!HAVE_MOOF (dash_stream)) {
     dashdemux->allow_trickmode_key_units = FALSE;
     return FALSE;
   }
@@ -3041,115 +3113,70 @@ gst_dash_demux_find_sync_samples (GstAdaptiveDemux * demux,
   dash_stream->moof_sync_samples =
       g_array_new (FALSE, FALSE, sizeof (GstDashStreamSyncSample));
 
-  prev_traf_end = dash_stream->moof_offset;
-
-  /* generate table of keyframes and offsets */
-  for (i = 0; i < dash_stream->moof->traf->len; i++) {
-    GstTrafBox *traf = &g_array_index (dash_stream->moof->traf, GstTrafBox, i);
-    guint64 traf_offset = 0, prev_trun_end;
-    guint j;
+  /* If this is the first moof of a subsegment that the SIDX marks as
+   * starting with a SAP, its first sample is a keyframe even if the sample
+   * flags are only given by the trex */
+  if (gst_dash_demux_stream_sidx_starts_with_sap (dash_stream) &&
+      dash_stream->moof_offset ==
+      dash_stream->sidx_base_offset + SIDX_CURRENT_ENTRY (dash_stream)->offset)
+    starts_with_sap = TRUE;
+
+  /* generate table of keyframes and offsets from the per-traf sample tables
+   * of the moof parser, which already resolved the data offsets */
+  for (i = 0; i < dash_stream->moof_parser.tables->len; i++) {
+    GstIsoffSampleTable *table =
+        &g_array_index (dash_stream->moof_parser.tables, GstIsoffSampleTable,
+        i);
+    guint64 base_offset;
+    guint k;
 
     if (i == 0) {
-      track_id = traf->tfhd.track_id;
-    } else if (track_id != traf->tfhd.track_id) {
+      track_id = table->track_id;
+    } else if (track_id != table->track_id) {
       GST_ERROR_OBJECT (stream->pad,
           "moof with trafs of different track ids (%u != %u)", track_id,
-          traf->tfhd.track_id);
+          table->track_id);
       g_array_free (dash_stream->moof_sync_samples, TRUE);
       dash_stream->moof_sync_samples = NULL;
       dashdemux->allow_trickmode_key_units = FALSE;
       return FALSE;
     }
 
-    if (traf->tfhd.flags & GST_TFHD_FLAGS_BASE_DATA_OFFSET_PRESENT) {
-      traf_offset = traf->tfhd.base_data_offset;
-    } else if (traf->tfhd.flags & GST_TFHD_FLAGS_DEFAULT_BASE_IS_MOOF) {
-      traf_offset = dash_stream->moof_offset;
-    } else {
-      traf_offset = prev_traf_end;
+    if (table->trex_sizes) {
+      GST_FIXME_OBJECT (stream->pad,
+          "Sample size given by trex - can't download only keyframes");
+      g_array_free (dash_stream->moof_sync_samples, TRUE);
+      dash_stream->moof_sync_samples = NULL;
+      dashdemux->allow_trickmode_key_units = FALSE;
+      return FALSE;
     }
 
-    prev_trun_end = traf_offset;
-
-    for (j = 0; j < traf->trun->len; j++) {
-      GstTrunBox *trun = &g_array_index (traf->trun, GstTrunBox, j);
-      guint64 trun_offset, prev_sample_end;
-      guint k;
-
-      if (trun->flags & GST_TRUN_FLAGS_DATA_OFFSET_PRESENT) {
-        trun_offset = traf_offset + trun->data_offset;
-      } else {
-        trun_offset = prev_trun_end;
-      }
-
-      prev_sample_end = trun_offset;
-      for (k = 0; k < trun->samples->len; k++) {
-        GstTrunSample *sample =
-            &g_array_index (trun->samples, GstTrunSample, k);
-        guint64 sample_offset;
-        guint32 sample_flags;
-#if 0
-        guint32 sample_duration;
-#endif
+    base_offset = table->absolute_offsets ? 0 : dash_stream->moof_offset;
 
-        sample_offset = prev_sample_end;
+    for (k = 0; k < table->sizes->len; k++) {
+      guint64 sample_offset =
+          base_offset + g_array_index (table->offsets, guint64, k);
+      guint32 sample_size = g_array_index (table->sizes, guint32, k);
+      guint32 sample_flags = g_array_index (table->flags, guint32, k);
 
-        if (trun->flags & GST_TRUN_FLAGS_SAMPLE_FLAGS_PRESENT) {
-          sample_flags = sample->sample_flags;
-        } else if ((trun->flags & GST_TRUN_FLAGS_FIRST_SAMPLE_FLAGS_PRESENT)
-            && k == 0) {
-          sample_flags = trun->first_sample_flags;
-        } else if (traf->
-            tfhd.flags & GST_TFHD_FLAGS_DEFAULT_SAMPLE_FLAGS_PRESENT) {
-          sample_flags = traf->tfhd.default_sample_flags;
+      if (sample_flags == GST_ISOFF_SAMPLE_FLAGS_FROM_TREX) {
+        if (starts_with_sap && i == 0 && k == 0) {
+          sample_flags = 0;
         } else {
           trex_sample_flags = TRUE;
           continue;
         }
-
-#if 0
-        if (trun->flags & GST_TRUN_FLAGS_SAMPLE_DURATION_PRESENT) {
-          sample_duration = sample->sample_duration;
-        } else if (traf->
-            tfhd.flags & GST_TFHD_FLAGS_DEFAULT_SAMPLE_DURATION_PRESENT) {
-          sample_duration = traf->tfhd.default_sample_duration;
-        } else {
-          GST_FIXME_OBJECT (stream->pad,
-              "Sample duration given by trex - can't download only keyframes");
-          g_array_free (dash_stream->moof_sync_samples, TRUE);
-          dash_stream->moof_sync_samples = NULL;
-          return FALSE;
-        }
-#endif
-
-        if (trun->flags & GST_TRUN_FLAGS_SAMPLE_SIZE_PRESENT) {
-          prev_sample_end += sample->sample_size;
-        } else if (traf->
-            tfhd.flags & GST_TFHD_FLAGS_DEFAULT_SAMPLE_SIZE_PRESENT) {
-          prev_sample_end += traf->tfhd.default_sample_size;
-        } else {
-          GST_FIXME_OBJECT (stream->pad,
-              "Sample size given by trex - can't download only keyframes");
-          g_array_free (dash_stream->moof_sync_samples, TRUE);
-          dash_stream->moof_sync_samples = NULL;
-          dashdemux->allow_trickmode_key_units = FALSE;
-          return FALSE;
-        }
-
-        /* Non-non-sync sample aka sync sample */
-        if (!GST_ISOFF_SAMPLE_FLAGS_SAMPLE_IS_NON_SYNC_SAMPLE (sample_flags) ||
-            GST_ISOFF_SAMPLE_FLAGS_SAMPLE_DEPENDS_ON (sample_flags) == 2) {
-          GstDashStreamSyncSample sync_sample =
-              { sample_offset, prev_sample_end - 1 };
-          /* TODO: need timestamps so we can decide to download or not */
-          g_array_append_val (dash_stream->moof_sync_samples, sync_sample);
-        }
       }
 
-      prev_trun_end = prev_sample_end;
+      /* Non-non-sync sample aka sync sample */
+      if (!GST_ISOFF_SAMPLE_FLAGS_SAMPLE_IS_NON_SYNC_SAMPLE (sample_flags) ||
+          GST_ISOFF_SAMPLE_FLAGS_SAMPLE_DEPENDS_ON (sample_flags) == 2) {
+        GstDashStreamSyncSample sync_sample =
+            { sample_offset, sample_offset + sample_size - 1 };
+        /* TODO: need timestamps so we can decide to download or not */
+        g_array_append_val (dash_stream->moof_sync_samples, sync_sample);
+      }
     }
-
-    prev_traf_end = prev_trun_end;
   }
 
   if (trex_sample_flags) {
@@ -3542,8 +3569,7 @@ gst_dash_demux_stream_free (GstAdaptiveDemuxStream * stream)
   gst_isoff_sidx_parser_clear (&dash_stream->sidx_parser);
   if (dash_stream->adapter)
     g_object_unref (dash_stream->adapter);
-  if (dash_stream->moof)
-    gst_isoff_moof_box_free (dash_stream->moof);
+  gst_isoff_moof_parser_clear (&dash_stream->moof_parser);
   if (dash_stream->moof_sync_samples)
     g_array_free (dash_stream->moof_sync_samples, TRUE);
 }
@@ -89,7 +89,7 @@ struct _GstDashDemuxStream
     guint64 current_size;
   } isobmff_parser;
 
-  GstMoofBox *moof;
+  GstMoofParser moof_parser;
   guint64 moof_offset, moof_size;
   GArray *moof_sync_samples;
   guint current_sync_sample;
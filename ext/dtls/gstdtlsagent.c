@@ -31,6 +31,8 @@
 
 #include "gstdtlsagent.h"
 
+#include <string.h>
+
 #ifdef __APPLE__
 # define __AVAILABILITYMACROS__
 # define DEPRECATED_IN_MAC_OS_X_VERSION_10_7_AND_LATER
@@ -55,11 +57,19 @@ enum
 
 static GParamSpec *properties[NUM_PROPERTIES];
 
+/* Upper bound on the number of client sessions kept for resumption, the
+ * oldest one is dropped first when it is reached. */
+#define MAX_CLIENT_SESSIONS 256
+
 struct _GstDtlsAgentPrivate
 {
   SSL_CTX *ssl_context;
 
   GstDtlsCertificate *certificate;
+
+  GMutex session_mutex;
+  GHashTable *client_sessions;
+  GQueue client_session_keys;
 };
 
 static void gst_dtls_agent_finalize (GObject * gobject);
@@ -200,6 +210,19 @@ gst_dtls_agent_init (GstDtlsAgent * self)
 #if OPENSSL_VERSION_NUMBER >= 0x1000200fL
   SSL_CTX_set_ecdh_auto (priv->ssl_context, 1);
 #endif
+
+  /* Let peers that talked to this agent before resume their session instead
+   * of going through a full handshake. Client side sessions are kept by
+   * _gst_dtls_agent_store_session() since the connections come and go. */
+  SSL_CTX_set_session_id_context (priv->ssl_context,
+      (const guchar *) "gstdtls", strlen ("gstdtls"));
+  SSL_CTX_set_session_cache_mode (priv->ssl_context,
+      SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_AUTO_CLEAR);
+
+  g_mutex_init (&priv->session_mutex);
+  priv->client_sessions = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, (GDestroyNotify) SSL_SESSION_free);
+  g_queue_init (&priv->client_session_keys);
 }
 
 static void
@@ -207,9 +230,17 @@ gst_dtls_agent_finalize (GObject * gobject)
 {
   GstDtlsAgentPrivate *priv = GST_DTLS_AGENT (gobject)->priv;
 
+  /* the keys are owned by the hash table */
+  g_queue_clear (&priv->client_session_keys);
+  g_hash_table_unref (priv->client_sessions);
+  priv->client_sessions = NULL;
+  g_mutex_clear (&priv->session_mutex);
+
   SSL_CTX_free (priv->ssl_context);
   priv->ssl_context = NULL;
 
+  g_clear_object (&priv->certificate);
+
   GST_DEBUG_OBJECT (gobject, "finalized");
 
   G_OBJECT_CLASS (gst_dtls_agent_parent_class)->finalize (gobject);
@@ -282,3 +313,64 @@ _gst_dtls_agent_peek_context (GstDtlsAgent * self)
   g_return_val_if_fail (GST_IS_DTLS_AGENT (self), NULL);
   return self->priv->ssl_context;
 }
+
+/* Returns a new reference to the session stored under @key, to be handed to
+ * SSL_set_session() before a client handshake, or NULL. */
+gpointer
+_gst_dtls_agent_lookup_session (GstDtlsAgent * self, const gchar * key)
+{
+  GstDtlsAgentPrivate *priv;
+  SSL_SESSION *session;
+
+  g_return_val_if_fail (GST_IS_DTLS_AGENT (self), NULL);
+  g_return_val_if_fail (key, NULL);
+
+  priv = self->priv;
+
+  g_mutex_lock (&priv->session_mutex);
+  session = g_hash_table_lookup (priv->client_sessions, key);
+  if (session) {
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+    SSL_SESSION_up_ref (session);
+#else
+    CRYPTO_add (&session->references, 1, CRYPTO_LOCK_SSL_SESSION);
+#endif
+  }
+  g_mutex_unlock (&priv->session_mutex);
+
+  return session;
+}
+
+/* Takes ownership of @session and stores it under @key, replacing any
+ * previous session for the same peer. */
+void
+_gst_dtls_agent_store_session (GstDtlsAgent * self, const gchar * key,
+    gpointer session)
+{
+  GstDtlsAgentPrivate *priv;
+
+  g_return_if_fail (GST_IS_DTLS_AGENT (self));
+  g_return_if_fail (key);
+  g_return_if_fail (session);
+
+  priv = self->priv;
+
+  g_mutex_lock (&priv->session_mutex);
+  if (!g_hash_table_contains (priv->client_sessions, key)) {
+    gchar *oldest;
+
+    if (g_queue_get_length (&priv->client_session_keys) >=
+        MAX_CLIENT_SESSIONS) {
+      oldest = g_queue_pop_head (&priv->client_session_keys);
+      GST_LOG_OBJECT (self, "evicting session for %s", oldest);
+      g_hash_table_remove (priv->client_sessions, oldest);
+    }
+    key = g_strdup (key);
+    g_queue_push_tail (&priv->client_session_keys, (gpointer) key);
+    g_hash_table_insert (priv->client_sessions, (gpointer) key, session);
+  } else {
+    /* keeps the existing key, which the eviction queue points to */
+    g_hash_table_insert (priv->client_sessions, g_strdup (key), session);
+  }
+  g_mutex_unlock (&priv->session_mutex);
+}
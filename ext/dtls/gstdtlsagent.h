@@ -76,6 +76,8 @@ gchar *gst_dtls_agent_get_certificate_pem(GstDtlsAgent *self);
 /* internal */
 void _gst_dtls_init_openssl(void);
 const GstDtlsAgentContext _gst_dtls_agent_peek_context(GstDtlsAgent *);
+gpointer _gst_dtls_agent_lookup_session(GstDtlsAgent *, const gchar *key);
+void _gst_dtls_agent_store_session(GstDtlsAgent *, const gchar *key, gpointer session);
 
 G_END_DECLS
 
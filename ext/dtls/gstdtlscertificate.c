@@ -45,6 +45,7 @@
 #endif
 #endif
 
+#include <openssl/ec.h>
 #include <openssl/ssl.h>
 
 GST_DEBUG_CATEGORY_STATIC (gst_dtls_certificate_debug);
@@ -97,7 +98,7 @@ gst_dtls_certificate_class_init (GstDtlsCertificateClass * klass)
   properties[PROP_PEM] =
       g_param_spec_string ("pem",
       "Pem string",
-      "A string containing a X509 certificate and RSA private key in PEM format",
+      "A string containing a X509 certificate and private key in PEM format",
       DEFAULT_PEM,
       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
 
@@ -178,7 +179,7 @@ static void
 init_generated (GstDtlsCertificate * self)
 {
   GstDtlsCertificatePrivate *priv = self->priv;
-  RSA *rsa;
+  EC_KEY *ec_key;
   X509_NAME *name = NULL;
 
   g_return_if_fail (!priv->x509);
@@ -200,25 +201,20 @@ init_generated (GstDtlsCertificate * self)
     return;
   }
 
-  /* XXX: RSA_generate_key is actually deprecated in 0.9.8 */
-#if OPENSSL_VERSION_NUMBER < 0x10100001L
-  rsa = RSA_generate_key (2048, RSA_F4, NULL, NULL);
-#else
-  rsa = RSA_new ();
-  if (rsa != NULL) {
-    BIGNUM *e = BN_new ();
-    if (e == NULL || !BN_set_word (e, RSA_F4)
-        || !RSA_generate_key_ex (rsa, 2048, e, NULL)) {
-      RSA_free (rsa);
-      rsa = NULL;
+  /* P-256 keys are a fraction of the cost of RSA 2048 to generate and make
+   * for smaller handshake flights; RSA can still be used by supplying a
+   * certificate through the "pem" property. */
+  ec_key = EC_KEY_new_by_curve_name (NID_X9_62_prime256v1);
+  if (ec_key) {
+    EC_KEY_set_asn1_flag (ec_key, OPENSSL_EC_NAMED_CURVE);
+    if (!EC_KEY_generate_key (ec_key)) {
+      EC_KEY_free (ec_key);
+      ec_key = NULL;
     }
-    if (e)
-      BN_free (e);
   }
-#endif
 
-  if (!rsa) {
-    GST_WARNING_OBJECT (self, "failed to generate RSA");
+  if (!ec_key) {
+    GST_WARNING_OBJECT (self, "failed to generate EC key");
     EVP_PKEY_free (priv->private_key);
     priv->private_key = NULL;
     X509_free (priv->x509);
@@ -226,17 +222,17 @@ init_generated (GstDtlsCertificate * self)
     return;
   }
 
-  if (!EVP_PKEY_assign_RSA (priv->private_key, rsa)) {
-    GST_WARNING_OBJECT (self, "failed to assign RSA");
-    RSA_free (rsa);
-    rsa = NULL;
+  if (!EVP_PKEY_assign_EC_KEY (priv->private_key, ec_key)) {
+    GST_WARNING_OBJECT (self, "failed to assign EC key");
+    EC_KEY_free (ec_key);
+    ec_key = NULL;
     EVP_PKEY_free (priv->private_key);
     priv->private_key = NULL;
     X509_free (priv->x509);
     priv->x509 = NULL;
     return;
   }
-  rsa = NULL;
+  ec_key = NULL;
 
   X509_set_version (priv->x509, 2);
   ASN1_INTEGER_set (X509_get_serialNumber (priv->x509), 0);
@@ -83,9 +83,13 @@ struct _GstDtlsConnectionPrivate
   SSL *ssl;
   BIO *bio;
 
+  GstDtlsAgent *agent;
+  gchar *resumption_key;
+
   gboolean is_client;
   gboolean is_alive;
   gboolean keys_exported;
+  gboolean failed;
 
   GMutex mutex;
   GCond condition;
@@ -105,6 +109,7 @@ static void gst_dtls_connection_set_property (GObject *, guint prop_id,
 
 static void log_state (GstDtlsConnection *, const gchar * str);
 static void export_srtp_keys (GstDtlsConnection *);
+static gboolean verify_resumed_peer (GstDtlsConnection *);
 static void openssl_poll (GstDtlsConnection *);
 static int openssl_verify_callback (int preverify_ok,
     X509_STORE_CTX * x509_ctx);
@@ -169,6 +174,9 @@ gst_dtls_connection_init (GstDtlsConnection * self)
   priv->ssl = NULL;
   priv->bio = NULL;
 
+  priv->agent = NULL;
+  priv->resumption_key = NULL;
+
   priv->send_closure = NULL;
 
   priv->is_client = FALSE;
@@ -202,6 +210,10 @@ gst_dtls_connection_finalize (GObject * gobject)
   SSL_free (priv->ssl);
   priv->ssl = NULL;
 
+  g_clear_object (&priv->agent);
+  g_free (priv->resumption_key);
+  priv->resumption_key = NULL;
+
   if (priv->send_closure) {
     g_closure_unref (priv->send_closure);
     priv->send_closure = NULL;
@@ -262,6 +274,7 @@ gst_dtls_connection_set_property (GObject * object, guint prop_id,
       agent = GST_DTLS_AGENT (g_value_get_object (value));
       g_return_if_fail (GST_IS_DTLS_AGENT (agent));
 
+      priv->agent = g_object_ref (agent);
       ssl_context = _gst_dtls_agent_peek_context (agent);
 
       priv->ssl = SSL_new (ssl_context);
@@ -308,6 +321,18 @@ gst_dtls_connection_start (GstDtlsConnection * self, gboolean is_client)
 
   priv->is_client = is_client;
   if (priv->is_client) {
+    if (priv->resumption_key) {
+      SSL_SESSION *session;
+
+      session = _gst_dtls_agent_lookup_session (priv->agent,
+          priv->resumption_key);
+      if (session) {
+        GST_DEBUG_OBJECT (self, "trying to resume session for %s",
+            priv->resumption_key);
+        SSL_set_session (priv->ssl, session);
+        SSL_SESSION_free (session);
+      }
+    }
     SSL_set_connect_state (priv->ssl);
   } else {
     SSL_set_accept_state (priv->ssl);
@@ -418,6 +443,18 @@ gst_dtls_connection_check_timeout_locked (GstDtlsConnection * self)
   }
 }
 
+void
+gst_dtls_connection_set_resumption_key (GstDtlsConnection * self,
+    const gchar * key)
+{
+  g_return_if_fail (GST_IS_DTLS_CONNECTION (self));
+
+  g_mutex_lock (&self->priv->mutex);
+  g_free (self->priv->resumption_key);
+  self->priv->resumption_key = g_strdup (key);
+  g_mutex_unlock (&self->priv->mutex);
+}
+
 void
 gst_dtls_connection_check_timeout (GstDtlsConnection * self)
 {
@@ -552,6 +589,20 @@ gst_dtls_connection_process (GstDtlsConnection * self, gpointer data, gint len)
   return result;
 }
 
+gboolean
+gst_dtls_connection_has_failed (GstDtlsConnection * self)
+{
+  gboolean failed;
+
+  g_return_val_if_fail (GST_IS_DTLS_CONNECTION (self), FALSE);
+
+  g_mutex_lock (&self->priv->mutex);
+  failed = self->priv->failed;
+  g_mutex_unlock (&self->priv->mutex);
+
+  return failed;
+}
+
 gint
 gst_dtls_connection_send (GstDtlsConnection * self, gpointer data, gint len)
 {
@@ -723,6 +774,24 @@ openssl_poll (GstDtlsConnection * self)
 
   if (ret == 1) {
     if (!self->priv->keys_exported) {
+      if (SSL_session_reused (self->priv->ssl)) {
+        GST_INFO_OBJECT (self, "session resumed");
+        if (!verify_resumed_peer (self)) {
+          GST_ERROR_OBJECT (self, "peer certificate of resumed session "
+              "was not accepted, closing connection");
+          /* tell the peer, it considers the handshake completed */
+          SSL_shutdown (self->priv->ssl);
+          self->priv->keys_exported = TRUE;
+          self->priv->failed = TRUE;
+          self->priv->is_alive = FALSE;
+          g_cond_signal (&self->priv->condition);
+          return;
+        }
+      } else if (self->priv->is_client && self->priv->resumption_key) {
+        _gst_dtls_agent_store_session (self->priv->agent,
+            self->priv->resumption_key, SSL_get1_session (self->priv->ssl));
+      }
+
       GST_INFO_OBJECT (self,
           "handshake just completed successfully, exporting keys");
       export_srtp_keys (self);
@@ -811,6 +880,37 @@ openssl_verify_callback (int preverify_ok, X509_STORE_CTX * x509_ctx)
   return accepted;
 }
 
+/* A resumed handshake skips certificate verification, so the peer certificate
+ * from the cached session still has to be offered for approval, the remote
+ * fingerprint may have changed since the session was established. */
+static gboolean
+verify_resumed_peer (GstDtlsConnection * self)
+{
+  X509 *peer;
+  gchar *pem;
+  gboolean accepted = FALSE;
+
+  peer = SSL_get_peer_certificate (self->priv->ssl);
+  if (!peer) {
+    GST_WARNING_OBJECT (self, "resumed session has no peer certificate");
+    return FALSE;
+  }
+
+  pem = _gst_dtls_x509_to_pem (peer);
+  X509_free (peer);
+
+  if (!pem) {
+    GST_WARNING_OBJECT (self,
+        "failed to convert resumed certificate to pem format");
+    return FALSE;
+  }
+
+  g_signal_emit (self, signals[SIGNAL_ON_PEER_CERTIFICATE], 0, pem, &accepted);
+  g_free (pem);
+
+  return accepted;
+}
+
 /*
     ########  ####  #######
     ##     ##  ##  ##     ##
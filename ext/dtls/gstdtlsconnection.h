@@ -85,6 +85,14 @@ struct _GstDtlsConnectionClass {
 GType gst_dtls_connection_get_type(void) G_GNUC_CONST;
 
 void gst_dtls_connection_start(GstDtlsConnection *, gboolean is_client);
+
+/*
+ * Sets the key under which the session is cached by the agent once the
+ * handshake completes. A client connection started with the key of an earlier
+ * connection to the same peer will attempt an abbreviated handshake.
+ * Must be called before gst_dtls_connection_start().
+ */
+void gst_dtls_connection_set_resumption_key(GstDtlsConnection *, const gchar *key);
 void gst_dtls_connection_check_timeout(GstDtlsConnection *);
 
 /*
@@ -112,6 +120,12 @@ void gst_dtls_connection_set_send_callback(GstDtlsConnection *, GClosure *);
  */
 gint gst_dtls_connection_process(GstDtlsConnection *, gpointer ptr, gint len);
 
+/*
+ * Returns TRUE if the connection was closed because the handshake could not
+ * be accepted, e.g. when the peer certificate of a resumed session was rejected.
+ */
+gboolean gst_dtls_connection_has_failed(GstDtlsConnection *);
+
 /*
  * If the DTLS handshake is completed this function will encode the given data.
  * Returns the length of the data sent, or 0 if the DTLS handshake is not completed.
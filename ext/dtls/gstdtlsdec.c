@@ -493,6 +493,17 @@ process_buffer_from_list (GstBuffer ** buffer, guint idx, gpointer user_data)
   return TRUE;
 }
 
+static GstFlowReturn
+check_connection_failed (GstDtlsDec * self)
+{
+  if (!gst_dtls_connection_has_failed (self->connection))
+    return GST_FLOW_OK;
+
+  GST_ELEMENT_ERROR (self, RESOURCE, NOT_AUTHORIZED, (NULL),
+      ("DTLS handshake of connection %s was rejected", self->connection_id));
+  return GST_FLOW_ERROR;
+}
+
 static GstFlowReturn
 sink_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
 {
@@ -507,7 +518,7 @@ sink_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
     GST_DEBUG_OBJECT (self, "Not produced any buffers");
     gst_buffer_list_unref (list);
 
-    return GST_FLOW_OK;
+    return check_connection_failed (self);
   }
 
   g_mutex_lock (&self->src_mutex);
@@ -553,7 +564,7 @@ sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   if (size <= 0) {
     gst_buffer_unref (buffer);
 
-    return GST_FLOW_OK;
+    return check_connection_failed (self);
   }
 
   g_mutex_lock (&self->src_mutex);
@@ -577,30 +588,51 @@ sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 static GHashTable *agent_table = NULL;
 G_LOCK_DEFINE_STATIC (agent_table);
 
+/* The generated certificate is shared by all elements of the process, key
+ * generation is by far the most expensive part of setting up an agent. It is
+ * replaced well before it expires, agents still in use keep the old one. */
+#define GENERATED_CERT_LIFETIME (30 * 24 * G_TIME_SPAN_HOUR)
+
 static GstDtlsAgent *generated_cert_agent = NULL;
+static gint64 generated_cert_time = 0;
+G_LOCK_DEFINE_STATIC (generated_cert_agent);
 
 static GstDtlsAgent *
 get_agent_by_pem (const gchar * pem)
 {
   GstDtlsAgent *agent;
+  GstDtlsCertificate *certificate;
 
   if (!pem) {
-    if (g_once_init_enter (&generated_cert_agent)) {
-      GstDtlsAgent *new_agent;
+    gint64 now = g_get_monotonic_time ();
 
-      new_agent = g_object_new (GST_TYPE_DTLS_AGENT, "certificate",
-          g_object_new (GST_TYPE_DTLS_CERTIFICATE, NULL), NULL);
+    G_LOCK (generated_cert_agent);
+
+    if (generated_cert_agent
+        && now - generated_cert_time >= GENERATED_CERT_LIFETIME) {
+      GST_DEBUG_OBJECT (generated_cert_agent,
+          "generated cert is due for rotation");
+      g_object_unref (generated_cert_agent);
+      generated_cert_agent = NULL;
+    }
+
+    if (!generated_cert_agent) {
+      certificate = g_object_new (GST_TYPE_DTLS_CERTIFICATE, NULL);
+      generated_cert_agent = g_object_new (GST_TYPE_DTLS_AGENT, "certificate",
+          certificate, NULL);
+      g_object_unref (certificate);
+      generated_cert_time = now;
 
       GST_DEBUG_OBJECT (generated_cert_agent,
           "no agent with generated cert found, creating new");
-      g_once_init_leave (&generated_cert_agent, new_agent);
     } else {
       GST_DEBUG_OBJECT (generated_cert_agent,
           "using agent with generated cert");
     }
 
-    agent = generated_cert_agent;
-    g_object_ref (agent);
+    agent = g_object_ref (generated_cert_agent);
+
+    G_UNLOCK (generated_cert_agent);
   } else {
     G_LOCK (agent_table);
 
@@ -612,9 +644,10 @@ get_agent_by_pem (const gchar * pem)
     agent = GST_DTLS_AGENT (g_hash_table_lookup (agent_table, pem));
 
     if (!agent) {
-      agent = g_object_new (GST_TYPE_DTLS_AGENT,
-          "certificate", g_object_new (GST_TYPE_DTLS_CERTIFICATE, "pem", pem,
-              NULL), NULL);
+      certificate = g_object_new (GST_TYPE_DTLS_CERTIFICATE, "pem", pem, NULL);
+      agent = g_object_new (GST_TYPE_DTLS_AGENT, "certificate", certificate,
+          NULL);
+      g_object_unref (certificate);
 
       g_object_weak_ref (G_OBJECT (agent), (GWeakNotify) agent_weak_ref_notify,
           (gpointer) g_strdup (pem));
@@ -700,6 +733,10 @@ create_connection (GstDtlsDec * self, gchar * id)
   self->connection =
       g_object_new (GST_TYPE_DTLS_CONNECTION, "agent", self->agent, NULL);
 
+  /* the connection id identifies the peer, a new connection under the same id
+   * will try to resume the previous session */
+  gst_dtls_connection_set_resumption_key (self->connection, id);
+
   g_object_weak_ref (G_OBJECT (self->connection),
       (GWeakNotify) connection_weak_ref_notify, g_strdup (id));
 
@@ -56,6 +56,11 @@ static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_STATIC_CAPS ("application/x-hls"));
 
 GST_DEBUG_CATEGORY (gst_hls_demux_debug);
+
+/* Decrypted fragments are handed out in buffers of at most this size */
+#define DECRYPT_BLOCK_SIZE (64 * 1024)
+/* Encrypted chunks the download may queue before waiting for the worker */
+#define DECRYPT_MAX_PENDING 16
 #define GST_CAT_DEFAULT gst_hls_demux_debug
 
 #define GST_M3U8_CLIENT_LOCK(l) /* FIXME */
@@ -75,12 +80,18 @@ static gchar *gst_hls_src_buf_to_utf8_playlist (GstBuffer * buf);
 
 static gboolean gst_hls_demux_change_playlist (GstHLSDemux * demux,
     guint max_bitrate, gboolean * changed);
-static GstBuffer *gst_hls_demux_decrypt_fragment (GstHLSDemux * demux,
-    GstHLSDemuxStream * stream, GstBuffer * encrypted_buffer, GError ** err);
+static gboolean gst_hls_demux_decrypt_fragment (GstHLSDemuxStream * stream,
+    GstBuffer * encrypted_buffer, GQueue * decrypted);
 static gboolean
 gst_hls_demux_stream_decrypt_start (GstHLSDemuxStream * stream,
     const guint8 * key_data, const guint8 * iv_data);
 static void gst_hls_demux_stream_decrypt_end (GstHLSDemuxStream * stream);
+static void gst_hls_demux_stream_decrypt_submit (GstHLSDemuxStream * stream,
+    GstBuffer * encrypted_buffer);
+static gboolean gst_hls_demux_stream_decrypt_collect (GstHLSDemuxStream *
+    stream, GQueue * decrypted, gboolean drain);
+static void gst_hls_demux_stream_decrypt_flush (GstHLSDemuxStream * stream);
+static void gst_hls_demux_stream_decrypt_stop (GstHLSDemuxStream * stream);
 
 static gboolean gst_hls_demux_is_live (GstAdaptiveDemux * demux);
 static GstClockTime gst_hls_demux_get_duration (GstAdaptiveDemux * demux);
@@ -258,6 +269,7 @@ gst_hls_demux_stream_clear_pending_data (GstHLSDemuxStream * hls_stream)
   gst_buffer_replace (&hls_stream->pending_typefind_buffer, NULL);
   gst_buffer_replace (&hls_stream->pending_pcr_buffer, NULL);
   hls_stream->current_offset = -1;
+  gst_hls_demux_stream_decrypt_flush (hls_stream);
   gst_hls_demux_stream_decrypt_end (hls_stream);
 }
 
@@ -608,6 +620,7 @@ gst_hls_demux_process_manifest (GstAdaptiveDemux * demux, GstBuffer * buf)
   GstHLSVariantStream *variant;
   GstHLSDemux *hlsdemux = GST_HLS_DEMUX_CAST (demux);
   gchar *playlist = NULL;
+  guint startup_bitrate;
 
   GST_INFO_OBJECT (demux, "Initial playlist location: %s (base uri: %s)",
       demux->manifest_uri, demux->manifest_base_uri);
@@ -633,7 +646,11 @@ gst_hls_demux_process_manifest (GstAdaptiveDemux * demux, GstBuffer * buf)
   }
 
   /* select the initial variant stream */
-  if (demux->connection_speed == 0) {
+  if (gst_adaptive_demux_get_startup_bitrate (demux, &startup_bitrate)) {
+    variant =
+        gst_hls_master_playlist_get_variant_for_bitrate (hlsdemux->master,
+        NULL, startup_bitrate);
+  } else if (demux->connection_speed == 0) {
     variant = hlsdemux->master->default_variant;
   } else {
     variant =
@@ -893,6 +910,41 @@ gst_hls_demux_handle_buffer (GstAdaptiveDemux * demux,
   return GST_FLOW_OK;
 }
 
+/* Pass on what the decryption worker has finished so far, or everything
+ * queued if @drain is set. The most recent buffer is always held back as
+ * pending_decrypted_buffer as only the last one carries the pkcs7 padding. */
+static GstFlowReturn
+gst_hls_demux_stream_push_decrypted (GstHLSDemuxStream * hls_stream,
+    gboolean drain)
+{
+  GstAdaptiveDemuxStream *stream = (GstAdaptiveDemuxStream *) hls_stream;
+  GQueue decrypted = G_QUEUE_INIT;
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstBuffer *buffer;
+
+  if (!gst_hls_demux_stream_decrypt_collect (hls_stream, &decrypted, drain)) {
+    GST_ELEMENT_ERROR (stream->demux, STREAM, DECODE,
+        ("Failed to decrypt buffer"), ("decryption failed"));
+    return GST_FLOW_ERROR;
+  }
+
+  while ((buffer = g_queue_pop_head (&decrypted))) {
+    GstBuffer *previous = hls_stream->pending_decrypted_buffer;
+
+    hls_stream->pending_decrypted_buffer = buffer;
+    if (previous == NULL)
+      continue;
+
+    if (ret == GST_FLOW_OK)
+      ret = gst_hls_demux_handle_buffer (stream->demux, stream, previous,
+          FALSE);
+    else
+      gst_buffer_unref (previous);
+  }
+
+  return ret;
+}
+
 static GstFlowReturn
 gst_hls_demux_finish_fragment (GstAdaptiveDemux * demux,
     GstAdaptiveDemuxStream * stream)
@@ -900,10 +952,15 @@ gst_hls_demux_finish_fragment (GstAdaptiveDemux * demux,
   GstHLSDemuxStream *hls_stream = GST_HLS_DEMUX_STREAM_CAST (stream);   // FIXME: pass HlsStream into function
   GstFlowReturn ret = GST_FLOW_OK;
 
-  if (hls_stream->current_key)
+  if (hls_stream->current_key) {
+    if (stream->last_ret == GST_FLOW_OK)
+      ret = gst_hls_demux_stream_push_decrypted (hls_stream, TRUE);
+    gst_hls_demux_stream_decrypt_flush (hls_stream);
     gst_hls_demux_stream_decrypt_end (hls_stream);
+  }
 
-  if (stream->last_ret == GST_FLOW_OK) {
+  if (stream->last_ret == GST_FLOW_OK && (ret == GST_FLOW_OK
+          || ret == GST_FLOW_NOT_LINKED)) {
     if (hls_stream->pending_decrypted_buffer) {
       if (hls_stream->current_key) {
         GstMapInfo info;
@@ -960,16 +1017,14 @@ gst_hls_demux_data_received (GstAdaptiveDemux * demux,
     GstAdaptiveDemuxStream * stream, GstBuffer * buffer)
 {
   GstHLSDemuxStream *hls_stream = GST_HLS_DEMUX_STREAM_CAST (stream);
-  GstHLSDemux *hlsdemux = GST_HLS_DEMUX_CAST (demux);
 
   if (hls_stream->current_offset == -1)
     hls_stream->current_offset = 0;
 
-  /* Is it encrypted? */
+  /* Is it encrypted? Then hand it to the decryption worker and push on
+   * whatever it has finished in the meantime */
   if (hls_stream->current_key) {
-    GError *err = NULL;
     gsize size;
-    GstBuffer *tmp_buffer;
 
     if (hls_stream->pending_encrypted_data == NULL)
       hls_stream->pending_encrypted_data = gst_adapter_new ();
@@ -980,23 +1035,13 @@ gst_hls_demux_data_received (GstAdaptiveDemux * demux,
     /* must be a multiple of 16 */
     size &= (~0xF);
 
-    if (size == 0) {
-      return GST_FLOW_OK;
-    }
-
-    buffer = gst_adapter_take_buffer (hls_stream->pending_encrypted_data, size);
-    buffer =
-        gst_hls_demux_decrypt_fragment (hlsdemux, hls_stream, buffer, &err);
-    if (buffer == NULL) {
-      GST_ELEMENT_ERROR (demux, STREAM, DECODE, ("Failed to decrypt buffer"),
-          ("decryption failed %s", err->message));
-      g_error_free (err);
-      return GST_FLOW_ERROR;
+    if (size > 0) {
+      buffer =
+          gst_adapter_take_buffer (hls_stream->pending_encrypted_data, size);
+      gst_hls_demux_stream_decrypt_submit (hls_stream, buffer);
     }
 
-    tmp_buffer = hls_stream->pending_decrypted_buffer;
-    hls_stream->pending_decrypted_buffer = buffer;
-    buffer = tmp_buffer;
+    return gst_hls_demux_stream_push_decrypted (hls_stream, FALSE);
   }
 
   return gst_hls_demux_handle_buffer (demux, stream, buffer, FALSE);
@@ -1027,6 +1072,7 @@ gst_hls_demux_stream_free (GstAdaptiveDemuxStream * stream)
     g_free (hls_stream->current_iv);
     hls_stream->current_iv = NULL;
   }
+  gst_hls_demux_stream_decrypt_stop (hls_stream);
   gst_hls_demux_stream_decrypt_end (hls_stream);
 }
 
@@ -1784,46 +1830,228 @@ gst_hls_demux_stream_decrypt_end (GstHLSDemuxStream * stream)
 }
 #endif
 
-static GstBuffer *
-gst_hls_demux_decrypt_fragment (GstHLSDemux * demux, GstHLSDemuxStream * stream,
-    GstBuffer * encrypted_buffer, GError ** err)
+/* Decrypt @encrypted_buffer into pooled buffers of at most
+ * DECRYPT_BLOCK_SIZE bytes each, appended to @decrypted. Runs on the
+ * decryption worker thread. */
+static gboolean
+gst_hls_demux_decrypt_fragment (GstHLSDemuxStream * stream,
+    GstBuffer * encrypted_buffer, GQueue * decrypted)
 {
-  GstBuffer *decrypted_buffer = NULL;
   GstMapInfo encrypted_info, decrypted_info;
-
-  decrypted_buffer =
-      gst_buffer_new_allocate (NULL, gst_buffer_get_size (encrypted_buffer),
-      NULL);
+  gsize offset = 0;
+  gboolean ret = TRUE;
 
   gst_buffer_map (encrypted_buffer, &encrypted_info, GST_MAP_READ);
-  gst_buffer_map (decrypted_buffer, &decrypted_info, GST_MAP_WRITE);
 
-  if (!decrypt_fragment (stream, encrypted_info.size,
-          encrypted_info.data, decrypted_info.data))
-    goto decrypt_error;
+  while (offset < encrypted_info.size) {
+    GstBuffer *decrypted_buffer = NULL;
+    gsize len = MIN (encrypted_info.size - offset, DECRYPT_BLOCK_SIZE);
+
+    if (gst_buffer_pool_acquire_buffer (stream->decrypt_pool,
+            &decrypted_buffer, NULL) != GST_FLOW_OK) {
+      ret = FALSE;
+      break;
+    }
 
+    gst_buffer_map (decrypted_buffer, &decrypted_info, GST_MAP_WRITE);
+    ret = decrypt_fragment (stream, len, encrypted_info.data + offset,
+        decrypted_info.data);
+    gst_buffer_unmap (decrypted_buffer, &decrypted_info);
 
-  gst_buffer_unmap (decrypted_buffer, &decrypted_info);
-  gst_buffer_unmap (encrypted_buffer, &encrypted_info);
+    if (!ret) {
+      gst_buffer_unref (decrypted_buffer);
+      break;
+    }
+
+    gst_buffer_set_size (decrypted_buffer, len);
+    g_queue_push_tail (decrypted, decrypted_buffer);
+    offset += len;
+  }
 
+  gst_buffer_unmap (encrypted_buffer, &encrypted_info);
   gst_buffer_unref (encrypted_buffer);
 
-  return decrypted_buffer;
+  if (!ret)
+    GST_ERROR_OBJECT (stream->adaptive_demux_stream.pad,
+        "Failed to decrypt fragment");
 
-decrypt_error:
-  GST_ERROR_OBJECT (demux, "Failed to decrypt fragment");
-  g_set_error (err, GST_STREAM_ERROR, GST_STREAM_ERROR_DECRYPT,
-      "Failed to decrypt fragment");
+  return ret;
+}
 
-  gst_buffer_unmap (decrypted_buffer, &decrypted_info);
-  gst_buffer_unmap (encrypted_buffer, &encrypted_info);
+static gpointer
+gst_hls_demux_stream_decrypt_thread (GstHLSDemuxStream * stream)
+{
+  g_mutex_lock (&stream->decrypt_lock);
+  while (!stream->decrypt_stop) {
+    GQueue decrypted = G_QUEUE_INIT;
+    GstBuffer *encrypted;
+    gboolean ok;
+
+    encrypted = g_queue_pop_head (&stream->decrypt_input);
+    if (encrypted == NULL) {
+      g_cond_wait (&stream->decrypt_cond, &stream->decrypt_lock);
+      continue;
+    }
 
-  gst_buffer_unref (encrypted_buffer);
-  gst_buffer_unref (decrypted_buffer);
+    /* the cipher context is only touched here while busy, start/end of the
+     * decryption happen with the worker idle */
+    stream->decrypt_busy = TRUE;
+    g_mutex_unlock (&stream->decrypt_lock);
+
+    ok = gst_hls_demux_decrypt_fragment (stream, encrypted, &decrypted);
+
+    g_mutex_lock (&stream->decrypt_lock);
+    stream->decrypt_busy = FALSE;
+    if (!ok)
+      stream->decrypt_error = TRUE;
+    while ((encrypted = g_queue_pop_head (&decrypted)))
+      g_queue_push_tail (&stream->decrypt_output, encrypted);
+    g_cond_broadcast (&stream->decrypt_cond);
+  }
+  g_mutex_unlock (&stream->decrypt_lock);
 
   return NULL;
 }
 
+static gboolean
+gst_hls_demux_stream_decrypt_ensure_worker (GstHLSDemuxStream * stream)
+{
+  GstStructure *config;
+  GError *err = NULL;
+
+  if (stream->decrypt_thread != NULL)
+    return TRUE;
+
+  /* No upper limit, decrypted buffers may sit in downstream queues for a
+   * while and the worker must not stall the download waiting for them */
+  stream->decrypt_pool = gst_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (stream->decrypt_pool);
+  gst_buffer_pool_config_set_params (config, NULL, DECRYPT_BLOCK_SIZE, 2, 0);
+  gst_buffer_pool_set_config (stream->decrypt_pool, config);
+  gst_buffer_pool_set_active (stream->decrypt_pool, TRUE);
+
+  g_mutex_init (&stream->decrypt_lock);
+  g_cond_init (&stream->decrypt_cond);
+  g_queue_init (&stream->decrypt_input);
+  g_queue_init (&stream->decrypt_output);
+  stream->decrypt_busy = FALSE;
+  stream->decrypt_error = FALSE;
+  stream->decrypt_stop = FALSE;
+
+  stream->decrypt_thread = g_thread_try_new ("hlsdemux-decrypt",
+      (GThreadFunc) gst_hls_demux_stream_decrypt_thread, stream, &err);
+  if (stream->decrypt_thread == NULL) {
+    GST_WARNING_OBJECT (stream->adaptive_demux_stream.pad,
+        "Failed to start decryption thread: %s", err->message);
+    g_clear_error (&err);
+    g_mutex_clear (&stream->decrypt_lock);
+    g_cond_clear (&stream->decrypt_cond);
+    gst_buffer_pool_set_active (stream->decrypt_pool, FALSE);
+    gst_object_unref (stream->decrypt_pool);
+    stream->decrypt_pool = NULL;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Queue a 16 byte aligned chunk of the current fragment for decryption. The
+ * download only waits if it got DECRYPT_MAX_PENDING chunks ahead. */
+static void
+gst_hls_demux_stream_decrypt_submit (GstHLSDemuxStream * stream,
+    GstBuffer * encrypted_buffer)
+{
+  if (!gst_hls_demux_stream_decrypt_ensure_worker (stream)) {
+    stream->decrypt_error = TRUE;
+    gst_buffer_unref (encrypted_buffer);
+    return;
+  }
+
+  g_mutex_lock (&stream->decrypt_lock);
+  while (g_queue_get_length (&stream->decrypt_input) >= DECRYPT_MAX_PENDING)
+    g_cond_wait (&stream->decrypt_cond, &stream->decrypt_lock);
+  g_queue_push_tail (&stream->decrypt_input, encrypted_buffer);
+  g_cond_broadcast (&stream->decrypt_cond);
+  g_mutex_unlock (&stream->decrypt_lock);
+}
+
+/* Take the buffers decrypted so far, waiting for all queued chunks if @drain
+ * is set. Returns FALSE if decryption failed. */
+static gboolean
+gst_hls_demux_stream_decrypt_collect (GstHLSDemuxStream * stream,
+    GQueue * decrypted, gboolean drain)
+{
+  GstBuffer *buffer;
+  gboolean ret;
+
+  if (stream->decrypt_thread == NULL)
+    return !stream->decrypt_error;
+
+  g_mutex_lock (&stream->decrypt_lock);
+  if (drain) {
+    while (!g_queue_is_empty (&stream->decrypt_input) || stream->decrypt_busy)
+      g_cond_wait (&stream->decrypt_cond, &stream->decrypt_lock);
+  }
+  while ((buffer = g_queue_pop_head (&stream->decrypt_output)))
+    g_queue_push_tail (decrypted, buffer);
+  ret = !stream->decrypt_error;
+  g_mutex_unlock (&stream->decrypt_lock);
+
+  if (!ret) {
+    while ((buffer = g_queue_pop_head (decrypted)))
+      gst_buffer_unref (buffer);
+  }
+
+  return ret;
+}
+
+/* Drop everything queued and wait for the worker to become idle, so the
+ * cipher context can be reset */
+static void
+gst_hls_demux_stream_decrypt_flush (GstHLSDemuxStream * stream)
+{
+  GstBuffer *buffer;
+
+  if (stream->decrypt_thread == NULL) {
+    stream->decrypt_error = FALSE;
+    return;
+  }
+
+  g_mutex_lock (&stream->decrypt_lock);
+  while ((buffer = g_queue_pop_head (&stream->decrypt_input)))
+    gst_buffer_unref (buffer);
+  while (stream->decrypt_busy)
+    g_cond_wait (&stream->decrypt_cond, &stream->decrypt_lock);
+  while ((buffer = g_queue_pop_head (&stream->decrypt_output)))
+    gst_buffer_unref (buffer);
+  stream->decrypt_error = FALSE;
+  g_cond_broadcast (&stream->decrypt_cond);
+  g_mutex_unlock (&stream->decrypt_lock);
+}
+
+static void
+gst_hls_demux_stream_decrypt_stop (GstHLSDemuxStream * stream)
+{
+  if (stream->decrypt_thread == NULL)
+    return;
+
+  gst_hls_demux_stream_decrypt_flush (stream);
+
+  g_mutex_lock (&stream->decrypt_lock);
+  stream->decrypt_stop = TRUE;
+  g_cond_broadcast (&stream->decrypt_cond);
+  g_mutex_unlock (&stream->decrypt_lock);
+
+  g_thread_join (stream->decrypt_thread);
+  stream->decrypt_thread = NULL;
+
+  g_mutex_clear (&stream->decrypt_lock);
+  g_cond_clear (&stream->decrypt_cond);
+  gst_buffer_pool_set_active (stream->decrypt_pool, FALSE);
+  gst_object_unref (stream->decrypt_pool);
+  stream->decrypt_pool = NULL;
+}
+
 static gint64
 gst_hls_demux_get_manifest_update_interval (GstAdaptiveDemux * demux)
 {
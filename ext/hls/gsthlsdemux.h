@@ -112,6 +112,18 @@ struct _GstHLSDemuxStream
   gcry_cipher_hd_t aes_ctx;
 #endif
 
+  /* decryption worker: encrypted chunks are queued by the download thread
+   * and decrypted into pooled buffers while the download continues */
+  GThread       *decrypt_thread;
+  GMutex         decrypt_lock;
+  GCond          decrypt_cond;
+  GQueue         decrypt_input;
+  GQueue         decrypt_output;
+  GstBufferPool *decrypt_pool;
+  gboolean       decrypt_busy;
+  gboolean       decrypt_error;
+  gboolean       decrypt_stop;
+
   gchar     *current_key;
   guint8    *current_iv;
 
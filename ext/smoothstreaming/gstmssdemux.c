@@ -414,6 +414,7 @@ gst_mss_demux_setup_streams (GstAdaptiveDemux * demux)
       gst_mss_manifest_get_protection_data (mssdemux->manifest);
   gboolean protected = protection_system_id && protection_data;
   const gchar *selected_system = NULL;
+  guint startup_bitrate;
 
   if (streams == NULL) {
     GST_INFO_OBJECT (mssdemux, "No streams found in the manifest");
@@ -459,9 +460,15 @@ gst_mss_demux_setup_streams (GstAdaptiveDemux * demux)
     active_streams = g_slist_prepend (active_streams, stream);
   }
 
-  GST_INFO_OBJECT (mssdemux, "Changing max bitrate to %u",
-      demux->connection_speed);
-  gst_mss_manifest_change_bitrate (mssdemux->manifest, demux->connection_speed);
+  if (gst_adaptive_demux_get_startup_bitrate (demux, &startup_bitrate)) {
+    /* 0 means highest for the manifest, start with the lowest instead */
+    startup_bitrate = MAX (startup_bitrate, 1);
+  } else {
+    startup_bitrate = demux->connection_speed;
+  }
+
+  GST_INFO_OBJECT (mssdemux, "Changing max bitrate to %u", startup_bitrate);
+  gst_mss_manifest_change_bitrate (mssdemux->manifest, startup_bitrate);
 
   for (iter = active_streams; iter; iter = g_slist_next (iter)) {
     GstMssDemuxStream *stream = iter->data;
@@ -27,6 +27,7 @@
 #include <srt/srt.h>
 
 #define SRT_DEFAULT_POLL_TIMEOUT -1
+#define SRT_DEFAULT_SEND_QUEUE_SIZE 0
 
 #define GST_CAT_DEFAULT gst_debug_srt_base_sink
 GST_DEBUG_CATEGORY (GST_CAT_DEFAULT);
@@ -37,6 +38,9 @@ enum
   PROP_LATENCY,
   PROP_PASSPHRASE,
   PROP_KEY_LENGTH,
+  PROP_SEND_QUEUE_SIZE,
+  PROP_SEND_QUEUE_LEVEL,
+  PROP_SEND_QUEUE_DROPPED,
 
   /*< private > */
   PROP_LAST
@@ -80,6 +84,19 @@ gst_srt_base_sink_get_property (GObject * object,
     case PROP_KEY_LENGTH:
       g_value_set_int (value, self->key_length);
       break;
+    case PROP_SEND_QUEUE_SIZE:
+      g_value_set_uint (value, self->send_queue_size);
+      break;
+    case PROP_SEND_QUEUE_LEVEL:
+      g_mutex_lock (&self->send_lock);
+      g_value_set_uint (value, self->send_queue.length);
+      g_mutex_unlock (&self->send_lock);
+      break;
+    case PROP_SEND_QUEUE_DROPPED:
+      g_mutex_lock (&self->send_lock);
+      g_value_set_uint64 (value, self->send_dropped);
+      g_mutex_unlock (&self->send_lock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -112,6 +129,9 @@ gst_srt_base_sink_set_property (GObject * object,
       self->key_length = key_length;
       break;
     }
+    case PROP_SEND_QUEUE_SIZE:
+      self->send_queue_size = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -127,9 +147,132 @@ gst_srt_base_sink_finalize (GObject * object)
   g_clear_pointer (&self->uri, gst_uri_unref);
   g_clear_pointer (&self->passphrase, g_free);
 
+  g_mutex_clear (&self->send_lock);
+  g_cond_clear (&self->send_cond);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+/* call with send_lock */
+static void
+gst_srt_base_sink_flush_queue (GstSRTBaseSink * self)
+{
+  GstBuffer *buffer;
+
+  while ((buffer = g_queue_pop_head (&self->send_queue)))
+    gst_buffer_unref (buffer);
+}
+
+static gpointer
+gst_srt_base_sink_send_loop (GstSRTBaseSink * self)
+{
+  GstSRTBaseSinkClass *bclass = GST_SRT_BASE_SINK_GET_CLASS (self);
+
+  g_mutex_lock (&self->send_lock);
+  while (self->send_running) {
+    GstBuffer *buffer;
+    GstMapInfo info;
+    gboolean ok;
+
+    buffer = g_queue_pop_head (&self->send_queue);
+    if (buffer == NULL) {
+      g_cond_wait (&self->send_cond, &self->send_lock);
+      continue;
+    }
+
+    self->sending = TRUE;
+    g_mutex_unlock (&self->send_lock);
+
+    if (gst_buffer_map (buffer, &info, GST_MAP_READ)) {
+      ok = bclass->send_buffer (self, &info);
+      gst_buffer_unmap (buffer, &info);
+    } else {
+      GST_ELEMENT_ERROR (self, RESOURCE, READ,
+          ("Could not map the input stream"), (NULL));
+      ok = FALSE;
+    }
+    gst_buffer_unref (buffer);
+
+    g_mutex_lock (&self->send_lock);
+    self->sending = FALSE;
+    if (!ok) {
+      self->send_flow = GST_FLOW_ERROR;
+      gst_srt_base_sink_flush_queue (self);
+    }
+    /* wake up anyone draining the queue */
+    g_cond_broadcast (&self->send_cond);
+  }
+  g_mutex_unlock (&self->send_lock);
+
+  return NULL;
+}
+
+static GstFlowReturn
+gst_srt_base_sink_queue_buffer (GstSRTBaseSink * self, GstBuffer * buffer)
+{
+  GstFlowReturn ret;
+
+  g_mutex_lock (&self->send_lock);
+  ret = self->send_flow;
+  if (ret != GST_FLOW_OK)
+    goto out;
+
+  if (self->send_thread == NULL) {
+    GST_DEBUG_OBJECT (self, "starting send thread");
+    self->send_running = TRUE;
+    self->send_thread = g_thread_new ("srtsink-send",
+        (GThreadFunc) gst_srt_base_sink_send_loop, self);
+  }
+
+  /* never block the streaming thread, live data that can't be sent in time
+   * is useless anyway */
+  while (self->send_queue.length >= self->send_queue_size) {
+    gst_buffer_unref (g_queue_pop_head (&self->send_queue));
+    self->send_dropped++;
+    GST_DEBUG_OBJECT (self, "send queue full, dropped oldest buffer "
+        "(%" G_GUINT64_FORMAT " total)", self->send_dropped);
+  }
+
+  g_queue_push_tail (&self->send_queue, gst_buffer_ref (buffer));
+  g_cond_broadcast (&self->send_cond);
+
+out:
+  g_mutex_unlock (&self->send_lock);
+
+  return ret;
+}
+
+/* waits until the send thread has sent everything that is queued */
+static void
+gst_srt_base_sink_drain (GstSRTBaseSink * self)
+{
+  g_mutex_lock (&self->send_lock);
+  while (self->send_running && (self->send_queue.length > 0 || self->sending))
+    g_cond_wait (&self->send_cond, &self->send_lock);
+  g_mutex_unlock (&self->send_lock);
+}
+
+static void
+gst_srt_base_sink_stop_send_thread (GstSRTBaseSink * self)
+{
+  GThread *thread;
+
+  g_mutex_lock (&self->send_lock);
+  thread = self->send_thread;
+  self->send_thread = NULL;
+  self->send_running = FALSE;
+  gst_srt_base_sink_flush_queue (self);
+  g_cond_broadcast (&self->send_cond);
+  g_mutex_unlock (&self->send_lock);
+
+  if (thread) {
+    GST_DEBUG_OBJECT (self, "stopping send thread");
+    g_thread_join (thread);
+  }
+
+  self->send_flow = GST_FLOW_OK;
+}
+
 static gboolean
 gst_srt_base_sink_set_caps (GstBaseSink * sink, GstCaps * caps)
 {
@@ -139,6 +282,9 @@ gst_srt_base_sink_set_caps (GstBaseSink * sink, GstCaps * caps)
 
   GST_DEBUG_OBJECT (self, "setcaps %" GST_PTR_FORMAT, caps);
 
+  /* the send thread might still be sending the old headers */
+  gst_srt_base_sink_drain (self);
+
   g_clear_pointer (&self->headers, gst_buffer_list_unref);
 
   s = gst_caps_get_structure (caps, 0);
@@ -180,6 +326,45 @@ gst_srt_base_sink_set_caps (GstBaseSink * sink, GstCaps * caps)
   return TRUE;
 }
 
+static gboolean
+gst_srt_base_sink_event (GstBaseSink * sink, GstEvent * event)
+{
+  GstSRTBaseSink *self = GST_SRT_BASE_SINK (sink);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_EOS:
+      gst_srt_base_sink_drain (self);
+      break;
+    case GST_EVENT_FLUSH_START:
+      g_mutex_lock (&self->send_lock);
+      gst_srt_base_sink_flush_queue (self);
+      g_mutex_unlock (&self->send_lock);
+      break;
+    default:
+      break;
+  }
+
+  return GST_BASE_SINK_CLASS (parent_class)->event (sink, event);
+}
+
+static GstStateChangeReturn
+gst_srt_base_sink_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstSRTBaseSink *self = GST_SRT_BASE_SINK (element);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* stop sending before subclasses close their sockets */
+      gst_srt_base_sink_stop_send_thread (self);
+      break;
+    default:
+      break;
+  }
+
+  return GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+}
+
 static gboolean
 gst_srt_base_sink_stop (GstBaseSink * sink)
 {
@@ -204,6 +389,9 @@ gst_srt_base_sink_render (GstBaseSink * sink, GstBuffer * buffer)
     return GST_FLOW_OK;
   }
 
+  if (self->send_queue_size > 0)
+    return gst_srt_base_sink_queue_buffer (self, buffer);
+
   GST_TRACE_OBJECT (self, "sending buffer %p, offset %"
       G_GINT64_FORMAT ", offset_end %" G_GINT64_FORMAT
       ", timestamp %" GST_TIME_FORMAT ", duration %" GST_TIME_FORMAT
@@ -232,6 +420,7 @@ static void
 gst_srt_base_sink_class_init (GstSRTBaseSinkClass * klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
   GstBaseSinkClass *gstbasesink_class = GST_BASE_SINK_CLASS (klass);
 
   gobject_class->set_property = gst_srt_base_sink_set_property;
@@ -262,9 +451,37 @@ gst_srt_base_sink_class_init (GstSRTBaseSinkClass * klass)
       "Crypto key length in bytes{16,24,32}", 16,
       32, SRT_DEFAULT_KEY_LENGTH, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GstSRTBaseSink:send-queue-size:
+   *
+   * When non-zero, buffers are queued and sent from a separate thread so
+   * that the streaming thread never waits for the network.  If the queue
+   * is full the oldest buffer is dropped.
+   */
+  properties[PROP_SEND_QUEUE_SIZE] =
+      g_param_spec_uint ("send-queue-size", "Send queue size",
+      "Maximum number of buffers waiting to be sent by a separate thread "
+      "(0 = send from the streaming thread)", 0, G_MAXUINT,
+      SRT_DEFAULT_SEND_QUEUE_SIZE,
+      G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY | G_PARAM_STATIC_STRINGS);
+
+  properties[PROP_SEND_QUEUE_LEVEL] =
+      g_param_spec_uint ("send-queue-level", "Send queue level",
+      "Number of buffers currently waiting to be sent", 0, G_MAXUINT, 0,
+      G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
+  properties[PROP_SEND_QUEUE_DROPPED] =
+      g_param_spec_uint64 ("send-queue-dropped", "Send queue dropped",
+      "Number of buffers dropped because the send queue was full", 0,
+      G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, properties);
 
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_srt_base_sink_change_state);
+
   gstbasesink_class->set_caps = GST_DEBUG_FUNCPTR (gst_srt_base_sink_set_caps);
+  gstbasesink_class->event = GST_DEBUG_FUNCPTR (gst_srt_base_sink_event);
   gstbasesink_class->stop = GST_DEBUG_FUNCPTR (gst_srt_base_sink_stop);
   gstbasesink_class->render = GST_DEBUG_FUNCPTR (gst_srt_base_sink_render);
 }
@@ -276,6 +493,11 @@ gst_srt_base_sink_init (GstSRTBaseSink * self)
   self->latency = SRT_DEFAULT_LATENCY;
   self->passphrase = NULL;
   self->key_length = SRT_DEFAULT_KEY_LENGTH;
+  self->send_queue_size = SRT_DEFAULT_SEND_QUEUE_SIZE;
+  g_queue_init (&self->send_queue);
+  g_mutex_init (&self->send_lock);
+  g_cond_init (&self->send_cond);
+  self->send_flow = GST_FLOW_OK;
 }
 
 static GstURIType
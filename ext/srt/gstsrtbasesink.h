@@ -50,6 +50,17 @@ struct _GstSRTBaseSink {
   gchar *passphrase;
   gint key_length;
 
+  /* optional queue decoupling the sending from the streaming thread */
+  guint send_queue_size;
+  GQueue send_queue;
+  GMutex send_lock;
+  GCond send_cond;
+  GThread *send_thread;
+  gboolean send_running;
+  gboolean sending;
+  GstFlowReturn send_flow;
+  guint64 send_dropped;
+
   /*< private >*/
   gpointer _gst_reserved[GST_PADDING];
 };
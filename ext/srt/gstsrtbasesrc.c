@@ -30,6 +30,9 @@
 #define GST_CAT_DEFAULT gst_debug_srt_base_src
 GST_DEBUG_CATEGORY (GST_CAT_DEFAULT);
 
+/* upper bound of messages pushed downstream per wakeup */
+#define SRT_MAX_BATCH_SIZE 64
+
 enum
 {
   PROP_URI = 1,
@@ -137,6 +140,12 @@ gst_srt_base_src_finalize (GObject * object)
   g_clear_pointer (&self->caps, gst_caps_unref);
   g_clear_pointer (&self->passphrase, g_free);
 
+  if (self->pool) {
+    gst_buffer_pool_set_active (self->pool, FALSE);
+    gst_object_unref (self->pool);
+    self->pool = NULL;
+  }
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -289,3 +298,142 @@ gst_srt_base_src_uri_handler_init (gpointer g_iface, gpointer iface_data)
   iface->get_uri = gst_srt_base_src_uri_get_uri;
   iface->set_uri = gst_srt_base_src_uri_set_uri;
 }
+
+static gboolean
+gst_srt_base_src_ensure_pool (GstSRTBaseSrc * self, guint size)
+{
+  GstStructure *config;
+
+  if (self->pool && self->pool_size == size)
+    return TRUE;
+
+  if (self->pool) {
+    gst_buffer_pool_set_active (self->pool, FALSE);
+    gst_object_unref (self->pool);
+  }
+
+  GST_DEBUG_OBJECT (self, "creating pool of %u bytes buffers", size);
+
+  self->pool = gst_buffer_pool_new ();
+  self->pool_size = size;
+
+  config = gst_buffer_pool_get_config (self->pool);
+  gst_buffer_pool_config_set_params (config, NULL, size, 0, 0);
+  if (!gst_buffer_pool_set_config (self->pool, config) ||
+      !gst_buffer_pool_set_active (self->pool, TRUE)) {
+    gst_object_unref (self->pool);
+    self->pool = NULL;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+ * gst_srt_base_src_receive:
+ * @self: a #GstSRTBaseSrc
+ * @sock: a connected socket in non-blocking receive mode
+ * @outbuf: (out): the buffer to return from create()
+ *
+ * Reads all messages that are ready on @sock into buffers from an internal
+ * pool.  A single message is returned in @outbuf, several are submitted as
+ * one buffer list and @outbuf is set to %NULL.
+ *
+ * Returns: %GST_SRT_BASE_SRC_FLOW_NO_DATA if nothing was ready, %GST_FLOW_EOS
+ * if the peer closed the connection and %GST_FLOW_ERROR if reading failed, in
+ * which case the SRT error is left for the caller to inspect.
+ */
+GstFlowReturn
+gst_srt_base_src_receive (GstSRTBaseSrc * self, SRTSOCKET sock,
+    GstBuffer ** outbuf)
+{
+  GstBaseSrc *src = GST_BASE_SRC (self);
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstBufferList *list;
+  GstClockTime pts = GST_CLOCK_TIME_NONE;
+  GstClock *clock;
+  guint len;
+
+  *outbuf = NULL;
+
+  if (!gst_srt_base_src_ensure_pool (self, gst_base_src_get_blocksize (src))) {
+    GST_ELEMENT_ERROR (self, RESOURCE, READ,
+        ("Could not allocate buffers"), (NULL));
+    return GST_FLOW_ERROR;
+  }
+
+  /* all messages of one wakeup share the same receive time */
+  clock = gst_element_get_clock (GST_ELEMENT_CAST (self));
+  if (clock) {
+    pts = gst_clock_get_time (clock) - GST_ELEMENT_CAST (self)->base_time;
+    gst_object_unref (clock);
+  }
+
+  list = gst_buffer_list_new_sized (SRT_MAX_BATCH_SIZE);
+
+  while (gst_buffer_list_length (list) < SRT_MAX_BATCH_SIZE) {
+    GstBuffer *buffer;
+    GstMapInfo info;
+    gint recv_len;
+
+    ret = gst_buffer_pool_acquire_buffer (self->pool, &buffer, NULL);
+    if (ret != GST_FLOW_OK)
+      break;
+
+    if (!gst_buffer_map (buffer, &info, GST_MAP_WRITE)) {
+      gst_buffer_unref (buffer);
+      GST_ELEMENT_ERROR (self, RESOURCE, READ,
+          ("Could not map the buffer for writing "), (NULL));
+      ret = GST_FLOW_ERROR;
+      break;
+    }
+
+    recv_len = srt_recvmsg (sock, (char *) info.data, info.size);
+
+    gst_buffer_unmap (buffer, &info);
+
+    if (recv_len == SRT_ERROR) {
+      gst_buffer_unref (buffer);
+
+      if (srt_getlasterror (NULL) == SRT_EASYNCRCV) {
+        srt_clearlasterror ();
+        ret = GST_SRT_BASE_SRC_FLOW_NO_DATA;
+      } else {
+        ret = GST_FLOW_ERROR;
+      }
+      break;
+    } else if (recv_len == 0) {
+      gst_buffer_unref (buffer);
+      ret = GST_FLOW_EOS;
+      break;
+    }
+
+    gst_buffer_resize (buffer, 0, recv_len);
+    GST_BUFFER_PTS (buffer) = pts;
+
+    GST_LOG_OBJECT (self, "received message of size %d, ts %" GST_TIME_FORMAT,
+        recv_len, GST_TIME_ARGS (pts));
+
+    gst_buffer_list_add (list, buffer);
+  }
+
+  len = gst_buffer_list_length (list);
+
+  /* push out what we have, any error or EOS is reported again on the next
+   * call */
+  if (len == 0) {
+    gst_buffer_list_unref (list);
+    return ret;
+  }
+
+  GST_LOG_OBJECT (self, "received %u messages", len);
+
+  if (len == 1) {
+    *outbuf = gst_buffer_ref (gst_buffer_list_get (list, 0));
+    gst_buffer_list_unref (list);
+  } else {
+    gst_base_src_submit_buffer_list (src, list);
+  }
+
+  return GST_FLOW_OK;
+}
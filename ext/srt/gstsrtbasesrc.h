@@ -24,6 +24,8 @@
 #include <gst/gst.h>
 #include <gst/base/gstpushsrc.h>
 
+#include <srt/srt.h>
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_SRT_BASE_SRC              (gst_srt_base_src_get_type ())
@@ -35,6 +37,9 @@ G_BEGIN_DECLS
 #define GST_SRT_BASE_SRC_CAST(obj)         ((GstSRTBaseSrc*)(obj))
 #define GST_SRT_BASE_SRC_CLASS_CAST(klass) ((GstSRTBaseSrcClass*)(klass))
 
+/* returned by gst_srt_base_src_receive() when no message was ready */
+#define GST_SRT_BASE_SRC_FLOW_NO_DATA GST_FLOW_CUSTOM_SUCCESS
+
 typedef struct _GstSRTBaseSrc GstSRTBaseSrc;
 typedef struct _GstSRTBaseSrcClass GstSRTBaseSrcClass;
 
@@ -48,6 +53,9 @@ struct _GstSRTBaseSrc {
   gint key_length;
 
   /*< private >*/
+  GstBufferPool *pool;
+  guint pool_size;
+
   gpointer _gst_reserved[GST_PADDING];
 };
 
@@ -60,6 +68,9 @@ struct _GstSRTBaseSrcClass {
 GST_EXPORT
 GType gst_srt_base_src_get_type (void);
 
+GstFlowReturn gst_srt_base_src_receive (GstSRTBaseSrc *self, SRTSOCKET sock,
+    GstBuffer **outbuf);
+
 G_END_DECLS
 
 #endif /* __GST_SRT_BASE_SRC_H__ */
@@ -66,6 +66,8 @@ struct _GstSRTClientSrcPrivate
   gboolean rendez_vous;
   gchar *bind_address;
   guint16 bind_port;
+
+  gboolean cancelled;
 };
 
 #define GST_SRT_CLIENT_SRC_GET_PRIVATE(obj)  \
@@ -166,66 +168,47 @@ gst_srt_client_src_finalize (GObject * object)
 }
 
 static GstFlowReturn
-gst_srt_client_src_fill (GstPushSrc * src, GstBuffer * outbuf)
+gst_srt_client_src_create (GstPushSrc * src, GstBuffer ** outbuf)
 {
   GstSRTClientSrc *self = GST_SRT_CLIENT_SRC (src);
   GstSRTClientSrcPrivate *priv = GST_SRT_CLIENT_SRC_GET_PRIVATE (self);
-  GstFlowReturn ret = GST_FLOW_OK;
-  GstMapInfo info;
+  GstFlowReturn ret;
   SRTSOCKET ready[2];
-  gint recv_len;
-
-  if (srt_epoll_wait (priv->poll_id, 0, 0, ready, &(int) {
-          2}, priv->poll_timeout, 0, 0, 0, 0) == -1) {
 
-    /* Assuming that timeout error is normal */
-    if (srt_getlasterror (NULL) != SRT_ETIMEOUT) {
-      GST_ELEMENT_ERROR (src, RESOURCE, READ,
-          (NULL), ("srt_epoll_wait error: %s", srt_getlasterror_str ()));
-      ret = GST_FLOW_ERROR;
+  do {
+    if (srt_epoll_wait (priv->poll_id, ready, &(int) {
+            2}, 0, 0, priv->poll_timeout, 0, 0, 0, 0) == -1) {
+      /* Assuming that timeout error is normal */
+      if (srt_getlasterror (NULL) != SRT_ETIMEOUT) {
+        GST_ELEMENT_ERROR (src, RESOURCE, READ,
+            (NULL), ("srt_epoll_wait error: %s", srt_getlasterror_str ()));
+        srt_clearlasterror ();
+        return GST_FLOW_ERROR;
+      }
+      srt_clearlasterror ();
+
+      /* Mimicking cancellable */
+      if (priv->cancelled) {
+        GST_DEBUG_OBJECT (self, "Cancelled waiting for data");
+        return GST_FLOW_FLUSHING;
+      }
+
+      ret = GST_SRT_BASE_SRC_FLOW_NO_DATA;
+      continue;
     }
-    srt_clearlasterror ();
-    goto out;
-  }
 
-  if (!gst_buffer_map (outbuf, &info, GST_MAP_WRITE)) {
-    GST_ELEMENT_ERROR (src, RESOURCE, READ,
-        ("Could not map the buffer for writing "), (NULL));
-    ret = GST_FLOW_ERROR;
-    goto out;
-  }
-
-  recv_len = srt_recvmsg (priv->sock, (char *) info.data,
-      gst_buffer_get_size (outbuf));
+    /* drains everything that is ready so a burst of messages is pushed
+     * downstream in one go */
+    ret = gst_srt_base_src_receive (GST_SRT_BASE_SRC (self), priv->sock,
+        outbuf);
+  } while (ret == GST_SRT_BASE_SRC_FLOW_NO_DATA);
 
-  gst_buffer_unmap (outbuf, &info);
-
-  if (recv_len == SRT_ERROR) {
+  if (ret == GST_FLOW_ERROR) {
     GST_ELEMENT_ERROR (src, RESOURCE, READ,
         (NULL), ("srt_recvmsg error: %s", srt_getlasterror_str ()));
-    ret = GST_FLOW_ERROR;
-    goto out;
-  } else if (recv_len == 0) {
-    ret = GST_FLOW_EOS;
-    goto out;
+    srt_clearlasterror ();
   }
 
-  GST_BUFFER_PTS (outbuf) =
-      gst_clock_get_time (GST_ELEMENT_CLOCK (src)) -
-      GST_ELEMENT_CAST (src)->base_time;
-
-  gst_buffer_resize (outbuf, 0, recv_len);
-
-  GST_LOG_OBJECT (src,
-      "filled buffer from _get of size %" G_GSIZE_FORMAT ", ts %"
-      GST_TIME_FORMAT ", dur %" GST_TIME_FORMAT
-      ", offset %" G_GINT64_FORMAT ", offset_end %" G_GINT64_FORMAT,
-      gst_buffer_get_size (outbuf),
-      GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (outbuf)),
-      GST_TIME_ARGS (GST_BUFFER_DURATION (outbuf)),
-      GST_BUFFER_OFFSET (outbuf), GST_BUFFER_OFFSET_END (outbuf));
-
-out:
   return ret;
 }
 
@@ -246,7 +229,16 @@ gst_srt_client_src_start (GstBaseSrc * src)
   g_clear_object (&socket_address);
   g_clear_pointer (&uri, gst_uri_unref);
 
-  return (priv->sock != SRT_INVALID_SOCK);
+  if (priv->sock == SRT_INVALID_SOCK)
+    return FALSE;
+
+  /* Wait for incoming data and never block in srt_recvmsg() */
+  srt_setsockopt (priv->sock, 0, SRTO_RCVSYN, &(int) {
+      0}, sizeof (int));
+  srt_epoll_update_usock (priv->poll_id, priv->sock, &(int) {
+      SRT_EPOLL_IN | SRT_EPOLL_ERR});
+
+  return TRUE;
 }
 
 static gboolean
@@ -267,6 +259,30 @@ gst_srt_client_src_stop (GstBaseSrc * src)
     srt_close (priv->sock);
   priv->sock = SRT_INVALID_SOCK;
 
+  priv->cancelled = FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+gst_srt_client_src_unlock (GstBaseSrc * src)
+{
+  GstSRTClientSrc *self = GST_SRT_CLIENT_SRC (src);
+  GstSRTClientSrcPrivate *priv = GST_SRT_CLIENT_SRC_GET_PRIVATE (self);
+
+  priv->cancelled = TRUE;
+
+  return TRUE;
+}
+
+static gboolean
+gst_srt_client_src_unlock_stop (GstBaseSrc * src)
+{
+  GstSRTClientSrc *self = GST_SRT_CLIENT_SRC (src);
+  GstSRTClientSrcPrivate *priv = GST_SRT_CLIENT_SRC_GET_PRIVATE (self);
+
+  priv->cancelled = FALSE;
+
   return TRUE;
 }
 
@@ -319,8 +335,11 @@ gst_srt_client_src_class_init (GstSRTClientSrcClass * klass)
 
   gstbasesrc_class->start = GST_DEBUG_FUNCPTR (gst_srt_client_src_start);
   gstbasesrc_class->stop = GST_DEBUG_FUNCPTR (gst_srt_client_src_stop);
+  gstbasesrc_class->unlock = GST_DEBUG_FUNCPTR (gst_srt_client_src_unlock);
+  gstbasesrc_class->unlock_stop =
+      GST_DEBUG_FUNCPTR (gst_srt_client_src_unlock_stop);
 
-  gstpushsrc_class->fill = GST_DEBUG_FUNCPTR (gst_srt_client_src_fill);
+  gstpushsrc_class->create = GST_DEBUG_FUNCPTR (gst_srt_client_src_create);
 }
 
 static void
@@ -26,6 +26,13 @@
  * packets to the network. Although SRT is an UDP-based protocol, srtserversink works like
  * a server socket of connection-oriented protocol.
  *
+ * Buffers are queued once and sent to all the connected clients from a
+ * separate thread as soon as their socket can take more data, so a slow
+ * client doesn't hold back the others.  Clients that fall behind by more
+ * than #GstSRTServerSink:client-latency-budget are either disconnected or
+ * skip ahead to the most recent data, see
+ * #GstSRTServerSink:disconnect-slow-clients.
+ *
  * <refsect2>
  * <title>Examples</title>
  * |[
@@ -45,6 +52,11 @@
 #include <gio/gio.h>
 
 #define SRT_DEFAULT_POLL_TIMEOUT -1
+#define SRT_DEFAULT_CLIENT_LATENCY_BUDGET 1000
+#define SRT_DEFAULT_DISCONNECT_SLOW_CLIENTS TRUE
+#define SRT_LISTEN_BACKLOG 64
+/* how long the fan-out thread waits for clients to become writable */
+#define SRT_FANOUT_POLL_TIMEOUT 50
 
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -68,6 +80,17 @@ struct _GstSRTServerSinkPrivate
   GThread *thread;
 
   GList *clients;
+
+  /* fan-out state, protected by the object lock */
+  gint client_poll_id;
+  GThread *fanout_thread;
+  GCond fanout_cond;
+  gboolean fanout_running;
+  GPtrArray *entries;
+  guint64 first_seq;
+  guint64 next_seq;
+  guint client_latency_budget;
+  gboolean disconnect_slow_clients;
 };
 
 #define GST_SRT_SERVER_SINK_GET_PRIVATE(obj)  \
@@ -77,6 +100,8 @@ enum
 {
   PROP_POLL_TIMEOUT = 1,
   PROP_STATS,
+  PROP_CLIENT_LATENCY_BUDGET,
+  PROP_DISCONNECT_SLOW_CLIENTS,
   /*< private > */
   PROP_LAST
 };
@@ -104,8 +129,32 @@ typedef struct
   int sock;
   GSocketAddress *sockaddr;
   gboolean sent_headers;
+
+  /* sequence number of the next entry to send */
+  guint64 next_seq;
+  guint64 packets_dropped;
+  gboolean want_write;
 } SRTClient;
 
+/* a buffer queued for all clients, mapped once */
+typedef struct
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  gint64 queued_time;
+} FanoutEntry;
+
+static gpointer fanout_thread_func (gpointer data);
+static void gst_srt_server_sink_stop_fanout (GstSRTServerSink * self);
+
+static void
+fanout_entry_free (FanoutEntry * entry)
+{
+  gst_buffer_unmap (entry->buffer, &entry->map);
+  gst_buffer_unref (entry->buffer);
+  g_slice_free (FanoutEntry, entry);
+}
+
 static SRTClient *
 srt_client_new (void)
 {
@@ -158,14 +207,42 @@ gst_srt_server_sink_get_property (GObject * object,
         SRTClient *client = item->data;
         GValue tmp = G_VALUE_INIT;
 
+        GstStructure *s;
+        guint64 queued = priv->next_seq - client->next_seq;
+        gint64 lag = 0;
+
+        if (queued > 0) {
+          FanoutEntry *entry = g_ptr_array_index (priv->entries,
+              client->next_seq - priv->first_seq);
+          lag = (g_get_monotonic_time () - entry->queued_time) / 1000;
+        }
+
+        s = gst_srt_base_sink_get_stats (client->sockaddr, client->sock);
+        gst_structure_set (s,
+            /* buffers waiting to be sent to this client */
+            "packets-queued", G_TYPE_UINT64, queued,
+            /* age of the oldest of them */
+            "queue-latency-ms", G_TYPE_INT64, lag,
+            /* buffers skipped because the client was too slow */
+            "packets-dropped", G_TYPE_UINT64, client->packets_dropped, NULL);
+
         g_value_init (&tmp, GST_TYPE_STRUCTURE);
-        g_value_take_boxed (&tmp, gst_srt_base_sink_get_stats (client->sockaddr,
-                client->sock));
+        g_value_take_boxed (&tmp, s);
         gst_value_array_append_and_take_value (value, &tmp);
       }
       GST_OBJECT_UNLOCK (self);
       break;
     }
+    case PROP_CLIENT_LATENCY_BUDGET:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, priv->client_latency_budget);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_DISCONNECT_SLOW_CLIENTS:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, priv->disconnect_slow_clients);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -183,12 +260,34 @@ gst_srt_server_sink_set_property (GObject * object,
     case PROP_POLL_TIMEOUT:
       priv->poll_timeout = g_value_get_int (value);
       break;
+    case PROP_CLIENT_LATENCY_BUDGET:
+      GST_OBJECT_LOCK (self);
+      priv->client_latency_budget = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_DISCONNECT_SLOW_CLIENTS:
+      GST_OBJECT_LOCK (self);
+      priv->disconnect_slow_clients = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static void
+gst_srt_server_sink_finalize (GObject * object)
+{
+  GstSRTServerSink *self = GST_SRT_SERVER_SINK (object);
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+
+  g_ptr_array_unref (priv->entries);
+  g_cond_clear (&priv->fanout_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static gboolean
 idle_listen_callback (gpointer data)
 {
@@ -234,7 +333,16 @@ idle_listen_callback (gpointer data)
 
   client->sockaddr = g_socket_address_new_from_native (&sa, sa_len);
 
+  /* the fan-out thread only sends when the socket can take more data */
+  srt_setsockopt (client->sock, 0, SRTO_SNDSYN, &(int) {
+      0}, sizeof (int));
+  srt_epoll_add_usock (priv->client_poll_id, client->sock, &(int) {
+      SRT_EPOLL_OUT | SRT_EPOLL_ERR});
+  client->want_write = TRUE;
+
   GST_OBJECT_LOCK (self);
+  /* start with the most recent data */
+  client->next_seq = priv->next_seq;
   priv->clients = g_list_append (priv->clients, client);
   GST_OBJECT_UNLOCK (self);
 
@@ -345,12 +453,29 @@ gst_srt_server_sink_start (GstBaseSink * sink)
     goto failed;
   }
 
-  if (srt_listen (priv->sock, 1) == SRT_ERROR) {
+  if (srt_listen (priv->sock, SRT_LISTEN_BACKLOG) == SRT_ERROR) {
     GST_WARNING_OBJECT (self, "failed to listen SRT socket (reason: %s)",
         srt_getlasterror_str ());
     goto failed;
   }
 
+  priv->client_poll_id = srt_epoll_create ();
+  if (priv->client_poll_id == -1) {
+    GST_WARNING_OBJECT (self,
+        "failed to create poll id for SRT client sockets (reason: %s)",
+        srt_getlasterror_str ());
+    goto failed;
+  }
+
+  priv->fanout_running = TRUE;
+  priv->fanout_thread = g_thread_try_new ("srtserversink-fanout",
+      fanout_thread_func, self, &error);
+  if (error != NULL) {
+    GST_WARNING_OBJECT (self, "failed to create thread (reason: %s)",
+        error->message);
+    goto failed;
+  }
+
   priv->context = g_main_context_new ();
 
   priv->server_source = g_idle_source_new ();
@@ -374,6 +499,8 @@ gst_srt_server_sink_start (GstBaseSink * sink)
   return ret;
 
 failed:
+  gst_srt_server_sink_stop_fanout (self);
+
   if (priv->poll_id != SRT_ERROR) {
     srt_epoll_release (priv->poll_id);
     priv->poll_id = SRT_ERROR;
@@ -406,42 +533,319 @@ send_buffer_internal (GstSRTBaseSink * sink,
   return TRUE;
 }
 
+/* Sends as many queued entries to @client as its socket takes. Returns
+ * FALSE if the client has to be removed. Call with the object lock. */
 static gboolean
-gst_srt_server_sink_send_buffer (GstSRTBaseSink * sink,
-    const GstMapInfo * mapinfo)
+gst_srt_server_sink_pump_client (GstSRTServerSink * self, SRTClient * client)
 {
-  GstSRTServerSink *self = GST_SRT_SERVER_SINK (sink);
   GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
-  GList *clients = priv->clients;
 
-  GST_OBJECT_LOCK (sink);
-  while (clients != NULL) {
-    SRTClient *client = clients->data;
-    clients = clients->next;
+  if (!client->sent_headers) {
+    if (!gst_srt_base_sink_send_headers (GST_SRT_BASE_SINK (self),
+            send_buffer_internal, client))
+      return FALSE;
+
+    client->sent_headers = TRUE;
+  }
+
+  while (client->next_seq < priv->next_seq) {
+    FanoutEntry *entry = g_ptr_array_index (priv->entries,
+        client->next_seq - priv->first_seq);
+
+    if (srt_sendmsg2 (client->sock, (char *) entry->map.data, entry->map.size,
+            0) == SRT_ERROR) {
+      if (srt_getlasterror (NULL) == SRT_EASYNCSND) {
+        /* send buffer is full, retry once it's writable again */
+        srt_clearlasterror ();
+        break;
+      }
 
-    if (!client->sent_headers) {
-      if (!gst_srt_base_sink_send_headers (sink, send_buffer_internal, client))
-        goto err;
+      GST_WARNING_OBJECT (self, "%s", srt_getlasterror_str ());
+      srt_clearlasterror ();
+      return FALSE;
+    }
+
+    client->next_seq++;
+  }
+
+  return TRUE;
+}
 
-      client->sent_headers = TRUE;
+/* Handles clients that fell behind by more than the latency budget and
+ * forgets about entries that were sent to everyone. Returns the clients to
+ * remove. Call with the object lock. */
+static GList *
+gst_srt_server_sink_check_clients (GstSRTServerSink * self)
+{
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+  gint64 deadline = g_get_monotonic_time () -
+      (gint64) priv->client_latency_budget * 1000;
+  guint64 min_seq = priv->next_seq;
+  GList *removed = NULL, *item, *next;
+
+  for (item = priv->clients; item; item = next) {
+    SRTClient *client = item->data;
+    FanoutEntry *entry;
+
+    next = item->next;
+
+    if (client->next_seq < priv->next_seq) {
+      entry = g_ptr_array_index (priv->entries,
+          client->next_seq - priv->first_seq);
+
+      if (entry->queued_time < deadline) {
+        if (priv->disconnect_slow_clients) {
+          GST_INFO_OBJECT (self, "client %d is too slow, disconnecting",
+              client->sock);
+          priv->clients = g_list_delete_link (priv->clients, item);
+          removed = g_list_prepend (removed, client);
+          continue;
+        }
+
+        GST_DEBUG_OBJECT (self, "client %d is too slow, dropping %"
+            G_GUINT64_FORMAT " buffers", client->sock,
+            priv->next_seq - client->next_seq);
+        client->packets_dropped += priv->next_seq - client->next_seq;
+        client->next_seq = priv->next_seq;
+      }
     }
 
-    if (!send_buffer_internal (sink, mapinfo, client))
-      goto err;
+    min_seq = MIN (min_seq, client->next_seq);
+  }
+
+  if (min_seq > priv->first_seq) {
+    g_ptr_array_remove_range (priv->entries, 0, min_seq - priv->first_seq);
+    priv->first_seq = min_seq;
+  }
+
+  return removed;
+}
+
+static void
+gst_srt_server_sink_remove_clients (GstSRTServerSink * self, GList * clients)
+{
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+  GList *item;
 
-    continue;
+  for (item = clients; item; item = item->next) {
+    SRTClient *client = item->data;
 
-  err:
-    priv->clients = g_list_remove (priv->clients, client);
-    GST_OBJECT_UNLOCK (sink);
+    srt_epoll_remove_usock (priv->client_poll_id, client->sock);
     g_signal_emit (self, signals[SIG_CLIENT_REMOVED], 0, client->sock,
         client->sockaddr);
-    srt_client_free (client);
-    GST_OBJECT_LOCK (sink);
   }
-  GST_OBJECT_UNLOCK (sink);
+  g_list_free_full (clients, (GDestroyNotify) srt_client_free);
+}
 
-  return TRUE;
+/* Only waits for clients that have something to send to become writable,
+ * as idle sockets would always wake us up. Returns FALSE if there's nothing
+ * to send at all. Call with the object lock. */
+static gboolean
+gst_srt_server_sink_update_polling (GstSRTServerSink * self)
+{
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+  gboolean pending = FALSE;
+  GList *item;
+
+  for (item = priv->clients; item; item = item->next) {
+    SRTClient *client = item->data;
+    gboolean want_write = client->next_seq < priv->next_seq
+        || !client->sent_headers;
+
+    if (want_write != client->want_write) {
+      srt_epoll_update_usock (priv->client_poll_id, client->sock, &(int) {
+          want_write ? SRT_EPOLL_OUT | SRT_EPOLL_ERR : SRT_EPOLL_ERR});
+      client->want_write = want_write;
+    }
+
+    pending |= want_write;
+  }
+
+  return pending;
+}
+
+static gpointer
+fanout_thread_func (gpointer data)
+{
+  GstSRTServerSink *self = GST_SRT_SERVER_SINK (data);
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+  SRTSOCKET *ready = NULL;
+  gint n_ready_max = 0;
+
+  GST_OBJECT_LOCK (self);
+  while (priv->fanout_running) {
+    GList *removed;
+    gint n_ready, i;
+
+    if (!gst_srt_server_sink_update_polling (self)) {
+      /* everything was sent, forget about it */
+      g_ptr_array_set_size (priv->entries, 0);
+      priv->first_seq = priv->next_seq;
+      g_cond_wait (&priv->fanout_cond, GST_OBJECT_GET_LOCK (self));
+      continue;
+    }
+
+    n_ready = g_list_length (priv->clients);
+    if (n_ready > n_ready_max) {
+      n_ready_max = n_ready;
+      ready = g_renew (SRTSOCKET, ready, n_ready_max);
+    }
+    GST_OBJECT_UNLOCK (self);
+
+    if (srt_epoll_wait (priv->client_poll_id, NULL, NULL, ready, &n_ready,
+            SRT_FANOUT_POLL_TIMEOUT, 0, 0, 0, 0) == -1) {
+      srt_clearlasterror ();
+      n_ready = 0;
+    }
+
+    GST_OBJECT_LOCK (self);
+    removed = NULL;
+    for (i = 0; i < n_ready; i++) {
+      GList *item;
+
+      for (item = priv->clients; item; item = item->next) {
+        SRTClient *client = item->data;
+
+        if (client->sock != ready[i])
+          continue;
+
+        if (!gst_srt_server_sink_pump_client (self, client)) {
+          priv->clients = g_list_delete_link (priv->clients, item);
+          removed = g_list_prepend (removed, client);
+        }
+        break;
+      }
+    }
+
+    removed = g_list_concat (removed, gst_srt_server_sink_check_clients (self));
+
+    if (removed) {
+      GST_OBJECT_UNLOCK (self);
+      gst_srt_server_sink_remove_clients (self, removed);
+      GST_OBJECT_LOCK (self);
+    }
+
+    /* wake up anyone draining the clients */
+    g_cond_broadcast (&priv->fanout_cond);
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  g_free (ready);
+
+  return NULL;
+}
+
+static GstFlowReturn
+gst_srt_server_sink_render (GstBaseSink * sink, GstBuffer * buffer)
+{
+  GstSRTServerSink *self = GST_SRT_SERVER_SINK (sink);
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+  FanoutEntry *entry;
+
+  if (GST_SRT_BASE_SINK (self)->headers
+      && GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_HEADER)) {
+    GST_DEBUG_OBJECT (self, "Have streamheaders,"
+        " ignoring header %" GST_PTR_FORMAT, buffer);
+    return GST_FLOW_OK;
+  }
+
+  entry = g_slice_new (FanoutEntry);
+  if (!gst_buffer_map (buffer, &entry->map, GST_MAP_READ)) {
+    g_slice_free (FanoutEntry, entry);
+    GST_ELEMENT_ERROR (self, RESOURCE, READ,
+        ("Could not map the input stream"), (NULL));
+    return GST_FLOW_ERROR;
+  }
+  entry->buffer = gst_buffer_ref (buffer);
+  entry->queued_time = g_get_monotonic_time ();
+
+  GST_TRACE_OBJECT (self, "queueing buffer %" GST_PTR_FORMAT, buffer);
+
+  GST_OBJECT_LOCK (self);
+  g_ptr_array_add (priv->entries, entry);
+  priv->next_seq++;
+  g_cond_broadcast (&priv->fanout_cond);
+  GST_OBJECT_UNLOCK (self);
+
+  return GST_FLOW_OK;
+}
+
+/* Whether any client still has queued entries to send. Call with the
+ * object lock. */
+static gboolean
+gst_srt_server_sink_has_pending (GstSRTServerSink * self)
+{
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+  GList *item;
+
+  for (item = priv->clients; item; item = item->next) {
+    SRTClient *client = item->data;
+
+    if (client->next_seq < priv->next_seq)
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+/* Waits until every client got everything that is queued. Clients that
+ * can't keep up are dropped or skip ahead after the latency budget, so this
+ * doesn't wait much longer than that. */
+static void
+gst_srt_server_sink_drain (GstSRTServerSink * self)
+{
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+  gint64 end_time;
+
+  GST_OBJECT_LOCK (self);
+  end_time = g_get_monotonic_time () +
+      ((gint64) priv->client_latency_budget + 2 * SRT_FANOUT_POLL_TIMEOUT) *
+      G_TIME_SPAN_MILLISECOND;
+
+  while (priv->fanout_running && !priv->cancelled &&
+      gst_srt_server_sink_has_pending (self)) {
+    if (!g_cond_wait_until (&priv->fanout_cond, GST_OBJECT_GET_LOCK (self),
+            end_time)) {
+      GST_WARNING_OBJECT (self, "Timed out waiting for clients to drain");
+      break;
+    }
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static gboolean
+gst_srt_server_sink_event (GstBaseSink * sink, GstEvent * event)
+{
+  GstSRTServerSink *self = GST_SRT_SERVER_SINK (sink);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS)
+    gst_srt_server_sink_drain (self);
+
+  return GST_BASE_SINK_CLASS (parent_class)->event (sink, event);
+}
+
+static void
+gst_srt_server_sink_stop_fanout (GstSRTServerSink * self)
+{
+  GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
+
+  GST_OBJECT_LOCK (self);
+  priv->fanout_running = FALSE;
+  g_cond_broadcast (&priv->fanout_cond);
+  GST_OBJECT_UNLOCK (self);
+
+  if (priv->fanout_thread) {
+    g_thread_join (priv->fanout_thread);
+    priv->fanout_thread = NULL;
+  }
+
+  if (priv->client_poll_id != SRT_ERROR) {
+    srt_epoll_release (priv->client_poll_id);
+    priv->client_poll_id = SRT_ERROR;
+  }
+
+  g_ptr_array_set_size (priv->entries, 0);
+  priv->first_seq = priv->next_seq = 0;
 }
 
 static gboolean
@@ -451,6 +855,8 @@ gst_srt_server_sink_stop (GstBaseSink * sink)
   GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
   GList *clients;
 
+  gst_srt_server_sink_stop_fanout (self);
+
   GST_DEBUG_OBJECT (self, "closing client sockets");
 
   GST_OBJECT_LOCK (sink);
@@ -489,7 +895,10 @@ gst_srt_server_sink_unlock (GstBaseSink * sink)
   GstSRTServerSink *self = GST_SRT_SERVER_SINK (sink);
   GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
 
+  GST_OBJECT_LOCK (self);
   priv->cancelled = TRUE;
+  g_cond_broadcast (&priv->fanout_cond);
+  GST_OBJECT_UNLOCK (self);
 
   return TRUE;
 }
@@ -500,7 +909,9 @@ gst_srt_server_sink_unlock_stop (GstBaseSink * sink)
   GstSRTServerSink *self = GST_SRT_SERVER_SINK (sink);
   GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
 
+  GST_OBJECT_LOCK (self);
   priv->cancelled = FALSE;
+  GST_OBJECT_UNLOCK (self);
 
   return TRUE;
 }
@@ -511,10 +922,10 @@ gst_srt_server_sink_class_init (GstSRTServerSinkClass * klass)
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
   GstBaseSinkClass *gstbasesink_class = GST_BASE_SINK_CLASS (klass);
-  GstSRTBaseSinkClass *gstsrtbasesink_class = GST_SRT_BASE_SINK_CLASS (klass);
 
   gobject_class->set_property = gst_srt_server_sink_set_property;
   gobject_class->get_property = gst_srt_server_sink_get_property;
+  gobject_class->finalize = gst_srt_server_sink_finalize;
 
   properties[PROP_POLL_TIMEOUT] =
       g_param_spec_int ("poll-timeout", "Poll Timeout",
@@ -529,6 +940,33 @@ gst_srt_server_sink_class_init (GstSRTServerSinkClass * klass)
           G_PARAM_READABLE | G_PARAM_STATIC_STRINGS),
       G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GstSRTServerSink:client-latency-budget:
+   *
+   * The maximum time a buffer may wait to be sent to a client.  Clients
+   * that can't keep up are handled according to
+   * #GstSRTServerSink:disconnect-slow-clients.
+   */
+  properties[PROP_CLIENT_LATENCY_BUDGET] =
+      g_param_spec_uint ("client-latency-budget", "Client latency budget",
+      "Maximum time in milliseconds a buffer may wait to be sent to a client",
+      1, G_MAXUINT, SRT_DEFAULT_CLIENT_LATENCY_BUDGET,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GstSRTServerSink:disconnect-slow-clients:
+   *
+   * Whether clients exceeding #GstSRTServerSink:client-latency-budget are
+   * disconnected.  Otherwise the buffers that are waiting for them are
+   * dropped and they continue with the most recent data.
+   */
+  properties[PROP_DISCONNECT_SLOW_CLIENTS] =
+      g_param_spec_boolean ("disconnect-slow-clients",
+      "Disconnect slow clients",
+      "Disconnect clients that exceed the latency budget instead of "
+      "dropping data for them", SRT_DEFAULT_DISCONNECT_SLOW_CLIENTS,
+      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, properties);
 
   /**
@@ -572,9 +1010,9 @@ gst_srt_server_sink_class_init (GstSRTServerSinkClass * klass)
   gstbasesink_class->unlock = GST_DEBUG_FUNCPTR (gst_srt_server_sink_unlock);
   gstbasesink_class->unlock_stop =
       GST_DEBUG_FUNCPTR (gst_srt_server_sink_unlock_stop);
-
-  gstsrtbasesink_class->send_buffer =
-      GST_DEBUG_FUNCPTR (gst_srt_server_sink_send_buffer);
+  /* buffers are queued for the fan-out thread instead of being sent */
+  gstbasesink_class->render = GST_DEBUG_FUNCPTR (gst_srt_server_sink_render);
+  gstbasesink_class->event = GST_DEBUG_FUNCPTR (gst_srt_server_sink_event);
 }
 
 static void
@@ -582,4 +1020,11 @@ gst_srt_server_sink_init (GstSRTServerSink * self)
 {
   GstSRTServerSinkPrivate *priv = GST_SRT_SERVER_SINK_GET_PRIVATE (self);
   priv->poll_timeout = SRT_DEFAULT_POLL_TIMEOUT;
+  priv->poll_id = SRT_ERROR;
+  priv->client_poll_id = SRT_ERROR;
+  priv->client_latency_budget = SRT_DEFAULT_CLIENT_LATENCY_BUDGET;
+  priv->disconnect_slow_clients = SRT_DEFAULT_DISCONNECT_SLOW_CLIENTS;
+  priv->entries =
+      g_ptr_array_new_with_free_func ((GDestroyNotify) fanout_entry_free);
+  g_cond_init (&priv->fanout_cond);
 }
@@ -60,6 +60,7 @@ struct _GstSRTServerSrcPrivate
   GSocketAddress *client_sockaddr;
 
   gint poll_id;
+  gint client_poll_id;
   gint poll_timeout;
 
   gboolean has_client;
@@ -140,6 +141,11 @@ gst_srt_server_src_finalize (GObject * object)
     priv->poll_id = SRT_ERROR;
   }
 
+  if (priv->client_poll_id != SRT_ERROR) {
+    srt_epoll_release (priv->client_poll_id);
+    priv->client_poll_id = SRT_ERROR;
+  }
+
   if (priv->sock != SRT_ERROR) {
     srt_close (priv->sock);
     priv->sock = SRT_ERROR;
@@ -148,18 +154,32 @@ gst_srt_server_src_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_srt_server_src_close_client (GstSRTServerSrc * self)
+{
+  GstSRTServerSrcPrivate *priv = GST_SRT_SERVER_SRC_GET_PRIVATE (self);
+
+  g_signal_emit (self, signals[SIG_CLIENT_CLOSED], 0,
+      priv->client_sock, priv->client_sockaddr);
+
+  srt_epoll_remove_usock (priv->client_poll_id, priv->client_sock);
+  srt_close (priv->client_sock);
+  priv->client_sock = SRT_INVALID_SOCK;
+  g_clear_object (&priv->client_sockaddr);
+  priv->has_client = FALSE;
+}
+
 static GstFlowReturn
-gst_srt_server_src_fill (GstPushSrc * src, GstBuffer * outbuf)
+gst_srt_server_src_create (GstPushSrc * src, GstBuffer ** outbuf)
 {
   GstSRTServerSrc *self = GST_SRT_SERVER_SRC (src);
   GstSRTServerSrcPrivate *priv = GST_SRT_SERVER_SRC_GET_PRIVATE (self);
-  GstFlowReturn ret = GST_FLOW_OK;
-  GstMapInfo info;
+  GstFlowReturn ret;
   SRTSOCKET ready[2];
-  gint recv_len;
   struct sockaddr client_sa;
   size_t client_sa_len;
 
+again:
   while (!priv->has_client) {
     GST_DEBUG_OBJECT (self, "poll wait (timeout: %d)", priv->poll_timeout);
 
@@ -202,59 +222,54 @@ gst_srt_server_src_fill (GstPushSrc * src, GstBuffer * outbuf)
       g_clear_object (&priv->client_sockaddr);
       priv->client_sockaddr = g_socket_address_new_from_native (&client_sa,
           client_sa_len);
+
+      /* Wait for incoming data and never block in srt_recvmsg() */
+      srt_setsockopt (priv->client_sock, 0, SRTO_RCVSYN, &(int) {
+          0}, sizeof (int));
+      srt_epoll_add_usock (priv->client_poll_id, priv->client_sock, &(int) {
+          SRT_EPOLL_IN | SRT_EPOLL_ERR});
+
       g_signal_emit (self, signals[SIG_CLIENT_ADDED], 0,
           priv->client_sock, priv->client_sockaddr);
     }
   }
 
-  GST_DEBUG_OBJECT (self, "filling buffer");
-
-  if (!gst_buffer_map (outbuf, &info, GST_MAP_WRITE)) {
-    GST_ELEMENT_ERROR (src, RESOURCE, WRITE,
-        ("Could not map the output stream"), (NULL));
-    ret = GST_FLOW_ERROR;
-    goto out;
-  }
+  if (srt_epoll_wait (priv->client_poll_id, ready, &(int) {
+          2}, 0, 0, priv->poll_timeout, 0, 0, 0, 0) == -1) {
+    int srt_errno = srt_getlasterror (NULL);
 
-  recv_len = srt_recvmsg (priv->client_sock, (char *) info.data,
-      gst_buffer_get_size (outbuf));
+    if (srt_errno != SRT_ETIMEOUT) {
+      GST_ELEMENT_ERROR (src, RESOURCE, FAILED,
+          ("SRT error: %s", srt_getlasterror_str ()), (NULL));
 
-  gst_buffer_unmap (outbuf, &info);
-
-  if (recv_len == SRT_ERROR) {
-    GST_WARNING_OBJECT (self, "%s", srt_getlasterror_str ());
+      return GST_FLOW_ERROR;
+    }
+    srt_clearlasterror ();
 
-    g_signal_emit (self, signals[SIG_CLIENT_CLOSED], 0,
-        priv->client_sock, priv->client_sockaddr);
+    if (priv->cancelled) {
+      GST_DEBUG_OBJECT (self, "Cancelled waiting for data");
+      return GST_FLOW_FLUSHING;
+    }
 
-    srt_close (priv->client_sock);
-    priv->client_sock = SRT_INVALID_SOCK;
-    g_clear_object (&priv->client_sockaddr);
-    priv->has_client = FALSE;
-    gst_buffer_resize (outbuf, 0, 0);
-    ret = GST_FLOW_OK;
-    goto out;
-  } else if (recv_len == 0) {
-    ret = GST_FLOW_EOS;
-    goto out;
+    goto again;
   }
 
-  GST_BUFFER_PTS (outbuf) =
-      gst_clock_get_time (GST_ELEMENT_CLOCK (src)) -
-      GST_ELEMENT_CAST (src)->base_time;
+  /* drains everything that is ready so a burst of messages is pushed
+   * downstream in one go */
+  ret = gst_srt_base_src_receive (GST_SRT_BASE_SRC (self), priv->client_sock,
+      outbuf);
 
-  gst_buffer_resize (outbuf, 0, recv_len);
+  if (ret == GST_SRT_BASE_SRC_FLOW_NO_DATA)
+    goto again;
 
-  GST_LOG_OBJECT (src,
-      "filled buffer from _get of size %" G_GSIZE_FORMAT ", ts %"
-      GST_TIME_FORMAT ", dur %" GST_TIME_FORMAT
-      ", offset %" G_GINT64_FORMAT ", offset_end %" G_GINT64_FORMAT,
-      gst_buffer_get_size (outbuf),
-      GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (outbuf)),
-      GST_TIME_ARGS (GST_BUFFER_DURATION (outbuf)),
-      GST_BUFFER_OFFSET (outbuf), GST_BUFFER_OFFSET_END (outbuf));
+  if (ret == GST_FLOW_ERROR) {
+    GST_WARNING_OBJECT (self, "%s", srt_getlasterror_str ());
+    srt_clearlasterror ();
+
+    gst_srt_server_src_close_client (self);
+    goto again;
+  }
 
-out:
   return ret;
 }
 
@@ -337,6 +352,14 @@ gst_srt_server_src_start (GstBaseSrc * src)
   srt_epoll_add_usock (priv->poll_id, priv->sock, &(int) {
       SRT_EPOLL_IN});
 
+  priv->client_poll_id = srt_epoll_create ();
+  if (priv->client_poll_id == -1) {
+    GST_ELEMENT_ERROR (self, LIBRARY, INIT, (NULL),
+        ("failed to create poll id for SRT socket (reason: %s)",
+            srt_getlasterror_str ()));
+    goto failed;
+  }
+
   if (srt_bind (priv->sock, &sa, sa_len) == SRT_ERROR) {
     GST_ELEMENT_ERROR (self, RESOURCE, OPEN_READ, (NULL),
         ("failed to bind SRT server socket (reason: %s)",
@@ -361,6 +384,11 @@ failed:
     priv->poll_id = SRT_ERROR;
   }
 
+  if (priv->client_poll_id != SRT_ERROR) {
+    srt_epoll_release (priv->client_poll_id);
+    priv->client_poll_id = SRT_ERROR;
+  }
+
   if (priv->sock != SRT_ERROR) {
     srt_close (priv->sock);
     priv->sock = SRT_ERROR;
@@ -382,12 +410,18 @@ gst_srt_server_src_stop (GstBaseSrc * src)
   if (priv->client_sock != SRT_INVALID_SOCK) {
     g_signal_emit (self, signals[SIG_CLIENT_ADDED], 0,
         priv->client_sock, priv->client_sockaddr);
+    srt_epoll_remove_usock (priv->client_poll_id, priv->client_sock);
     srt_close (priv->client_sock);
     g_clear_object (&priv->client_sockaddr);
     priv->client_sock = SRT_INVALID_SOCK;
     priv->has_client = FALSE;
   }
 
+  if (priv->client_poll_id != SRT_ERROR) {
+    srt_epoll_release (priv->client_poll_id);
+    priv->client_poll_id = SRT_ERROR;
+  }
+
   if (priv->poll_id != SRT_ERROR) {
     srt_epoll_remove_usock (priv->poll_id, priv->sock);
     srt_epoll_release (priv->poll_id);
@@ -495,7 +529,7 @@ gst_srt_server_src_class_init (GstSRTServerSrcClass * klass)
   gstbasesrc_class->unlock_stop =
       GST_DEBUG_FUNCPTR (gst_srt_server_src_unlock_stop);
 
-  gstpushsrc_class->fill = GST_DEBUG_FUNCPTR (gst_srt_server_src_fill);
+  gstpushsrc_class->create = GST_DEBUG_FUNCPTR (gst_srt_server_src_create);
 }
 
 static void
@@ -506,5 +540,6 @@ gst_srt_server_src_init (GstSRTServerSrc * self)
   priv->sock = SRT_INVALID_SOCK;
   priv->client_sock = SRT_INVALID_SOCK;
   priv->poll_id = SRT_ERROR;
+  priv->client_poll_id = SRT_ERROR;
   priv->poll_timeout = SRT_DEFAULT_POLL_TIMEOUT;
 }
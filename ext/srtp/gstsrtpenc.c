@@ -158,10 +158,8 @@ enum
 typedef struct ProcessBufferItData
 {
   GstSrtpEnc *filter;
-  GstPad *pad;
-  GstBufferList *out_list;
-  GstFlowReturn flowret;
   gboolean is_rtcp;
+  srtp_err_status_t err;
 } ProcessBufferItData;
 
 /* the capabilities of the inputs and outputs.
@@ -908,6 +906,32 @@ gst_srtp_enc_sink_query (GstPad * pad, GstObject * parent, GstQuery * query,
 
       return TRUE;
     }
+    case GST_QUERY_ALLOCATION:
+    {
+      GstAllocationParams params;
+      GstAllocator *allocator;
+      guint i, n;
+
+      gst_pad_query_default (pad, parent, query);
+
+      /* Ask for room after the packets so that we can add the SRTP
+       * trailer without copying them */
+      n = gst_query_get_n_allocation_params (query);
+      for (i = 0; i < n; i++) {
+        gst_query_parse_nth_allocation_param (query, i, &allocator, &params);
+        params.padding = MAX (params.padding, SRTP_MAX_TRAILER_LEN);
+        gst_query_set_nth_allocation_param (query, i, allocator, &params);
+        if (allocator)
+          gst_object_unref (allocator);
+      }
+      if (n == 0) {
+        gst_allocation_params_init (&params);
+        params.padding = SRTP_MAX_TRAILER_LEN;
+        gst_query_add_allocation_param (query, NULL, &params);
+      }
+
+      return TRUE;
+    }
     default:
       return gst_pad_query_default (pad, parent, query);
   }
@@ -1030,75 +1054,125 @@ gst_srtp_enc_check_set_caps (GstSrtpEnc * filter, GstPad * pad,
   return GST_FLOW_OK;
 }
 
-static GstFlowReturn
-gst_srtp_enc_process_buffer (GstSrtpEnc * filter, GstPad * pad,
-    GstBuffer * buf, gboolean is_rtcp, GstBuffer ** outbuf_ptr)
+/* Returns a buffer with the content of buf in a single writable memory,
+ * followed by enough room for the SRTP trailer. This is buf itself if it
+ * already is like that, so it can be protected in place.
+ */
+static GstBuffer *
+gst_srtp_enc_make_protectable (GstSrtpEnc * filter, GstBuffer * buf)
 {
-  GstFlowReturn ret = GST_FLOW_OK;
-  gint size_max, size;
-  GstBuffer *bufout = NULL;
+  GstBuffer *bufout;
   GstMapInfo mapout;
-  srtp_err_status_t err;
+  gsize size;
 
-  /* Create a bigger buffer to add protection */
   size = gst_buffer_get_size (buf);
-  size_max = size + SRTP_MAX_TRAILER_LEN + 10;
-  bufout = gst_buffer_new_allocate (NULL, size_max, NULL);
 
-  gst_buffer_map (bufout, &mapout, GST_MAP_READWRITE);
+  if (gst_buffer_is_writable (buf) && gst_buffer_n_memory (buf) == 1) {
+    GstMemory *mem = gst_buffer_peek_memory (buf, 0);
+    gsize offset, maxsize;
+
+    gst_memory_get_sizes (mem, &offset, &maxsize);
+    if (gst_memory_is_writable (mem)
+        && maxsize - offset - size >= SRTP_MAX_TRAILER_LEN)
+      return buf;
+  }
+
+  /* Create a bigger buffer to add protection */
+  bufout = gst_buffer_new_allocate (NULL, size + SRTP_MAX_TRAILER_LEN + 10,
+      NULL);
 
+  gst_buffer_map (bufout, &mapout, GST_MAP_WRITE);
   gst_buffer_extract (buf, 0, mapout.data, size);
+  gst_buffer_unmap (bufout, &mapout);
 
-  GST_OBJECT_LOCK (filter);
+  gst_buffer_set_size (bufout, size);
+  gst_buffer_copy_into (bufout, buf, GST_BUFFER_COPY_METADATA, 0, -1);
+  gst_buffer_unref (buf);
 
-  gst_srtp_init_event_reporter ();
+  return bufout;
+}
 
-  if (filter->session == NULL) {
-    /* The rtcp session disappeared (element shutting down) */
-    GST_OBJECT_UNLOCK (filter);
-    ret = GST_FLOW_FLUSHING;
-    goto fail;
-  }
+/* Protects buf in place, it must come from gst_srtp_enc_make_protectable().
+ * Must be called with the object lock held.
+ */
+static srtp_err_status_t
+gst_srtp_enc_protect_no_lock (GstSrtpEnc * filter, GstBuffer * buf,
+    gboolean is_rtcp)
+{
+  GstMapInfo map;
+  srtp_err_status_t err;
+  gint size;
 
-  if (is_rtcp)
-    err = srtp_protect_rtcp (filter->session, mapout.data, &size);
-  else
-    err = srtp_protect (filter->session, mapout.data, &size);
+  size = gst_buffer_get_size (buf);
+  gst_buffer_set_size (buf, size + SRTP_MAX_TRAILER_LEN);
 
-  GST_OBJECT_UNLOCK (filter);
+  gst_buffer_map (buf, &map, GST_MAP_READWRITE);
 
-  gst_buffer_unmap (bufout, &mapout);
+  if (is_rtcp)
+    err = srtp_protect_rtcp (filter->session, map.data, &size);
+  else
+    err = srtp_protect (filter->session, map.data, &size);
 
-  if (err == srtp_err_status_ok) {
-    /* Buffer protected */
-    gst_buffer_set_size (bufout, size);
-    gst_buffer_copy_into (bufout, buf, GST_BUFFER_COPY_METADATA, 0, -1);
+  gst_buffer_unmap (buf, &map);
 
-    GST_LOG_OBJECT (pad, "Encoding %s buffer of size %d",
-        is_rtcp ? "RTCP" : "RTP", size);
+  if (err == srtp_err_status_ok)
+    gst_buffer_set_size (buf, size);
 
-  } else if (err == srtp_err_status_key_expired) {
+  return err;
+}
 
+static GstFlowReturn
+gst_srtp_enc_protect_error (GstSrtpEnc * filter, srtp_err_status_t err)
+{
+  if (err == srtp_err_status_key_expired) {
     GST_ELEMENT_ERROR (GST_ELEMENT_CAST (filter), STREAM, ENCODE,
         ("Key usage limit has been reached"),
         ("Unable to protect buffer (hard key usage limit reached)"));
-    ret = GST_FLOW_ERROR;
-    goto fail;
-
   } else {
     /* srtp_protect failed */
     GST_ELEMENT_ERROR (filter, LIBRARY, FAILED, (NULL),
         ("Unable to protect buffer (protect failed) code %d", err));
-    ret = GST_FLOW_ERROR;
-    goto fail;
   }
 
-  *outbuf_ptr = bufout;
-  return ret;
+  return GST_FLOW_ERROR;
+}
 
-fail:
-  gst_buffer_unref (bufout);
-  return ret;
+/* Takes ownership of buf */
+static GstFlowReturn
+gst_srtp_enc_process_buffer (GstSrtpEnc * filter, GstPad * pad,
+    GstBuffer * buf, gboolean is_rtcp, GstBuffer ** outbuf_ptr)
+{
+  GstBuffer *bufout;
+  srtp_err_status_t err;
+
+  bufout = gst_srtp_enc_make_protectable (filter, buf);
+
+  GST_OBJECT_LOCK (filter);
+
+  gst_srtp_init_event_reporter ();
+
+  if (filter->session == NULL) {
+    /* The rtcp session disappeared (element shutting down) */
+    GST_OBJECT_UNLOCK (filter);
+    gst_buffer_unref (bufout);
+    return GST_FLOW_FLUSHING;
+  }
+
+  err = gst_srtp_enc_protect_no_lock (filter, bufout, is_rtcp);
+
+  GST_OBJECT_UNLOCK (filter);
+
+  if (err != srtp_err_status_ok) {
+    gst_buffer_unref (bufout);
+    return gst_srtp_enc_protect_error (filter, err);
+  }
+
+  /* Buffer protected */
+  GST_LOG_OBJECT (pad, "Encoding %s buffer of size %" G_GSIZE_FORMAT,
+      is_rtcp ? "RTCP" : "RTP", gst_buffer_get_size (bufout));
+
+  *outbuf_ptr = bufout;
+  return GST_FLOW_OK;
 }
 
 static GstFlowReturn
@@ -1111,6 +1185,7 @@ gst_srtp_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buf,
   GstBuffer *bufout = NULL;
 
   if ((ret = gst_srtp_enc_check_set_caps (filter, pad, is_rtcp)) != GST_FLOW_OK) {
+    gst_buffer_unref (buf);
     goto out;
   }
 
@@ -1149,29 +1224,30 @@ gst_srtp_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buf,
   GST_OBJECT_UNLOCK (filter);
 
 out:
-  gst_buffer_unref (buf);
   return ret;
 }
 
 static gboolean
-process_buffer_it (GstBuffer ** buffer, guint index, gpointer user_data)
+make_protectable_it (GstBuffer ** buffer, guint index, gpointer user_data)
 {
   ProcessBufferItData *data = user_data;
-  GstBuffer *bufout;
-  GstFlowReturn ret;
 
-  ret = gst_srtp_enc_process_buffer (data->filter, data->pad, *buffer,
-      data->is_rtcp, &bufout);
-  if (ret != GST_FLOW_OK) {
-    data->flowret = ret;
-    return FALSE;
-  }
-
-  gst_buffer_list_add (data->out_list, bufout);
+  *buffer = gst_srtp_enc_make_protectable (data->filter, *buffer);
 
   return TRUE;
 }
 
+static gboolean
+protect_buffer_it (GstBuffer ** buffer, guint index, gpointer user_data)
+{
+  ProcessBufferItData *data = user_data;
+
+  data->err = gst_srtp_enc_protect_no_lock (data->filter, *buffer,
+      data->is_rtcp);
+
+  return data->err == srtp_err_status_ok;
+}
+
 static GstFlowReturn
 gst_srtp_enc_chain_list (GstPad * pad, GstObject * parent,
     GstBufferList * buf_list, gboolean is_rtcp)
@@ -1179,7 +1255,6 @@ gst_srtp_enc_chain_list (GstPad * pad, GstObject * parent,
   GstSrtpEnc *filter = GST_SRTP_ENC (parent);
   GstFlowReturn ret = GST_FLOW_OK;
   GstPad *otherpad;
-  GstBufferList *out_list = NULL;
   ProcessBufferItData process_data;
 
   GST_LOG_OBJECT (pad, "Buffer chain with list of %d",
@@ -1201,22 +1276,32 @@ gst_srtp_enc_chain_list (GstPad * pad, GstObject * parent,
 
   GST_OBJECT_UNLOCK (filter);
 
-  out_list = gst_buffer_list_new ();
-
   process_data.filter = filter;
-  process_data.pad = pad;
   process_data.is_rtcp = is_rtcp;
-  process_data.out_list = out_list;
-  process_data.flowret = GST_FLOW_OK;
+  process_data.err = srtp_err_status_ok;
 
-  if (!gst_buffer_list_foreach (buf_list, process_buffer_it, &process_data)) {
-    ret = process_data.flowret;
+  /* Protect the buffers in the list we got, copying only those that do
+   * not have room for the trailer, and all of them under a single lock */
+  buf_list = gst_buffer_list_make_writable (buf_list);
+  gst_buffer_list_foreach (buf_list, make_protectable_it, &process_data);
+
+  GST_OBJECT_LOCK (filter);
+
+  gst_srtp_init_event_reporter ();
+
+  if (filter->session == NULL) {
+    /* The rtcp session disappeared (element shutting down) */
+    GST_OBJECT_UNLOCK (filter);
+    ret = GST_FLOW_FLUSHING;
     goto out;
   }
 
-  if (!gst_buffer_list_length (out_list)) {
-    gst_buffer_list_unref (out_list);
-    ret = GST_FLOW_OK;
+  gst_buffer_list_foreach (buf_list, protect_buffer_it, &process_data);
+
+  GST_OBJECT_UNLOCK (filter);
+
+  if (process_data.err != srtp_err_status_ok) {
+    ret = gst_srtp_enc_protect_error (filter, process_data.err);
     goto out;
   }
 
@@ -1224,7 +1309,8 @@ gst_srtp_enc_chain_list (GstPad * pad, GstObject * parent,
   otherpad = get_rtp_other_pad (pad);
   GST_LOG_OBJECT (pad, "Pushing buffer chain of %d",
       gst_buffer_list_length (buf_list));
-  ret = gst_pad_push_list (otherpad, out_list);
+  ret = gst_pad_push_list (otherpad, buf_list);
+  buf_list = NULL;
 
   if (ret != GST_FLOW_OK) {
     goto out;
@@ -1244,7 +1330,8 @@ gst_srtp_enc_chain_list (GstPad * pad, GstObject * parent,
 
 out:
 
-  gst_buffer_list_unref (buf_list);
+  if (buf_list)
+    gst_buffer_list_unref (buf_list);
 
   return ret;
 }
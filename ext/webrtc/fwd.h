@@ -53,6 +53,8 @@ typedef struct _TransportReceiveBinClass TransportReceiveBinClass;
 typedef struct _WebRTCTransceiver WebRTCTransceiver;
 typedef struct _WebRTCTransceiverClass WebRTCTransceiverClass;
 
+typedef struct _WebRTCWorker WebRTCWorker;
+
 G_END_DECLS
 
 #endif /* __WEBRTC_FWD_H__ */
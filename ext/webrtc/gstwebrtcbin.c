@@ -28,6 +28,9 @@
 #include "utils.h"
 #include "webrtcsdp.h"
 #include "webrtctransceiver.h"
+#include "workerpool.h"
+
+#include <gst/rtp/rtp.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -42,6 +45,8 @@
 #define PC_LOCK(w) (g_mutex_lock (PC_GET_LOCK(w)))
 #define PC_UNLOCK(w) (g_mutex_unlock (PC_GET_LOCK(w)))
 
+#define RTPHDREXT_MID "urn:ietf:params:rtp-hdrext:sdes:mid"
+
 #define PC_GET_COND(w) (&w->priv->pc_cond)
 #define PC_COND_WAIT(w) (g_cond_wait(PC_GET_COND(w), PC_GET_LOCK(w)))
 #define PC_COND_BROADCAST(w) (g_cond_broadcast(PC_GET_COND(w)))
@@ -68,7 +73,7 @@
  * assert sending payload type matches the stream
  * reconfiguration (of anything)
  * LS groups
- * bundling
+ * balanced/max-compat bundle policies
  * setting custom DTLS certificates
  * data channel
  *
@@ -213,6 +218,8 @@ enum
   PROP_PENDING_REMOTE_DESCRIPTION,
   PROP_STUN_SERVER,
   PROP_TURN_SERVER,
+  PROP_BUNDLE_POLICY,
+  PROP_WORKER_POOL_SIZE,
 };
 
 static guint gst_webrtc_bin_signals[LAST_SIGNAL] = { 0 };
@@ -381,6 +388,128 @@ _find_transport_for_session (GstWebRTCBin * webrtc, guint session_id)
   return stream;
 }
 
+/* returns the members of the BUNDLE group in @sdp that contains @mid or the
+ * first BUNDLE group if @mid is %NULL */
+static gchar **
+_get_bundle_group (const GstSDPMessage * sdp, const gchar * mid)
+{
+  int i;
+
+  for (i = 0; i < gst_sdp_message_attributes_len (sdp); i++) {
+    const GstSDPAttribute *attr = gst_sdp_message_get_attribute (sdp, i);
+    gchar *members, **group;
+
+    if (g_strcmp0 (attr->key, "group") != 0 || !attr->value
+        || !g_str_has_prefix (attr->value, "BUNDLE "))
+      continue;
+
+    members = g_strstrip (g_strdup (&attr->value[7]));
+    group = g_strsplit (members, " ", -1);
+    g_free (members);
+    if (group[0] && (!mid || g_strv_contains ((const gchar **) group, mid)))
+      return group;
+    g_strfreev (group);
+  }
+
+  return NULL;
+}
+
+static gint
+_find_media_idx_for_mid (const GstSDPMessage * sdp, const gchar * mid)
+{
+  int i;
+
+  for (i = 0; i < gst_sdp_message_medias_len (sdp); i++) {
+    const GstSDPMedia *media = gst_sdp_message_get_media (sdp, i);
+
+    if (g_strcmp0 (gst_sdp_media_get_attribute_val (media, "mid"), mid) == 0)
+      return i;
+  }
+
+  return -1;
+}
+
+/* If @media_idx is part of a BUNDLE group in @sdp, sets @bundle_idx to the
+ * m-line of the group's tag.  m-lines that @sdp doesn't know about yet (newly
+ * added transceivers) join the first BUNDLE group. */
+static gboolean
+_get_bundle_idx_from_sdp (const GstSDPMessage * sdp, guint media_idx,
+    guint * bundle_idx)
+{
+  const gchar *mid = NULL;
+  gchar **group;
+  gint idx = -1;
+
+  if (media_idx < gst_sdp_message_medias_len (sdp)) {
+    const GstSDPMedia *media = gst_sdp_message_get_media (sdp, media_idx);
+
+    mid = gst_sdp_media_get_attribute_val (media, "mid");
+    if (!mid)
+      return FALSE;
+  }
+
+  if (!(group = _get_bundle_group (sdp, mid)))
+    return FALSE;
+
+  idx = _find_media_idx_for_mid (sdp, group[0]);
+  g_strfreev (group);
+
+  if (idx < 0)
+    return FALSE;
+
+  *bundle_idx = idx;
+  return TRUE;
+}
+
+/* Returns the rtpbin session (and transport) that carries the media for
+ * @media_idx.  With bundling, this is the m-line of the BUNDLE tag and is
+ * shared with all the other m-lines in the group. */
+static guint
+_get_session_id_for_media (GstWebRTCBin * webrtc, guint media_idx)
+{
+  GstWebRTCSessionDescription *local, *remote;
+  guint local_idx = media_idx, remote_idx = media_idx;
+
+  if (webrtc->priv->bundle_policy == GST_WEBRTC_BUNDLE_POLICY_NONE)
+    return media_idx;
+
+  local = webrtc->pending_local_description ?
+      webrtc->pending_local_description : webrtc->current_local_description;
+  remote = webrtc->pending_remote_description ?
+      webrtc->pending_remote_description : webrtc->current_remote_description;
+
+  /* nothing negotiated yet, our offer will contain a single BUNDLE group
+   * tagged by the first m-line */
+  if (!local && !remote)
+    return 0;
+
+  if (local && !_get_bundle_idx_from_sdp (local->sdp, media_idx, &local_idx))
+    return media_idx;
+  if (remote && !_get_bundle_idx_from_sdp (remote->sdp, media_idx,
+          &remote_idx))
+    return media_idx;
+
+  return local ? local_idx : remote_idx;
+}
+
+static TransportStream *_create_transport_channel (GstWebRTCBin * webrtc,
+    guint session_id);
+
+static TransportStream *
+_get_or_create_transport_stream (GstWebRTCBin * webrtc, guint media_idx)
+{
+  guint session_id = _get_session_id_for_media (webrtc, media_idx);
+  TransportStream *ret;
+
+  if (!(ret = _find_transport_for_session (webrtc, session_id)))
+    ret = _create_transport_channel (webrtc, session_id);
+
+  GST_TRACE_OBJECT (webrtc, "Using transport %" GST_PTR_FORMAT " for media "
+      "%u", ret, media_idx);
+
+  return ret;
+}
+
 typedef gboolean (*FindPadFunc) (GstWebRTCBinPad * p1, gconstpointer data);
 
 static GstWebRTCBinPad *
@@ -545,6 +674,16 @@ static void
 _start_thread (GstWebRTCBin * webrtc)
 {
   PC_LOCK (webrtc);
+  if (webrtc->priv->worker_pool_size > 0) {
+    webrtc->priv->worker =
+        webrtc_worker_pool_acquire (webrtc->priv->worker_pool_size);
+    webrtc->priv->main_context =
+        g_main_context_ref (webrtc_worker_get_context (webrtc->priv->worker));
+    webrtc->priv->is_closed = FALSE;
+    PC_UNLOCK (webrtc);
+    return;
+  }
+
   webrtc->priv->thread = g_thread_new ("gst-pc-ops",
       (GThreadFunc) _gst_pc_thread, webrtc);
 
@@ -559,6 +698,16 @@ _stop_thread (GstWebRTCBin * webrtc)
 {
   PC_LOCK (webrtc);
   webrtc->priv->is_closed = TRUE;
+  if (webrtc->priv->worker) {
+    /* queued tasks keep us alive so there's nothing left to wait for and
+     * we may be called from the worker itself */
+    g_main_context_unref (webrtc->priv->main_context);
+    webrtc->priv->main_context = NULL;
+    webrtc_worker_release (webrtc->priv->worker);
+    webrtc->priv->worker = NULL;
+    PC_UNLOCK (webrtc);
+    return;
+  }
   g_main_loop_quit (webrtc->priv->loop);
   while (webrtc->priv->loop)
     PC_COND_WAIT (webrtc);
@@ -589,6 +738,8 @@ _free_op (GstWebRTCBinTask * op)
 {
   if (op->notify)
     op->notify (op->data);
+  if (op->owns_ref)
+    gst_object_unref (op->webrtc);
   g_free (op);
 }
 
@@ -612,6 +763,12 @@ gst_webrtc_bin_enqueue_task (GstWebRTCBin * webrtc, GstWebRTCBinFunc func,
   op->op = func;
   op->data = data;
   op->notify = notify;
+  /* a shared worker outlives us, make sure that we stay alive until the
+   * task has been executed */
+  if (webrtc->priv->worker) {
+    gst_object_ref (webrtc);
+    op->owns_ref = TRUE;
+  }
 
   source = g_idle_source_new ();
   g_source_set_priority (source, G_PRIORITY_DEFAULT);
@@ -1395,10 +1552,8 @@ sdp_media_from_transceiver (GstWebRTCBin * webrtc, GstSDPMedia * media,
 
     if (!trans->sender->transport) {
       TransportStream *item;
-      /* FIXME: bundle */
-      item = _find_transport_for_session (webrtc, media_idx);
-      if (!item)
-        item = _create_transport_channel (webrtc, media_idx);
+
+      item = _get_or_create_transport_stream (webrtc, media_idx);
       webrtc_transceiver_set_transport (WEBRTC_TRANSCEIVER (trans), item);
     }
 
@@ -1425,6 +1580,9 @@ static GstSDPMessage *
 _create_offer_task (GstWebRTCBin * webrtc, const GstStructure * options)
 {
   GstSDPMessage *ret;
+  GString *bundle_group = NULL;
+  gchar *bundle_ufrag = NULL, *bundle_pwd = NULL;
+  guint n_bundled = 0;
   int i;
 
   gst_sdp_message_new (&ret);
@@ -1440,6 +1598,15 @@ _create_offer_task (GstWebRTCBin * webrtc, const GstStructure * options)
   gst_sdp_message_add_time (ret, "0", "0", NULL);
   gst_sdp_message_add_attribute (ret, "ice-options", "trickle");
 
+  /* FIXME: balanced and max-compat should only bundle m-lines of the same
+   * media type if the answerer rejects BUNDLE.  For now every policy other
+   * than none offers a single BUNDLE group over one transport */
+  if (webrtc->priv->bundle_policy != GST_WEBRTC_BUNDLE_POLICY_NONE) {
+    bundle_group = g_string_new ("BUNDLE");
+    /* all bundled media must share the same ICE credentials */
+    _generate_ice_credentials (&bundle_ufrag, &bundle_pwd);
+  }
+
   /* for each rtp transceiver */
   for (i = 0; i < webrtc->priv->transceivers->len; i++) {
     GstWebRTCRTPTransceiver *trans;
@@ -1455,17 +1622,36 @@ _create_offer_task (GstWebRTCBin * webrtc, const GstStructure * options)
     gst_sdp_media_add_attribute (&media, "setup", "actpass");
 
     /* FIXME: only needed when restarting ICE */
-    _generate_ice_credentials (&ufrag, &pwd);
+    if (bundle_group) {
+      ufrag = g_strdup (bundle_ufrag);
+      pwd = g_strdup (bundle_pwd);
+    } else {
+      _generate_ice_credentials (&ufrag, &pwd);
+    }
     gst_sdp_media_add_attribute (&media, "ice-ufrag", ufrag);
     gst_sdp_media_add_attribute (&media, "ice-pwd", pwd);
     g_free (ufrag);
     g_free (pwd);
 
     if (sdp_media_from_transceiver (webrtc, &media, trans,
-            GST_WEBRTC_SDP_TYPE_OFFER, i))
+            GST_WEBRTC_SDP_TYPE_OFFER, i)) {
+      if (bundle_group) {
+        g_string_append_printf (bundle_group, " %s",
+            gst_sdp_media_get_attribute_val (&media, "mid"));
+        n_bundled++;
+      }
       gst_sdp_message_add_media (ret, &media);
-    else
+    } else {
       gst_sdp_media_uninit (&media);
+    }
+  }
+
+  if (bundle_group) {
+    if (n_bundled > 0)
+      gst_sdp_message_add_attribute (ret, "group", bundle_group->str);
+    g_string_free (bundle_group, TRUE);
+    g_free (bundle_ufrag);
+    g_free (bundle_pwd);
   }
 
   /* FIXME: pre-emptively setup receiving elements when needed */
@@ -1482,6 +1668,10 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
   GstSDPMessage *ret = NULL;
   const GstWebRTCSessionDescription *pending_remote =
       webrtc->pending_remote_description;
+  gchar **bundled = NULL;
+  GString *bundle_group = NULL;
+  gchar *bundle_ufrag = NULL, *bundle_pwd = NULL;
+  guint n_bundled = 0;
   int i;
 
   if (!webrtc->pending_remote_description) {
@@ -1511,10 +1701,16 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
     }
   }
 
+  /* only accept the offered BUNDLE group if we are allowed to bundle,
+   * otherwise every m-line gets its own transport as before */
+  if (webrtc->priv->bundle_policy != GST_WEBRTC_BUNDLE_POLICY_NONE)
+    bundled = _get_bundle_group (pending_remote->sdp, NULL);
+  if (bundled) {
+    bundle_group = g_string_new ("BUNDLE");
+    _generate_ice_credentials (&bundle_ufrag, &bundle_pwd);
+  }
+
   for (i = 0; i < gst_sdp_message_medias_len (pending_remote->sdp); i++) {
-    /* FIXME:
-     * bundle policy
-     */
     GstSDPMedia *media = NULL;
     GstSDPMedia *offer_media;
     GstWebRTCRTPTransceiver *rtp_trans = NULL;
@@ -1522,9 +1718,17 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
     GstWebRTCRTPTransceiverDirection offer_dir, answer_dir;
     GstWebRTCDTLSSetup offer_setup, answer_setup;
     GstCaps *offer_caps, *answer_caps = NULL;
+    const gchar *mid;
+    gboolean media_bundled;
     gchar *cert;
     int j;
 
+    offer_media =
+        (GstSDPMedia *) gst_sdp_message_get_media (pending_remote->sdp, i);
+    mid = gst_sdp_media_get_attribute_val (offer_media, "mid");
+    media_bundled = bundled && mid
+        && g_strv_contains ((const gchar **) bundled, mid);
+
     gst_sdp_media_new (&media);
     gst_sdp_media_set_port_info (media, 9, 0);
     gst_sdp_media_set_proto (media, "UDP/TLS/RTP/SAVPF");
@@ -1533,15 +1737,18 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
     {
       /* FIXME: only needed when restarting ICE */
       gchar *ufrag, *pwd;
-      _generate_ice_credentials (&ufrag, &pwd);
+      if (media_bundled) {
+        ufrag = g_strdup (bundle_ufrag);
+        pwd = g_strdup (bundle_pwd);
+      } else {
+        _generate_ice_credentials (&ufrag, &pwd);
+      }
       gst_sdp_media_add_attribute (media, "ice-ufrag", ufrag);
       gst_sdp_media_add_attribute (media, "ice-pwd", pwd);
       g_free (ufrag);
       g_free (pwd);
     }
 
-    offer_media =
-        (GstSDPMedia *) gst_sdp_message_get_media (pending_remote->sdp, i);
     for (j = 0; j < gst_sdp_media_attributes_len (offer_media); j++) {
       const GstSDPAttribute *attr =
           gst_sdp_media_get_attribute (offer_media, j);
@@ -1656,11 +1863,8 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
     }
     _media_replace_setup (media, answer_setup);
 
-    /* FIXME: bundle! */
     if (!trans->stream) {
-      TransportStream *item = _find_transport_for_session (webrtc, i);
-      if (!item)
-        item = _create_transport_channel (webrtc, i);
+      TransportStream *item = _get_or_create_transport_stream (webrtc, i);
       webrtc_transceiver_set_transport (trans, item);
     }
     /* set the a=fingerprint: for this transport */
@@ -1694,6 +1898,25 @@ _create_answer_task (GstWebRTCBin * webrtc, const GstStructure * options)
     gst_caps_unref (offer_caps);
   }
 
+  if (bundle_group) {
+    /* keep the offerer's ordering so that both sides agree on the tag */
+    for (i = 0; bundled[i]; i++) {
+      gint idx = _find_media_idx_for_mid (ret, bundled[i]);
+
+      if (idx >= 0
+          && gst_sdp_media_get_port (gst_sdp_message_get_media (ret, idx))) {
+        g_string_append_printf (bundle_group, " %s", bundled[i]);
+        n_bundled++;
+      }
+    }
+    if (n_bundled > 0)
+      gst_sdp_message_add_attribute (ret, "group", bundle_group->str);
+    g_string_free (bundle_group, TRUE);
+    g_free (bundle_ufrag);
+    g_free (bundle_pwd);
+  }
+  g_strfreev (bundled);
+
   /* FIXME: can we add not matched transceivers? */
 
   /* XXX: only true for the initial offerer */
@@ -1841,45 +2064,89 @@ _connect_input_stream (GstWebRTCBin * webrtc, GstWebRTCBinPad * pad)
  * o----------o send_rtp_sink_%u   ;                           ;
  * ;          '--------------------'                           ;
  * '--------------------- -------------------------------------'
+ */
+/*
+ * With bundling, all the sink pads sharing a transport are combined into the
+ * single rtpbin session of the BUNDLE tag:
+ *
+ * ,------------------------webrtcbin------------------------,
+ * ;           ,-rtpfunnel-,   ,-rtpbin-,   ,-transport_send-, ;
+ * ; sink_0    ;           ;   ;        ;   ;                ; ;
+ * o-----------o sink_0    ;   ;        ;   ;                ; ;
+ * ; sink_1    ;       src o---o ...    o---o rtp_sink       ; ;
+ * o-----------o sink_1    ;   ;        ;   ;                ; ;
+ * ;           '-----------'   '--------'   '----------------' ;
+ * '---------------------------------------------------------'
  */
   GstPadTemplate *rtp_templ;
   GstPad *rtp_sink;
   gchar *pad_name;
   WebRTCTransceiver *trans;
+  TransportStream *stream;
 
   g_return_val_if_fail (pad->trans != NULL, NULL);
 
   GST_INFO_OBJECT (pad, "linking input stream %u", pad->mlineindex);
 
-  rtp_templ =
-      _find_pad_template (webrtc->rtpbin, GST_PAD_SINK, GST_PAD_REQUEST,
-      "send_rtp_sink_%u");
-  g_assert (rtp_templ);
-
-  pad_name = g_strdup_printf ("send_rtp_sink_%u", pad->mlineindex);
-  rtp_sink =
-      gst_element_request_pad (webrtc->rtpbin, rtp_templ, pad_name, NULL);
-  g_free (pad_name);
-  gst_ghost_pad_set_target (GST_GHOST_PAD (pad), rtp_sink);
-  gst_object_unref (rtp_sink);
-
   trans = WEBRTC_TRANSCEIVER (pad->trans);
   if (!trans->stream) {
     TransportStream *item;
-    /* FIXME: bundle */
-    item = _find_transport_for_session (webrtc, pad->mlineindex);
-    if (!item)
-      item = _create_transport_channel (webrtc, pad->mlineindex);
+
+    item = _get_or_create_transport_stream (webrtc, pad->mlineindex);
     webrtc_transceiver_set_transport (trans, item);
   }
+  stream = trans->stream;
+
+  if (webrtc->priv->bundle_policy == GST_WEBRTC_BUNDLE_POLICY_NONE) {
+    rtp_templ =
+        _find_pad_template (webrtc->rtpbin, GST_PAD_SINK, GST_PAD_REQUEST,
+        "send_rtp_sink_%u");
+    g_assert (rtp_templ);
+
+    pad_name = g_strdup_printf ("send_rtp_sink_%u", stream->session_id);
+    rtp_sink =
+        gst_element_request_pad (webrtc->rtpbin, rtp_templ, pad_name, NULL);
+    g_free (pad_name);
+  } else {
+    if (!stream->rtpfunnel) {
+      GstElement *funnel;
 
-  pad_name = g_strdup_printf ("send_rtp_src_%u", pad->mlineindex);
-  if (!gst_element_link_pads (GST_ELEMENT (webrtc->rtpbin), pad_name,
-          GST_ELEMENT (trans->stream->send_bin), "rtp_sink"))
-    g_warn_if_reached ();
-  g_free (pad_name);
+      if (!(funnel = gst_element_factory_make ("rtpfunnel", NULL))) {
+        GST_ELEMENT_ERROR (webrtc, CORE, MISSING_PLUGIN, (NULL),
+            ("%s", "rtpfunnel element is not available"));
+        return NULL;
+      }
 
-  gst_element_sync_state_with_parent (GST_ELEMENT (trans->stream->send_bin));
+      gst_bin_add (GST_BIN (webrtc), funnel);
+      gst_element_sync_state_with_parent (funnel);
+
+      pad_name = g_strdup_printf ("send_rtp_sink_%u", stream->session_id);
+      if (!gst_element_link_pads (funnel, "src", webrtc->rtpbin, pad_name))
+        g_warn_if_reached ();
+      g_free (pad_name);
+
+      stream->rtpfunnel = funnel;
+    }
+
+    rtp_sink = gst_element_get_request_pad (stream->rtpfunnel, "sink_%u");
+  }
+
+  gst_ghost_pad_set_target (GST_GHOST_PAD (pad), rtp_sink);
+  gst_object_unref (rtp_sink);
+
+  /* bundled streams only link the shared session once */
+  rtp_sink = gst_element_get_static_pad (GST_ELEMENT (stream->send_bin),
+      "rtp_sink");
+  if (!gst_pad_is_linked (rtp_sink)) {
+    pad_name = g_strdup_printf ("send_rtp_src_%u", stream->session_id);
+    if (!gst_element_link_pads (GST_ELEMENT (webrtc->rtpbin), pad_name,
+            GST_ELEMENT (stream->send_bin), "rtp_sink"))
+      g_warn_if_reached ();
+    g_free (pad_name);
+  }
+  gst_object_unref (rtp_sink);
+
+  gst_element_sync_state_with_parent (GST_ELEMENT (stream->send_bin));
 
   return GST_PAD (pad);
 }
@@ -1910,18 +2177,20 @@ _connect_output_stream (GstWebRTCBin * webrtc, GstWebRTCBinPad * pad)
   trans = WEBRTC_TRANSCEIVER (pad->trans);
   if (!trans->stream) {
     TransportStream *item;
-    /* FIXME: bundle */
-    item = _find_transport_for_session (webrtc, pad->mlineindex);
-    if (!item)
-      item = _create_transport_channel (webrtc, pad->mlineindex);
+
+    item = _get_or_create_transport_stream (webrtc, pad->mlineindex);
     webrtc_transceiver_set_transport (trans, item);
   }
 
-  pad_name = g_strdup_printf ("recv_rtp_sink_%u", pad->mlineindex);
-  if (!gst_element_link_pads (GST_ELEMENT (trans->stream->receive_bin),
-          "rtp_src", GST_ELEMENT (webrtc->rtpbin), pad_name))
-    g_warn_if_reached ();
-  g_free (pad_name);
+  /* bundled streams share the receive side of the BUNDLE tag's session and
+   * are demuxed by payload type in on_rtpbin_pad_added() */
+  if (!gst_pad_is_linked (trans->stream->receive_bin->rtp_src)) {
+    pad_name = g_strdup_printf ("recv_rtp_sink_%u", trans->stream->session_id);
+    if (!gst_element_link_pads (GST_ELEMENT (trans->stream->receive_bin),
+            "rtp_src", GST_ELEMENT (webrtc->rtpbin), pad_name))
+      g_warn_if_reached ();
+    g_free (pad_name);
+  }
 
   gst_element_sync_state_with_parent (GST_ELEMENT (trans->stream->receive_bin));
 
@@ -1946,7 +2215,8 @@ _add_ice_candidate (GstWebRTCBin * webrtc, IceCandidateItem * item)
 {
   GstWebRTCICEStream *stream;
 
-  stream = _find_ice_stream_for_session (webrtc, item->mlineindex);
+  stream = _find_ice_stream_for_session (webrtc,
+      _get_session_id_for_media (webrtc, item->mlineindex));
   if (stream == NULL) {
     GST_WARNING_OBJECT (webrtc, "Unknown mline %u, ignoring", item->mlineindex);
     return;
@@ -1958,6 +2228,99 @@ _add_ice_candidate (GstWebRTCBin * webrtc, IceCandidateItem * item)
   gst_webrtc_ice_add_candidate (webrtc->priv->ice, stream, item->candidate);
 }
 
+static gboolean
+_find_media_idx_for_remote_ssrc (TransportStream * stream, guint32 ssrc,
+    guint * media_idx)
+{
+  guint i;
+
+  for (i = 0; i < stream->remote_ssrcmap->len; i++) {
+    SsrcMapItem *item = &g_array_index (stream->remote_ssrcmap, SsrcMapItem, i);
+    if (item->ssrc == ssrc) {
+      *media_idx = item->media_idx;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/* Remembers the SSRCs the peer signalled for @media_idx and the id of its
+ * MID header extension, used to route the streams of a BUNDLE group */
+static void
+_update_remote_ssrcs_from_sdp_media (TransportStream * stream,
+    const GstSDPMedia * remote_media, guint media_idx)
+{
+  guint i, len;
+
+  for (i = stream->remote_ssrcmap->len; i > 0; i--) {
+    SsrcMapItem *item =
+        &g_array_index (stream->remote_ssrcmap, SsrcMapItem, i - 1);
+    if (item->media_idx == media_idx)
+      g_array_remove_index (stream->remote_ssrcmap, i - 1);
+  }
+
+  len = gst_sdp_media_attributes_len (remote_media);
+  for (i = 0; i < len; i++) {
+    const GstSDPAttribute *attr =
+        gst_sdp_media_get_attribute (remote_media, i);
+
+    if (!attr->value)
+      continue;
+
+    if (g_strcmp0 (attr->key, "ssrc") == 0) {
+      SsrcMapItem item;
+      guint existing;
+
+      item.ssrc = (guint32) g_ascii_strtoull (attr->value, NULL, 10);
+      item.media_idx = media_idx;
+      /* there is one ssrc attribute per source attribute */
+      if (!_find_media_idx_for_remote_ssrc (stream, item.ssrc, &existing))
+        g_array_append_val (stream->remote_ssrcmap, item);
+    } else if (g_strcmp0 (attr->key, "extmap") == 0) {
+      gchar **tokens = g_strsplit (attr->value, " ", 3);
+
+      /* <id>[/<direction>] <uri> [<attributes>] */
+      if (tokens[0] && tokens[1] && g_strcmp0 (tokens[1], RTPHDREXT_MID) == 0) {
+        guint id = atoi (tokens[0]);
+        if (id > 0 && id < 256)
+          stream->mid_ext_id = id;
+      }
+      g_strfreev (tokens);
+    }
+  }
+}
+
+/* The transports of a BUNDLE group are shared, so they have to keep
+ * receiving as long as one of their transceivers does */
+static void
+_update_transport_receive_state (GstWebRTCBin * webrtc,
+    TransportStream * stream)
+{
+  ReceiveState state = RECEIVE_STATE_DROP;
+  guint i;
+
+  for (i = 0; i < webrtc->priv->transceivers->len; i++) {
+    GstWebRTCRTPTransceiver *rtp_trans =
+        g_array_index (webrtc->priv->transceivers, GstWebRTCRTPTransceiver *,
+        i);
+
+    if (WEBRTC_TRANSCEIVER (rtp_trans)->stream != stream)
+      continue;
+
+    if (rtp_trans->current_direction ==
+        GST_WEBRTC_RTP_TRANSCEIVER_DIRECTION_RECVONLY
+        || rtp_trans->current_direction ==
+        GST_WEBRTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV) {
+      state = RECEIVE_STATE_PASS;
+      break;
+    }
+  }
+
+  transport_receive_bin_set_receive_state (TRANSPORT_RECEIVE_BIN
+      (stream->receive_bin), state);
+}
+
 static void
 _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
     const GstSDPMessage * sdp, guint media_idx,
@@ -1984,10 +2347,8 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
   }
 
   if (!stream) {
-    /* FIXME: find an existing transport for e.g. bundle/reconfiguration */
-    stream = _find_transport_for_session (webrtc, media_idx);
-    if (!stream)
-      stream = _create_transport_channel (webrtc, media_idx);
+    /* FIXME: find an existing transport for e.g. reconfiguration */
+    stream = _get_or_create_transport_stream (webrtc, media_idx);
     webrtc_transceiver_set_transport (trans, stream);
   }
 
@@ -2028,8 +2389,13 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
       GST_DEBUG_OBJECT (webrtc, "mapping sdp media level attributes to caps");
       gst_sdp_media_attributes_to_caps (media, global_caps);
 
-      /* clear the ptmap */
-      g_array_set_size (stream->ptmap, 0);
+      /* clear the ptmap entries of this media, bundled m-lines share the
+       * ptmap of their transport */
+      for (i = stream->ptmap->len; i > 0; i--) {
+        PtMapItem *item = &g_array_index (stream->ptmap, PtMapItem, i - 1);
+        if (item->media_idx == media_idx)
+          g_array_remove_index (stream->ptmap, i - 1);
+      }
 
       len = gst_sdp_media_formats_len (media);
       for (i = 0; i < len; i++) {
@@ -2058,6 +2424,7 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
         gst_structure_set_name (s, "application/x-rtp");
 
         item.pt = pt;
+        item.media_idx = media_idx;
         item.caps = outcaps;
 
         g_array_append_val (stream->ptmap, item);
@@ -2066,6 +2433,8 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
       gst_caps_unref (global_caps);
     }
 
+    _update_remote_ssrcs_from_sdp_media (stream, remote_media, media_idx);
+
     new_rtcp_mux = _media_has_attribute_key (local_media, "rtcp-mux")
         && _media_has_attribute_key (remote_media, "rtcp-mux");
     new_rtcp_rsize = _media_has_attribute_key (local_media, "rtcp-rsize")
@@ -2074,7 +2443,7 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
     {
       GObject *session;
       g_signal_emit_by_name (webrtc->rtpbin, "get-internal-session",
-          media_idx, &session);
+          stream->session_id, &session);
       if (session) {
         g_object_set (session, "rtcp-reduced-size", new_rtcp_rsize, NULL);
         g_object_unref (session);
@@ -2088,17 +2457,13 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
     return;
   }
 
-  /* FIXME: bundle! */
-  g_object_set (stream, "rtcp-mux", new_rtcp_mux, NULL);
+  /* the m-line of the BUNDLE tag decides for all the bundled m-lines */
+  if (media_idx == stream->session_id)
+    g_object_set (stream, "rtcp-mux", new_rtcp_mux, NULL);
 
   if (new_dir != prev_dir) {
-    TransportReceiveBin *receive;
-
     GST_TRACE_OBJECT (webrtc, "transceiver direction change");
 
-    /* FIXME: this may not always be true. e.g. bundle */
-    g_assert (media_idx == stream->session_id);
-
     if (new_dir == GST_WEBRTC_RTP_TRANSCEIVER_DIRECTION_SENDONLY ||
         new_dir == GST_WEBRTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV) {
       GstWebRTCBinPad *pad =
@@ -2146,15 +2511,10 @@ _update_transceiver_from_sdp_media (GstWebRTCBin * webrtc,
           new_setup == GST_WEBRTC_DTLS_SETUP_ACTIVE, NULL);
     }
 
-    receive = TRANSPORT_RECEIVE_BIN (stream->receive_bin);
-    if (new_dir == GST_WEBRTC_RTP_TRANSCEIVER_DIRECTION_RECVONLY ||
-        new_dir == GST_WEBRTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV)
-      transport_receive_bin_set_receive_state (receive, RECEIVE_STATE_PASS);
-    else
-      transport_receive_bin_set_receive_state (receive, RECEIVE_STATE_DROP);
-
     rtp_trans->mline = media_idx;
     rtp_trans->current_direction = new_dir;
+
+    _update_transport_receive_state (webrtc, stream);
   }
 }
 
@@ -2456,10 +2816,10 @@ _set_description_task (GstWebRTCBin * webrtc, struct set_description *sd)
       gchar *ufrag, *pwd;
       TransportStream *item;
 
-      /* FIXME: bundle */
-      item = _find_transport_for_session (webrtc, i);
-      if (!item)
-        item = _create_transport_channel (webrtc, i);
+      item = _get_or_create_transport_stream (webrtc, i);
+      /* bundled m-lines use the credentials of the BUNDLE tag */
+      if (item->session_id != i)
+        continue;
 
       _get_ice_credentials_from_sdp_media (sd->sdp->sdp, i, &ufrag, &pwd);
       gst_webrtc_ice_set_local_credentials (webrtc->priv->ice,
@@ -2476,10 +2836,10 @@ _set_description_task (GstWebRTCBin * webrtc, struct set_description *sd)
       gchar *ufrag, *pwd;
       TransportStream *item;
 
-      /* FIXME: bundle */
-      item = _find_transport_for_session (webrtc, i);
-      if (!item)
-        item = _create_transport_channel (webrtc, i);
+      item = _get_or_create_transport_stream (webrtc, i);
+      /* bundled m-lines use the credentials of the BUNDLE tag */
+      if (item->session_id != i)
+        continue;
 
       _get_ice_credentials_from_sdp_media (sd->sdp->sdp, i, &ufrag, &pwd);
       gst_webrtc_ice_set_remote_credentials (webrtc->priv->ice,
@@ -2648,7 +3008,8 @@ _on_ice_candidate (GstWebRTCICE * ice, guint session_id,
 {
   IceCandidateItem *item = g_new0 (IceCandidateItem, 1);
 
-  /* FIXME: bundle support */
+  /* with bundling, the session is the m-line of the BUNDLE tag which is
+   * where the candidates belong */
   item->mlineindex = session_id;
   item->candidate = g_strdup (candidate);
 
@@ -2772,6 +3133,149 @@ gst_webrtc_bin_get_transceivers (GstWebRTCBin * webrtc)
   return arr;
 }
 
+static void
+_connect_rtpbin_recv_pad (GstWebRTCBin * webrtc, GstPad * new_pad,
+    TransportStream * stream, guint media_idx)
+{
+  GstWebRTCRTPTransceiver *rtp_trans;
+  WebRTCTransceiver *trans;
+  GstWebRTCBinPad *pad;
+
+  rtp_trans = _find_transceiver_for_mline (webrtc, media_idx);
+  if (!rtp_trans)
+    g_warn_if_reached ();
+  trans = WEBRTC_TRANSCEIVER (rtp_trans);
+  g_assert (trans->stream == stream);
+
+  pad = _find_pad_for_transceiver (webrtc, GST_PAD_SRC, rtp_trans);
+
+  GST_TRACE_OBJECT (webrtc, "found pad %" GST_PTR_FORMAT
+      " for rtpbin pad %" GST_PTR_FORMAT, pad, new_pad);
+  if (!pad)
+    g_warn_if_reached ();
+  gst_ghost_pad_set_target (GST_GHOST_PAD (pad), GST_PAD (new_pad));
+
+  if (webrtc->priv->running)
+    gst_pad_set_active (GST_PAD (pad), TRUE);
+  gst_element_add_pad (GST_ELEMENT (webrtc), GST_PAD (pad));
+  _remove_pending_pad (webrtc, pad);
+
+  gst_object_unref (pad);
+}
+
+/* Returns the m-line using @pt, with @ambiguous set if several m-lines of
+ * a BUNDLE group use it */
+static guint
+_find_media_idx_for_pt (TransportStream * stream, guint pt,
+    gboolean * ambiguous)
+{
+  guint media_idx = stream->session_id;
+  gboolean found = FALSE;
+  guint i;
+
+  *ambiguous = FALSE;
+  for (i = 0; i < stream->ptmap->len; i++) {
+    PtMapItem *item = &g_array_index (stream->ptmap, PtMapItem, i);
+    if (item->pt != pt)
+      continue;
+    if (!found) {
+      media_idx = item->media_idx;
+      found = TRUE;
+    } else if (item->media_idx != media_idx) {
+      *ambiguous = TRUE;
+    }
+  }
+
+  return media_idx;
+}
+
+static gboolean
+_stream_is_bundled (TransportStream * stream)
+{
+  guint i;
+
+  for (i = 0; i < stream->ptmap->len; i++) {
+    PtMapItem *item = &g_array_index (stream->ptmap, PtMapItem, i);
+    if (item->media_idx != stream->session_id)
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+static gchar *
+_get_rtp_buffer_mid (GstBuffer * buffer, guint8 ext_id)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  gpointer data;
+  guint size;
+  gchar *mid = NULL;
+
+  if (!gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp))
+    return NULL;
+
+  if (gst_rtp_buffer_get_extension_onebyte_header (&rtp, ext_id, 0, &data,
+          &size)
+      || gst_rtp_buffer_get_extension_twobytes_header (&rtp, NULL, ext_id, 0,
+          &data, &size))
+    mid = g_strndup (data, size);
+
+  gst_rtp_buffer_unmap (&rtp);
+
+  return mid;
+}
+
+typedef struct
+{
+  GstWebRTCBin *webrtc;
+  TransportStream *stream;
+  guint pt;
+} MidRouteData;
+
+static void
+mid_route_data_free (MidRouteData * data)
+{
+  gst_object_unref (data->stream);
+  g_free (data);
+}
+
+/* routes a bundled stream with the MID of its first packet */
+static GstPadProbeReturn
+_route_by_mid_probe (GstPad * pad, GstPadProbeInfo * info, MidRouteData * data)
+{
+  GstWebRTCRTPTransceiver *rtp_trans = NULL;
+  GstBuffer *buffer;
+  gboolean ambiguous;
+  guint media_idx;
+  gchar *mid;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+    buffer = gst_buffer_list_get (GST_PAD_PROBE_INFO_BUFFER_LIST (info), 0);
+  else
+    buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+
+  mid = buffer ? _get_rtp_buffer_mid (buffer, data->stream->mid_ext_id) : NULL;
+  if (mid)
+    rtp_trans = _find_transceiver (data->webrtc, mid,
+        (FindTransceiverFunc) match_for_mid);
+
+  if (rtp_trans && rtp_trans->mline != -1) {
+    media_idx = rtp_trans->mline;
+  } else {
+    media_idx = _find_media_idx_for_pt (data->stream, data->pt, &ambiguous);
+    GST_WARNING_OBJECT (data->webrtc, "No known MID in %" GST_PTR_FORMAT
+        " (%s), routing by payload type %u%s", pad, GST_STR_NULL (mid),
+        data->pt, ambiguous ? " although several m-lines use it" : "");
+  }
+  g_free (mid);
+
+  GST_DEBUG_OBJECT (data->webrtc, "Routing %" GST_PTR_FORMAT " to m-line %u",
+      pad, media_idx);
+  _connect_rtpbin_recv_pad (data->webrtc, pad, data->stream, media_idx);
+
+  return GST_PAD_PROBE_REMOVE;
+}
+
 /* === rtpbin signal implementations === */
 
 static void
@@ -2784,10 +3288,9 @@ on_rtpbin_pad_added (GstElement * rtpbin, GstPad * new_pad,
   GST_TRACE_OBJECT (webrtc, "new rtpbin pad %s", new_pad_name);
   if (g_str_has_prefix (new_pad_name, "recv_rtp_src_")) {
     guint32 session_id = 0, ssrc = 0, pt = 0;
-    GstWebRTCRTPTransceiver *rtp_trans;
-    WebRTCTransceiver *trans;
+    guint media_idx;
     TransportStream *stream;
-    GstWebRTCBinPad *pad;
+    gboolean ambiguous;
 
     if (sscanf (new_pad_name, "recv_rtp_src_%u_%u_%u", &session_id, &ssrc,
             &pt) != 3) {
@@ -2796,30 +3299,42 @@ on_rtpbin_pad_added (GstElement * rtpbin, GstPad * new_pad,
     }
 
     stream = _find_transport_for_session (webrtc, session_id);
-    if (!stream)
-      g_warn_if_reached ();
-
-    /* FIXME: bundle! */
-    rtp_trans = _find_transceiver_for_mline (webrtc, session_id);
-    if (!rtp_trans)
+    if (!stream) {
       g_warn_if_reached ();
-    trans = WEBRTC_TRANSCEIVER (rtp_trans);
-    g_assert (trans->stream == stream);
-
-    pad = _find_pad_for_transceiver (webrtc, GST_PAD_SRC, rtp_trans);
-
-    GST_TRACE_OBJECT (webrtc, "found pad %" GST_PTR_FORMAT
-        " for rtpbin pad name %s", pad, new_pad_name);
-    if (!pad)
-      g_warn_if_reached ();
-    gst_ghost_pad_set_target (GST_GHOST_PAD (pad), GST_PAD (new_pad));
+      g_free (new_pad_name);
+      return;
+    }
 
-    if (webrtc->priv->running)
-      gst_pad_set_active (GST_PAD (pad), TRUE);
-    gst_element_add_pad (GST_ELEMENT (webrtc), GST_PAD (pad));
-    _remove_pending_pad (webrtc, pad);
+    /* bundled m-lines share the session, find the m-line of this stream
+     * with the SSRCs the peer signalled, or its MID, or as a last resort
+     * with its payload type */
+    if (!_stream_is_bundled (stream)) {
+      media_idx = session_id;
+    } else if (_find_media_idx_for_remote_ssrc (stream, ssrc, &media_idx)) {
+      GST_DEBUG_OBJECT (webrtc, "Routing ssrc %u to m-line %u", ssrc,
+          media_idx);
+    } else if (stream->mid_ext_id != 0) {
+      MidRouteData *data = g_new0 (MidRouteData, 1);
+
+      GST_DEBUG_OBJECT (webrtc, "Waiting for the MID of ssrc %u", ssrc);
+      data->webrtc = webrtc;
+      data->stream = gst_object_ref (stream);
+      data->pt = pt;
+      gst_pad_add_probe (new_pad,
+          GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+          (GstPadProbeCallback) _route_by_mid_probe, data,
+          (GDestroyNotify) mid_route_data_free);
+      g_free (new_pad_name);
+      return;
+    } else {
+      media_idx = _find_media_idx_for_pt (stream, pt, &ambiguous);
+      if (ambiguous)
+        GST_WARNING_OBJECT (webrtc, "Several bundled m-lines use payload type "
+            "%u and ssrc %u was not signalled, routing it to m-line %u", pt,
+            ssrc, media_idx);
+    }
 
-    gst_object_unref (pad);
+    _connect_rtpbin_recv_pad (webrtc, new_pad, stream, media_idx);
   }
   g_free (new_pad_name);
 }
@@ -3047,6 +3562,60 @@ gst_webrtc_bin_release_pad (GstElement * element, GstPad * pad)
   _remove_pad (webrtc, webrtc_pad);
 }
 
+static void
+_create_ice (GstWebRTCBin * webrtc)
+{
+  webrtc->priv->ice = gst_webrtc_ice_new (webrtc->priv->worker_pool_size);
+  g_signal_connect (webrtc->priv->ice, "on-ice-candidate",
+      G_CALLBACK (_on_ice_candidate), webrtc);
+}
+
+static void
+_set_worker_pool_size (GstWebRTCBin * webrtc, guint size)
+{
+  GstWebRTCICE *old_ice;
+  gchar *stun_server, *turn_server;
+
+  PC_LOCK (webrtc);
+  if (size == webrtc->priv->worker_pool_size) {
+    PC_UNLOCK (webrtc);
+    return;
+  }
+  if (webrtc->priv->transports->len > 0 || webrtc->priv->transceivers->len > 0
+      || webrtc->current_local_description
+      || webrtc->pending_local_description
+      || webrtc->current_remote_description
+      || webrtc->pending_remote_description) {
+    PC_UNLOCK (webrtc);
+    GST_WARNING_OBJECT (webrtc, "Can't change the worker pool size after "
+        "negotiation has started");
+    return;
+  }
+  PC_UNLOCK (webrtc);
+
+  GST_DEBUG_OBJECT (webrtc, "switching to %s",
+      size > 0 ? "shared workers" : "dedicated threads");
+
+  _stop_thread (webrtc);
+  webrtc->priv->worker_pool_size = size;
+  _start_thread (webrtc);
+
+  /* the ICE agent has nothing going on yet, recreate it on the new context */
+  old_ice = webrtc->priv->ice;
+  g_object_get (old_ice, "stun-server", &stun_server, "turn-server",
+      &turn_server, NULL);
+  g_signal_handlers_disconnect_by_data (old_ice, webrtc);
+  gst_object_unref (old_ice);
+
+  _create_ice (webrtc);
+  if (stun_server)
+    g_object_set (webrtc->priv->ice, "stun-server", stun_server, NULL);
+  if (turn_server)
+    g_object_set (webrtc->priv->ice, "turn-server", turn_server, NULL);
+  g_free (stun_server);
+  g_free (turn_server);
+}
+
 static void
 gst_webrtc_bin_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -3058,6 +3627,14 @@ gst_webrtc_bin_set_property (GObject * object, guint prop_id,
     case PROP_TURN_SERVER:
       g_object_set_property (G_OBJECT (webrtc->priv->ice), pspec->name, value);
       break;
+    case PROP_BUNDLE_POLICY:
+      PC_LOCK (webrtc);
+      webrtc->priv->bundle_policy = g_value_get_enum (value);
+      PC_UNLOCK (webrtc);
+      break;
+    case PROP_WORKER_POOL_SIZE:
+      _set_worker_pool_size (webrtc, g_value_get_uint (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3116,6 +3693,12 @@ gst_webrtc_bin_get_property (GObject * object, guint prop_id,
     case PROP_TURN_SERVER:
       g_object_get_property (G_OBJECT (webrtc->priv->ice), pspec->name, value);
       break;
+    case PROP_BUNDLE_POLICY:
+      g_value_set_enum (value, webrtc->priv->bundle_policy);
+      break;
+    case PROP_WORKER_POOL_SIZE:
+      g_value_set_uint (value, webrtc->priv->worker_pool_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3244,6 +3827,50 @@ gst_webrtc_bin_class_init (GstWebRTCBinClass * klass)
           "The TURN server of the form turn(s)://username:password@host:port",
           NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstWebRTCBin:bundle-policy:
+   *
+   * How media is bundled onto transports.  With any policy other than
+   * "none", all the m-lines of the connection are offered in a single BUNDLE
+   * group and share one ICE and DTLS transport with rtcp-mux.  Received
+   * packets are demultiplexed by payload type.  "balanced" and "max-compat"
+   * currently behave like "max-bundle".
+   *
+   * Must be set before any pads are requested or any description is set.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_BUNDLE_POLICY,
+      g_param_spec_enum ("bundle-policy", "Bundle Policy",
+          "The policy to apply for bundling",
+          GST_TYPE_WEBRTC_BUNDLE_POLICY,
+          GST_WEBRTC_BUNDLE_POLICY_NONE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstWebRTCBin:worker-pool-size:
+   *
+   * By default, every webrtcbin runs a thread for its peerconnection
+   * operations and one for its ICE agent.  When set to a non-zero value,
+   * both run on a thread of a process wide pool instead which is shared
+   * with all the other webrtcbin's using this mode and grows to at most this
+   * many threads.  This allows running a large number of peers in a single
+   * process.  Signal handlers and promise callbacks are called from the
+   * shared threads and should not block.
+   *
+   * Can only be changed before any pads are requested or any description is
+   * set.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_WORKER_POOL_SIZE,
+      g_param_spec_uint ("worker-pool-size", "Worker pool size",
+          "Maximum number of threads in the process wide pool shared with "
+          "other webrtcbin's (0 = use dedicated threads)", 0, G_MAXUINT, 0,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   g_object_class_install_property (gobject_class,
       PROP_CONNECTION_STATE,
       g_param_spec_enum ("connection-state", "Connection State",
@@ -3520,9 +4147,7 @@ gst_webrtc_bin_init (GstWebRTCBin * webrtc)
   g_array_set_clear_func (webrtc->priv->session_mid_map,
       (GDestroyNotify) clear_session_mid_item);
 
-  webrtc->priv->ice = gst_webrtc_ice_new ();
-  g_signal_connect (webrtc->priv->ice, "on-ice-candidate",
-      G_CALLBACK (_on_ice_candidate), webrtc);
+  _create_ice (webrtc);
   webrtc->priv->ice_stream_map =
       g_array_new (FALSE, TRUE, sizeof (IceStreamItem));
   webrtc->priv->pending_ice_candidates =
@@ -100,7 +100,7 @@ struct _GstWebRTCBinPrivate
 {
   guint max_sink_pad_serial;
 
-  gboolean bundle;
+  GstWebRTCBundlePolicy bundle_policy;
   GArray *transceivers;
   GArray *session_mid_map;
   GArray *transports;
@@ -121,6 +121,11 @@ struct _GstWebRTCBinPrivate
   GMutex pc_lock;
   GCond pc_cond;
 
+  /* when non-zero, the helper thread and the ICE agent run on a worker from
+   * a process wide pool shared with other webrtcbin's instead */
+  guint worker_pool_size;
+  WebRTCWorker *worker;
+
   gboolean running;
   gboolean async_pending;
 
@@ -141,6 +146,7 @@ typedef struct
   GstWebRTCBinFunc op;
   gpointer data;
   GDestroyNotify notify;
+  gboolean owns_ref;        /* holds a reference to webrtc */
 //  GstPromise *promise;      /* FIXME */
 } GstWebRTCBinTask;
 
@@ -26,6 +26,7 @@
 #include <agent.h>
 #include "icestream.h"
 #include "nicetransport.h"
+#include "workerpool.h"
 
 /* XXX:
  *
@@ -63,6 +64,7 @@ enum
   PROP_TURN_SERVER,
   PROP_CONTROLLER,
   PROP_AGENT,
+  PROP_WORKER_POOL_SIZE,
 };
 
 static guint gst_webrtc_ice_signals[LAST_SIGNAL] = { 0 };
@@ -78,6 +80,9 @@ struct _GstWebRTCICEPrivate
   GMainLoop *loop;
   GMutex lock;
   GCond cond;
+
+  guint worker_pool_size;
+  WebRTCWorker *worker;
 };
 
 static gboolean
@@ -114,6 +119,13 @@ _gst_nice_thread (GstWebRTCICE * ice)
 static void
 _start_thread (GstWebRTCICE * ice)
 {
+  if (ice->priv->worker_pool_size > 0) {
+    ice->priv->worker = webrtc_worker_pool_acquire (ice->priv->worker_pool_size);
+    ice->priv->main_context =
+        g_main_context_ref (webrtc_worker_get_context (ice->priv->worker));
+    return;
+  }
+
   g_mutex_lock (&ice->priv->lock);
   ice->priv->thread = g_thread_new ("gst-nice-ops",
       (GThreadFunc) _gst_nice_thread, ice);
@@ -126,6 +138,14 @@ _start_thread (GstWebRTCICE * ice)
 static void
 _stop_thread (GstWebRTCICE * ice)
 {
+  if (ice->priv->worker) {
+    g_main_context_unref (ice->priv->main_context);
+    ice->priv->main_context = NULL;
+    webrtc_worker_release (ice->priv->worker);
+    ice->priv->worker = NULL;
+    return;
+  }
+
   g_mutex_lock (&ice->priv->lock);
   g_main_loop_quit (ice->priv->loop);
   while (ice->priv->loop)
@@ -748,6 +768,9 @@ gst_webrtc_ice_set_property (GObject * object, guint prop_id,
       g_object_set_property (G_OBJECT (ice->priv->nice_agent),
           "controlling-mode", value);
       break;
+    case PROP_WORKER_POOL_SIZE:
+      ice->priv->worker_pool_size = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -780,12 +803,32 @@ gst_webrtc_ice_get_property (GObject * object, guint prop_id,
     case PROP_AGENT:
       g_value_set_object (value, ice->priv->nice_agent);
       break;
+    case PROP_WORKER_POOL_SIZE:
+      g_value_set_uint (value, ice->priv->worker_pool_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static void
+gst_webrtc_ice_constructed (GObject * object)
+{
+  GstWebRTCICE *ice = GST_WEBRTC_ICE (object);
+
+  /* the agent needs to know which context it runs on from the start so this
+   * can only happen once the construct properties are set */
+  _start_thread (ice);
+
+  ice->priv->nice_agent = nice_agent_new (ice->priv->main_context,
+      NICE_COMPATIBILITY_RFC5245);
+  g_signal_connect (ice->priv->nice_agent, "new-candidate-full",
+      G_CALLBACK (_on_new_candidate), ice);
+
+  G_OBJECT_CLASS (parent_class)->constructed (object);
+}
+
 static void
 gst_webrtc_ice_finalize (GObject * object)
 {
@@ -793,6 +836,12 @@ gst_webrtc_ice_finalize (GObject * object)
 
   g_signal_handlers_disconnect_by_data (ice->priv->nice_agent, ice);
 
+  /* the agent's sources must be gone before a shared worker is reused */
+  if (ice->priv->worker) {
+    g_object_unref (ice->priv->nice_agent);
+    ice->priv->nice_agent = NULL;
+  }
+
   _stop_thread (ice);
 
   if (ice->turn_server)
@@ -805,7 +854,8 @@ gst_webrtc_ice_finalize (GObject * object)
 
   g_array_free (ice->priv->nice_stream_map, TRUE);
 
-  g_object_unref (ice->priv->nice_agent);
+  if (ice->priv->nice_agent)
+    g_object_unref (ice->priv->nice_agent);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -819,6 +869,7 @@ gst_webrtc_ice_class_init (GstWebRTCICEClass * klass)
 
   gobject_class->get_property = gst_webrtc_ice_get_property;
   gobject_class->set_property = gst_webrtc_ice_set_property;
+  gobject_class->constructed = gst_webrtc_ice_constructed;
   gobject_class->finalize = gst_webrtc_ice_finalize;
 
   g_object_class_install_property (gobject_class,
@@ -846,6 +897,15 @@ gst_webrtc_ice_class_init (GstWebRTCICEClass * klass)
           "ICE agent in use by this object", NICE_TYPE_AGENT,
           G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class,
+      PROP_WORKER_POOL_SIZE,
+      g_param_spec_uint ("worker-pool-size", "Worker pool size",
+          "Run the ICE agent on a thread shared with other agents from a "
+          "process wide pool of at most this many threads "
+          "(0 = use a dedicated thread)", 0, G_MAXUINT, 0,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+          G_PARAM_STATIC_STRINGS));
+
   /**
    * GstWebRTCICE::on-ice-candidate:
    * @object: the #GstWebRtcBin
@@ -867,13 +927,6 @@ gst_webrtc_ice_init (GstWebRTCICE * ice)
   g_mutex_init (&ice->priv->lock);
   g_cond_init (&ice->priv->cond);
 
-  _start_thread (ice);
-
-  ice->priv->nice_agent = nice_agent_new (ice->priv->main_context,
-      NICE_COMPATIBILITY_RFC5245);
-  g_signal_connect (ice->priv->nice_agent, "new-candidate-full",
-      G_CALLBACK (_on_new_candidate), ice);
-
   ice->priv->nice_stream_map =
       g_array_new (FALSE, TRUE, sizeof (struct NiceStreamItem));
   g_array_set_clear_func (ice->priv->nice_stream_map,
@@ -881,7 +934,8 @@ gst_webrtc_ice_init (GstWebRTCICE * ice)
 }
 
 GstWebRTCICE *
-gst_webrtc_ice_new (void)
+gst_webrtc_ice_new (guint worker_pool_size)
 {
-  return g_object_new (GST_TYPE_WEBRTC_ICE, NULL);
+  return g_object_new (GST_TYPE_WEBRTC_ICE, "worker-pool-size",
+      worker_pool_size, NULL);
 }
@@ -34,9 +34,16 @@ GType transport_stream_get_type(void);
 typedef struct
 {
   guint8 pt;
+  guint media_idx;
   GstCaps *caps;
 } PtMapItem;
 
+typedef struct
+{
+  guint32 ssrc;
+  guint media_idx;
+} SsrcMapItem;
+
 struct _TransportStream
 {
   GstObject                 parent;
@@ -54,6 +61,10 @@ struct _TransportStream
   GstWebRTCDTLSTransport   *rtcp_transport;
 
   GArray                   *ptmap;                  /* array of PtMapItem's */
+  GArray                   *remote_ssrcmap;         /* array of SsrcMapItem's signalled by the peer */
+  guint8                    mid_ext_id;             /* id of the peer's sdes:mid RTP header extension, 0 if none */
+
+  GstElement               *rtpfunnel;              /* combines the bundled sending streams */
 };
 
 struct _TransportStreamClass
@@ -0,0 +1,176 @@
+/* GStreamer
+ * Copyright (C) 2026 GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "workerpool.h"
+
+/*
+ * A process wide pool of threads each running a GMainContext that can be
+ * shared between many webrtcbin (and ICE agent) instances.  Without it, every
+ * webrtcbin runs one thread for its peerconnection operations and another
+ * one for its ICE agent which doesn't scale to hundreds of peers in a single
+ * process.
+ *
+ * Users are spread over the least loaded worker and workers are only
+ * spawned while the pool is smaller than the requested maximum.  Once the
+ * last user of the pool is released, all the workers are stopped.  As that
+ * may happen from a worker's own thread, each worker frees itself when its
+ * loop quits and only the other threads are joined.
+ */
+
+#define GST_CAT_DEFAULT webrtc_worker_pool_debug
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+
+struct _WebRTCWorker
+{
+  GThread *thread;
+  GMainContext *main_context;
+  GMainLoop *loop;
+  guint n_users;
+};
+
+static GMutex pool_lock;
+static GCond pool_cond;
+static GPtrArray *workers;
+static guint n_pool_users;
+
+static gpointer
+_worker_thread (WebRTCWorker * worker)
+{
+  g_mutex_lock (&pool_lock);
+  worker->loop = g_main_loop_new (worker->main_context, FALSE);
+  g_cond_broadcast (&pool_cond);
+  g_mutex_unlock (&pool_lock);
+
+  /* Having the thread be the thread default GMainContext will break the
+   * required queue-like ordering (from W3's peerconnection spec) of re-entrant
+   * tasks */
+  g_main_loop_run (worker->loop);
+
+  GST_INFO ("stopped worker %p", worker);
+
+  g_main_loop_unref (worker->loop);
+  g_main_context_unref (worker->main_context);
+  g_free (worker);
+
+  return NULL;
+}
+
+static WebRTCWorker *
+_worker_new (void)
+{
+  WebRTCWorker *worker = g_new0 (WebRTCWorker, 1);
+  gchar *name;
+
+  name = g_strdup_printf ("gst-webrtc-worker%u", workers->len);
+  worker->main_context = g_main_context_new ();
+  worker->thread = g_thread_new (name, (GThreadFunc) _worker_thread, worker);
+  g_free (name);
+
+  while (!worker->loop)
+    g_cond_wait (&pool_cond, &pool_lock);
+
+  g_ptr_array_add (workers, worker);
+
+  GST_INFO ("started worker %p, %u workers in the pool", worker, workers->len);
+
+  return worker;
+}
+
+/* Returns a worker of the shared pool, spawning a new one if all the existing
+ * workers are used and there are less than @max_workers */
+WebRTCWorker *
+webrtc_worker_pool_acquire (guint max_workers)
+{
+  WebRTCWorker *ret = NULL;
+  guint i;
+
+  g_return_val_if_fail (max_workers > 0, NULL);
+
+  g_mutex_lock (&pool_lock);
+  if (!workers) {
+    if (!webrtc_worker_pool_debug)
+      GST_DEBUG_CATEGORY_INIT (webrtc_worker_pool_debug, "webrtcworkerpool",
+          0, "webrtcbin shared worker pool");
+    workers = g_ptr_array_new ();
+  }
+
+  for (i = 0; i < workers->len; i++) {
+    WebRTCWorker *worker = g_ptr_array_index (workers, i);
+
+    if (!ret || worker->n_users < ret->n_users)
+      ret = worker;
+  }
+
+  if (!ret || (ret->n_users > 0 && workers->len < max_workers))
+    ret = _worker_new ();
+
+  ret->n_users++;
+  n_pool_users++;
+  GST_TRACE ("acquired worker %p with %u users", ret, ret->n_users);
+  g_mutex_unlock (&pool_lock);
+
+  return ret;
+}
+
+GMainContext *
+webrtc_worker_get_context (WebRTCWorker * worker)
+{
+  return worker->main_context;
+}
+
+void
+webrtc_worker_release (WebRTCWorker * worker)
+{
+  GPtrArray *stopping = NULL;
+  guint i;
+
+  g_mutex_lock (&pool_lock);
+  g_assert (worker->n_users > 0);
+  worker->n_users--;
+  GST_TRACE ("released worker %p, %u users left", worker, worker->n_users);
+
+  if (--n_pool_users == 0) {
+    GST_INFO ("last user released, stopping %u workers", workers->len);
+    stopping = workers;
+    workers = NULL;
+  }
+  g_mutex_unlock (&pool_lock);
+
+  if (!stopping)
+    return;
+
+  for (i = 0; i < stopping->len; i++) {
+    WebRTCWorker *w = g_ptr_array_index (stopping, i);
+    GThread *thread = w->thread;
+    GMainLoop *loop = g_main_loop_ref (w->loop);
+
+    /* the worker is freed by its thread once the loop quits */
+    g_main_loop_quit (loop);
+    g_main_loop_unref (loop);
+    if (thread == g_thread_self ())
+      g_thread_unref (thread);
+    else
+      g_thread_join (thread);
+  }
+  g_ptr_array_free (stopping, TRUE);
+}
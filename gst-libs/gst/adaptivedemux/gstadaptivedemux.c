@@ -134,6 +134,8 @@ GST_DEBUG_CATEGORY (adaptivedemux_debug);
 #define DEFAULT_FAILED_COUNT 3
 #define DEFAULT_CONNECTION_SPEED 0
 #define DEFAULT_BITRATE_LIMIT 0.8f
+#define DEFAULT_FAST_START FALSE
+#define DEFAULT_STARTUP_BITRATE 0
 #define SRC_QUEUE_MAX_BYTES 20 * 1024 * 1024    /* For safety. Large enough to hold a segment. */
 #define NUM_LOOKBACK_FRAGMENTS 3
 
@@ -162,6 +164,8 @@ enum
   PROP_0,
   PROP_CONNECTION_SPEED,
   PROP_BITRATE_LIMIT,
+  PROP_FAST_START,
+  PROP_STARTUP_BITRATE,
   PROP_LAST
 };
 
@@ -210,8 +214,36 @@ struct _GstAdaptiveDemuxPrivate
    * without needing to stop tasks when they just want to
    * update the segment boundaries */
   GMutex segment_lock;
+
+  /* fast-start mode */
+  gboolean fast_start;          /* protected by manifest_lock */
+  guint startup_bitrate;        /* protected by manifest_lock */
+  GThreadPool *prefetch_pool;
+  GstClockTime startup_time;    /* protected by manifest_lock */
+  GstClockTime manifest_time;   /* protected by manifest_lock */
 };
 
+/* A download issued ahead of time on the prefetch pool, consumed by
+ * gst_adaptive_demux_stream_download_uri() instead of going through the
+ * stream's source element */
+typedef struct _GstAdaptiveDemuxPrefetch
+{
+  volatile gint ref_count;
+
+  GMutex lock;
+  GCond cond;
+  gboolean done;                /* protected by lock */
+
+  GstUriDownloader *downloader;
+  gchar *uri;
+  gint64 range_start;
+  gint64 range_end;
+
+  GstFragment *download;        /* protected by lock */
+  GstClockTime start_time;
+  GstClockTime stop_time;       /* protected by lock */
+} GstAdaptiveDemuxPrefetch;
+
 typedef struct _GstAdaptiveDemuxTimer
 {
   volatile gint ref_count;
@@ -307,6 +339,10 @@ static gboolean gst_adaptive_demux_clock_callback (GstClock * clock,
 static gboolean
 gst_adaptive_demux_requires_periodical_playlist_update_default (GstAdaptiveDemux
     * demux);
+static void gst_adaptive_demux_prefetch_func (GstAdaptiveDemuxPrefetch *
+    prefetch, GstAdaptiveDemux * demux);
+static void gst_adaptive_demux_stream_clear_prefetches (GstAdaptiveDemuxStream *
+    stream);
 
 /* we can't use G_DEFINE_ABSTRACT_TYPE because we need the klass in the _init
  * method to get to the padtemplates */
@@ -354,6 +390,12 @@ gst_adaptive_demux_set_property (GObject * object, guint prop_id,
     case PROP_BITRATE_LIMIT:
       demux->bitrate_limit = g_value_get_float (value);
       break;
+    case PROP_FAST_START:
+      demux->priv->fast_start = g_value_get_boolean (value);
+      break;
+    case PROP_STARTUP_BITRATE:
+      demux->priv->startup_bitrate = g_value_get_uint (value) * 1000;
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -378,6 +420,12 @@ gst_adaptive_demux_get_property (GObject * object, guint prop_id,
     case PROP_BITRATE_LIMIT:
       g_value_set_float (value, demux->bitrate_limit);
       break;
+    case PROP_FAST_START:
+      g_value_set_boolean (value, demux->priv->fast_start);
+      break;
+    case PROP_STARTUP_BITRATE:
+      g_value_set_uint (value, demux->priv->startup_bitrate / 1000);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -421,6 +469,18 @@ gst_adaptive_demux_class_init (GstAdaptiveDemuxClass * klass)
           0, 1, DEFAULT_BITRATE_LIMIT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_FAST_START,
+      g_param_spec_boolean ("fast-start", "Fast start",
+          "Fetch the header, index and first fragment of new streams "
+          "concurrently, starting at the startup bitrate",
+          DEFAULT_FAST_START, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_STARTUP_BITRATE,
+      g_param_spec_uint ("startup-bitrate", "Startup bitrate",
+          "Bitrate in kbps of the representations to start with in fast-start "
+          "mode (0 = lowest)", 0, G_MAXUINT / 1000, DEFAULT_STARTUP_BITRATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state = gst_adaptive_demux_change_state;
 
   gstbin_class->handle_message = gst_adaptive_demux_handle_message;
@@ -500,6 +560,12 @@ gst_adaptive_demux_init (GstAdaptiveDemux * demux,
   g_cond_init (&demux->priv->preroll_cond);
   g_mutex_init (&demux->priv->preroll_lock);
 
+  demux->priv->prefetch_pool =
+      g_thread_pool_new ((GFunc) gst_adaptive_demux_prefetch_func, demux, -1,
+      FALSE, NULL);
+  demux->priv->startup_time = GST_CLOCK_TIME_NONE;
+  demux->priv->manifest_time = GST_CLOCK_TIME_NONE;
+
   pad_template =
       gst_element_class_get_pad_template (GST_ELEMENT_CLASS (klass), "sink");
   g_return_if_fail (pad_template != NULL);
@@ -513,6 +579,8 @@ gst_adaptive_demux_init (GstAdaptiveDemux * demux,
   /* Properties */
   demux->bitrate_limit = DEFAULT_BITRATE_LIMIT;
   demux->connection_speed = DEFAULT_CONNECTION_SPEED;
+  demux->priv->fast_start = DEFAULT_FAST_START;
+  demux->priv->startup_bitrate = DEFAULT_STARTUP_BITRATE;
 
   gst_element_add_pad (GST_ELEMENT (demux), demux->sinkpad);
 }
@@ -525,6 +593,9 @@ gst_adaptive_demux_finalize (GObject * object)
 
   GST_DEBUG_OBJECT (object, "finalize");
 
+  /* wait for pending prefetches, they use the realtime clock */
+  g_thread_pool_free (priv->prefetch_pool, FALSE, TRUE);
+
   g_object_unref (priv->input_adapter);
   g_object_unref (demux->downloader);
 
@@ -570,6 +641,8 @@ gst_adaptive_demux_change_state (GstElement * element,
       /* Clear "cancelled" flag in uridownloader since subclass might want to
        * use uridownloader to fetch another manifest */
       gst_uri_downloader_reset (demux->downloader);
+      demux->priv->startup_time = gst_adaptive_demux_get_monotonic_time (demux);
+      demux->priv->manifest_time = GST_CLOCK_TIME_NONE;
       if (demux->priv->have_manifest)
         gst_adaptive_demux_start_manifest_update_task (demux);
       demux->running = TRUE;
@@ -678,6 +751,8 @@ gst_adaptive_demux_sink_event (GstPad * pad, GstObject * parent,
         ret = FALSE;
       } else {
         demux->priv->have_manifest = TRUE;
+        demux->priv->manifest_time =
+            gst_adaptive_demux_get_monotonic_time (demux);
       }
       gst_buffer_unref (manifest_buffer);
 
@@ -1310,6 +1385,9 @@ gst_adaptive_demux_stream_new (GstAdaptiveDemux * demux, GstPad * pad)
       g_malloc0 (sizeof (guint64) * NUM_LOOKBACK_FRAGMENTS);
   gst_pad_set_element_private (pad, stream);
   stream->qos_earliest_time = GST_CLOCK_TIME_NONE;
+  stream->fast_start_pending = demux->priv->fast_start;
+  stream->startup_header_time = GST_CLOCK_TIME_NONE;
+  stream->startup_index_time = GST_CLOCK_TIME_NONE;
 
   g_mutex_lock (&demux->priv->preroll_lock);
   stream->do_block = TRUE;
@@ -1373,6 +1451,7 @@ gst_adaptive_demux_stream_free (GstAdaptiveDemuxStream * stream)
       g_cond_signal (&stream->fragment_download_cond);
       g_mutex_unlock (&stream->fragment_download_lock);
     }
+    gst_adaptive_demux_stream_clear_prefetches (stream);
     GST_LOG_OBJECT (demux, "Waiting for task to finish");
 
     /* temporarily drop the manifest lock to join the task */
@@ -1389,6 +1468,7 @@ gst_adaptive_demux_stream_free (GstAdaptiveDemuxStream * stream)
   }
 
   gst_adaptive_demux_stream_fragment_clear (&stream->fragment);
+  gst_adaptive_demux_stream_clear_prefetches (stream);
 
   if (stream->pending_segment) {
     gst_event_unref (stream->pending_segment);
@@ -2090,6 +2170,8 @@ gst_adaptive_demux_stop_tasks (GstAdaptiveDemux * demux, gboolean stop_updates)
       gst_task_stop (stream->download_task);
       g_cond_signal (&stream->fragment_download_cond);
       g_mutex_unlock (&stream->fragment_download_lock);
+
+      gst_adaptive_demux_stream_clear_prefetches (stream);
     }
     list_to_process = demux->prepared_streams;
   }
@@ -3108,6 +3190,283 @@ uritype (GstAdaptiveDemuxStream * s)
 }
 #endif
 
+static GstAdaptiveDemuxPrefetch *
+gst_adaptive_demux_prefetch_ref (GstAdaptiveDemuxPrefetch * prefetch)
+{
+  g_atomic_int_inc (&prefetch->ref_count);
+  return prefetch;
+}
+
+static void
+gst_adaptive_demux_prefetch_unref (GstAdaptiveDemuxPrefetch * prefetch)
+{
+  if (g_atomic_int_dec_and_test (&prefetch->ref_count)) {
+    if (prefetch->download)
+      g_object_unref (prefetch->download);
+    gst_object_unref (prefetch->downloader);
+    g_free (prefetch->uri);
+    g_mutex_clear (&prefetch->lock);
+    g_cond_clear (&prefetch->cond);
+    g_slice_free (GstAdaptiveDemuxPrefetch, prefetch);
+  }
+}
+
+/* runs on the prefetch pool */
+static void
+gst_adaptive_demux_prefetch_func (GstAdaptiveDemuxPrefetch * prefetch,
+    GstAdaptiveDemux * demux)
+{
+  GstFragment *download;
+  gint64 range_end = prefetch->range_end;
+
+  /* HTTP ranges are inclusive, the downloader's stop position is not */
+  if (range_end != -1)
+    range_end += 1;
+
+  download = gst_uri_downloader_fetch_uri_with_range (prefetch->downloader,
+      prefetch->uri, NULL, FALSE, FALSE, TRUE, prefetch->range_start,
+      range_end, NULL);
+
+  g_mutex_lock (&prefetch->lock);
+  prefetch->download = download;
+  prefetch->stop_time = gst_adaptive_demux_get_monotonic_time (demux);
+  prefetch->done = TRUE;
+  g_cond_signal (&prefetch->cond);
+  g_mutex_unlock (&prefetch->lock);
+
+  gst_adaptive_demux_prefetch_unref (prefetch);
+}
+
+/* must be called with manifest_lock taken */
+static void
+gst_adaptive_demux_stream_prefetch_uri (GstAdaptiveDemux * demux,
+    GstAdaptiveDemuxStream * stream, const gchar * uri, gint64 start,
+    gint64 end)
+{
+  GstAdaptiveDemuxPrefetch *prefetch;
+
+  if (uri == NULL)
+    return;
+
+  GST_DEBUG_OBJECT (stream->pad,
+      "Prefetching uri: %s, range:%" G_GINT64_FORMAT " - %" G_GINT64_FORMAT,
+      uri, start, end);
+
+  prefetch = g_slice_new0 (GstAdaptiveDemuxPrefetch);
+  prefetch->ref_count = 1;
+  g_mutex_init (&prefetch->lock);
+  g_cond_init (&prefetch->cond);
+  prefetch->downloader = gst_uri_downloader_new ();
+  gst_uri_downloader_set_parent (prefetch->downloader,
+      GST_ELEMENT_CAST (demux));
+  prefetch->uri = g_strdup (uri);
+  prefetch->range_start = start;
+  prefetch->range_end = end;
+  prefetch->start_time = gst_adaptive_demux_get_monotonic_time (demux);
+
+  g_mutex_lock (&stream->fragment_download_lock);
+  stream->prefetches = g_list_append (stream->prefetches, prefetch);
+  g_mutex_unlock (&stream->fragment_download_lock);
+
+  g_thread_pool_push (demux->priv->prefetch_pool,
+      gst_adaptive_demux_prefetch_ref (prefetch), NULL);
+}
+
+/* must be called with manifest_lock taken */
+static void
+gst_adaptive_demux_stream_start_prefetches (GstAdaptiveDemux * demux,
+    GstAdaptiveDemuxStream * stream)
+{
+  stream->fast_start_prefetched = TRUE;
+
+  if (stream->need_header) {
+    gst_adaptive_demux_stream_prefetch_uri (demux, stream,
+        stream->fragment.header_uri, stream->fragment.header_range_start,
+        stream->fragment.header_range_end);
+    gst_adaptive_demux_stream_prefetch_uri (demux, stream,
+        stream->fragment.index_uri, stream->fragment.index_range_start,
+        stream->fragment.index_range_end);
+  }
+
+  /* With an index the subclass might only know the actual fragment range
+   * after parsing it, and trick modes might download it in chunks */
+  if (stream->fragment.index_uri == NULL && demux->segment.rate == 1.0
+      && !GST_ADAPTIVE_DEMUX_IN_TRICKMODE_KEY_UNITS (demux)) {
+    gst_adaptive_demux_stream_prefetch_uri (demux, stream,
+        stream->fragment.uri, stream->fragment.range_start,
+        stream->fragment.range_end);
+  }
+}
+
+static void
+gst_adaptive_demux_stream_clear_prefetches (GstAdaptiveDemuxStream * stream)
+{
+  GList *prefetches, *iter;
+
+  g_mutex_lock (&stream->fragment_download_lock);
+  prefetches = stream->prefetches;
+  stream->prefetches = NULL;
+  g_mutex_unlock (&stream->fragment_download_lock);
+
+  for (iter = prefetches; iter; iter = g_list_next (iter)) {
+    GstAdaptiveDemuxPrefetch *prefetch = iter->data;
+
+    gst_uri_downloader_cancel (prefetch->downloader);
+  }
+  g_list_free_full (prefetches,
+      (GDestroyNotify) gst_adaptive_demux_prefetch_unref);
+}
+
+/* must be called with manifest_lock taken */
+static GstAdaptiveDemuxPrefetch *
+gst_adaptive_demux_stream_find_prefetch (GstAdaptiveDemuxStream * stream,
+    const gchar * uri, gint64 start, gint64 end)
+{
+  GstAdaptiveDemuxPrefetch *prefetch = NULL;
+  GList *iter;
+
+  g_mutex_lock (&stream->fragment_download_lock);
+  for (iter = stream->prefetches; iter; iter = g_list_next (iter)) {
+    GstAdaptiveDemuxPrefetch *p = iter->data;
+
+    if (p->range_start == start && p->range_end == end
+        && g_strcmp0 (p->uri, uri) == 0) {
+      prefetch = gst_adaptive_demux_prefetch_ref (p);
+      break;
+    }
+  }
+  g_mutex_unlock (&stream->fragment_download_lock);
+
+  return prefetch;
+}
+
+/* must be called with manifest_lock taken.
+ * Can temporarily release manifest_lock
+ *
+ * Waits for a prefetched URI and feeds it to the stream as if it had been
+ * downloaded by the source element. Returns GST_FLOW_CUSTOM_ERROR if the
+ * prefetch failed and the URI has to be downloaded again.
+ */
+static GstFlowReturn
+gst_adaptive_demux_stream_download_prefetch (GstAdaptiveDemux * demux,
+    GstAdaptiveDemuxStream * stream, GstAdaptiveDemuxPrefetch * prefetch)
+{
+  GstFragment *download;
+  GstBuffer *buffer = NULL;
+  GstClockTime stop_time;
+  GstFlowReturn ret;
+  GList *link;
+  gsize size;
+
+  /* cancelling the stream clears the pending prefetches and cancels their
+   * downloads, which wakes us up */
+  GST_MANIFEST_UNLOCK (demux);
+  g_mutex_lock (&prefetch->lock);
+  while (!prefetch->done)
+    g_cond_wait (&prefetch->cond, &prefetch->lock);
+  download = prefetch->download ? g_object_ref (prefetch->download) : NULL;
+  stop_time = prefetch->stop_time;
+  g_mutex_unlock (&prefetch->lock);
+  GST_MANIFEST_LOCK (demux);
+
+  if (download) {
+    buffer = gst_fragment_get_buffer (download);
+    g_object_unref (download);
+  }
+
+  g_mutex_lock (&stream->fragment_download_lock);
+  link = g_list_find (stream->prefetches, prefetch);
+  if (link) {
+    stream->prefetches = g_list_delete_link (stream->prefetches, link);
+    gst_adaptive_demux_prefetch_unref (prefetch);
+  }
+  if (G_UNLIKELY (stream->cancelled)) {
+    g_mutex_unlock (&stream->fragment_download_lock);
+    gst_buffer_replace (&buffer, NULL);
+    return stream->last_ret = GST_FLOW_FLUSHING;
+  }
+  stream->download_finished = FALSE;
+  stream->downloading_first_buffer = TRUE;
+  g_mutex_unlock (&stream->fragment_download_lock);
+
+  if (buffer == NULL) {
+    GST_DEBUG_OBJECT (stream->pad, "Prefetching %s failed: %s",
+        uritype (stream), prefetch->uri);
+    return GST_FLOW_CUSTOM_ERROR;
+  }
+
+  GST_DEBUG_OBJECT (stream->pad, "Using prefetched %s: %s", uritype (stream),
+      prefetch->uri);
+
+  /* account the download as if it went through the source element */
+  size = gst_buffer_get_size (buffer);
+  stream->download_start_time = GST_TIME_AS_USECONDS (prefetch->start_time);
+  stream->fragment_bytes_downloaded = size;
+  stream->last_download_time = MAX (stop_time - prefetch->start_time, 1);
+  stream->last_bitrate = gst_util_uint64_scale (size, 8 * GST_SECOND,
+      stream->last_download_time);
+
+  /* _src_chain() would query the size from the source element otherwise */
+  if (!stream->downloading_header && !stream->downloading_index
+      && stream->fragment.bitrate == 0 && stream->fragment.duration != 0) {
+    stream->fragment.bitrate = MIN (G_MAXUINT, gst_util_uint64_scale (size,
+            8 * GST_SECOND, stream->fragment.duration));
+  }
+
+  GST_MANIFEST_UNLOCK (demux);
+  ret = _src_chain (stream->internal_pad, GST_OBJECT_CAST (demux), buffer);
+  GST_MANIFEST_LOCK (demux);
+
+  /* on errors or EOS _src_chain() already finished the download */
+  if (ret == GST_FLOW_OK)
+    gst_adaptive_demux_eos_handling (stream);
+
+  g_mutex_lock (&stream->fragment_download_lock);
+  if (G_UNLIKELY (stream->cancelled))
+    stream->last_ret = GST_FLOW_FLUSHING;
+  g_mutex_unlock (&stream->fragment_download_lock);
+
+  return stream->last_ret;
+}
+
+/* must be called with manifest_lock taken */
+static void
+gst_adaptive_demux_stream_finish_fast_start (GstAdaptiveDemux * demux,
+    GstAdaptiveDemuxStream * stream)
+{
+  GstClockTime now = gst_adaptive_demux_get_monotonic_time (demux);
+  GstClockTime manifest_time = GST_CLOCK_TIME_NONE;
+  GstClockTime first_fragment_time = GST_CLOCK_TIME_NONE;
+
+  stream->fast_start_pending = FALSE;
+
+  /* anything not consumed by now is of no use anymore */
+  gst_adaptive_demux_stream_clear_prefetches (stream);
+
+  if (GST_CLOCK_TIME_IS_VALID (demux->priv->startup_time)) {
+    first_fragment_time = now - demux->priv->startup_time;
+    if (GST_CLOCK_TIME_IS_VALID (demux->priv->manifest_time))
+      manifest_time = demux->priv->manifest_time - demux->priv->startup_time;
+  }
+
+  GST_INFO_OBJECT (stream->pad, "First fragment after %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (first_fragment_time));
+
+  gst_element_post_message (GST_ELEMENT_CAST (demux),
+      gst_message_new_element (GST_OBJECT_CAST (demux),
+          gst_structure_new (GST_ADAPTIVE_DEMUX_STARTUP_MESSAGE_NAME,
+              "stream", G_TYPE_STRING, GST_PAD_NAME (stream->pad),
+              "manifest-time", GST_TYPE_CLOCK_TIME, manifest_time,
+              "header-download-time", GST_TYPE_CLOCK_TIME,
+              stream->startup_header_time,
+              "index-download-time", GST_TYPE_CLOCK_TIME,
+              stream->startup_index_time,
+              "fragment-download-time", GST_TYPE_CLOCK_TIME,
+              stream->last_download_time,
+              "first-fragment-time", GST_TYPE_CLOCK_TIME, first_fragment_time,
+              "bitrate", G_TYPE_UINT, stream->fragment.bitrate, NULL)));
+}
+
 /* must be called with manifest_lock taken.
  * Can temporarily release manifest_lock
  *
@@ -3119,6 +3478,8 @@ gst_adaptive_demux_stream_download_uri (GstAdaptiveDemux * demux,
     gint64 end, guint * http_status)
 {
   GstFlowReturn ret = GST_FLOW_OK;
+  GstAdaptiveDemuxPrefetch *prefetch;
+
   GST_DEBUG_OBJECT (stream->pad,
       "Downloading %s uri: %s, range:%" G_GINT64_FORMAT " - %" G_GINT64_FORMAT,
       uritype (stream), uri, start, end);
@@ -3126,6 +3487,15 @@ gst_adaptive_demux_stream_download_uri (GstAdaptiveDemux * demux,
   if (http_status)
     *http_status = 200;         /* default to ok if no further information */
 
+  prefetch = gst_adaptive_demux_stream_find_prefetch (stream, uri, start, end);
+  if (prefetch) {
+    ret = gst_adaptive_demux_stream_download_prefetch (demux, stream, prefetch);
+    gst_adaptive_demux_prefetch_unref (prefetch);
+    if (ret != GST_FLOW_CUSTOM_ERROR)
+      return ret;
+    ret = GST_FLOW_OK;
+  }
+
   if (!gst_adaptive_demux_stream_update_source (stream, uri, NULL, FALSE, TRUE)) {
     ret = stream->last_ret = GST_FLOW_ERROR;
     return ret;
@@ -3280,17 +3650,22 @@ gst_adaptive_demux_stream_download_header_fragment (GstAdaptiveDemuxStream *
 {
   GstAdaptiveDemux *demux = stream->demux;
   GstFlowReturn ret = GST_FLOW_OK;
+  GstClockTime start;
 
   if (stream->fragment.header_uri != NULL) {
     GST_DEBUG_OBJECT (demux, "Fetching header %s %" G_GINT64_FORMAT "-%"
         G_GINT64_FORMAT, stream->fragment.header_uri,
         stream->fragment.header_range_start, stream->fragment.header_range_end);
 
+    start = gst_adaptive_demux_get_monotonic_time (demux);
     stream->downloading_header = TRUE;
     ret = gst_adaptive_demux_stream_download_uri (demux, stream,
         stream->fragment.header_uri, stream->fragment.header_range_start,
         stream->fragment.header_range_end, NULL);
     stream->downloading_header = FALSE;
+    if (stream->fast_start_pending)
+      stream->startup_header_time =
+          gst_adaptive_demux_get_monotonic_time (demux) - start;
   }
 
   /* check if we have an index */
@@ -3301,11 +3676,15 @@ gst_adaptive_demux_stream_download_header_fragment (GstAdaptiveDemuxStream *
           "Fetching index %s %" G_GINT64_FORMAT "-%" G_GINT64_FORMAT,
           stream->fragment.index_uri,
           stream->fragment.index_range_start, stream->fragment.index_range_end);
+      start = gst_adaptive_demux_get_monotonic_time (demux);
       stream->downloading_index = TRUE;
       ret = gst_adaptive_demux_stream_download_uri (demux, stream,
           stream->fragment.index_uri, stream->fragment.index_range_start,
           stream->fragment.index_range_end, NULL);
       stream->downloading_index = FALSE;
+      if (stream->fast_start_pending)
+        stream->startup_index_time =
+            gst_adaptive_demux_get_monotonic_time (demux) - start;
     }
   }
 
@@ -3341,6 +3720,9 @@ gst_adaptive_demux_stream_download_fragment (GstAdaptiveDemuxStream * stream)
       stream->fragment.index_uri == NULL)
     goto no_url_error;
 
+  if (G_UNLIKELY (stream->fast_start_pending && !stream->fast_start_prefetched))
+    gst_adaptive_demux_stream_start_prefetches (demux, stream);
+
   if (stream->need_header) {
     ret = gst_adaptive_demux_stream_download_header_fragment (stream);
     if (ret != GST_FLOW_OK) {
@@ -3545,6 +3927,8 @@ again:
   }
 
 beach:
+  if (G_UNLIKELY (stream->fast_start_pending) && ret == GST_FLOW_OK)
+    gst_adaptive_demux_stream_finish_fast_start (demux, stream);
   return ret;
 
 no_url_error:
@@ -4452,6 +4836,34 @@ gst_adaptive_demux_get_monotonic_time (GstAdaptiveDemux * demux)
   return gst_clock_get_time (demux->realtime_clock);
 }
 
+/**
+ * gst_adaptive_demux_get_startup_bitrate:
+ * @demux: #GstAdaptiveDemux
+ * @bitrate: (out): the bitrate to start with in bps, 0 for the lowest
+ *
+ * Subclasses should call this when selecting the initial representations of
+ * new streams.
+ *
+ * Returns: %TRUE if fast-start mode is enabled and the initial
+ * representations should be selected according to @bitrate
+ */
+gboolean
+gst_adaptive_demux_get_startup_bitrate (GstAdaptiveDemux * demux,
+    guint * bitrate)
+{
+  gboolean ret;
+
+  g_return_val_if_fail (demux != NULL, FALSE);
+  g_return_val_if_fail (bitrate != NULL, FALSE);
+
+  GST_MANIFEST_LOCK (demux);
+  ret = demux->priv->fast_start;
+  *bitrate = demux->priv->startup_bitrate;
+  GST_MANIFEST_UNLOCK (demux);
+
+  return ret;
+}
+
 /**
  * gst_adaptive_demux_get_client_now_utc:
  * @demux: #GstAdaptiveDemux
@@ -75,6 +75,15 @@ G_BEGIN_DECLS
  */
 #define GST_ADAPTIVE_DEMUX_STATISTICS_MESSAGE_NAME "adaptive-streaming-statistics"
 
+/**
+ * GST_ADAPTIVE_DEMUX_STARTUP_MESSAGE_NAME:
+ *
+ * Name of the ELEMENT type messages posted in fast-start mode once the
+ * first fragment of a stream was downloaded, with the time-to-first-fragment
+ * breakdown.
+ */
+#define GST_ADAPTIVE_DEMUX_STARTUP_MESSAGE_NAME "adaptive-streaming-startup"
+
 #define GST_ELEMENT_ERROR_FROM_ERROR(el, msg, err) G_STMT_START { \
   gchar *__dbg = g_strdup_printf ("%s: %s", msg, err->message);         \
   GST_WARNING_OBJECT (el, "error: %s", __dbg);                          \
@@ -195,6 +204,13 @@ struct _GstAdaptiveDemuxStream
   gboolean eos;
 
   gboolean do_block; /* TRUE if stream should block on preroll */
+
+  /* fast-start: header, index and first fragment are fetched concurrently */
+  gboolean fast_start_pending;
+  gboolean fast_start_prefetched;
+  GList *prefetches; /* protected by fragment_download_lock */
+  GstClockTime startup_header_time;
+  GstClockTime startup_index_time;
 };
 
 /**
@@ -529,6 +545,10 @@ GstClockTime gst_adaptive_demux_get_monotonic_time (GstAdaptiveDemux * demux);
 GST_ADAPTIVE_DEMUX_API
 GDateTime *gst_adaptive_demux_get_client_now_utc (GstAdaptiveDemux * demux);
 
+GST_ADAPTIVE_DEMUX_API
+gboolean gst_adaptive_demux_get_startup_bitrate (GstAdaptiveDemux * demux,
+    guint * bitrate);
+
 G_END_DECLS
 
 #endif
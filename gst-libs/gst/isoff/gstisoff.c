@@ -970,3 +970,390 @@ done:
   gst_buffer_unmap (buffer, &info);
   return res;
 }
+
+static void
+gst_isoff_sample_table_clear (GstIsoffSampleTable * table)
+{
+  g_array_free (table->offsets, TRUE);
+  g_array_free (table->sizes, TRUE);
+  g_array_free (table->durations, TRUE);
+  g_array_free (table->flags, TRUE);
+  g_array_free (table->composition_offsets, TRUE);
+}
+
+void
+gst_isoff_moof_parser_init (GstMoofParser * parser)
+{
+  memset (parser, 0, sizeof (*parser));
+  parser->status = GST_ISOFF_MOOF_PARSER_INIT;
+}
+
+void
+gst_isoff_moof_parser_clear (GstMoofParser * parser)
+{
+  if (parser->tables)
+    g_array_free (parser->tables, TRUE);
+
+  gst_isoff_moof_parser_init (parser);
+}
+
+static GstIsoffSampleTable *
+gst_isoff_moof_parser_add_table (GstMoofParser * parser)
+{
+  GstIsoffSampleTable table = { 0, };
+  GstTfhdBox *tfhd = &parser->tfhd;
+
+  /* Without an explicit base the data of the first traf starts at the
+   * moof, and that of every following one where the previous ended, so
+   * its offsets are absolute if those of the previous one were */
+  if (tfhd->flags & GST_TFHD_FLAGS_BASE_DATA_OFFSET_PRESENT) {
+    parser->base_offset = tfhd->base_data_offset;
+    table.absolute_offsets = TRUE;
+  } else if ((tfhd->flags & GST_TFHD_FLAGS_DEFAULT_BASE_IS_MOOF) ||
+      parser->tables->len == 0) {
+    parser->base_offset = 0;
+    table.absolute_offsets = FALSE;
+  } else {
+    parser->base_offset = parser->data_offset;
+    table.absolute_offsets = g_array_index (parser->tables,
+        GstIsoffSampleTable, parser->tables->len - 1).absolute_offsets;
+  }
+  parser->data_offset = parser->base_offset;
+
+  table.track_id = tfhd->track_id;
+  table.decode_time = G_MAXUINT64;
+  table.offsets = g_array_new (FALSE, FALSE, sizeof (guint64));
+  table.sizes = g_array_new (FALSE, FALSE, sizeof (guint32));
+  table.durations = g_array_new (FALSE, FALSE, sizeof (guint32));
+  table.flags = g_array_new (FALSE, FALSE, sizeof (guint32));
+  table.composition_offsets = g_array_new (FALSE, FALSE, sizeof (gint32));
+  g_array_append_val (parser->tables, table);
+
+  return &g_array_index (parser->tables, GstIsoffSampleTable,
+      parser->tables->len - 1);
+}
+
+static guint
+gst_isoff_trun_sample_entry_size (GstTrunFlags flags)
+{
+  guint size = 0;
+
+  if (flags & GST_TRUN_FLAGS_SAMPLE_DURATION_PRESENT)
+    size += 4;
+  if (flags & GST_TRUN_FLAGS_SAMPLE_SIZE_PRESENT)
+    size += 4;
+  if (flags & GST_TRUN_FLAGS_SAMPLE_FLAGS_PRESENT)
+    size += 4;
+  if (flags & GST_TRUN_FLAGS_SAMPLE_COMPOSITION_TIME_OFFSETS_PRESENT)
+    size += 4;
+
+  return size;
+}
+
+/* Reads one trun sample entry, filling in the tfhd defaults for the fields
+ * the trun does not carry */
+static void
+gst_isoff_moof_parser_add_sample (GstMoofParser * parser,
+    GstIsoffSampleTable * table, GstByteReader * reader)
+{
+  GstTfhdBox *tfhd = &parser->tfhd;
+  GstTrunBox *trun = &parser->trun;
+  guint32 duration = 0;
+  guint32 size = 0;
+  guint32 flags = GST_ISOFF_SAMPLE_FLAGS_FROM_TREX;
+  gint32 composition_offset = 0;
+
+  if (trun->flags & GST_TRUN_FLAGS_SAMPLE_DURATION_PRESENT)
+    duration = gst_byte_reader_get_uint32_be_unchecked (reader);
+  else if (tfhd->flags & GST_TFHD_FLAGS_DEFAULT_SAMPLE_DURATION_PRESENT)
+    duration = tfhd->default_sample_duration;
+  else
+    table->trex_durations = TRUE;
+
+  if (trun->flags & GST_TRUN_FLAGS_SAMPLE_SIZE_PRESENT)
+    size = gst_byte_reader_get_uint32_be_unchecked (reader);
+  else if (tfhd->flags & GST_TFHD_FLAGS_DEFAULT_SAMPLE_SIZE_PRESENT)
+    size = tfhd->default_sample_size;
+  else
+    table->trex_sizes = TRUE;
+
+  if (trun->flags & GST_TRUN_FLAGS_SAMPLE_FLAGS_PRESENT)
+    flags = gst_byte_reader_get_uint32_be_unchecked (reader);
+  else if (tfhd->flags & GST_TFHD_FLAGS_DEFAULT_SAMPLE_FLAGS_PRESENT)
+    flags = tfhd->default_sample_flags;
+
+  if ((trun->flags & GST_TRUN_FLAGS_FIRST_SAMPLE_FLAGS_PRESENT) &&
+      parser->samples_left == trun->sample_count)
+    flags = trun->first_sample_flags;
+
+  if (trun->flags & GST_TRUN_FLAGS_SAMPLE_COMPOSITION_TIME_OFFSETS_PRESENT)
+    composition_offset = gst_byte_reader_get_int32_be_unchecked (reader);
+
+  g_array_append_val (table->offsets, parser->data_offset);
+  g_array_append_val (table->sizes, size);
+  g_array_append_val (table->durations, duration);
+  g_array_append_val (table->flags, flags);
+  g_array_append_val (table->composition_offsets, composition_offset);
+
+  parser->data_offset += size;
+  parser->samples_left--;
+}
+
+/* Parses the trun header, leaving the reader at the first sample entry.
+ * Returns FALSE if more data is needed. */
+static gboolean
+gst_isoff_moof_parser_parse_trun_header (GstMoofParser * parser,
+    GstByteReader * reader)
+{
+  GstTrunBox *trun = &parser->trun;
+
+  memset (trun, 0, sizeof (*trun));
+
+  if (gst_byte_reader_get_remaining (reader) < 8)
+    return FALSE;
+
+  trun->version = gst_byte_reader_get_uint8_unchecked (reader);
+  trun->flags = gst_byte_reader_get_uint24_be_unchecked (reader);
+  trun->sample_count = gst_byte_reader_get_uint32_be_unchecked (reader);
+
+  if ((trun->flags & GST_TRUN_FLAGS_DATA_OFFSET_PRESENT) &&
+      !gst_byte_reader_get_int32_be (reader, &trun->data_offset))
+    return FALSE;
+
+  if ((trun->flags & GST_TRUN_FLAGS_FIRST_SAMPLE_FLAGS_PRESENT) &&
+      !gst_byte_reader_get_uint32_be (reader, &trun->first_sample_flags))
+    return FALSE;
+
+  return TRUE;
+}
+
+/* gst_isoff_moof_parser_parse:
+ *
+ * Incrementally parses a moof box, starting with its box header. Sample
+ * entries are appended to the per-traf tables in @parser->tables as soon as
+ * they are available, so callers can start handling samples of the first
+ * track runs while the rest of the moof is still being received. Boxes that
+ * are not needed for the sample tables are skipped without being buffered.
+ *
+ * Each chunk of a CMAF fragment carries its own moof, so once a moof is
+ * DONE the parser has to be cleared before feeding it the next one.
+ *
+ * Returns: %GST_ISOFF_PARSER_DONE once the complete moof was parsed and
+ * %GST_ISOFF_PARSER_OK if more data is needed. @consumed is set to the
+ * position the reader was advanced to; the remaining data has to be passed
+ * again together with the following data.
+ */
+GstIsoffParserResult
+gst_isoff_moof_parser_parse (GstMoofParser * parser,
+    GstByteReader * reader, guint * consumed)
+{
+  GstIsoffParserResult res = GST_ISOFF_PARSER_OK;
+  GstIsoffSampleTable *table = NULL;
+  GstByteReader sub_reader;
+  guint box_start = 0;
+  guint32 fourcc;
+  guint header_size;
+  guint64 size, end, content;
+
+  INITIALIZE_DEBUG_CATEGORY;
+
+  if (parser->tables == NULL) {
+    parser->tables = g_array_new (FALSE, FALSE, sizeof (GstIsoffSampleTable));
+    g_array_set_clear_func (parser->tables,
+        (GDestroyNotify) gst_isoff_sample_table_clear);
+  }
+  if (parser->had_tfhd)
+    table = &g_array_index (parser->tables, GstIsoffSampleTable,
+        parser->tables->len - 1);
+
+  while (res == GST_ISOFF_PARSER_OK) {
+    box_start = gst_byte_reader_get_pos (reader);
+
+    switch (parser->status) {
+      case GST_ISOFF_MOOF_PARSER_INIT:
+        if (!gst_isoff_parse_box_header (reader, &fourcc, NULL, &header_size,
+                &parser->size))
+          goto done;
+
+        if (fourcc != GST_ISOFF_FOURCC_MOOF) {
+          gst_byte_reader_set_pos (reader, box_start);
+          res = GST_ISOFF_PARSER_UNEXPECTED;
+          goto done;
+        }
+
+        if (parser->size < header_size)
+          goto error;
+
+        parser->offset = header_size;
+        parser->status = GST_ISOFF_MOOF_PARSER_BOXES;
+        break;
+
+      case GST_ISOFF_MOOF_PARSER_BOXES:
+        if (parser->traf_end && parser->offset == parser->traf_end) {
+          if (!parser->had_tfhd) {
+            GST_WARNING ("traf without tfhd");
+            goto error;
+          }
+          GST_LOG ("traf of track %u with %u samples", table->track_id,
+              table->sizes->len);
+          parser->traf_end = 0;
+          parser->had_tfhd = FALSE;
+          table = NULL;
+        }
+
+        if (parser->offset == parser->size) {
+          parser->status = GST_ISOFF_MOOF_PARSER_FINISHED;
+          break;
+        }
+
+        if (!gst_isoff_parse_box_header (reader, &fourcc, NULL, &header_size,
+                &size))
+          goto done;
+
+        end = parser->offset + size;
+        if (size < header_size ||
+            end > (parser->traf_end ? parser->traf_end : parser->size)) {
+          GST_WARNING ("box %" GST_FOURCC_FORMAT " of size %" G_GUINT64_FORMAT
+              " does not fit into its parent", GST_FOURCC_ARGS (fourcc), size);
+          goto error;
+        }
+        content = size - header_size;
+
+        /* Everything but the boxes needed for the sample tables is skipped,
+         * those are small except for the trun samples which are read one
+         * by one */
+        if (!parser->traf_end && fourcc == GST_ISOFF_FOURCC_TRAF) {
+          parser->traf_end = end;
+          parser->offset += header_size;
+        } else if (fourcc == GST_ISOFF_FOURCC_TRUN && parser->had_tfhd) {
+          if (!gst_isoff_moof_parser_parse_trun_header (parser, reader)) {
+            gst_byte_reader_set_pos (reader, box_start);
+            goto done;
+          }
+          parser->offset += gst_byte_reader_get_pos (reader) - box_start;
+          parser->box_end = end;
+
+          if (parser->trun.version != 0 && parser->trun.version != 1) {
+            GST_WARNING ("unsupported trun version %u", parser->trun.version);
+            goto error;
+          }
+
+          if (parser->offset > end || (guint64) parser->trun.sample_count *
+              gst_isoff_trun_sample_entry_size (parser->trun.flags) >
+              end - parser->offset) {
+            GST_WARNING ("trun with %u samples exceeds box size",
+                parser->trun.sample_count);
+            goto error;
+          }
+
+          if (parser->trun.flags & GST_TRUN_FLAGS_DATA_OFFSET_PRESENT)
+            parser->data_offset =
+                parser->base_offset + parser->trun.data_offset;
+          parser->samples_left = parser->trun.sample_count;
+          parser->status = GST_ISOFF_MOOF_PARSER_SAMPLES;
+        } else if ((!parser->traf_end && fourcc == GST_ISOFF_FOURCC_MFHD) ||
+            (parser->traf_end && (fourcc == GST_ISOFF_FOURCC_TFHD ||
+                    fourcc == GST_ISOFF_FOURCC_TFDT))) {
+          if (gst_byte_reader_get_remaining (reader) < content) {
+            gst_byte_reader_set_pos (reader, box_start);
+            goto done;
+          }
+          gst_byte_reader_get_sub_reader (reader, &sub_reader, content);
+          parser->offset = end;
+
+          if (fourcc == GST_ISOFF_FOURCC_MFHD) {
+            GstMfhdBox mfhd;
+
+            if (!gst_isoff_mfhd_box_parse (&mfhd, &sub_reader))
+              goto error;
+            parser->sequence_number = mfhd.sequence_number;
+          } else if (fourcc == GST_ISOFF_FOURCC_TFHD) {
+            if (parser->had_tfhd ||
+                !gst_isoff_tfhd_box_parse (&parser->tfhd, &sub_reader))
+              goto error;
+            parser->had_tfhd = TRUE;
+            table = gst_isoff_moof_parser_add_table (parser);
+          } else {
+            GstTfdtBox tfdt;
+
+            if (!parser->had_tfhd ||
+                !gst_isoff_tfdt_box_parse (&tfdt, &sub_reader))
+              goto error;
+            table->decode_time = tfdt.decode_time;
+          }
+        } else {
+          parser->offset += header_size;
+          parser->box_end = end;
+          parser->status = GST_ISOFF_MOOF_PARSER_SKIP;
+        }
+        break;
+
+      case GST_ISOFF_MOOF_PARSER_SAMPLES:{
+        guint entry_size =
+            gst_isoff_trun_sample_entry_size (parser->trun.flags);
+
+        while (parser->samples_left > 0 &&
+            gst_byte_reader_get_remaining (reader) >= entry_size) {
+          gst_isoff_moof_parser_add_sample (parser, table, reader);
+          parser->offset += entry_size;
+        }
+
+        if (parser->samples_left > 0)
+          goto done;
+
+        /* Skip any trailing data of the trun */
+        parser->status = GST_ISOFF_MOOF_PARSER_SKIP;
+        break;
+      }
+
+      case GST_ISOFF_MOOF_PARSER_SKIP:{
+        guint64 skip = MIN (parser->box_end - parser->offset,
+            gst_byte_reader_get_remaining (reader));
+
+        gst_byte_reader_skip_unchecked (reader, skip);
+        parser->offset += skip;
+
+        if (parser->offset < parser->box_end)
+          goto done;
+
+        parser->status = GST_ISOFF_MOOF_PARSER_BOXES;
+        break;
+      }
+
+      case GST_ISOFF_MOOF_PARSER_FINISHED:
+        res = GST_ISOFF_PARSER_DONE;
+        break;
+    }
+  }
+
+done:
+  *consumed = gst_byte_reader_get_pos (reader);
+
+  return res;
+
+error:
+  gst_byte_reader_set_pos (reader, box_start);
+  *consumed = box_start;
+
+  return GST_ISOFF_PARSER_ERROR;
+}
+
+GstIsoffParserResult
+gst_isoff_moof_parser_add_buffer (GstMoofParser * parser, GstBuffer * buffer,
+    guint * consumed)
+{
+  GstIsoffParserResult res;
+  GstByteReader reader;
+  GstMapInfo info;
+
+  if (!gst_buffer_map (buffer, &info, GST_MAP_READ)) {
+    *consumed = 0;
+    return GST_ISOFF_PARSER_ERROR;
+  }
+
+  gst_byte_reader_init (&reader, info.data, info.size);
+  res = gst_isoff_moof_parser_parse (parser, &reader, consumed);
+
+  gst_buffer_unmap (buffer, &info);
+  return res;
+}
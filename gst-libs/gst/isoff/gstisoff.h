@@ -290,6 +290,73 @@ GstIsoffParserResult gst_isoff_sidx_parser_parse (GstSidxParser * parser, GstByt
 GST_ISOFF_API
 GstIsoffParserResult gst_isoff_sidx_parser_add_buffer (GstSidxParser * parser, GstBuffer * buf, guint * consumed);
 
+/* Sample flags that are neither in the trun nor in the tfhd but given by the
+ * trex of the moov, which the moof parser does not know. Has reserved bits
+ * set so it can't be confused with actual sample flags. */
+#define GST_ISOFF_SAMPLE_FLAGS_FROM_TREX 0xffffffff
+
+/* Flat sample table of one track fragment, one entry per sample in every
+ * array. Offsets are relative to the first byte of the moof unless the tfhd
+ * carries an explicit base data offset, in which case they are absolute.
+ * Sizes and durations only given by the trex are stored as 0, and the
+ * offsets following such a size are unusable. */
+typedef struct _GstIsoffSampleTable
+{
+  guint32 track_id;
+  guint64 decode_time;          /* from the tfdt, G_MAXUINT64 if none */
+  gboolean absolute_offsets;
+  gboolean trex_sizes;          /* some sizes are given by the trex */
+  gboolean trex_durations;      /* some durations are given by the trex */
+
+  GArray *offsets;              /* guint64 */
+  GArray *sizes;                /* guint32 */
+  GArray *durations;            /* guint32 */
+  GArray *flags;                /* guint32 */
+  GArray *composition_offsets;  /* gint32 */
+} GstIsoffSampleTable;
+
+typedef enum _GstMoofParserStatus
+{
+  GST_ISOFF_MOOF_PARSER_INIT,
+  GST_ISOFF_MOOF_PARSER_BOXES,
+  GST_ISOFF_MOOF_PARSER_SAMPLES,
+  GST_ISOFF_MOOF_PARSER_SKIP,
+  GST_ISOFF_MOOF_PARSER_FINISHED
+} GstMoofParserStatus;
+
+typedef struct _GstMoofParser
+{
+  GstMoofParserStatus status;
+
+  guint64 size;
+  guint64 offset;               /* bytes of the moof consumed so far */
+  guint64 traf_end;             /* 0 outside of a traf */
+  guint64 box_end;              /* end of the trun or skipped box */
+
+  guint32 sequence_number;
+
+  gboolean had_tfhd;
+  GstTfhdBox tfhd;
+  GstTrunBox trun;              /* header only, samples go to the table */
+  guint32 samples_left;
+  guint64 base_offset;
+  guint64 data_offset;
+
+  GArray *tables;               /* GstIsoffSampleTable, one per traf */
+} GstMoofParser;
+
+GST_ISOFF_API
+void gst_isoff_moof_parser_init (GstMoofParser * parser);
+
+GST_ISOFF_API
+void gst_isoff_moof_parser_clear (GstMoofParser * parser);
+
+GST_ISOFF_API
+GstIsoffParserResult gst_isoff_moof_parser_parse (GstMoofParser * parser, GstByteReader * reader, guint * consumed);
+
+GST_ISOFF_API
+GstIsoffParserResult gst_isoff_moof_parser_add_buffer (GstMoofParser * parser, GstBuffer * buf, guint * consumed);
+
 G_END_DECLS
 
 #endif /* __GST_ISOFF_H__ */
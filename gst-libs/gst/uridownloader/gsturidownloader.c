@@ -50,6 +50,387 @@ struct _GstUriDownloaderPrivate
   gboolean cancelled;
 };
 
+/* Process-wide cache shared by all downloaders. Entries are keyed by the
+ * requested URI and byte range and evicted in LRU order once the configured
+ * maximum size is exceeded. A maximum size of 0 disables the cache. */
+typedef struct
+{
+  gchar *key;
+  GstBuffer *buffer;
+  gsize size;
+
+  gchar *uri;
+  gchar *redirect_uri;
+  gboolean redirect_permanent;
+  GstStructure *headers;
+
+  /* monotonic time until which the entry is fresh, G_MAXINT64 if the
+   * response carried no explicit lifetime */
+  gint64 expires;
+  gboolean explicit_lifetime;
+
+  GList *link;
+} GstUriDownloaderCacheEntry;
+
+typedef struct
+{
+  GMutex lock;
+  GHashTable *entries;
+  GQueue lru;                   /* most recently used at the head */
+  guint64 max_size;
+  guint64 size;
+
+  guint64 hits;
+  guint64 misses;
+  guint64 stores;
+  guint64 evictions;
+} GstUriDownloaderCache;
+
+static GstUriDownloaderCache *
+gst_uri_downloader_cache_get (void)
+{
+  static GstUriDownloaderCache *cache = NULL;
+
+  if (g_once_init_enter (&cache)) {
+    GstUriDownloaderCache *c = g_new0 (GstUriDownloaderCache, 1);
+    const gchar *env;
+
+    g_mutex_init (&c->lock);
+    g_queue_init (&c->lru);
+    c->entries = g_hash_table_new (g_str_hash, g_str_equal);
+
+    /* allows enabling the cache for applications that don't know about it */
+    env = g_getenv ("GST_URI_DOWNLOADER_CACHE_SIZE");
+    if (env != NULL)
+      c->max_size = g_ascii_strtoull (env, NULL, 10);
+
+    g_once_init_leave (&cache, c);
+  }
+
+  return cache;
+}
+
+static void
+gst_uri_downloader_cache_entry_free (GstUriDownloaderCacheEntry * entry)
+{
+  g_free (entry->key);
+  gst_buffer_unref (entry->buffer);
+  g_free (entry->uri);
+  g_free (entry->redirect_uri);
+  if (entry->headers)
+    gst_structure_free (entry->headers);
+  g_slice_free (GstUriDownloaderCacheEntry, entry);
+}
+
+/* must be called with the cache lock */
+static void
+gst_uri_downloader_cache_remove_entry (GstUriDownloaderCache * cache,
+    GstUriDownloaderCacheEntry * entry)
+{
+  g_hash_table_remove (cache->entries, entry->key);
+  g_queue_delete_link (&cache->lru, entry->link);
+  cache->size -= entry->size;
+  gst_uri_downloader_cache_entry_free (entry);
+}
+
+/* must be called with the cache lock */
+static void
+gst_uri_downloader_cache_shrink (GstUriDownloaderCache * cache,
+    guint64 max_size)
+{
+  while (cache->size > max_size) {
+    GstUriDownloaderCacheEntry *entry = g_queue_peek_tail (&cache->lru);
+
+    GST_LOG ("Evicting %s from the cache", entry->key);
+    gst_uri_downloader_cache_remove_entry (cache, entry);
+    cache->evictions++;
+  }
+}
+
+static gchar *
+gst_uri_downloader_cache_make_key (const gchar * uri, gint64 range_start,
+    gint64 range_end)
+{
+  return g_strdup_printf ("%" G_GINT64_FORMAT "-%" G_GINT64_FORMAT " %s",
+      range_start, range_end, uri);
+}
+
+static const gchar *
+gst_uri_downloader_cache_get_header (const GstStructure * headers,
+    const gchar * name)
+{
+  gint i, n;
+
+  /* header names are case insensitive */
+  n = gst_structure_n_fields (headers);
+  for (i = 0; i < n; i++) {
+    const gchar *field = gst_structure_nth_field_name (headers, i);
+
+    if (g_ascii_strcasecmp (field, name) == 0)
+      return gst_structure_get_string (headers, field);
+  }
+
+  return NULL;
+}
+
+/* Computes the freshness lifetime of a response from its Cache-Control
+ * max-age and Age headers. Returns FALSE if the response must not be stored
+ * at all. */
+static gboolean
+gst_uri_downloader_cache_get_lifetime (const GstStructure * headers,
+    gint64 * lifetime, gboolean * explicit_lifetime)
+{
+  const GstStructure *response_headers = NULL;
+  const gchar *cache_control;
+  const gchar *age;
+  gchar **directives;
+  gint i;
+
+  *lifetime = -1;
+  *explicit_lifetime = FALSE;
+
+  if (headers) {
+    const GValue *val = gst_structure_get_value (headers, "response-headers");
+
+    if (val && GST_VALUE_HOLDS_STRUCTURE (val))
+      response_headers = gst_value_get_structure (val);
+  }
+  if (response_headers == NULL)
+    return TRUE;
+
+  cache_control =
+      gst_uri_downloader_cache_get_header (response_headers, "Cache-Control");
+  if (cache_control == NULL)
+    return TRUE;
+
+  directives = g_strsplit (cache_control, ",", -1);
+  for (i = 0; directives[i]; i++) {
+    gchar *directive = g_strstrip (directives[i]);
+
+    if (g_ascii_strcasecmp (directive, "no-store") == 0 ||
+        g_ascii_strcasecmp (directive, "no-cache") == 0) {
+      g_strfreev (directives);
+      return FALSE;
+    } else if (g_ascii_strncasecmp (directive, "max-age=", 8) == 0) {
+      *lifetime = g_ascii_strtoll (directive + 8, NULL, 10);
+      *explicit_lifetime = TRUE;
+    }
+  }
+  g_strfreev (directives);
+
+  if (*explicit_lifetime) {
+    age = gst_uri_downloader_cache_get_header (response_headers, "Age");
+    if (age)
+      *lifetime -= g_ascii_strtoll (age, NULL, 10);
+    if (*lifetime <= 0)
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Returns a new fragment for a cached response of @uri, or NULL. If @refresh
+ * is set the caller wants an up to date copy (e.g. a live manifest), so only
+ * responses that are still fresh according to their own Cache-Control
+ * lifetime are returned */
+static GstFragment *
+gst_uri_downloader_cache_lookup (const gchar * uri, gint64 range_start,
+    gint64 range_end, gboolean refresh)
+{
+  GstUriDownloaderCache *cache = gst_uri_downloader_cache_get ();
+  GstUriDownloaderCacheEntry *entry;
+  GstFragment *download = NULL;
+  gchar *key;
+
+  g_mutex_lock (&cache->lock);
+  if (cache->max_size == 0) {
+    g_mutex_unlock (&cache->lock);
+    return NULL;
+  }
+
+  key = gst_uri_downloader_cache_make_key (uri, range_start, range_end);
+  entry = g_hash_table_lookup (cache->entries, key);
+  g_free (key);
+
+  if (entry && entry->expires <= g_get_monotonic_time ()) {
+    GST_LOG ("Cached %s expired", entry->key);
+    gst_uri_downloader_cache_remove_entry (cache, entry);
+    entry = NULL;
+  }
+
+  if (entry && (entry->explicit_lifetime || !refresh)) {
+    download = gst_fragment_new ();
+    download->range_start = range_start;
+    download->range_end = range_end;
+    download->uri = g_strdup (entry->uri);
+    download->redirect_uri = g_strdup (entry->redirect_uri);
+    download->redirect_permanent = entry->redirect_permanent;
+    if (entry->headers)
+      download->headers = gst_structure_copy (entry->headers);
+    /* the fragment gets its own metadata, the memory is shared */
+    gst_fragment_add_buffer (download, gst_buffer_copy (entry->buffer));
+    download->completed = TRUE;
+    download->download_stop_time = download->download_start_time;
+
+    g_queue_unlink (&cache->lru, entry->link);
+    g_queue_push_head_link (&cache->lru, entry->link);
+    cache->hits++;
+    GST_DEBUG ("Cache hit for %s (%" G_GSIZE_FORMAT " bytes)", uri,
+        entry->size);
+  } else {
+    cache->misses++;
+  }
+  g_mutex_unlock (&cache->lock);
+
+  return download;
+}
+
+static void
+gst_uri_downloader_cache_store (const gchar * uri, gint64 range_start,
+    gint64 range_end, GstFragment * download)
+{
+  GstUriDownloaderCache *cache = gst_uri_downloader_cache_get ();
+  GstUriDownloaderCacheEntry *entry, *old;
+  GstBuffer *buffer;
+  gint64 lifetime;
+  gboolean explicit_lifetime;
+
+  if (!gst_uri_downloader_cache_get_lifetime (download->headers, &lifetime,
+          &explicit_lifetime)) {
+    GST_LOG ("Response for %s is not cacheable", uri);
+    return;
+  }
+
+  buffer = gst_fragment_get_buffer (download);
+  if (buffer == NULL)
+    return;
+
+  g_mutex_lock (&cache->lock);
+  if (cache->max_size == 0 || gst_buffer_get_size (buffer) > cache->max_size) {
+    g_mutex_unlock (&cache->lock);
+    gst_buffer_unref (buffer);
+    return;
+  }
+
+  entry = g_slice_new0 (GstUriDownloaderCacheEntry);
+  entry->key = gst_uri_downloader_cache_make_key (uri, range_start, range_end);
+  entry->buffer = gst_buffer_copy (buffer);
+  entry->size = gst_buffer_get_size (buffer);
+  entry->uri = g_strdup (download->uri);
+  entry->redirect_uri = g_strdup (download->redirect_uri);
+  entry->redirect_permanent = download->redirect_permanent;
+  if (download->headers)
+    entry->headers = gst_structure_copy (download->headers);
+  entry->explicit_lifetime = explicit_lifetime;
+  if (explicit_lifetime)
+    entry->expires = g_get_monotonic_time () + lifetime * G_USEC_PER_SEC;
+  else
+    entry->expires = G_MAXINT64;
+  gst_buffer_unref (buffer);
+
+  old = g_hash_table_lookup (cache->entries, entry->key);
+  if (old)
+    gst_uri_downloader_cache_remove_entry (cache, old);
+
+  gst_uri_downloader_cache_shrink (cache, cache->max_size - entry->size);
+
+  g_hash_table_insert (cache->entries, entry->key, entry);
+  g_queue_push_head (&cache->lru, entry);
+  entry->link = cache->lru.head;
+  cache->size += entry->size;
+  cache->stores++;
+  g_mutex_unlock (&cache->lock);
+}
+
+/**
+ * gst_uri_downloader_cache_set_max_size:
+ * @max_size: the maximum size of the cache in bytes, 0 to disable it
+ *
+ * Sets the size of the process-wide cache shared by all #GstUriDownloader
+ * instances, so that several pipelines playing the same stream only fetch
+ * manifests, playlists, keys and indexes once. The cache is disabled by
+ * default, unless the GST_URI_DOWNLOADER_CACHE_SIZE environment variable
+ * is set.
+ *
+ * Only requests made through gst_uri_downloader_fetch_uri_with_range() are
+ * cached. Media fragments downloaded by the adaptive demuxers through their
+ * own source elements never go through the cache.
+ *
+ * Responses are only shared if the caller allows caching. Requests that
+ * ask for a refreshed copy are only served from the cache while the
+ * response is still fresh according to its Cache-Control max-age.
+ */
+void
+gst_uri_downloader_cache_set_max_size (guint64 max_size)
+{
+  GstUriDownloaderCache *cache = gst_uri_downloader_cache_get ();
+
+  g_mutex_lock (&cache->lock);
+  cache->max_size = max_size;
+  gst_uri_downloader_cache_shrink (cache, max_size);
+  g_mutex_unlock (&cache->lock);
+}
+
+/**
+ * gst_uri_downloader_cache_get_max_size:
+ *
+ * Returns: the maximum size of the shared cache in bytes, 0 if disabled
+ */
+guint64
+gst_uri_downloader_cache_get_max_size (void)
+{
+  GstUriDownloaderCache *cache = gst_uri_downloader_cache_get ();
+  guint64 max_size;
+
+  g_mutex_lock (&cache->lock);
+  max_size = cache->max_size;
+  g_mutex_unlock (&cache->lock);
+
+  return max_size;
+}
+
+/**
+ * gst_uri_downloader_cache_clear:
+ *
+ * Drops all entries from the shared cache and resets its statistics.
+ */
+void
+gst_uri_downloader_cache_clear (void)
+{
+  GstUriDownloaderCache *cache = gst_uri_downloader_cache_get ();
+
+  g_mutex_lock (&cache->lock);
+  gst_uri_downloader_cache_shrink (cache, 0);
+  cache->hits = cache->misses = cache->stores = cache->evictions = 0;
+  g_mutex_unlock (&cache->lock);
+}
+
+/**
+ * gst_uri_downloader_cache_get_stats:
+ *
+ * Returns: (transfer full): a #GstStructure with the "max-size", "size",
+ * "entries", "hits", "misses", "stores" and "evictions" of the shared cache
+ */
+GstStructure *
+gst_uri_downloader_cache_get_stats (void)
+{
+  GstUriDownloaderCache *cache = gst_uri_downloader_cache_get ();
+  GstStructure *s;
+
+  g_mutex_lock (&cache->lock);
+  s = gst_structure_new ("application/x-uri-downloader-cache-stats",
+      "max-size", G_TYPE_UINT64, cache->max_size,
+      "size", G_TYPE_UINT64, cache->size,
+      "entries", G_TYPE_UINT, g_hash_table_size (cache->entries),
+      "hits", G_TYPE_UINT64, cache->hits,
+      "misses", G_TYPE_UINT64, cache->misses,
+      "stores", G_TYPE_UINT64, cache->stores,
+      "evictions", G_TYPE_UINT64, cache->evictions, NULL);
+  g_mutex_unlock (&cache->lock);
+
+  return s;
+}
+
 static void gst_uri_downloader_finalize (GObject * object);
 static void gst_uri_downloader_dispose (GObject * object);
 
@@ -550,6 +931,10 @@ gst_uri_downloader_fetch_uri (GstUriDownloader * downloader,
  * @range_start: the starting byte index
  * @range_end: the final byte index, use -1 for unspecified
  *
+ * If @allow_cache is set and the shared cache is enabled, the response is
+ * looked up in and stored into the cache, see
+ * gst_uri_downloader_cache_set_max_size().
+ *
  * Returns the downloaded #GstFragment
  */
 GstFragment *
@@ -573,6 +958,18 @@ gst_uri_downloader_fetch_uri_with_range (GstUriDownloader *
     goto quit;
   }
 
+  /* HEAD requests are never cached */
+  if (allow_cache && (range_start >= 0 || range_end >= 0)) {
+    download = gst_uri_downloader_cache_lookup (uri, range_start, range_end,
+        refresh);
+    if (download) {
+      GST_INFO_OBJECT (downloader, "URI fetched from the cache");
+      GST_OBJECT_UNLOCK (downloader);
+      g_mutex_unlock (&downloader->priv->download_lock);
+      return download;
+    }
+  }
+
   if (!gst_uri_downloader_set_uri (downloader, uri, referer, compress, refresh,
           allow_cache)) {
     GST_WARNING_OBJECT (downloader, "Failed to set URI");
@@ -718,6 +1115,11 @@ quit:
     downloader->priv->cancelled = FALSE;
 
     g_mutex_unlock (&downloader->priv->download_lock);
+
+    if (download != NULL && allow_cache && (range_start >= 0
+            || range_end >= 0))
+      gst_uri_downloader_cache_store (uri, range_start, range_end, download);
+
     return download;
   }
 }
@@ -79,5 +79,17 @@ void gst_uri_downloader_reset (GstUriDownloader *downloader);
 GST_URI_DOWNLOADER_API
 void gst_uri_downloader_cancel (GstUriDownloader *downloader);
 
+GST_URI_DOWNLOADER_API
+void gst_uri_downloader_cache_set_max_size (guint64 max_size);
+
+GST_URI_DOWNLOADER_API
+guint64 gst_uri_downloader_cache_get_max_size (void);
+
+GST_URI_DOWNLOADER_API
+void gst_uri_downloader_cache_clear (void);
+
+GST_URI_DOWNLOADER_API
+GstStructure * gst_uri_downloader_cache_get_stats (void);
+
 G_END_DECLS
 #endif /* __GSTURIDOWNLOADER_H__ */
@@ -1412,17 +1412,19 @@ static void
 gst_asf_mux_add_simple_index_entry (GstAsfMux * asfmux,
     GstAsfVideoPad * videopad)
 {
-  SimpleIndexEntry *entry = NULL;
+  SimpleIndexEntry entry;
   GST_DEBUG_OBJECT (asfmux, "Adding new simple index entry "
       "packet number: %" G_GUINT32_FORMAT ", "
       "packet count: %" G_GUINT16_FORMAT,
       videopad->last_keyframe_packet, videopad->last_keyframe_packet_count);
-  entry = g_malloc0 (sizeof (SimpleIndexEntry));
-  entry->packet_number = videopad->last_keyframe_packet;
-  entry->packet_count = videopad->last_keyframe_packet_count;
-  if (entry->packet_count > videopad->max_keyframe_packet_count)
-    videopad->max_keyframe_packet_count = entry->packet_count;
-  videopad->simple_index = g_slist_append (videopad->simple_index, entry);
+  entry.packet_number = videopad->last_keyframe_packet;
+  entry.packet_count = videopad->last_keyframe_packet_count;
+  if (entry.packet_count > videopad->max_keyframe_packet_count)
+    videopad->max_keyframe_packet_count = entry.packet_count;
+  if (videopad->simple_index == NULL)
+    videopad->simple_index =
+        g_array_new (FALSE, FALSE, sizeof (SimpleIndexEntry));
+  g_array_append_val (videopad->simple_index, entry);
 }
 
 /**
@@ -1691,12 +1693,12 @@ stream_number_compare (gconstpointer a, gconstpointer b)
 static GstFlowReturn
 gst_asf_mux_push_simple_index (GstAsfMux * asfmux, GstAsfVideoPad * pad)
 {
+  guint32 entries_count = pad->simple_index ? pad->simple_index->len : 0;
   guint64 object_size = ASF_SIMPLE_INDEX_OBJECT_SIZE +
-      g_slist_length (pad->simple_index) * ASF_SIMPLE_INDEX_ENTRY_SIZE;
+      (guint64) entries_count * ASF_SIMPLE_INDEX_ENTRY_SIZE;
   GstBuffer *buf;
-  GSList *walk;
   guint8 *data;
-  guint32 entries_count = g_slist_length (pad->simple_index);
+  guint32 i;
   GstMapInfo map;
   gsize bufsize;
 
@@ -1720,9 +1722,10 @@ gst_asf_mux_push_simple_index (GstAsfMux * asfmux, GstAsfVideoPad * pad)
       G_GUINT32_FORMAT, object_size, pad->time_interval,
       pad->max_keyframe_packet_count, entries_count);
 
-  for (walk = pad->simple_index; walk; walk = g_slist_next (walk)) {
-    SimpleIndexEntry *entry = (SimpleIndexEntry *) walk->data;
-    GST_DEBUG_OBJECT (asfmux, "Simple index entry: packet_number:%"
+  for (i = 0; i < entries_count; i++) {
+    SimpleIndexEntry *entry =
+        &g_array_index (pad->simple_index, SimpleIndexEntry, i);
+    GST_LOG_OBJECT (asfmux, "Simple index entry: packet_number:%"
         G_GUINT32_FORMAT " packet_count:%" G_GUINT16_FORMAT,
         entry->packet_number, entry->packet_count);
     GST_WRITE_UINT32_LE (data, entry->packet_number);
@@ -2092,14 +2095,8 @@ gst_asf_mux_pad_reset (GstAsfPad * pad)
     videopad->max_keyframe_packet_count = 0;
     videopad->next_index_time = 0;
     videopad->time_interval = DEFAULT_SIMPLE_INDEX_TIME_INTERVAL;
-    if (videopad->simple_index) {
-      GSList *walk;
-      for (walk = videopad->simple_index; walk; walk = g_slist_next (walk)) {
-        g_free (walk->data);
-        walk->data = NULL;
-      }
-      g_slist_free (videopad->simple_index);
-    }
+    if (videopad->simple_index)
+      g_array_free (videopad->simple_index, TRUE);
     videopad->simple_index = NULL;
   }
 }
@@ -87,7 +87,7 @@ struct _GstAsfVideoPad
   gst_riff_strf_vids vidinfo;
 
   /* Simple Index Entries */
-  GSList *simple_index;
+  GArray *simple_index;
   gboolean has_keyframe;        /* if we have received one at least */
   guint32 last_keyframe_packet;
   guint16 last_keyframe_packet_count;
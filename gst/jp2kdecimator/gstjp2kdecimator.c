@@ -61,16 +61,36 @@ enum
 {
   PROP_0,
   PROP_MAX_LAYERS,
-  PROP_MAX_DECOMPOSITION_LEVELS
+  PROP_MAX_DECOMPOSITION_LEVELS,
+  PROP_N_THREADS
 };
 
 #define DEFAULT_MAX_LAYERS (0)
 #define DEFAULT_MAX_DECOMPOSITION_LEVELS (-1)
+#define DEFAULT_N_THREADS (1)
+
+/* Tiles of one frame that are processed by the thread pool */
+typedef struct
+{
+  const MainHeader *header;
+
+  GMutex lock;
+  GCond cond;
+  guint pending;
+  GstFlowReturn ret;
+} TileBatch;
+
+typedef struct
+{
+  TileBatch *batch;
+  Tile *tile;
+} TileJob;
 
 static void gst_jp2k_decimator_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec);
 static void gst_jp2k_decimator_get_property (GObject * object,
     guint prop_id, GValue * value, GParamSpec * pspec);
+static void gst_jp2k_decimator_finalize (GObject * object);
 
 static GstFlowReturn gst_jp2k_decimator_sink_chain (GstPad * pad,
     GstObject * parent, GstBuffer * inbuf);
@@ -99,6 +119,7 @@ gst_jp2k_decimator_class_init (GstJP2kDecimatorClass * klass)
 
   gobject_class->set_property = gst_jp2k_decimator_set_property;
   gobject_class->get_property = gst_jp2k_decimator_get_property;
+  gobject_class->finalize = gst_jp2k_decimator_finalize;
 
   g_object_class_install_property (gobject_class, PROP_MAX_LAYERS,
       g_param_spec_int ("max-layers", "Maximum Number of Layers",
@@ -111,6 +132,20 @@ gst_jp2k_decimator_class_init (GstJP2kDecimatorClass * klass)
           "Maximum number of decomposition levels to keep (-1 == all)", -1, 32,
           DEFAULT_MAX_DECOMPOSITION_LEVELS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstJP2kDecimator:n-threads:
+   *
+   * Number of threads used to parse and decimate the tiles of a frame in
+   * parallel. Only codestreams with multiple tiles benefit from this.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of Threads",
+          "Number of threads to process tiles with (0 == number of processors)",
+          0, G_MAXINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -118,6 +153,7 @@ gst_jp2k_decimator_init (GstJP2kDecimator * self)
 {
   self->max_layers = DEFAULT_MAX_LAYERS;
   self->max_decomposition_levels = DEFAULT_MAX_DECOMPOSITION_LEVELS;
+  self->n_threads = DEFAULT_N_THREADS;
 
   self->sinkpad = gst_pad_new_from_static_template (&sink_pad_template, "sink");
   GST_PAD_SET_PROXY_CAPS (self->sinkpad);
@@ -145,6 +181,9 @@ gst_jp2k_decimator_set_property (GObject * object,
     case PROP_MAX_DECOMPOSITION_LEVELS:
       self->max_decomposition_levels = g_value_get_int (value);
       break;
+    case PROP_N_THREADS:
+      self->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -164,12 +203,98 @@ gst_jp2k_decimator_get_property (GObject * object,
     case PROP_MAX_DECOMPOSITION_LEVELS:
       g_value_set_int (value, self->max_decomposition_levels);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, self->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static void
+gst_jp2k_decimator_finalize (GObject * object)
+{
+  GstJP2kDecimator *self = GST_JP2K_DECIMATOR (object);
+
+  if (self->pool)
+    g_thread_pool_free (self->pool, FALSE, TRUE);
+  self->pool = NULL;
+
+  G_OBJECT_CLASS (gst_jp2k_decimator_parent_class)->finalize (object);
+}
+
+static void
+gst_jp2k_decimator_tile_func (TileJob * job, GstJP2kDecimator * self)
+{
+  TileBatch *batch = job->batch;
+  GstFlowReturn ret;
+
+  ret = decimate_tile (self, batch->header, job->tile);
+
+  g_mutex_lock (&batch->lock);
+  if (ret != GST_FLOW_OK)
+    batch->ret = ret;
+  if (--batch->pending == 0)
+    g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->lock);
+}
+
+/* Decimates all tiles of the frame, in parallel if configured and if there
+ * is more than one tile */
+static GstFlowReturn
+gst_jp2k_decimator_decimate_tiles (GstJP2kDecimator * self,
+    MainHeader * header)
+{
+  TileBatch batch;
+  TileJob *jobs;
+  guint n_threads;
+  guint i;
+
+  n_threads = self->n_threads;
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  if (n_threads < 2 || header->n_tiles < 2)
+    return decimate_main_header (self, header);
+
+  if (self->pool == NULL) {
+    self->pool =
+        g_thread_pool_new ((GFunc) gst_jp2k_decimator_tile_func, self,
+        n_threads, FALSE, NULL);
+  } else if ((guint) g_thread_pool_get_max_threads (self->pool) !=
+      n_threads) {
+    g_thread_pool_set_max_threads (self->pool, n_threads, NULL);
+  }
+
+  GST_LOG_OBJECT (self, "Decimating %u tiles with %u threads",
+      header->n_tiles, n_threads);
+
+  batch.header = header;
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+  batch.pending = header->n_tiles;
+  batch.ret = GST_FLOW_OK;
+
+  jobs = g_new (TileJob, header->n_tiles);
+  for (i = 0; i < header->n_tiles; i++) {
+    jobs[i].batch = &batch;
+    jobs[i].tile = &header->tiles[i];
+    g_thread_pool_push (self->pool, &jobs[i], NULL);
+  }
+
+  g_mutex_lock (&batch.lock);
+  while (batch.pending > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+  g_mutex_unlock (&batch.lock);
+
+  g_free (jobs);
+  g_cond_clear (&batch.cond);
+  g_mutex_clear (&batch.lock);
+
+  return batch.ret;
+}
+
 static GstFlowReturn
 gst_jp2k_decimator_decimate_jpc (GstJP2kDecimator * self, GstBuffer * inbuf,
     GstBuffer ** outbuf_)
@@ -198,7 +323,7 @@ gst_jp2k_decimator_decimate_jpc (GstJP2kDecimator * self, GstBuffer * inbuf,
   if (ret != GST_FLOW_OK)
     goto done;
 
-  ret = decimate_main_header (self, &main_header);
+  ret = gst_jp2k_decimator_decimate_tiles (self, &main_header);
   if (ret != GST_FLOW_OK)
     goto done;
 
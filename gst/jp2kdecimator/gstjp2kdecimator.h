@@ -43,6 +43,9 @@ struct _GstJP2kDecimator
 
   gint max_layers;
   gint max_decomposition_levels;
+  guint n_threads;
+
+  GThreadPool *pool;
 };
 
 struct _GstJP2kDecimatorClass
@@ -1591,14 +1591,44 @@ parse_main_header (GstJP2kDecimator * self, GstByteReader * reader,
 
   header->tiles = g_slice_alloc0 (sizeof (Tile) * header->n_tiles);
 
-  /* now at SOT marker, read the tiles */
+  /* now at SOT marker, locate the tile parts. They are only parsed by
+   * decimate_tile() so that tiles can be processed independently */
   {
     gint i;
 
     for (i = 0; i < header->n_tiles; i++) {
-      ret = parse_tile (self, reader, header, &header->tiles[i]);
-      if (ret != GST_FLOW_OK)
+      Tile *tile = &header->tiles[i];
+      guint32 tile_part_size;
+
+      if (!gst_byte_reader_peek_uint16_be (reader, &marker)
+          || marker != MARKER_SOT) {
+        GST_ERROR_OBJECT (self, "No SOT marker for tile %d", i);
+        ret = GST_FLOW_ERROR;
+        goto done;
+      }
+
+      if (gst_byte_reader_get_remaining (reader) < 2 + 10 + 2) {
+        GST_ERROR_OBJECT (self, "Invalid SOT marker");
+        ret = GST_FLOW_ERROR;
+        goto done;
+      }
+
+      /* Psot, 0 if the tile part extends to the EOC marker */
+      tile_part_size =
+          GST_READ_UINT32_BE (gst_byte_reader_peek_data_unchecked (reader) + 6);
+      if (tile_part_size == 0)
+        tile_part_size = gst_byte_reader_get_remaining (reader) - 2;
+
+      if (tile_part_size < 2 + 10 || (guint64) tile_part_size + 2 >
+          gst_byte_reader_get_remaining (reader)) {
+        GST_ERROR_OBJECT (self, "Invalid or truncated tile part");
+        ret = GST_FLOW_ERROR;
         goto done;
+      }
+
+      tile->data = gst_byte_reader_peek_data_unchecked (reader);
+      tile->length = tile_part_size;
+      gst_byte_reader_skip_unchecked (reader, tile_part_size);
     }
   }
 
@@ -1750,69 +1780,91 @@ done:
   return ret;
 }
 
+/* Parses and decimates a single tile. Tiles are independent of each other,
+ * so this can be called for different tiles of the same header from
+ * multiple threads */
 GstFlowReturn
-decimate_main_header (GstJP2kDecimator * self, MainHeader * header)
+decimate_tile (GstJP2kDecimator * self, const MainHeader * header, Tile * tile)
 {
   GstFlowReturn ret = GST_FLOW_OK;
-  gint i;
+  GstByteReader reader;
+  GList *l;
+  PacketIterator it;
+  PacketLengthTilePart *plt = NULL;
 
-  for (i = 0; i < header->n_tiles; i++) {
-    Tile *tile = &header->tiles[i];
-    GList *l;
-    PacketIterator it;
-    PacketLengthTilePart *plt = NULL;
-
-    if (tile->plt) {
-      if (g_list_length (tile->plt) > 1) {
-        GST_ERROR_OBJECT (self, "Multiple PLT per tile not supported yet");
-        ret = GST_FLOW_ERROR;
-        goto done;
-      }
-      plt = g_slice_new (PacketLengthTilePart);
-      plt->index = 0;
-      plt->packet_lengths = g_array_new (FALSE, FALSE, sizeof (guint32));
+  /* Include the following marker, it terminates the last packet */
+  gst_byte_reader_init (&reader, tile->data, tile->length + 2);
+  ret = parse_tile (self, &reader, header, tile);
+  if (ret != GST_FLOW_OK)
+    goto done;
+
+  if (tile->plt) {
+    if (g_list_length (tile->plt) > 1) {
+      GST_ERROR_OBJECT (self, "Multiple PLT per tile not supported yet");
+      ret = GST_FLOW_ERROR;
+      goto done;
     }
+    plt = g_slice_new (PacketLengthTilePart);
+    plt->index = 0;
+    plt->packet_lengths = g_array_new (FALSE, FALSE, sizeof (guint32));
+  }
 
-    init_packet_iterator (self, &it, header, tile);
+  init_packet_iterator (self, &it, header, tile);
 
-    l = tile->packets;
-    while ((it.next (&it))) {
-      Packet *p;
+  l = tile->packets;
+  while ((it.next (&it))) {
+    Packet *p;
 
-      if (l == NULL) {
-        GST_ERROR_OBJECT (self, "Not enough packets");
-        ret = GST_FLOW_ERROR;
+    if (l == NULL) {
+      GST_ERROR_OBJECT (self, "Not enough packets");
+      ret = GST_FLOW_ERROR;
+      if (plt) {
         g_array_free (plt->packet_lengths, TRUE);
         g_slice_free (PacketLengthTilePart, plt);
-        goto done;
-      }
-
-      p = l->data;
-
-      if ((self->max_layers != 0 && it.cur_layer >= self->max_layers) ||
-          (self->max_decomposition_levels != -1
-              && it.cur_resolution > self->max_decomposition_levels)) {
-        p->data = NULL;
-        p->length = 1;
       }
+      goto done;
+    }
 
-      if (plt) {
-        guint32 len = sizeof_packet (self, p);
-        g_array_append_val (plt->packet_lengths, len);
-      }
+    p = l->data;
 
-      l = l->next;
+    if ((self->max_layers != 0 && it.cur_layer >= self->max_layers) ||
+        (self->max_decomposition_levels != -1
+            && it.cur_resolution > self->max_decomposition_levels)) {
+      p->data = NULL;
+      p->length = 1;
     }
 
     if (plt) {
-      reset_plt (self, tile->plt->data);
-      g_slice_free (PacketLengthTilePart, tile->plt->data);
-      tile->plt->data = plt;
+      guint32 len = sizeof_packet (self, p);
+      g_array_append_val (plt->packet_lengths, len);
     }
 
-    tile->sot.tile_part_size = sizeof_tile (self, tile);
+    l = l->next;
+  }
+
+  if (plt) {
+    reset_plt (self, tile->plt->data);
+    g_slice_free (PacketLengthTilePart, tile->plt->data);
+    tile->plt->data = plt;
   }
 
+  tile->sot.tile_part_size = sizeof_tile (self, tile);
+
 done:
   return ret;
 }
+
+GstFlowReturn
+decimate_main_header (GstJP2kDecimator * self, MainHeader * header)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  gint i;
+
+  for (i = 0; i < header->n_tiles; i++) {
+    ret = decimate_tile (self, header, &header->tiles[i]);
+    if (ret != GST_FLOW_OK)
+      break;
+  }
+
+  return ret;
+}
@@ -132,6 +132,10 @@ typedef struct
   /* Calculated value */
   gint tile_x, tile_y;
   gint tx0, tx1, ty0, ty1;      /* tile dimensions */
+
+  /* Tile part in the input, followed by the next SOT or the EOC marker */
+  const guint8 *data;
+  guint length;
 } Tile;
 
 typedef struct
@@ -189,5 +193,6 @@ guint sizeof_main_header (GstJP2kDecimator * self, const MainHeader * header);
 void reset_main_header (GstJP2kDecimator * self, MainHeader * header);
 GstFlowReturn write_main_header (GstJP2kDecimator * self, GstByteWriter * writer, const MainHeader * header);
 GstFlowReturn decimate_main_header (GstJP2kDecimator * self, MainHeader * header);
+GstFlowReturn decimate_tile (GstJP2kDecimator * self, const MainHeader * header, Tile * tile);
 
 #endif /* __JP2K_CODESTREAM_H__ */
@@ -58,6 +58,8 @@
 #define BLOCK_SZ                    32768
 #define SCAN_SCR_SZ                 12
 #define SCAN_PTS_SZ                 80
+/* Minimum SCR distance between two index entries */
+#define INDEX_INTERVAL              CLOCK_FREQ
 
 #define SEGMENT_THRESHOLD (300*GST_MSECOND)
 #define VIDEO_SEGMENT_THRESHOLD (500*GST_MSECOND)
@@ -275,6 +277,7 @@ gst_ps_demux_init (GstPsDemux * demux)
   demux->adapter = gst_adapter_new ();
   demux->rev_adapter = gst_adapter_new ();
   demux->flowcombiner = gst_flow_combiner_new ();
+  demux->index = g_array_new (FALSE, FALSE, sizeof (GstPsDemuxIndexEntry));
 
   gst_ps_demux_reset (demux);
 }
@@ -289,6 +292,7 @@ gst_ps_demux_finalize (GstPsDemux * demux)
   gst_flow_combiner_free (demux->flowcombiner);
   g_object_unref (demux->adapter);
   g_object_unref (demux->rev_adapter);
+  g_array_free (demux->index, TRUE);
 
   G_OBJECT_CLASS (parent_class)->finalize (G_OBJECT (demux));
 }
@@ -332,6 +336,7 @@ gst_ps_demux_reset (GstPsDemux * demux)
   demux->scr_rate_d = G_MAXUINT64;
   demux->first_pts = G_MAXUINT64;
   demux->last_pts = G_MAXUINT64;
+  g_array_set_size (demux->index, 0);
   demux->mux_rate = G_MAXUINT64;
   demux->next_pts = G_MAXUINT64;
   demux->next_dts = G_MAXUINT64;
@@ -1117,6 +1122,89 @@ not_supported:
   }
 }
 
+/* Remember the pack starting at @offset with @scr, so later seeks only
+ * have to search between the closest known packs. Entries are kept at
+ * least INDEX_INTERVAL apart, packs with SCR values going backwards
+ * (discontinuities) are not indexed. */
+static void
+gst_ps_demux_index_add (GstPsDemux * demux, guint64 scr, guint64 offset)
+{
+  GstPsDemuxIndexEntry entry;
+  guint lo = 0, hi = demux->index->len;
+
+  while (lo < hi) {
+    guint mid = (lo + hi) / 2;
+
+    if (g_array_index (demux->index, GstPsDemuxIndexEntry, mid).offset <
+        offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (lo > 0) {
+    GstPsDemuxIndexEntry *prev =
+        &g_array_index (demux->index, GstPsDemuxIndexEntry, lo - 1);
+
+    if (prev->scr >= scr || scr - prev->scr < INDEX_INTERVAL)
+      return;
+  }
+
+  if (lo < demux->index->len) {
+    GstPsDemuxIndexEntry *next =
+        &g_array_index (demux->index, GstPsDemuxIndexEntry, lo);
+
+    if (next->scr <= scr || next->scr - scr < INDEX_INTERVAL)
+      return;
+  }
+
+  GST_LOG_OBJECT (demux, "indexing SCR %" G_GUINT64_FORMAT " at offset %"
+      G_GUINT64_FORMAT, scr, offset);
+
+  entry.scr = scr;
+  entry.offset = offset;
+  g_array_insert_val (demux->index, lo, entry);
+}
+
+/* Narrow down the SCR range to search for @scr using the index */
+static void
+gst_ps_demux_index_find (GstPsDemux * demux, guint64 scr,
+    guint64 * min_scr, guint64 * min_scr_offset,
+    guint64 * max_scr, guint64 * max_scr_offset)
+{
+  guint lo = 0, hi = demux->index->len;
+
+  /* first entry with a bigger SCR */
+  while (lo < hi) {
+    guint mid = (lo + hi) / 2;
+
+    if (g_array_index (demux->index, GstPsDemuxIndexEntry, mid).scr <= scr)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (lo > 0) {
+    GstPsDemuxIndexEntry *prev =
+        &g_array_index (demux->index, GstPsDemuxIndexEntry, lo - 1);
+
+    if (prev->scr > *min_scr && prev->offset > *min_scr_offset) {
+      *min_scr = prev->scr;
+      *min_scr_offset = prev->offset;
+    }
+  }
+
+  if (lo < demux->index->len) {
+    GstPsDemuxIndexEntry *next =
+        &g_array_index (demux->index, GstPsDemuxIndexEntry, lo);
+
+    if (next->scr < *max_scr && next->offset < *max_scr_offset) {
+      *max_scr = next->scr;
+      *max_scr_offset = next->offset;
+    }
+  }
+}
+
 #define MAX_RECURSION_COUNT 100
 
 /* Binary search for requested SCR */
@@ -1138,8 +1226,9 @@ find_offset (GstPsDemux * demux, guint64 scr,
       MIN (gst_util_uint64_scale (scr - min_scr, scr_rate_n,
           scr_rate_d), demux->sink_segment.stop);
 
-  if (!gst_ps_demux_scan_forward_ts (demux, &offset, SCAN_SCR, &fscr, 0)) {
-    gst_ps_demux_scan_backward_ts (demux, &offset, SCAN_SCR, &fscr, 0);
+  if (gst_ps_demux_scan_forward_ts (demux, &offset, SCAN_SCR, &fscr, 0) ||
+      gst_ps_demux_scan_backward_ts (demux, &offset, SCAN_SCR, &fscr, 0)) {
+    gst_ps_demux_index_add (demux, fscr, offset);
   }
 
   if (fscr == scr || fscr == min_scr || fscr == max_scr) {
@@ -1160,6 +1249,7 @@ gst_ps_demux_do_seek (GstPsDemux * demux, GstSegment * seeksegment)
 {
   gboolean found;
   guint64 fscr, offset;
+  guint64 min_scr, min_scr_offset, max_scr, max_scr_offset;
   guint64 scr = GSTTIME_TO_MPEGTIME (seeksegment->position + demux->base_time);
 
   /* In some clips the PTS values are completely unaligned with SCR values.
@@ -1175,9 +1265,22 @@ gst_ps_demux_do_seek (GstPsDemux * demux, GstSegment * seeksegment)
   GST_INFO_OBJECT (demux, "sink segment configured %" GST_SEGMENT_FORMAT
       ", trying to go at SCR: %" G_GUINT64_FORMAT, &demux->sink_segment, scr);
 
-  offset =
-      find_offset (demux, scr, demux->first_scr, demux->first_scr_offset,
-      demux->last_scr, demux->last_scr_offset, 0);
+  min_scr = demux->first_scr;
+  min_scr_offset = demux->first_scr_offset;
+  max_scr = demux->last_scr;
+  max_scr_offset = demux->last_scr_offset;
+  gst_ps_demux_index_find (demux, scr, &min_scr, &min_scr_offset, &max_scr,
+      &max_scr_offset);
+
+  GST_DEBUG_OBJECT (demux, "searching between SCR %" G_GUINT64_FORMAT
+      " at %" G_GUINT64_FORMAT " and %" G_GUINT64_FORMAT " at %"
+      G_GUINT64_FORMAT, min_scr, min_scr_offset, max_scr, max_scr_offset);
+
+  if (min_scr == scr)
+    offset = min_scr_offset;
+  else
+    offset = find_offset (demux, scr, min_scr, min_scr_offset, max_scr,
+        max_scr_offset, 0);
 
   if (offset == (guint64) - 1) {
     return FALSE;
@@ -1718,6 +1821,9 @@ gst_ps_demux_parse_pack_start (GstPsDemux * demux)
   }
   new_rate *= MPEG_MUX_RATE_MULT;
 
+  if (demux->random_access && demux->adapter_offset != G_MAXUINT64)
+    gst_ps_demux_index_add (demux, scr, demux->adapter_offset);
+
   /* scr adjusted is the new scr found + the colected adjustment */
   scr_adjusted = scr + demux->scr_adjust;
 
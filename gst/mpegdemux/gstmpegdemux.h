@@ -84,6 +84,13 @@ typedef enum
   STATE_PS_DEMUX_NEED_MORE_DATA,
 } GstPsDemuxState;
 
+/* Pack start offset of an SCR, see gst_ps_demux_index_add() */
+typedef struct
+{
+  guint64 scr;
+  guint64 offset;
+} GstPsDemuxIndexEntry;
+
 /* Information associated with a single FluPS stream. */
 struct _GstPsStream
 {
@@ -137,6 +144,9 @@ struct _GstPsDemux
   guint64 first_pts;
   guint64 last_pts;
 
+  /* GstPsDemuxIndexEntry sorted by offset and SCR, pull mode only */
+  GArray *index;
+
   gint16 psm[GST_PS_DEMUX_MAX_PSM];
 
   GstSegment sink_segment;
@@ -71,6 +71,7 @@ GST_STATIC_PAD_TEMPLATE ("track_%u",
 GST_DEBUG_CATEGORY_STATIC (mxfdemux_debug);
 #define GST_CAT_DEFAULT mxfdemux_debug
 
+static void gst_mxf_demux_clear_readahead (GstMXFDemux * demux);
 static GstFlowReturn
 gst_mxf_demux_pull_klv_packet (GstMXFDemux * demux, guint64 offset, MXFUL * key,
     GstBuffer ** outbuf, guint * read);
@@ -79,6 +80,8 @@ gst_mxf_demux_handle_index_table_segment (GstMXFDemux * demux,
     const MXFUL * key, GstBuffer * buffer, guint64 offset);
 
 static void collect_index_table_segments (GstMXFDemux * demux);
+static gboolean gst_mxf_demux_parse_descriptive_metadata (GstMXFDemux *
+    demux);
 
 GType gst_mxf_demux_pad_get_type (void);
 G_DEFINE_TYPE (GstMXFDemuxPad, gst_mxf_demux_pad, GST_TYPE_PAD);
@@ -116,9 +119,12 @@ enum
   PROP_0,
   PROP_PACKAGE,
   PROP_MAX_DRIFT,
-  PROP_STRUCTURE
+  PROP_STRUCTURE,
+  PROP_READ_AHEAD_SIZE
 };
 
+#define DEFAULT_READ_AHEAD_SIZE (4 * 1024 * 1024)
+
 static gboolean gst_mxf_demux_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 static gboolean gst_mxf_demux_src_event (GstPad * pad, GstObject * parent,
@@ -153,6 +159,13 @@ gst_mxf_demux_partition_free (GstMXFDemuxPartition * partition)
   g_free (partition);
 }
 
+static void
+gst_mxf_demux_descriptive_metadata_free (GstMXFDemuxDescriptiveMetadata * dm)
+{
+  gst_buffer_unref (dm->buffer);
+  g_free (dm);
+}
+
 static void
 gst_mxf_demux_reset_mxf_state (GstMXFDemux * demux)
 {
@@ -160,6 +173,11 @@ gst_mxf_demux_reset_mxf_state (GstMXFDemux * demux)
 
   GST_DEBUG_OBJECT (demux, "Resetting MXF state");
 
+  /* Pending descriptive metadata points to the primer packs */
+  g_rw_lock_writer_lock (&demux->metadata_lock);
+  g_ptr_array_set_size (demux->pending_descriptive_metadata, 0);
+  g_rw_lock_writer_unlock (&demux->metadata_lock);
+
   g_list_foreach (demux->partitions, (GFunc) gst_mxf_demux_partition_free,
       NULL);
   g_list_free (demux->partitions);
@@ -227,6 +245,7 @@ gst_mxf_demux_reset_metadata (GstMXFDemux * demux)
     g_hash_table_destroy (demux->metadata);
   }
   demux->metadata = mxf_metadata_hash_table_new ();
+  g_ptr_array_set_size (demux->pending_descriptive_metadata, 0);
 
   if (demux->tags) {
     gst_tag_list_unref (demux->tags);
@@ -245,6 +264,7 @@ gst_mxf_demux_reset (GstMXFDemux * demux)
 
   demux->footer_partition_pack_offset = 0;
   demux->offset = 0;
+  gst_mxf_demux_clear_readahead (demux);
 
   demux->pull_footer_metadata = TRUE;
 
@@ -301,11 +321,79 @@ gst_mxf_demux_reset (GstMXFDemux * demux)
   demux->group_id = G_MAXUINT;
 }
 
+static void
+gst_mxf_demux_clear_readahead (GstMXFDemux * demux)
+{
+  gst_buffer_replace (&demux->readahead_buffer, NULL);
+  demux->readahead_offset = 0;
+}
+
+static gboolean
+gst_mxf_demux_readahead_contains (GstMXFDemux * demux, guint64 offset,
+    guint size)
+{
+  return demux->readahead_buffer != NULL &&
+      offset >= demux->readahead_offset &&
+      offset + size <= demux->readahead_offset +
+      gst_buffer_get_size (demux->readahead_buffer);
+}
+
+/* Refill the read-ahead window starting at @offset, clamped to the end of
+ * the file as upstream might not do short reads */
+static void
+gst_mxf_demux_fill_readahead (GstMXFDemux * demux, guint64 offset,
+    guint window)
+{
+  GstBuffer *buffer = NULL;
+  gint64 filesize;
+
+  gst_mxf_demux_clear_readahead (demux);
+
+  if (gst_pad_peer_query_duration (demux->sinkpad, GST_FORMAT_BYTES,
+          &filesize) && filesize > 0) {
+    if (offset >= filesize)
+      return;
+    window = MIN (window, filesize - offset);
+  }
+
+  if (gst_pad_pull_range (demux->sinkpad, offset, window,
+          &buffer) != GST_FLOW_OK)
+    return;
+
+  GST_LOG_OBJECT (demux, "Read %" G_GSIZE_FORMAT " bytes ahead from offset %"
+      G_GUINT64_FORMAT, gst_buffer_get_size (buffer), offset);
+  demux->readahead_buffer = buffer;
+  demux->readahead_offset = offset;
+}
+
 static GstFlowReturn
 gst_mxf_demux_pull_range (GstMXFDemux * demux, guint64 offset,
     guint size, GstBuffer ** buffer)
 {
   GstFlowReturn ret;
+  guint readahead_size;
+
+  GST_OBJECT_LOCK (demux);
+  readahead_size = demux->readahead_size;
+  GST_OBJECT_UNLOCK (demux);
+
+  /* KLV keys, lengths and the values of all the elements of a content
+   * package are usually next to each other, so serve them as sub-buffers of
+   * one larger read instead of pulling each of them separately */
+  if (size < readahead_size) {
+    if (!gst_mxf_demux_readahead_contains (demux, offset, size))
+      gst_mxf_demux_fill_readahead (demux, offset, readahead_size);
+
+    if (gst_mxf_demux_readahead_contains (demux, offset, size)) {
+      *buffer = gst_buffer_copy_region (demux->readahead_buffer,
+          GST_BUFFER_COPY_MEMORY, offset - demux->readahead_offset, size);
+      GST_BUFFER_OFFSET (*buffer) = offset;
+      GST_BUFFER_OFFSET_END (*buffer) = offset + size;
+      return GST_FLOW_OK;
+    }
+
+    /* Otherwise pull directly below, which reports the error */
+  }
 
   ret = gst_pad_pull_range (demux->sinkpad, offset, size, buffer);
   if (G_UNLIKELY (ret != GST_FLOW_OK)) {
@@ -522,22 +610,20 @@ gst_mxf_demux_resolve_references (GstMXFDemux * demux)
     m->resolved = MXF_METADATA_BASE_RESOLVE_STATE_NONE;
   }
 
-  g_hash_table_iter_init (&iter, demux->metadata);
-  while (g_hash_table_iter_next (&iter, NULL, (gpointer) & m)) {
-    gboolean resolved;
-
-    resolved = mxf_metadata_base_resolve (m, demux->metadata);
-
-    /* Resolving can fail for anything but the preface, as the preface
-     * will resolve everything required */
-    if (!resolved && MXF_IS_METADATA_PREFACE (m)) {
-      ret = GST_FLOW_ERROR;
-      goto error;
-    }
+  /* Only resolve what is reachable from the preface, that's everything
+   * required for setting up the tracks. Sets nobody references are left
+   * alone. */
+  if (!demux->preface
+      || !mxf_metadata_base_resolve (MXF_METADATA_BASE (demux->preface),
+          demux->metadata)) {
+    ret = GST_FLOW_ERROR;
+    goto error;
   }
 
   demux->metadata_resolved = TRUE;
 
+  /* Descriptive metadata that is still pending is left out here, the tag
+   * is posted again once it was parsed */
   structure =
       mxf_metadata_base_to_structure (MXF_METADATA_BASE (demux->preface));
   if (!demux->tags)
@@ -1436,11 +1522,9 @@ static GstFlowReturn
 gst_mxf_demux_handle_descriptive_metadata (GstMXFDemux * demux,
     const MXFUL * key, GstBuffer * buffer)
 {
+  GstMXFDemuxDescriptiveMetadata *dm;
   guint32 type;
   guint8 scheme;
-  GstMapInfo map;
-  GstFlowReturn ret = GST_FLOW_OK;
-  MXFDescriptiveMetadata *m = NULL, *old = NULL;
 
   scheme = GST_READ_UINT8 (key->u + 12);
   type = GST_READ_UINT24_BE (key->u + 13);
@@ -1465,59 +1549,115 @@ gst_mxf_demux_handle_descriptive_metadata (GstMXFDemux * demux,
     return GST_FLOW_OK;
   }
 
-  gst_buffer_map (buffer, &map, GST_MAP_READ);
-  m = mxf_descriptive_metadata_new (scheme, type,
-      &demux->current_partition->primer, demux->offset, map.data, map.size);
-  gst_buffer_unmap (buffer, &map);
+  /* Descriptive metadata is not needed for setting up the tracks, keep it
+   * around as is and only parse it when the metadata is requested */
+  dm = g_new0 (GstMXFDemuxDescriptiveMetadata, 1);
+  dm->scheme = scheme;
+  dm->type = type;
+  dm->primer = &demux->current_partition->primer;
+  dm->offset = demux->offset;
+  dm->buffer = gst_buffer_ref (buffer);
 
-  if (!m) {
-    GST_WARNING_OBJECT (demux,
-        "Unknown or unhandled descriptive metadata of scheme 0x%02x and type 0x%06x",
-        scheme, type);
-    return GST_FLOW_OK;
+  g_rw_lock_writer_lock (&demux->metadata_lock);
+  /* A closed and complete partition repeats all of the header metadata, so
+   * what is still pending from other partitions is superseded */
+  if (demux->current_partition->partition.closed
+      && demux->current_partition->partition.complete) {
+    guint i = 0;
+
+    while (i < demux->pending_descriptive_metadata->len) {
+      GstMXFDemuxDescriptiveMetadata *other =
+          g_ptr_array_index (demux->pending_descriptive_metadata, i);
+
+      if (other->primer != dm->primer)
+        g_ptr_array_remove_index_fast (demux->pending_descriptive_metadata,
+            i);
+      else
+        i++;
+    }
   }
+  g_ptr_array_add (demux->pending_descriptive_metadata, dm);
+  g_rw_lock_writer_unlock (&demux->metadata_lock);
 
-  old =
-      g_hash_table_lookup (demux->metadata,
-      &MXF_METADATA_BASE (m)->instance_uid);
+  return GST_FLOW_OK;
+}
 
-  if (old && G_TYPE_FROM_INSTANCE (old) != G_TYPE_FROM_INSTANCE (m)) {
-#ifndef GST_DISABLE_GST_DEBUG
-    gchar str[48];
-#endif
+/* Must be called with the metadata lock taken for writing. Returns TRUE if
+ * there was pending descriptive metadata */
+static gboolean
+gst_mxf_demux_parse_descriptive_metadata (GstMXFDemux * demux)
+{
+  GHashTableIter iter;
+  MXFMetadataBase *m = NULL;
+  guint i;
 
-    GST_DEBUG_OBJECT (demux,
-        "Metadata with instance uid %s already exists and has different type '%s',"
-        " expected '%s'",
-        mxf_uuid_to_string (&MXF_METADATA_BASE (m)->instance_uid, str),
-        g_type_name (G_TYPE_FROM_INSTANCE (old)),
-        g_type_name (G_TYPE_FROM_INSTANCE (m)));
-    g_object_unref (m);
-    return GST_FLOW_ERROR;
-  } else if (old
-      && MXF_METADATA_BASE (old)->offset >= MXF_METADATA_BASE (m)->offset) {
+  if (demux->pending_descriptive_metadata->len == 0)
+    return FALSE;
+
+  GST_DEBUG_OBJECT (demux, "Parsing %u descriptive metadata sets",
+      demux->pending_descriptive_metadata->len);
+
+  for (i = 0; i < demux->pending_descriptive_metadata->len; i++) {
+    GstMXFDemuxDescriptiveMetadata *dm =
+        g_ptr_array_index (demux->pending_descriptive_metadata, i);
+    MXFDescriptiveMetadata *d, *old;
+    GstMapInfo map;
 #ifndef GST_DISABLE_GST_DEBUG
     gchar str[48];
 #endif
 
-    GST_DEBUG_OBJECT (demux,
-        "Metadata with instance uid %s already exists and is newer",
-        mxf_uuid_to_string (&MXF_METADATA_BASE (m)->instance_uid, str));
-    g_object_unref (m);
-    return GST_FLOW_OK;
-  }
+    if (!gst_buffer_map (dm->buffer, &map, GST_MAP_READ)) {
+      GST_WARNING_OBJECT (demux, "Failed to map descriptive metadata");
+      continue;
+    }
+    d = mxf_descriptive_metadata_new (dm->scheme, dm->type, dm->primer,
+        dm->offset, map.data, map.size);
+    gst_buffer_unmap (dm->buffer, &map);
+    if (!d) {
+      GST_WARNING_OBJECT (demux,
+          "Unknown or unhandled descriptive metadata of scheme 0x%02x and type 0x%06x",
+          dm->scheme, dm->type);
+      continue;
+    }
 
-  g_rw_lock_writer_lock (&demux->metadata_lock);
+    old =
+        g_hash_table_lookup (demux->metadata,
+        &MXF_METADATA_BASE (d)->instance_uid);
 
-  demux->update_metadata = TRUE;
-  gst_mxf_demux_reset_linked_metadata (demux);
+    if (old && G_TYPE_FROM_INSTANCE (old) != G_TYPE_FROM_INSTANCE (d)) {
+      GST_DEBUG_OBJECT (demux,
+          "Metadata with instance uid %s already exists and has different type '%s',"
+          " expected '%s'",
+          mxf_uuid_to_string (&MXF_METADATA_BASE (d)->instance_uid, str),
+          g_type_name (G_TYPE_FROM_INSTANCE (old)),
+          g_type_name (G_TYPE_FROM_INSTANCE (d)));
+      g_object_unref (d);
+      continue;
+    } else if (old
+        && MXF_METADATA_BASE (old)->offset >= MXF_METADATA_BASE (d)->offset) {
+      GST_DEBUG_OBJECT (demux,
+          "Metadata with instance uid %s already exists and is newer",
+          mxf_uuid_to_string (&MXF_METADATA_BASE (d)->instance_uid, str));
+      g_object_unref (d);
+      continue;
+    }
 
-  g_hash_table_replace (demux->metadata, &MXF_METADATA_BASE (m)->instance_uid,
-      m);
+    g_hash_table_replace (demux->metadata,
+        &MXF_METADATA_BASE (d)->instance_uid, d);
+  }
+  g_ptr_array_set_size (demux->pending_descriptive_metadata, 0);
 
-  g_rw_lock_writer_unlock (&demux->metadata_lock);
+  /* Link the DM segments to their now available frameworks */
+  g_hash_table_iter_init (&iter, demux->metadata);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer) & m)) {
+    if (MXF_IS_METADATA_DM_SEGMENT (m)
+        && m->resolved == MXF_METADATA_BASE_RESOLVE_STATE_SUCCESS) {
+      m->resolved = MXF_METADATA_BASE_RESOLVE_STATE_NONE;
+      mxf_metadata_base_resolve (m, demux->metadata);
+    }
+  }
 
-  return ret;
+  return TRUE;
 }
 
 static GstFlowReturn
@@ -1681,6 +1821,56 @@ gst_mxf_demux_pad_set_component (GstMXFDemux * demux, GstMXFDemuxPad * pad,
   return ret;
 }
 
+static GstMXFDemuxIndexTable *
+gst_mxf_demux_find_index_table (GstMXFDemux * demux, guint32 body_sid,
+    guint32 index_sid)
+{
+  GList *l;
+
+  for (l = demux->index_tables; l; l = l->next) {
+    GstMXFDemuxIndexTable *tmp = l->data;
+
+    if (tmp->body_sid == body_sid && tmp->index_sid == index_sid)
+      return tmp;
+  }
+
+  return NULL;
+}
+
+/* Returns the edit unit of the content package containing @offset, which
+ * is the last one starting at or before it, or -1 if the index table has no
+ * such edit unit. Offsets are increasing in DTS order, entries without an
+ * offset are skipped. */
+static gint64
+gst_mxf_demux_index_table_find_position (GstMXFDemuxIndexTable * index_table,
+    guint64 offset)
+{
+  GArray *offsets = index_table->offsets;
+  guint lo = 0, hi = offsets->len;
+  gint64 found = -1;
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+    guint i = mid;
+    GstMXFDemuxIndex *idx;
+
+    while (i > lo && g_array_index (offsets, GstMXFDemuxIndex, i).offset == 0)
+      i--;
+    idx = &g_array_index (offsets, GstMXFDemuxIndex, i);
+
+    if (idx->offset == 0) {
+      lo = mid + 1;
+    } else if (idx->offset > offset) {
+      hi = i;
+    } else {
+      found = i;
+      lo = mid + 1;
+    }
+  }
+
+  return found;
+}
+
 static GstFlowReturn
 gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
     const MXFUL * key, GstBuffer * buffer, gboolean peek)
@@ -1760,6 +1950,19 @@ gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
       }
     }
 
+    /* After seeking directly to an edit unit from the index table nothing
+     * was generated yet, but the index table tells the content package */
+    if (etrack->position == -1 && demux->index_tables) {
+      GstMXFDemuxIndexTable *index_table =
+          gst_mxf_demux_find_index_table (demux, etrack->body_sid,
+          etrack->index_sid);
+
+      if (index_table)
+        etrack->position =
+            gst_mxf_demux_index_table_find_position (index_table,
+            demux->offset - demux->run_in);
+    }
+
     if (etrack->position == -1) {
       GST_WARNING_OBJECT (demux, "Essence track position not in index");
       return GST_FLOW_OK;
@@ -1811,18 +2014,9 @@ gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
 
   /* Prefer keyframe information from index tables over everything else */
   if (demux->index_tables) {
-    GList *l;
-    GstMXFDemuxIndexTable *index_table = NULL;
-
-    for (l = demux->index_tables; l; l = l->next) {
-      GstMXFDemuxIndexTable *tmp = l->data;
-
-      if (tmp->body_sid == etrack->body_sid
-          && tmp->index_sid == etrack->index_sid) {
-        index_table = tmp;
-        break;
-      }
-    }
+    GstMXFDemuxIndexTable *index_table =
+        gst_mxf_demux_find_index_table (demux, etrack->body_sid,
+        etrack->index_sid);
 
     if (index_table && index_table->offsets->len > etrack->position) {
       GstMXFDemuxIndex *index =
@@ -2825,19 +3019,10 @@ gst_mxf_demux_find_essence_element (GstMXFDemux * demux,
       " of track %u with body_sid %u (keyframe %d)", *position,
       etrack->track_number, etrack->body_sid, keyframe);
 
-  if (demux->index_tables) {
-    GList *l;
-
-    for (l = demux->index_tables; l; l = l->next) {
-      GstMXFDemuxIndexTable *tmp = l->data;
-
-      if (tmp->body_sid == etrack->body_sid
-          && tmp->index_sid == etrack->index_sid) {
-        index_table = tmp;
-        break;
-      }
-    }
-  }
+  if (demux->index_tables)
+    index_table =
+        gst_mxf_demux_find_index_table (demux, etrack->body_sid,
+        etrack->index_sid);
 
 from_index:
 
@@ -2880,6 +3065,24 @@ from_index:
   } else if (demux->random_access) {
     gint64 index_start_position = *position;
 
+    /* If the index table has the requested edit unit that's where its
+     * content package starts, no need to walk there from the closest
+     * keyframe. The essence element handler gets the track positions from
+     * the index table then. */
+    if (index_table) {
+      gint64 index_position = *position;
+
+      offset = find_offset (index_table->offsets, &index_position, keyframe);
+      if (offset != -1) {
+        GST_DEBUG_OBJECT (demux,
+            "Found edit unit %" G_GINT64_FORMAT " for %" G_GINT64_FORMAT
+            " in index at offset %" G_GUINT64_FORMAT, index_position,
+            requested_position, offset);
+        *position = index_position;
+        return offset;
+      }
+    }
+
     demux->offset = demux->run_in;
 
     offset =
@@ -4239,8 +4442,12 @@ gst_mxf_demux_sink_activate_mode (GstPad * sinkpad, GstObject * parent,
       return gst_pad_start_task (sinkpad, (GstTaskFunction) gst_mxf_demux_loop,
           sinkpad, NULL);
     } else {
+      gboolean ret;
+
       demux->random_access = FALSE;
-      return gst_pad_stop_task (sinkpad);
+      ret = gst_pad_stop_task (sinkpad);
+      gst_mxf_demux_clear_readahead (demux);
+      return ret;
     }
   }
 
@@ -4549,6 +4756,11 @@ gst_mxf_demux_set_property (GObject * object, guint prop_id,
     case PROP_MAX_DRIFT:
       demux->max_drift = g_value_get_uint64 (value);
       break;
+    case PROP_READ_AHEAD_SIZE:
+      GST_OBJECT_LOCK (demux);
+      demux->readahead_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (demux);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -4568,10 +4780,18 @@ gst_mxf_demux_get_property (GObject * object, guint prop_id,
     case PROP_MAX_DRIFT:
       g_value_set_uint64 (value, demux->max_drift);
       break;
+    case PROP_READ_AHEAD_SIZE:
+      GST_OBJECT_LOCK (demux);
+      g_value_set_uint (value, demux->readahead_size);
+      GST_OBJECT_UNLOCK (demux);
+      break;
     case PROP_STRUCTURE:{
       GstStructure *s;
+      GstTagList *tags = NULL;
+      gboolean parsed;
 
-      g_rw_lock_reader_lock (&demux->metadata_lock);
+      g_rw_lock_writer_lock (&demux->metadata_lock);
+      parsed = gst_mxf_demux_parse_descriptive_metadata (demux);
       if (demux->preface &&
           MXF_METADATA_BASE (demux->preface)->resolved ==
           MXF_METADATA_BASE_RESOLVE_STATE_SUCCESS)
@@ -4579,12 +4799,23 @@ gst_mxf_demux_get_property (GObject * object, guint prop_id,
       else
         s = NULL;
 
+      /* The structure tag was built without the descriptive metadata that
+       * was pending, update it and post it again */
+      if (parsed && s && demux->tags) {
+        gst_tag_list_add (demux->tags, GST_TAG_MERGE_REPLACE,
+            GST_TAG_MXF_STRUCTURE, s, NULL);
+        tags = gst_tag_list_new (GST_TAG_MXF_STRUCTURE, s, NULL);
+      }
+      g_rw_lock_writer_unlock (&demux->metadata_lock);
+
       gst_value_set_structure (value, s);
 
       if (s)
         gst_structure_free (s);
 
-      g_rw_lock_reader_unlock (&demux->metadata_lock);
+      if (tags)
+        gst_element_post_message (GST_ELEMENT_CAST (demux),
+            gst_message_new_tag (GST_OBJECT_CAST (demux), tags));
       break;
     }
     default:
@@ -4626,6 +4857,7 @@ gst_mxf_demux_finalize (GObject * object)
   demux->essence_tracks = NULL;
 
   g_hash_table_destroy (demux->metadata);
+  g_ptr_array_free (demux->pending_descriptive_metadata, TRUE);
 
   g_rw_lock_clear (&demux->metadata_lock);
 
@@ -4662,6 +4894,23 @@ gst_mxf_demux_class_init (GstMXFDemuxClass * klass)
           "Structural metadata of the MXF file",
           GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstMXFDemux:read-ahead-size:
+   *
+   * In pull mode, read this many bytes at once and parse the KLV packets
+   * from that window, instead of issuing separate small reads for the key,
+   * length and value of every packet. Mostly useful on network storage.
+   * Essence buffers reference the window, so larger values keep more
+   * memory alive while buffers are queued downstream. 0 disables.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_READ_AHEAD_SIZE,
+      g_param_spec_uint ("read-ahead-size", "Read ahead size",
+          "Number of bytes to read ahead in pull mode (0 = disabled)",
+          0, 256 * 1024 * 1024, DEFAULT_READ_AHEAD_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_mxf_demux_change_state);
   gstelement_class->query = GST_DEBUG_FUNCPTR (gst_mxf_demux_query);
@@ -4693,12 +4942,16 @@ gst_mxf_demux_init (GstMXFDemux * demux)
   gst_element_add_pad (GST_ELEMENT (demux), demux->sinkpad);
 
   demux->max_drift = 500 * GST_MSECOND;
+  demux->readahead_size = DEFAULT_READ_AHEAD_SIZE;
 
   demux->adapter = gst_adapter_new ();
   demux->flowcombiner = gst_flow_combiner_new ();
   g_rw_lock_init (&demux->metadata_lock);
 
   demux->src = g_ptr_array_new ();
+  demux->pending_descriptive_metadata =
+      g_ptr_array_new_with_free_func ((GDestroyNotify)
+      gst_mxf_demux_descriptive_metadata_free);
   demux->essence_tracks =
       g_array_new (FALSE, FALSE, sizeof (GstMXFDemuxEssenceTrack));
 
@@ -57,6 +57,16 @@ typedef struct
   guint64 essence_container_offset;
 } GstMXFDemuxPartition;
 
+/* Unparsed descriptive metadata set */
+typedef struct
+{
+  guint8 scheme;
+  guint32 type;
+  MXFPrimerPack *primer;
+  guint64 offset;
+  GstBuffer *buffer;
+} GstMXFDemuxDescriptiveMetadata;
+
 typedef struct
 {
   guint32 body_sid;
@@ -170,6 +180,10 @@ struct _GstMXFDemux
 
   guint64 offset;
 
+  /* Read-ahead window in pull mode, small reads are served from it */
+  GstBuffer *readahead_buffer;
+  guint64 readahead_offset;
+
   gboolean random_access;
   gboolean flushing;
 
@@ -198,6 +212,8 @@ struct _GstMXFDemux
   gboolean metadata_resolved;
   MXFMetadataPreface *preface;
   GHashTable *metadata;
+  /* GstMXFDemuxDescriptiveMetadata, only parsed when requested */
+  GPtrArray *pending_descriptive_metadata;
 
   MXFUMID current_package_uid;
   MXFMetadataGenericPackage *current_package;
@@ -208,6 +224,7 @@ struct _GstMXFDemux
   /* Properties */
   gchar *requested_package_string;
   GstClockTime max_drift;
+  guint readahead_size;
 };
 
 struct _GstMXFDemuxClass
@@ -3786,6 +3786,10 @@ mxf_metadata_dm_segment_resolve (MXFMetadataBase * m, GHashTable * metadata)
   gchar str[48];
 #endif
 
+  self->dm_framework = NULL;
+
+  /* The framework is optional for everything but the descriptive metadata
+   * itself, which might not have been parsed yet */
   current = g_hash_table_lookup (metadata, &self->dm_framework_uid);
   if (current && MXF_IS_DESCRIPTIVE_METADATA_FRAMEWORK (current)) {
     if (mxf_metadata_base_resolve (current, metadata)) {
@@ -3796,9 +3800,8 @@ mxf_metadata_dm_segment_resolve (MXFMetadataBase * m, GHashTable * metadata)
       return FALSE;
     }
   } else {
-    GST_ERROR ("Couldn't find DM framework %s",
+    GST_DEBUG ("Couldn't find DM framework %s",
         mxf_uuid_to_string (&self->dm_framework_uid, str));
-    return FALSE;
   }
 
 
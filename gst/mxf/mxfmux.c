@@ -28,6 +28,11 @@
  * gst-launch-1.0 -v filesrc location=/path/to/audio ! decodebin ! queue ! mxfmux name=m ! filesink location=file.mxf   filesrc location=/path/to/video ! decodebin ! queue ! m.
  * ]| This pipeline muxes an audio and video file into a single MXF file.
  *
+ * If #GstMXFMux:partition-interval is set, a new body partition is started
+ * periodically. Each of them repeats the header metadata and carries the
+ * index table segments collected since the previous one, so the file can be
+ * opened while it is still being written.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -115,13 +120,20 @@ static GstStaticPadTemplate src_templ = GST_STATIC_PAD_TEMPLATE ("src",
 
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_PARTITION_INTERVAL
 };
 
+#define DEFAULT_PARTITION_INTERVAL 0
+
 #define gst_mxf_mux_parent_class parent_class
 G_DEFINE_TYPE (GstMXFMux, gst_mxf_mux, GST_TYPE_AGGREGATOR);
 
 static void gst_mxf_mux_finalize (GObject * object);
+static void gst_mxf_mux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_mxf_mux_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static GstFlowReturn gst_mxf_mux_aggregate (GstAggregator * aggregator,
     gboolean timeout);
@@ -163,6 +175,24 @@ gst_mxf_mux_class_init (GstMXFMuxClass * klass)
   gstaggregator_class = (GstAggregatorClass *) klass;
 
   gobject_class->finalize = gst_mxf_mux_finalize;
+  gobject_class->set_property = gst_mxf_mux_set_property;
+  gobject_class->get_property = gst_mxf_mux_get_property;
+
+  /**
+   * GstMXFMux:partition-interval:
+   *
+   * Start a new body partition at the first keyframe after this much time
+   * has been written to the current one. Every body partition repeats the
+   * header metadata and carries the index table segments of the previous
+   * partitions, which are then released. 0 writes a single body partition.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_PARTITION_INTERVAL,
+      g_param_spec_uint64 ("partition-interval", "Partition interval",
+          "Interval in nanoseconds between body partitions (0 = disabled)",
+          0, G_MAXUINT64, DEFAULT_PARTITION_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstaggregator_class->create_new_pad =
       GST_DEBUG_FUNCPTR (gst_mxf_mux_create_new_pad);
@@ -191,6 +221,9 @@ static void
 gst_mxf_mux_init (GstMXFMux * mux)
 {
   mux->index_table = g_array_new (FALSE, FALSE, sizeof (MXFIndexTableSegment));
+  mux->body_partitions =
+      g_array_new (FALSE, FALSE, sizeof (MXFRandomIndexPackEntry));
+  mux->partition_interval = DEFAULT_PARTITION_INTERVAL;
   gst_mxf_mux_reset (mux);
 }
 
@@ -217,14 +250,66 @@ gst_mxf_mux_finalize (GObject * object)
     mux->index_table = NULL;
   }
 
+  if (mux->body_partitions) {
+    g_array_free (mux->body_partitions, TRUE);
+    mux->body_partitions = NULL;
+  }
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_mxf_mux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstMXFMux *mux = GST_MXF_MUX (object);
+
+  switch (prop_id) {
+    case PROP_PARTITION_INTERVAL:
+      GST_OBJECT_LOCK (mux);
+      mux->partition_interval = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (mux);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_mxf_mux_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstMXFMux *mux = GST_MXF_MUX (object);
+
+  switch (prop_id) {
+    case PROP_PARTITION_INTERVAL:
+      GST_OBJECT_LOCK (mux);
+      g_value_set_uint64 (value, mux->partition_interval);
+      GST_OBJECT_UNLOCK (mux);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_mxf_mux_clear_index_table (GstMXFMux * mux)
+{
+  gsize n;
+
+  for (n = 0; n < mux->index_table->len; ++n)
+    g_free (g_array_index (mux->index_table, MXFIndexTableSegment,
+            n).index_entries);
+  g_array_set_size (mux->index_table, 0);
+  mux->current_index_pos = 0;
+}
+
 static void
 gst_mxf_mux_reset (GstMXFMux * mux)
 {
   GList *l;
-  gsize n;
 
   GST_OBJECT_LOCK (mux);
   for (l = GST_ELEMENT_CAST (mux)->sinkpads; l; l = l->next) {
@@ -261,13 +346,12 @@ gst_mxf_mux_reset (GstMXFMux * mux)
   mux->last_gc_position = 0;
   mux->offset = 0;
 
-  if (mux->index_table)
-    for (n = 0; n < mux->index_table->len; ++n)
-      g_free (g_array_index (mux->index_table, MXFIndexTableSegment,
-              n).index_entries);
-  g_array_set_size (mux->index_table, 0);
-  mux->current_index_pos = 0;
+  gst_mxf_mux_clear_index_table (mux);
+  mux->index_start_position = 0;
   mux->last_keyframe_pos = 0;
+
+  g_array_set_size (mux->body_partitions, 0);
+  mux->partition_start = 0;
 }
 
 static gboolean
@@ -1205,6 +1289,38 @@ static const guint8 _gc_essence_element_ul[] = {
   0x0d, 0x01, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00
 };
 
+static void
+gst_mxf_mux_append_index_segment (GstMXFMux * mux, GstMXFMuxPad * pad,
+    gint max_segment_size)
+{
+  MXFIndexTableSegment s;
+
+  memset (&s, 0, sizeof (s));
+
+  mxf_uuid_init (&s.instance_id, mux->metadata);
+  memcpy (&s.index_edit_rate, &pad->source_track->edit_rate,
+      sizeof (s.index_edit_rate));
+  /* All segments but the last one are filled up completely */
+  s.index_start_position =
+      mux->index_start_position + mux->index_table->len * max_segment_size;
+  s.index_duration = 0;
+  s.edit_unit_byte_count = 0;
+  s.index_sid =
+      mux->preface->content_storage->essence_container_data[0]->index_sid;
+  s.body_sid =
+      mux->preface->content_storage->essence_container_data[0]->body_sid;
+  s.slice_count = 0;
+  s.pos_table_count = 0;
+  s.n_delta_entries = 0;
+  s.delta_entries = NULL;
+  s.n_index_entries = 0;
+  s.index_entries = g_new0 (MXFIndexEntry, max_segment_size);
+  g_array_append_val (mux->index_table, s);
+}
+
+static GstFlowReturn gst_mxf_mux_start_body_partition (GstMXFMux * mux,
+    GstMXFMuxPad * pad);
+
 static GstFlowReturn
 gst_mxf_mux_handle_buffer (GstMXFMux * mux, GstMXFMuxPad * pad)
 {
@@ -1265,6 +1381,25 @@ gst_mxf_mux_handle_buffer (GstMXFMux * mux, GstMXFMuxPad * pad)
   if (buf == NULL)
     return ret;
 
+  /* The first essence stream is written first in every content package, so
+   * new body partitions are started right before one of its keyframes */
+  if (pad == (GstMXFMuxPad *) GST_ELEMENT_CAST (mux)->sinkpads->data
+      && is_keyframe && pad->pos > 0) {
+    GstClockTime partition_interval;
+
+    GST_OBJECT_LOCK (mux);
+    partition_interval = mux->partition_interval;
+    GST_OBJECT_UNLOCK (mux);
+
+    if (partition_interval > 0
+        && pad->last_timestamp >= mux->partition_start + partition_interval) {
+      if ((ret = gst_mxf_mux_start_body_partition (mux, pad)) != GST_FLOW_OK) {
+        gst_buffer_unref (buf);
+        return ret;
+      }
+    }
+  }
+
   /* We currently only index the first essence stream */
   if (pad == (GstMXFMuxPad *) GST_ELEMENT_CAST (mux)->sinkpads->data) {
     MXFIndexTableSegment *segment;
@@ -1277,34 +1412,8 @@ gst_mxf_mux_handle_buffer (GstMXFMux * mux, GstMXFMuxPad * pad)
       if (mux->index_table->len > 0)
         mux->current_index_pos++;
 
-      if (mux->index_table->len <= mux->current_index_pos) {
-        MXFIndexTableSegment s;
-
-        memset (&segment, 0, sizeof (segment));
-
-        mxf_uuid_init (&s.instance_id, mux->metadata);
-        memcpy (&s.index_edit_rate, &pad->source_track->edit_rate,
-            sizeof (s.index_edit_rate));
-        if (mux->index_table->len > 0)
-          s.index_start_position =
-              g_array_index (mux->index_table, MXFIndexTableSegment,
-              mux->index_table->len - 1).index_start_position;
-        else
-          s.index_start_position = 0;
-        s.index_duration = 0;
-        s.edit_unit_byte_count = 0;
-        s.index_sid =
-            mux->preface->content_storage->essence_container_data[0]->index_sid;
-        s.body_sid =
-            mux->preface->content_storage->essence_container_data[0]->body_sid;
-        s.slice_count = 0;
-        s.pos_table_count = 0;
-        s.n_delta_entries = 0;
-        s.delta_entries = NULL;
-        s.n_index_entries = 0;
-        s.index_entries = g_new0 (MXFIndexEntry, max_segment_size);
-        g_array_append_val (mux->index_table, s);
-      }
+      if (mux->index_table->len <= mux->current_index_pos)
+        gst_mxf_mux_append_index_segment (mux, pad, max_segment_size);
     }
     segment =
         &g_array_index (mux->index_table, MXFIndexTableSegment,
@@ -1332,36 +1441,8 @@ gst_mxf_mux_handle_buffer (GstMXFMux * mux, GstMXFMuxPad * pad)
           pts_segment_pos = 0;
           pts_index_pos++;
 
-          if (pts_index_pos >= mux->index_table->len) {
-            MXFIndexTableSegment s;
-
-            memset (&segment, 0, sizeof (segment));
-
-            mxf_uuid_init (&s.instance_id, mux->metadata);
-            memcpy (&s.index_edit_rate, &pad->source_track->edit_rate,
-                sizeof (s.index_edit_rate));
-            if (mux->index_table->len > 0)
-              s.index_start_position =
-                  g_array_index (mux->index_table, MXFIndexTableSegment,
-                  mux->index_table->len - 1).index_start_position;
-            else
-              s.index_start_position = 0;
-            s.index_duration = 0;
-            s.edit_unit_byte_count = 0;
-            s.index_sid =
-                mux->preface->content_storage->
-                essence_container_data[0]->index_sid;
-            s.body_sid =
-                mux->preface->content_storage->
-                essence_container_data[0]->body_sid;
-            s.slice_count = 0;
-            s.pos_table_count = 0;
-            s.n_delta_entries = 0;
-            s.delta_entries = NULL;
-            s.n_index_entries = 0;
-            s.index_entries = g_new0 (MXFIndexEntry, max_segment_size);
-            g_array_append_val (mux->index_table, s);
-          }
+          if (pts_index_pos >= mux->index_table->len)
+            gst_mxf_mux_append_index_segment (mux, pad, max_segment_size);
         }
       } else {
         while (pts_segment_pos + index_pos_diff <= 0) {
@@ -1432,6 +1513,7 @@ static GstFlowReturn
 gst_mxf_mux_write_body_partition (GstMXFMux * mux)
 {
   GstBuffer *buf;
+  MXFRandomIndexPackEntry entry;
 
   mux->partition.type = MXF_PARTITION_PACK_BODY;
   mux->partition.closed = TRUE;
@@ -1446,64 +1528,19 @@ gst_mxf_mux_write_body_partition (GstMXFMux * mux)
   mux->partition.body_sid =
       mux->preface->content_storage->essence_container_data[0]->body_sid;
 
+  entry.offset = mux->partition.this_partition;
+  entry.body_sid = mux->partition.body_sid;
+  g_array_append_val (mux->body_partitions, entry);
+  mux->partition_start = 0;
+
   buf = mxf_partition_pack_to_buffer (&mux->partition);
   return gst_mxf_mux_push (mux, buf);
 }
 
-static GstFlowReturn
-gst_mxf_mux_handle_eos (GstMXFMux * mux)
+static void
+gst_mxf_mux_update_durations (GstMXFMux * mux)
 {
   GList *l;
-  gboolean have_data = FALSE;
-  GstBuffer *packet;
-
-  do {
-    GstMXFMuxPad *best = NULL;
-
-    have_data = FALSE;
-
-    GST_OBJECT_LOCK (mux);
-    for (l = GST_ELEMENT_CAST (mux)->sinkpads; l; l = l->next) {
-      GstMXFMuxPad *pad = l->data;
-      GstBuffer *buffer =
-          gst_aggregator_pad_peek_buffer (GST_AGGREGATOR_PAD (pad));
-
-      GstClockTime next_gc_timestamp =
-          gst_util_uint64_scale ((mux->last_gc_position + 1) * GST_SECOND,
-          mux->min_edit_rate.d, mux->min_edit_rate.n);
-
-      if (pad->have_complete_edit_unit ||
-          gst_adapter_available (pad->adapter) > 0 || buffer) {
-        have_data = TRUE;
-        if (pad->last_timestamp < next_gc_timestamp) {
-          best = gst_object_ref (pad);
-          if (buffer)
-            gst_buffer_unref (buffer);
-          break;
-        }
-      }
-      if (buffer)
-        gst_buffer_unref (buffer);
-
-      if (have_data && !l->next) {
-        mux->last_gc_position++;
-        mux->last_gc_timestamp = next_gc_timestamp;
-        break;
-      }
-    }
-    GST_OBJECT_UNLOCK (mux);
-
-    if (best) {
-      gst_mxf_mux_handle_buffer (mux, best);
-      gst_object_unref (best);
-      have_data = TRUE;
-    }
-  } while (have_data);
-
-  mux->last_gc_position++;
-  mux->last_gc_timestamp =
-      gst_util_uint64_scale (mux->last_gc_position * GST_SECOND,
-      mux->min_edit_rate.d, mux->min_edit_rate.n);
 
   /* Update essence track durations */
   GST_OBJECT_LOCK (mux);
@@ -1562,10 +1599,146 @@ gst_mxf_mux_handle_eos (GstMXFMux * mux)
     sequence->duration = mux->last_gc_position;
     component->parent.duration = mux->last_gc_position;
   }
+}
+
+static GstFlowReturn
+gst_mxf_mux_start_body_partition (GstMXFMux * mux, GstMXFMuxPad * pad)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  MXFRandomIndexPackEntry entry;
+  GList *index_entries = NULL, *l;
+  guint64 index_byte_count = 0;
+  guint i;
+
+  GST_DEBUG_OBJECT (mux, "Starting new body partition at offset %"
+      G_GUINT64_FORMAT " and position %" G_GUINT64_FORMAT, mux->offset,
+      pad->pos);
+
+  /* Everything indexed so far goes into this partition. Entries for the
+   * next edit units start a new segment, temporal offsets pointing back
+   * into the segments written here are lost. */
+  for (i = 0; i < mux->index_table->len; i++) {
+    MXFIndexTableSegment *segment =
+        &g_array_index (mux->index_table, MXFIndexTableSegment, i);
+    GstBuffer *segment_buffer;
+
+    if (segment->n_index_entries == 0)
+      continue;
+
+    segment_buffer = mxf_index_table_segment_to_buffer (segment);
+    index_byte_count += gst_buffer_get_size (segment_buffer);
+    index_entries = g_list_prepend (index_entries, segment_buffer);
+  }
+  index_entries = g_list_reverse (index_entries);
+
+  gst_mxf_mux_clear_index_table (mux);
+  mux->index_start_position = pad->pos;
+
+  /* Repeat the header metadata with the durations written so far */
+  gst_mxf_mux_update_durations (mux);
+
+  mux->partition.type = MXF_PARTITION_PACK_BODY;
+  mux->partition.closed = FALSE;
+  mux->partition.complete = TRUE;
+  mux->partition.prev_partition = mux->partition.this_partition;
+  mux->partition.this_partition = mux->offset;
+  mux->partition.footer_partition = 0;
+  mux->partition.header_byte_count = 0;
+  mux->partition.index_byte_count = index_byte_count;
+  mux->partition.index_sid = index_byte_count > 0 ?
+      mux->preface->content_storage->essence_container_data[0]->index_sid : 0;
+  /* body_offset keeps counting the essence container bytes */
+  mux->partition.body_sid =
+      mux->preface->content_storage->essence_container_data[0]->body_sid;
+
+  entry.offset = mux->partition.this_partition;
+  entry.body_sid = mux->partition.body_sid;
+  g_array_append_val (mux->body_partitions, entry);
+  mux->partition_start = pad->last_timestamp;
+
+  if ((ret = gst_mxf_mux_write_header_metadata (mux)) != GST_FLOW_OK) {
+    g_list_free_full (index_entries, (GDestroyNotify) gst_mini_object_unref);
+    return ret;
+  }
+
+  for (l = index_entries; l; l = l->next) {
+    GstBuffer *buf = l->data;
+
+    l->data = NULL;
+    if ((ret = gst_mxf_mux_push (mux, buf)) != GST_FLOW_OK) {
+      GST_ERROR_OBJECT (mux, "Failed pushing index table segment");
+      g_list_free_full (l->next, (GDestroyNotify) gst_mini_object_unref);
+      l->next = NULL;
+      break;
+    }
+  }
+  g_list_free (index_entries);
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_mxf_mux_handle_eos (GstMXFMux * mux)
+{
+  GList *l;
+  gboolean have_data = FALSE;
+  GstBuffer *packet;
+
+  do {
+    GstMXFMuxPad *best = NULL;
+
+    have_data = FALSE;
+
+    GST_OBJECT_LOCK (mux);
+    for (l = GST_ELEMENT_CAST (mux)->sinkpads; l; l = l->next) {
+      GstMXFMuxPad *pad = l->data;
+      GstBuffer *buffer =
+          gst_aggregator_pad_peek_buffer (GST_AGGREGATOR_PAD (pad));
+
+      GstClockTime next_gc_timestamp =
+          gst_util_uint64_scale ((mux->last_gc_position + 1) * GST_SECOND,
+          mux->min_edit_rate.d, mux->min_edit_rate.n);
+
+      if (pad->have_complete_edit_unit ||
+          gst_adapter_available (pad->adapter) > 0 || buffer) {
+        have_data = TRUE;
+        if (pad->last_timestamp < next_gc_timestamp) {
+          best = gst_object_ref (pad);
+          if (buffer)
+            gst_buffer_unref (buffer);
+          break;
+        }
+      }
+      if (buffer)
+        gst_buffer_unref (buffer);
+
+      if (have_data && !l->next) {
+        mux->last_gc_position++;
+        mux->last_gc_timestamp = next_gc_timestamp;
+        break;
+      }
+    }
+    GST_OBJECT_UNLOCK (mux);
+
+    if (best) {
+      gst_mxf_mux_handle_buffer (mux, best);
+      gst_object_unref (best);
+      have_data = TRUE;
+    }
+  } while (have_data);
+
+  mux->last_gc_position++;
+  mux->last_gc_timestamp =
+      gst_util_uint64_scale (mux->last_gc_position * GST_SECOND,
+      mux->min_edit_rate.d, mux->min_edit_rate.n);
+
+  gst_mxf_mux_update_durations (mux);
 
   {
-    guint64 body_partition = mux->partition.this_partition;
-    guint32 body_sid = mux->partition.body_sid;
+    guint64 prev_partition = mux->partition.this_partition;
+    guint64 body_partition =
+        g_array_index (mux->body_partitions, MXFRandomIndexPackEntry,
+        0).offset;
     guint64 footer_partition = mux->offset;
     GArray *rip;
     GstFlowReturn ret;
@@ -1589,7 +1762,7 @@ gst_mxf_mux_handle_eos (GstMXFMux * mux)
     mux->partition.closed = TRUE;
     mux->partition.complete = TRUE;
     mux->partition.this_partition = mux->offset;
-    mux->partition.prev_partition = body_partition;
+    mux->partition.prev_partition = prev_partition;
     mux->partition.footer_partition = mux->offset;
     mux->partition.header_byte_count = 0;
     mux->partition.index_byte_count = index_byte_count;
@@ -1608,13 +1781,13 @@ gst_mxf_mux_handle_eos (GstMXFMux * mux)
     }
     g_list_free (index_entries);
 
-    rip = g_array_sized_new (FALSE, FALSE, sizeof (MXFRandomIndexPackEntry), 3);
+    rip = g_array_sized_new (FALSE, FALSE, sizeof (MXFRandomIndexPackEntry),
+        mux->body_partitions->len + 2);
     entry.offset = 0;
     entry.body_sid = 0;
     g_array_append_val (rip, entry);
-    entry.offset = body_partition;
-    entry.body_sid = body_sid;
-    g_array_append_val (rip, entry);
+    g_array_append_vals (rip, mux->body_partitions->data,
+        mux->body_partitions->len);
     entry.offset = footer_partition;
     entry.body_sid = 0;
     g_array_append_val (rip, entry);
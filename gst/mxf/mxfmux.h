@@ -71,7 +71,14 @@ typedef struct _GstMXFMux {
 
   GArray *index_table;
   guint current_index_pos;
+  guint64 index_start_position;
   guint64 last_keyframe_pos;
+
+  /* MXFRandomIndexPackEntry of every body partition written so far */
+  GArray *body_partitions;
+  GstClockTime partition_start;
+
+  GstClockTime partition_interval;
 } GstMXFMux;
 
 typedef struct _GstMXFMuxClass {
@@ -66,6 +66,11 @@ enum
   PROP_MAX_KBPS,
   PROP_MAX_BUCKET_SIZE,
   PROP_ALLOW_REORDERING,
+  PROP_MAX_QUEUE_DELAY,
+  PROP_BURST_ENTER_PROBABILITY,
+  PROP_BURST_EXIT_PROBABILITY,
+  PROP_BURST_DROP_PROBABILITY,
+  PROP_SEED,
 };
 
 /* these numbers are nothing but wild guesses and dont reflect any reality */
@@ -79,6 +84,11 @@ enum
 #define DEFAULT_MAX_KBPS -1
 #define DEFAULT_MAX_BUCKET_SIZE -1
 #define DEFAULT_ALLOW_REORDERING TRUE
+#define DEFAULT_MAX_QUEUE_DELAY 0
+#define DEFAULT_BURST_ENTER_PROBABILITY 0.0
+#define DEFAULT_BURST_EXIT_PROBABILITY 0.5
+#define DEFAULT_BURST_DROP_PROBABILITY 1.0
+#define DEFAULT_SEED 0
 
 static GstStaticPadTemplate gst_net_sim_sink_template =
 GST_STATIC_PAD_TEMPLATE ("sink",
@@ -94,12 +104,125 @@ GST_STATIC_PAD_TEMPLATE ("src",
 
 G_DEFINE_TYPE (GstNetSim, gst_net_sim, GST_TYPE_ELEMENT);
 
+typedef struct
+{
+  gint64 ready_time;
+  guint64 seq;
+  GstBuffer *buf;
+} DelayedPacket;
+
+/* ties are broken by arrival order so equal ready times keep their order */
+static inline gboolean
+delayed_packet_before (const DelayedPacket * a, const DelayedPacket * b)
+{
+  if (a->ready_time != b->ready_time)
+    return a->ready_time < b->ready_time;
+  return a->seq < b->seq;
+}
+
+static void
+delayed_heap_push (GArray * heap, const DelayedPacket * packet)
+{
+  DelayedPacket *items, tmp;
+  guint i, parent;
+
+  g_array_append_vals (heap, packet, 1);
+  items = (DelayedPacket *) heap->data;
+
+  for (i = heap->len - 1; i > 0; i = parent) {
+    parent = (i - 1) / 2;
+    if (!delayed_packet_before (&items[i], &items[parent]))
+      break;
+    tmp = items[i];
+    items[i] = items[parent];
+    items[parent] = tmp;
+  }
+}
+
+static void
+delayed_heap_pop (GArray * heap, DelayedPacket * packet)
+{
+  DelayedPacket *items = (DelayedPacket *) heap->data, tmp;
+  guint i = 0, n;
+
+  *packet = items[0];
+  n = heap->len - 1;
+  items[0] = items[n];
+  g_array_set_size (heap, n);
+
+  while (TRUE) {
+    guint left = 2 * i + 1;
+    guint right = left + 1;
+    guint first = i;
+
+    if (left < n && delayed_packet_before (&items[left], &items[first]))
+      first = left;
+    if (right < n && delayed_packet_before (&items[right], &items[first]))
+      first = right;
+    if (first == i)
+      break;
+
+    tmp = items[i];
+    items[i] = items[first];
+    items[first] = tmp;
+    i = first;
+  }
+}
+
+static gint64
+delayed_heap_next_ready_time (GArray * heap)
+{
+  if (heap->len == 0)
+    return -1;
+
+  return g_array_index (heap, DelayedPacket, 0).ready_time;
+}
+
+static void
+gst_net_sim_flush_delayed (GstNetSim * netsim)
+{
+  guint i;
+
+  for (i = 0; i < netsim->delayed->len; i++)
+    gst_buffer_unref (g_array_index (netsim->delayed, DelayedPacket, i).buf);
+  g_array_set_size (netsim->delayed, 0);
+}
+
+/* One source serves all delayed packets, its ready time always tracks the
+ * head of the heap. Creating a source per packet does not scale to high
+ * packet rates. */
+typedef struct
+{
+  GSource parent;
+  GstNetSim *netsim;
+} GstNetSimSource;
+
 static gboolean
 gst_net_sim_source_dispatch (GSource * source,
     GSourceFunc callback, gpointer user_data)
 {
-  callback (user_data);
-  return FALSE;
+  GstNetSim *netsim = ((GstNetSimSource *) source)->netsim;
+  DelayedPacket packet;
+  gint64 now;
+
+  now = g_source_get_time (source);
+
+  /* push while holding the lock, like the undelayed path in the chain
+   * function does, so that a packet that isn't delayed can't overtake the
+   * ones that are due and the srcpad is only pushed from one thread at a
+   * time */
+  g_mutex_lock (&netsim->loop_mutex);
+  while (netsim->delayed->len > 0 &&
+      delayed_heap_next_ready_time (netsim->delayed) <= now) {
+    delayed_heap_pop (netsim->delayed, &packet);
+    GST_DEBUG_OBJECT (netsim, "Pushing buffer now");
+    gst_pad_push (netsim->srcpad, packet.buf);
+  }
+  g_source_set_ready_time (source,
+      delayed_heap_next_ready_time (netsim->delayed));
+  g_mutex_unlock (&netsim->loop_mutex);
+
+  return G_SOURCE_CONTINUE;
 }
 
 GSourceFuncs gst_net_sim_source_funcs = {
@@ -159,8 +282,22 @@ gst_net_sim_src_activatemode (GstPad * pad, GstObject * parent,
     if (netsim->main_loop == NULL) {
       GMainContext *main_context = g_main_context_new ();
       netsim->main_loop = g_main_loop_new (main_context, FALSE);
+
+      netsim->delay_source = g_source_new (&gst_net_sim_source_funcs,
+          sizeof (GstNetSimSource));
+      ((GstNetSimSource *) netsim->delay_source)->netsim = netsim;
+      g_source_attach (netsim->delay_source, main_context);
       g_main_context_unref (main_context);
 
+      /* start every run from the same state so that seeded runs repeat */
+      if (netsim->seed != 0)
+        g_rand_set_seed (netsim->rand_seed, netsim->seed);
+      memset (&netsim->delay_state, 0, sizeof (netsim->delay_state));
+      netsim->in_burst = FALSE;
+      netsim->last_ready_time = 0;
+      netsim->link_free_time = 0;
+      netsim->delayed_seq = 0;
+
       GST_TRACE_OBJECT (netsim, "ACT: Starting task on srcpad");
       result = gst_pad_start_task (netsim->srcpad,
           (GstTaskFunction) gst_net_sim_loop, netsim, NULL);
@@ -198,6 +335,11 @@ gst_net_sim_src_activatemode (GstPad * pad, GstObject * parent,
       GST_TRACE_OBJECT (netsim, "DEACT: Stopping task on srcpad");
       result = gst_pad_stop_task (netsim->srcpad);
       GST_TRACE_OBJECT (netsim, "DEACT: Mainloop and GstTask stopped");
+
+      g_source_destroy (netsim->delay_source);
+      g_source_unref (netsim->delay_source);
+      netsim->delay_source = NULL;
+      gst_net_sim_flush_delayed (netsim);
     }
   }
   g_mutex_unlock (&netsim->loop_mutex);
@@ -205,39 +347,6 @@ gst_net_sim_src_activatemode (GstPad * pad, GstObject * parent,
   return result;
 }
 
-typedef struct
-{
-  GstPad *pad;
-  GstBuffer *buf;
-} PushBufferCtx;
-
-G_INLINE_FUNC PushBufferCtx *
-push_buffer_ctx_new (GstPad * pad, GstBuffer * buf)
-{
-  PushBufferCtx *ctx = g_slice_new (PushBufferCtx);
-  ctx->pad = gst_object_ref (pad);
-  ctx->buf = gst_buffer_ref (buf);
-  return ctx;
-}
-
-G_INLINE_FUNC void
-push_buffer_ctx_free (PushBufferCtx * ctx)
-{
-  if (G_LIKELY (ctx != NULL)) {
-    gst_buffer_unref (ctx->buf);
-    gst_object_unref (ctx->pad);
-    g_slice_free (PushBufferCtx, ctx);
-  }
-}
-
-static gboolean
-push_buffer_ctx_push (PushBufferCtx * ctx)
-{
-  GST_DEBUG_OBJECT (ctx->pad, "Pushing buffer now");
-  gst_pad_push (ctx->pad, gst_buffer_ref (ctx->buf));
-  return FALSE;
-}
-
 static gint
 get_random_value_uniform (GRand * rand_seed, gint32 min_value, gint32 max_value)
 {
@@ -326,60 +435,83 @@ get_random_value_gamma (GRand * rand_seed, gint32 low, gint32 high,
   return round (x + low);
 }
 
+static gint
+gst_net_sim_get_delay (GstNetSim * netsim)
+{
+  gint delay;
+
+  switch (netsim->delay_distribution) {
+    case DISTRIBUTION_UNIFORM:
+      delay = get_random_value_uniform (netsim->rand_seed, netsim->min_delay,
+          netsim->max_delay);
+      break;
+    case DISTRIBUTION_NORMAL:
+      delay = get_random_value_normal (netsim->rand_seed, netsim->min_delay,
+          netsim->max_delay, &netsim->delay_state);
+      break;
+    case DISTRIBUTION_GAMMA:
+      delay = get_random_value_gamma (netsim->rand_seed, netsim->min_delay,
+          netsim->max_delay, &netsim->delay_state);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+  }
+
+  return MAX (delay, 0);
+}
+
+/* @departure_time is the monotonic time at which the emulated link is done
+ * sending the buffer, or 0 if it can go out right away */
 static GstFlowReturn
-gst_net_sim_delay_buffer (GstNetSim * netsim, GstBuffer * buf)
+gst_net_sim_delay_buffer (GstNetSim * netsim, GstBuffer * buf,
+    gint64 departure_time)
 {
   GstFlowReturn ret = GST_FLOW_OK;
+  gint64 ready_time, now_time;
+  gint delay = 0;
 
   g_mutex_lock (&netsim->loop_mutex);
-  if (netsim->main_loop != NULL && netsim->delay_probability > 0 &&
-      g_rand_double (netsim->rand_seed) < netsim->delay_probability) {
-    gint delay;
-    PushBufferCtx *ctx;
-    GSource *source;
-    gint64 ready_time, now_time;
-
-    switch (netsim->delay_distribution) {
-      case DISTRIBUTION_UNIFORM:
-        delay = get_random_value_uniform (netsim->rand_seed, netsim->min_delay,
-            netsim->max_delay);
-        break;
-      case DISTRIBUTION_NORMAL:
-        delay = get_random_value_normal (netsim->rand_seed, netsim->min_delay,
-            netsim->max_delay, &netsim->delay_state);
-        break;
-      case DISTRIBUTION_GAMMA:
-        delay = get_random_value_gamma (netsim->rand_seed, netsim->min_delay,
-            netsim->max_delay, &netsim->delay_state);
-        break;
-      default:
-        g_assert_not_reached ();
-        break;
-    }
-
-    if (delay < 0)
-      delay = 0;
-
-    ctx = push_buffer_ctx_new (netsim->srcpad, buf);
+  if (netsim->main_loop == NULL)
+    goto push;
+
+  if (netsim->delay_probability > 0 &&
+      g_rand_double (netsim->rand_seed) < netsim->delay_probability)
+    delay = gst_net_sim_get_delay (netsim);
+
+  now_time = g_get_monotonic_time ();
+  ready_time = MAX (now_time, departure_time) + delay * 1000;
+  /* without reordering, a packet that is due right away still has to wait
+   * for the ones delayed before it */
+  if (ready_time <= now_time &&
+      (netsim->allow_reordering || netsim->delayed->len == 0))
+    goto push;
+
+  if (!netsim->allow_reordering && ready_time <= netsim->last_ready_time)
+    ready_time = netsim->last_ready_time + 1;
+
+  netsim->last_ready_time = ready_time;
+  GST_DEBUG_OBJECT (netsim, "Delaying packet by %" G_GINT64_FORMAT "ms",
+      (ready_time - now_time) / 1000);
+
+  {
+    DelayedPacket packet;
+
+    packet.ready_time = ready_time;
+    packet.seq = netsim->delayed_seq++;
+    packet.buf = gst_buffer_ref (buf);
+    delayed_heap_push (netsim->delayed, &packet);
+  }
 
-    source = g_source_new (&gst_net_sim_source_funcs, sizeof (GSource));
-    now_time = g_get_monotonic_time ();
-    ready_time = now_time + delay * 1000;
-    if (!netsim->allow_reordering && ready_time < netsim->last_ready_time)
-      ready_time = netsim->last_ready_time + 1;
+  /* only wake up the loop when the new packet is the first one due */
+  if (delayed_heap_next_ready_time (netsim->delayed) == ready_time)
+    g_source_set_ready_time (netsim->delay_source, ready_time);
 
-    netsim->last_ready_time = ready_time;
-    GST_DEBUG_OBJECT (netsim, "Delaying packet by %" G_GINT64_FORMAT "ms",
-        (ready_time - now_time) / 1000);
+  g_mutex_unlock (&netsim->loop_mutex);
+  return ret;
 
-    g_source_set_ready_time (source, ready_time);
-    g_source_set_callback (source, (GSourceFunc) push_buffer_ctx_push,
-        ctx, (GDestroyNotify) push_buffer_ctx_free);
-    g_source_attach (source, g_main_loop_get_context (netsim->main_loop));
-    g_source_unref (source);
-  } else {
-    ret = gst_pad_push (netsim->srcpad, gst_buffer_ref (buf));
-  }
+push:
+  ret = gst_pad_push (netsim->srcpad, gst_buffer_ref (buf));
   g_mutex_unlock (&netsim->loop_mutex);
 
   return ret;
@@ -468,31 +600,95 @@ gst_net_sim_token_bucket (GstNetSim * netsim, GstBuffer * buf)
   return TRUE;
 }
 
+/* Models a bottleneck link of max-kbps with a drop-tail queue: buffers are
+ * sent back to back at the link rate and dropped once the time they would
+ * wait in the queue exceeds max-queue-delay. */
+static gboolean
+gst_net_sim_link_queue (GstNetSim * netsim, GstBuffer * buf,
+    gint64 * departure_time)
+{
+  gint64 now_time, start_time, queue_delay;
+  guint64 send_time;
+
+  now_time = g_get_monotonic_time ();
+  start_time = MAX (now_time, netsim->link_free_time);
+  queue_delay = start_time - now_time;
+
+  if (queue_delay > (gint64) netsim->max_queue_delay * 1000) {
+    GST_DEBUG_OBJECT (netsim, "Link queue full (%" G_GINT64_FORMAT "ms), "
+        "dropping packet", queue_delay / 1000);
+    return FALSE;
+  }
+
+  send_time = gst_util_uint64_scale (gst_buffer_get_size (buf) * 8,
+      G_USEC_PER_SEC, (guint64) netsim->max_kbps * 1000);
+  netsim->link_free_time = start_time + send_time;
+  *departure_time = netsim->link_free_time;
+
+  GST_LOG_OBJECT (netsim, "Packet queued for %" G_GINT64_FORMAT "us, "
+      "sending takes %" G_GUINT64_FORMAT "us", queue_delay, send_time);
+
+  return TRUE;
+}
+
+/* With burst-enter-probability set this is a Gilbert-Elliott model: a two
+ * state Markov chain that is stepped for every packet, dropping with
+ * drop-probability in the good state and burst-drop-probability in the bad
+ * one. */
+static gboolean
+gst_net_sim_should_drop (GstNetSim * netsim)
+{
+  gfloat drop_probability = netsim->drop_probability;
+
+  if (netsim->burst_enter_probability > 0) {
+    if (netsim->in_burst) {
+      if (g_rand_double (netsim->rand_seed) <
+          (gdouble) netsim->burst_exit_probability) {
+        GST_LOG_OBJECT (netsim, "Leaving loss burst");
+        netsim->in_burst = FALSE;
+      }
+    } else if (g_rand_double (netsim->rand_seed) <
+        (gdouble) netsim->burst_enter_probability) {
+      GST_LOG_OBJECT (netsim, "Entering loss burst");
+      netsim->in_burst = TRUE;
+    }
+
+    if (netsim->in_burst)
+      drop_probability = netsim->burst_drop_probability;
+  }
+
+  return drop_probability > 0 &&
+      g_rand_double (netsim->rand_seed) < (gdouble) drop_probability;
+}
+
 static GstFlowReturn
 gst_net_sim_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 {
   GstNetSim *netsim = GST_NET_SIM (parent);
   GstFlowReturn ret = GST_FLOW_OK;
+  gint64 departure_time = 0;
 
-  if (!gst_net_sim_token_bucket (netsim, buf))
+  if (netsim->max_queue_delay > 0 && netsim->max_kbps > 0) {
+    if (!gst_net_sim_link_queue (netsim, buf, &departure_time))
+      goto done;
+  } else if (!gst_net_sim_token_bucket (netsim, buf)) {
     goto done;
+  }
 
   if (netsim->drop_packets > 0) {
     netsim->drop_packets--;
     GST_DEBUG_OBJECT (netsim, "Dropping packet (%d left)",
         netsim->drop_packets);
-  } else if (netsim->drop_probability > 0
-      && g_rand_double (netsim->rand_seed) <
-      (gdouble) netsim->drop_probability) {
+  } else if (gst_net_sim_should_drop (netsim)) {
     GST_DEBUG_OBJECT (netsim, "Dropping packet");
   } else if (netsim->duplicate_probability > 0 &&
       g_rand_double (netsim->rand_seed) <
       (gdouble) netsim->duplicate_probability) {
     GST_DEBUG_OBJECT (netsim, "Duplicating packet");
-    gst_net_sim_delay_buffer (netsim, buf);
-    ret = gst_net_sim_delay_buffer (netsim, buf);
+    gst_net_sim_delay_buffer (netsim, buf, departure_time);
+    ret = gst_net_sim_delay_buffer (netsim, buf, departure_time);
   } else {
-    ret = gst_net_sim_delay_buffer (netsim, buf);
+    ret = gst_net_sim_delay_buffer (netsim, buf, departure_time);
   }
 
 done:
@@ -540,6 +736,23 @@ gst_net_sim_set_property (GObject * object,
     case PROP_ALLOW_REORDERING:
       netsim->allow_reordering = g_value_get_boolean (value);
       break;
+    case PROP_MAX_QUEUE_DELAY:
+      netsim->max_queue_delay = g_value_get_int (value);
+      break;
+    case PROP_BURST_ENTER_PROBABILITY:
+      netsim->burst_enter_probability = g_value_get_float (value);
+      break;
+    case PROP_BURST_EXIT_PROBABILITY:
+      netsim->burst_exit_probability = g_value_get_float (value);
+      break;
+    case PROP_BURST_DROP_PROBABILITY:
+      netsim->burst_drop_probability = g_value_get_float (value);
+      break;
+    case PROP_SEED:
+      netsim->seed = g_value_get_uint (value);
+      if (netsim->seed != 0)
+        g_rand_set_seed (netsim->rand_seed, netsim->seed);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -583,6 +796,21 @@ gst_net_sim_get_property (GObject * object,
     case PROP_ALLOW_REORDERING:
       g_value_set_boolean (value, netsim->allow_reordering);
       break;
+    case PROP_MAX_QUEUE_DELAY:
+      g_value_set_int (value, netsim->max_queue_delay);
+      break;
+    case PROP_BURST_ENTER_PROBABILITY:
+      g_value_set_float (value, netsim->burst_enter_probability);
+      break;
+    case PROP_BURST_EXIT_PROBABILITY:
+      g_value_set_float (value, netsim->burst_exit_probability);
+      break;
+    case PROP_BURST_DROP_PROBABILITY:
+      g_value_set_float (value, netsim->burst_drop_probability);
+      break;
+    case PROP_SEED:
+      g_value_set_uint (value, netsim->seed);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -606,6 +834,7 @@ gst_net_sim_init (GstNetSim * netsim)
   netsim->rand_seed = g_rand_new ();
   netsim->main_loop = NULL;
   netsim->prev_time = GST_CLOCK_TIME_NONE;
+  netsim->delayed = g_array_new (FALSE, FALSE, sizeof (DelayedPacket));
 
   GST_OBJECT_FLAG_SET (netsim->sinkpad,
       GST_PAD_FLAG_PROXY_CAPS | GST_PAD_FLAG_PROXY_ALLOCATION);
@@ -622,6 +851,8 @@ gst_net_sim_finalize (GObject * object)
   GstNetSim *netsim = GST_NET_SIM (object);
 
   g_rand_free (netsim->rand_seed);
+  gst_net_sim_flush_delayed (netsim);
+  g_array_free (netsim->delayed, TRUE);
   g_mutex_clear (&netsim->loop_mutex);
   g_cond_clear (&netsim->start_cond);
 
@@ -755,6 +986,88 @@ gst_net_sim_class_init (GstNetSimClass * klass)
           DEFAULT_ALLOW_REORDERING,
           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstNetSim:max-queue-delay:
+   *
+   * When set together with "max-kbps", buffers exceeding the link rate are
+   * queued and sent at the link rate instead of being dropped right away, as
+   * happens in front of a real bottleneck link. Buffers that would have to
+   * wait longer than this are dropped. When 0 the token bucket configured
+   * through "max-bucket-size" is used instead.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_QUEUE_DELAY,
+      g_param_spec_int ("max-queue-delay", "Maximum queue delay (ms)",
+          "The maximum time in ms a buffer waits for the link when max-kbps "
+          "is set (0 = no queue, use the token bucket)", 0, G_MAXINT,
+          DEFAULT_MAX_QUEUE_DELAY,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetSim:burst-enter-probability:
+   *
+   * Setting this enables the Gilbert-Elliott loss model, where losses come
+   * in bursts. For every buffer the model moves to the bad state with this
+   * probability, and back to the good state with "burst-exit-probability".
+   * Buffers are dropped with "drop-probability" in the good state and with
+   * "burst-drop-probability" in the bad state.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_BURST_ENTER_PROBABILITY,
+      g_param_spec_float ("burst-enter-probability",
+          "Burst Enter Probability",
+          "The probability of going from the good to the bad state of the "
+          "Gilbert-Elliott loss model (0 = disabled)",
+          0.0, 1.0, DEFAULT_BURST_ENTER_PROBABILITY,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetSim:burst-exit-probability:
+   *
+   * The probability of going back to the good state of the Gilbert-Elliott
+   * loss model, the mean burst length is the inverse of this.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_BURST_EXIT_PROBABILITY,
+      g_param_spec_float ("burst-exit-probability", "Burst Exit Probability",
+          "The probability of going from the bad to the good state of the "
+          "Gilbert-Elliott loss model",
+          0.0, 1.0, DEFAULT_BURST_EXIT_PROBABILITY,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetSim:burst-drop-probability:
+   *
+   * The probability a buffer is dropped while in the bad state of the
+   * Gilbert-Elliott loss model.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_BURST_DROP_PROBABILITY,
+      g_param_spec_float ("burst-drop-probability", "Burst Drop Probability",
+          "The probability a buffer is dropped in the bad state of the "
+          "Gilbert-Elliott loss model",
+          0.0, 1.0, DEFAULT_BURST_DROP_PROBABILITY,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetSim:seed:
+   *
+   * Seed for the random number generator behind all drop, duplicate and
+   * delay decisions. With a non-zero seed the element makes the same
+   * decisions every time it is started, which makes test runs reproducible.
+   *
+   * Since: 1.16
+   */
+  g_object_class_install_property (gobject_class, PROP_SEED,
+      g_param_spec_uint ("seed", "Seed",
+          "Seed for the random number generator (0 = random)",
+          0, G_MAXUINT, DEFAULT_SEED,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
   GST_DEBUG_CATEGORY_INIT (netsim_debug, "netsim", 0, "Network simulator");
 }
 
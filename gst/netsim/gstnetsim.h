@@ -77,6 +77,19 @@ struct _GstNetSim
   NormalDistributionState delay_state;
   gint64 last_ready_time;
 
+  /* delayed packets, a binary heap ordered by ready time that is served by
+   * a single source on the main loop */
+  GArray *delayed;
+  guint64 delayed_seq;
+  GSource *delay_source;
+
+  /* Gilbert-Elliott state, TRUE while in the bad (bursty loss) state */
+  gboolean in_burst;
+
+  /* monotonic time at which the emulated link is done sending what is
+   * queued already */
+  gint64 link_free_time;
+
   /* properties */
   gint min_delay;
   gint max_delay;
@@ -88,6 +101,11 @@ struct _GstNetSim
   gint max_kbps;
   gint max_bucket_size;
   gboolean allow_reordering;
+  gint max_queue_delay;
+  gfloat burst_enter_probability;
+  gfloat burst_exit_probability;
+  gfloat burst_drop_probability;
+  guint seed;
 };
 
 struct _GstNetSimClass
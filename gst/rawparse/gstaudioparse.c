@@ -85,6 +85,11 @@ static void gst_audio_parse_set_property (GObject * object, guint prop_id,
 static void gst_audio_parse_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 
+static gboolean gst_audio_parse_src_event (GstPad * pad, GstObject * parent,
+    GstEvent * event);
+static gboolean gst_audio_parse_src_query (GstPad * pad, GstObject * parent,
+    GstQuery * query);
+
 GST_DEBUG_CATEGORY_STATIC (gst_audio_parse_debug);
 #define GST_CAT_DEFAULT gst_audio_parse_debug
 
@@ -209,6 +214,10 @@ gst_audio_parse_init (GstAudioParse * ap)
   ghostpad =
       gst_ghost_pad_new_from_template ("src", inner_pad,
       gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (ap), "src"));
+  gst_pad_set_event_function (ghostpad,
+      GST_DEBUG_FUNCPTR (gst_audio_parse_src_event));
+  gst_pad_set_query_function (ghostpad,
+      GST_DEBUG_FUNCPTR (gst_audio_parse_src_query));
   gst_element_add_pad (GST_ELEMENT (ap), ghostpad);
   gst_object_unref (GST_OBJECT (inner_pad));
 }
@@ -372,3 +381,145 @@ gst_audio_parse_get_property (GObject * object, guint prop_id, GValue * value,
       break;
   }
 }
+
+/* Seeks and queries in samples (GST_FORMAT_DEFAULT) are translated to time
+ * here, rounding up so that rawaudioparse maps them back to the same
+ * sample. */
+static gint64
+gst_audio_parse_samples_to_time (gint64 samples, gint rate)
+{
+  if (samples == -1)
+    return -1;
+
+  return gst_util_uint64_scale_int_ceil (samples, GST_SECOND, rate);
+}
+
+static gint64
+gst_audio_parse_time_to_samples (gint64 time, gint rate)
+{
+  if (time == -1)
+    return -1;
+
+  return gst_util_uint64_scale_int_round (time, rate, GST_SECOND);
+}
+
+static gint
+gst_audio_parse_get_rate (GstAudioParse * ap)
+{
+  gint sample_rate;
+
+  g_object_get (G_OBJECT (ap->rawaudioparse), "sample-rate", &sample_rate,
+      NULL);
+
+  return sample_rate;
+}
+
+static gboolean
+gst_audio_parse_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstAudioParse *ap = GST_AUDIO_PARSE (parent);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_SEEK) {
+    gdouble rate;
+    GstFormat format;
+    GstSeekFlags flags;
+    GstSeekType start_type, stop_type;
+    gint64 start, stop;
+    gint sample_rate;
+    GstEvent *time_event;
+
+    gst_event_parse_seek (event, &rate, &format, &flags, &start_type, &start,
+        &stop_type, &stop);
+
+    if (format == GST_FORMAT_DEFAULT) {
+      sample_rate = gst_audio_parse_get_rate (ap);
+      if (sample_rate <= 0) {
+        GST_DEBUG_OBJECT (ap, "can't seek in samples without a sample rate");
+        gst_event_unref (event);
+        return FALSE;
+      }
+
+      GST_DEBUG_OBJECT (ap, "seeking to sample %" G_GINT64_FORMAT, start);
+
+      time_event = gst_event_new_seek (rate, GST_FORMAT_TIME, flags,
+          start_type, gst_audio_parse_samples_to_time (start, sample_rate),
+          stop_type, gst_audio_parse_samples_to_time (stop, sample_rate));
+      gst_event_set_seqnum (time_event, gst_event_get_seqnum (event));
+      gst_event_unref (event);
+      event = time_event;
+    }
+  }
+
+  return gst_proxy_pad_event_default (pad, parent, event);
+}
+
+static gboolean
+gst_audio_parse_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstAudioParse *ap = GST_AUDIO_PARSE (parent);
+  GstFormat format;
+  GstQuery *time_query;
+  gint64 time;
+  gint sample_rate;
+  gboolean ret;
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_POSITION:
+      gst_query_parse_position (query, &format, NULL);
+      if (format != GST_FORMAT_DEFAULT ||
+          (sample_rate = gst_audio_parse_get_rate (ap)) <= 0)
+        break;
+
+      time_query = gst_query_new_position (GST_FORMAT_TIME);
+      ret = gst_proxy_pad_query_default (pad, parent, time_query);
+      if (ret) {
+        gst_query_parse_position (time_query, NULL, &time);
+        gst_query_set_position (query, GST_FORMAT_DEFAULT,
+            gst_audio_parse_time_to_samples (time, sample_rate));
+      }
+      gst_query_unref (time_query);
+      return ret;
+
+    case GST_QUERY_DURATION:
+      gst_query_parse_duration (query, &format, NULL);
+      if (format != GST_FORMAT_DEFAULT ||
+          (sample_rate = gst_audio_parse_get_rate (ap)) <= 0)
+        break;
+
+      time_query = gst_query_new_duration (GST_FORMAT_TIME);
+      ret = gst_proxy_pad_query_default (pad, parent, time_query);
+      if (ret) {
+        gst_query_parse_duration (time_query, NULL, &time);
+        gst_query_set_duration (query, GST_FORMAT_DEFAULT,
+            gst_audio_parse_time_to_samples (time, sample_rate));
+      }
+      gst_query_unref (time_query);
+      return ret;
+
+    case GST_QUERY_SEEKING:{
+      gboolean seekable;
+      gint64 start, stop;
+
+      gst_query_parse_seeking (query, &format, NULL, NULL, NULL);
+      if (format != GST_FORMAT_DEFAULT ||
+          (sample_rate = gst_audio_parse_get_rate (ap)) <= 0)
+        break;
+
+      time_query = gst_query_new_seeking (GST_FORMAT_TIME);
+      ret = gst_proxy_pad_query_default (pad, parent, time_query);
+      if (ret) {
+        gst_query_parse_seeking (time_query, NULL, &seekable, &start, &stop);
+        gst_query_set_seeking (query, GST_FORMAT_DEFAULT, seekable,
+            gst_audio_parse_time_to_samples (start, sample_rate),
+            gst_audio_parse_time_to_samples (stop, sample_rate));
+      }
+      gst_query_unref (time_query);
+      return ret;
+    }
+
+    default:
+      break;
+  }
+
+  return gst_proxy_pad_query_default (pad, parent, query);
+}
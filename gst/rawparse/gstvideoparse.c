@@ -58,6 +58,11 @@ static void gst_video_parse_set_property (GObject * object, guint prop_id,
 static void gst_video_parse_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 
+static gboolean gst_video_parse_src_event (GstPad * pad, GstObject * parent,
+    GstEvent * event);
+static gboolean gst_video_parse_src_query (GstPad * pad, GstObject * parent,
+    GstQuery * query);
+
 static gboolean gst_video_parse_int_valarray_from_string (const gchar *
     str, GValue * valarray);
 static gchar *gst_video_parse_int_valarray_to_string (GValue * valarray);
@@ -169,6 +174,10 @@ gst_video_parse_init (GstVideoParse * vp)
   ghostpad =
       gst_ghost_pad_new_from_template ("src", inner_pad,
       gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (vp), "src"));
+  gst_pad_set_event_function (ghostpad,
+      GST_DEBUG_FUNCPTR (gst_video_parse_src_event));
+  gst_pad_set_query_function (ghostpad,
+      GST_DEBUG_FUNCPTR (gst_video_parse_src_query));
   gst_element_add_pad (GST_ELEMENT (vp), ghostpad);
   gst_object_unref (GST_OBJECT (inner_pad));
 }
@@ -354,6 +363,146 @@ gst_video_parse_get_property (GObject * object, guint prop_id, GValue * value,
   }
 }
 
+/* Seeks and queries in frames (GST_FORMAT_DEFAULT) are translated to time
+ * here. A frame number maps to the start time of the frame, rounded up so
+ * that rawvideoparse maps it back to the same frame and, in pull mode,
+ * directly to its byte offset. */
+static gboolean
+gst_video_parse_get_framerate (GstVideoParse * vp, gint * fps_n, gint * fps_d)
+{
+  g_object_get (G_OBJECT (vp->rawvideoparse), "framerate", fps_n, fps_d,
+      NULL);
+
+  return *fps_n > 0 && *fps_d > 0;
+}
+
+static gint64
+gst_video_parse_frames_to_time (gint64 frames, gint fps_n, gint fps_d)
+{
+  if (frames == -1)
+    return -1;
+
+  return gst_util_uint64_scale_ceil (frames, fps_d * GST_SECOND, fps_n);
+}
+
+static gint64
+gst_video_parse_time_to_frames (gint64 time, gint fps_n, gint fps_d)
+{
+  if (time == -1)
+    return -1;
+
+  return gst_util_uint64_scale_round (time, fps_n, fps_d * GST_SECOND);
+}
+
+static gboolean
+gst_video_parse_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstVideoParse *vp = GST_VIDEO_PARSE (parent);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_SEEK) {
+    gdouble rate;
+    GstFormat format;
+    GstSeekFlags flags;
+    GstSeekType start_type, stop_type;
+    gint64 start, stop;
+    gint fps_n, fps_d;
+    GstEvent *time_event;
+
+    gst_event_parse_seek (event, &rate, &format, &flags, &start_type, &start,
+        &stop_type, &stop);
+
+    if (format == GST_FORMAT_DEFAULT) {
+      if (!gst_video_parse_get_framerate (vp, &fps_n, &fps_d)) {
+        GST_DEBUG_OBJECT (vp, "can't seek in frames without a framerate");
+        gst_event_unref (event);
+        return FALSE;
+      }
+
+      GST_DEBUG_OBJECT (vp, "seeking to frame %" G_GINT64_FORMAT, start);
+
+      time_event = gst_event_new_seek (rate, GST_FORMAT_TIME, flags,
+          start_type, gst_video_parse_frames_to_time (start, fps_n, fps_d),
+          stop_type, gst_video_parse_frames_to_time (stop, fps_n, fps_d));
+      gst_event_set_seqnum (time_event, gst_event_get_seqnum (event));
+      gst_event_unref (event);
+      event = time_event;
+    }
+  }
+
+  return gst_proxy_pad_event_default (pad, parent, event);
+}
+
+static gboolean
+gst_video_parse_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstVideoParse *vp = GST_VIDEO_PARSE (parent);
+  GstFormat format;
+  GstQuery *time_query;
+  gint64 time;
+  gint fps_n, fps_d;
+  gboolean ret;
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_POSITION:
+      gst_query_parse_position (query, &format, NULL);
+      if (format != GST_FORMAT_DEFAULT ||
+          !gst_video_parse_get_framerate (vp, &fps_n, &fps_d))
+        break;
+
+      time_query = gst_query_new_position (GST_FORMAT_TIME);
+      ret = gst_proxy_pad_query_default (pad, parent, time_query);
+      if (ret) {
+        gst_query_parse_position (time_query, NULL, &time);
+        gst_query_set_position (query, GST_FORMAT_DEFAULT,
+            gst_video_parse_time_to_frames (time, fps_n, fps_d));
+      }
+      gst_query_unref (time_query);
+      return ret;
+
+    case GST_QUERY_DURATION:
+      gst_query_parse_duration (query, &format, NULL);
+      if (format != GST_FORMAT_DEFAULT ||
+          !gst_video_parse_get_framerate (vp, &fps_n, &fps_d))
+        break;
+
+      time_query = gst_query_new_duration (GST_FORMAT_TIME);
+      ret = gst_proxy_pad_query_default (pad, parent, time_query);
+      if (ret) {
+        gst_query_parse_duration (time_query, NULL, &time);
+        gst_query_set_duration (query, GST_FORMAT_DEFAULT,
+            gst_video_parse_time_to_frames (time, fps_n, fps_d));
+      }
+      gst_query_unref (time_query);
+      return ret;
+
+    case GST_QUERY_SEEKING:{
+      gboolean seekable;
+      gint64 start, stop;
+
+      gst_query_parse_seeking (query, &format, NULL, NULL, NULL);
+      if (format != GST_FORMAT_DEFAULT ||
+          !gst_video_parse_get_framerate (vp, &fps_n, &fps_d))
+        break;
+
+      time_query = gst_query_new_seeking (GST_FORMAT_TIME);
+      ret = gst_proxy_pad_query_default (pad, parent, time_query);
+      if (ret) {
+        gst_query_parse_seeking (time_query, NULL, &seekable, &start, &stop);
+        gst_query_set_seeking (query, GST_FORMAT_DEFAULT, seekable,
+            gst_video_parse_time_to_frames (start, fps_n, fps_d),
+            gst_video_parse_time_to_frames (stop, fps_n, fps_d));
+      }
+      gst_query_unref (time_query);
+      return ret;
+    }
+
+    default:
+      break;
+  }
+
+  return gst_proxy_pad_query_default (pad, parent, query);
+}
+
 static gboolean
 gst_video_parse_int_valarray_from_string (const gchar * str, GValue * valarray)
 {
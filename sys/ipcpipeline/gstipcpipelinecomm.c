@@ -24,9 +24,17 @@
 #  include "config.h"
 #endif
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE             /* memfd_create */
+#endif
+
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
 #include <gst/base/gstbytewriter.h>
 #include <gst/gstprotection.h>
 #include "gstipcpipelinecomm.h"
@@ -36,6 +44,9 @@ GST_DEBUG_CATEGORY_STATIC (gst_ipc_pipeline_comm_debug);
 
 #define DEFAULT_ACK_TIME (10 * G_TIME_SPAN_SECOND)
 
+/* maximum number of fds we expect to be passed along with a single read */
+#define MAX_PASSED_FDS 4
+
 GQuark QUARK_ID;
 
 typedef enum
@@ -186,6 +197,12 @@ gst_ipc_pipeline_comm_data_type_get_name (GstIpcPipelineCommDataType type)
       return "MESSAGE";
     case GST_IPC_PIPELINE_COMM_DATA_TYPE_GERROR_MESSAGE:
       return "GERROR_MESSAGE";
+    case GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_POOL:
+      return "SHM_POOL";
+    case GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_BUFFER:
+      return "SHM_BUFFER";
+    case GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_RELEASE:
+      return "SHM_RELEASE";
     default:
       return "UNKNOWN";
   }
@@ -255,6 +272,459 @@ write_byte_writer_to_fd (GstIpcPipelineComm * comm, GstByteWriter * bw)
   return ret;
 }
 
+/* Writes the contents of the byte writer with fd attached to its first
+ * byte. Fails without writing anything if fdout can not pass fds. */
+static gboolean
+write_byte_writer_with_fd_to_fd (GstIpcPipelineComm * comm, GstByteWriter * bw,
+    int fd)
+{
+  union
+  {
+    struct cmsghdr hdr;
+    char buf[CMSG_SPACE (sizeof (int))];
+  } control;
+  struct cmsghdr *cmsg;
+  struct msghdr msg;
+  struct iovec iov;
+  ssize_t written;
+  guint8 *data;
+  gboolean ret;
+  guint size;
+
+  size = gst_byte_writer_get_size (bw);
+  data = gst_byte_writer_reset_and_get_data (bw);
+  if (!data)
+    return FALSE;
+
+  memset (&msg, 0, sizeof (msg));
+  iov.iov_base = data;
+  iov.iov_len = size;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof (control.buf);
+
+  cmsg = CMSG_FIRSTHDR (&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN (sizeof (int));
+  memcpy (CMSG_DATA (cmsg), &fd, sizeof (int));
+
+  GST_TRACE_OBJECT (comm->element, "Writing %u bytes and fd %d to fdout", size,
+      fd);
+  do {
+    written = sendmsg (comm->fdout, &msg, 0);
+  } while (written < 0 && (errno == EAGAIN || errno == EINTR));
+
+  if (written < 0) {
+    GST_WARNING_OBJECT (comm->element, "Failed to pass fd: %s",
+        strerror (errno));
+    ret = FALSE;
+  } else if (written < size) {
+    ret = write_to_fd_raw (comm, data + written, size - written);
+  } else {
+    ret = TRUE;
+  }
+
+  g_free (data);
+  return ret;
+}
+
+/* Shared memory payload transport.
+ *
+ * The sending side creates a memfd pool and passes it once to the peer,
+ * along with a SHM_POOL chunk. Buffer payloads are then copied into the
+ * pool, and the SHM_BUFFER chunks only carry their location. The peer
+ * maps the pool read only and wraps the payloads without copying them,
+ * sending a SHM_RELEASE chunk back once a buffer is freed.
+ *
+ * The pool is used as a ring: blocks are allocated after the most recent
+ * one, and since buffers are normally freed in the order they were sent,
+ * blocks become reusable in that order too. A block released out of order
+ * is only reused once all the older ones are released. When there is no
+ * room left, payloads are sent inline as usual. */
+
+#define SHM_BLOCK_ALIGN(offset) GST_ROUND_UP_64 (offset)
+
+typedef struct
+{
+  gsize offset;
+  gsize size;
+  gboolean released;
+} ShmBlock;
+
+struct _GstIpcPipelineCommShmMapping
+{
+  gint refcount;
+  guint8 *data;
+  gsize size;
+};
+
+typedef struct
+{
+  GstElement *element;
+  GstIpcPipelineComm *comm;
+  GstIpcPipelineCommShmMapping *mapping;
+  guint32 pool_id;
+  guint64 offset;
+} ShmBufferRelease;
+
+static gboolean
+gst_ipc_pipeline_comm_create_shm_pool (GstIpcPipelineComm * comm)
+{
+#ifdef HAVE_MEMFD_CREATE
+  const unsigned char payload_type = GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_POOL;
+  GstByteWriter bw;
+  guint8 *data;
+  int fd;
+
+  fd = memfd_create ("gst-ipcpipeline", MFD_CLOEXEC);
+  if (fd < 0)
+    goto failed;
+
+  if (ftruncate (fd, comm->shm_pool_size) < 0) {
+    close (fd);
+    goto failed;
+  }
+
+  data = mmap (NULL, comm->shm_pool_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+      fd, 0);
+  if (data == MAP_FAILED) {
+    close (fd);
+    goto failed;
+  }
+
+  ++comm->send_id;
+  ++comm->shm_pool_id;
+
+  GST_DEBUG_OBJECT (comm->element, "Sending shared memory pool %u of %u bytes",
+      comm->shm_pool_id, comm->shm_pool_size);
+
+  gst_byte_writer_init (&bw);
+  if (!gst_byte_writer_put_uint8 (&bw, payload_type)
+      || !gst_byte_writer_put_uint32_le (&bw, comm->send_id)
+      || !gst_byte_writer_put_uint32_le (&bw,
+          sizeof (guint32) + sizeof (guint64))
+      || !gst_byte_writer_put_uint32_le (&bw, comm->shm_pool_id)
+      || !gst_byte_writer_put_uint64_le (&bw, comm->shm_pool_size)
+      || !write_byte_writer_with_fd_to_fd (comm, &bw, fd)) {
+    gst_byte_writer_reset (&bw);
+    munmap (data, comm->shm_pool_size);
+    close (fd);
+    goto failed;
+  }
+
+  comm->shm_fd = fd;
+  comm->shm_data = data;
+  comm->shm_size = comm->shm_pool_size;
+  comm->shm_head = 0;
+  return TRUE;
+
+failed:
+  GST_WARNING_OBJECT (comm->element, "Could not set up shared memory pool (%s)"
+      ", sending buffer payloads inline", strerror (errno));
+  comm->shm_failed = TRUE;
+  return FALSE;
+#else
+  GST_WARNING_OBJECT (comm->element, "No memfd support, sending buffer "
+      "payloads inline");
+  comm->shm_failed = TRUE;
+  return FALSE;
+#endif
+}
+
+/* call with comm->mutex held */
+static gboolean
+gst_ipc_pipeline_comm_shm_alloc (GstIpcPipelineComm * comm, gsize size,
+    gsize * offset)
+{
+  ShmBlock *first, *block;
+  gsize start;
+
+  if (comm->shm_pool_size == 0 || comm->shm_failed || size == 0)
+    return FALSE;
+
+  if (!comm->shm_data && !gst_ipc_pipeline_comm_create_shm_pool (comm))
+    return FALSE;
+
+  start = SHM_BLOCK_ALIGN (comm->shm_head);
+  first = g_queue_peek_head (&comm->shm_blocks);
+  if (!first) {
+    start = 0;
+    if (size > comm->shm_size)
+      return FALSE;
+  } else if (comm->shm_head > first->offset) {
+    /* free space is after the head, and before the first block */
+    if (start + size > comm->shm_size) {
+      if (size > first->offset)
+        return FALSE;
+      start = 0;
+    }
+  } else if (start + size > first->offset) {
+    /* wrapped around, free space is between the head and the first block */
+    return FALSE;
+  }
+
+  block = g_slice_new (ShmBlock);
+  block->offset = start;
+  block->size = size;
+  block->released = FALSE;
+  g_queue_push_tail (&comm->shm_blocks, block);
+  comm->shm_head = start + size;
+
+  *offset = start;
+  return TRUE;
+}
+
+/* call with comm->mutex held */
+static void
+gst_ipc_pipeline_comm_shm_release (GstIpcPipelineComm * comm, guint32 pool_id,
+    guint64 offset)
+{
+  ShmBlock *block;
+  GList *l;
+
+  if (!comm->shm_data || pool_id != comm->shm_pool_id) {
+    GST_DEBUG_OBJECT (comm->element, "Ignoring release for stale pool %u",
+        pool_id);
+    return;
+  }
+
+  for (l = comm->shm_blocks.head; l; l = l->next) {
+    block = l->data;
+    if (block->offset == offset && !block->released) {
+      block->released = TRUE;
+      break;
+    }
+  }
+  if (!l) {
+    GST_WARNING_OBJECT (comm->element, "Got release for unknown block at %"
+        G_GUINT64_FORMAT, offset);
+    return;
+  }
+
+  while ((block = g_queue_peek_head (&comm->shm_blocks)) && block->released)
+    g_slice_free (ShmBlock, g_queue_pop_head (&comm->shm_blocks));
+  if (g_queue_is_empty (&comm->shm_blocks))
+    comm->shm_head = 0;
+}
+
+static void
+shm_block_free (gpointer data)
+{
+  g_slice_free (ShmBlock, data);
+}
+
+static void
+gst_ipc_pipeline_comm_reset_shm_pool_unlocked (GstIpcPipelineComm * comm)
+{
+  if (comm->shm_data) {
+    GST_DEBUG_OBJECT (comm->element, "Dropping shared memory pool %u",
+        comm->shm_pool_id);
+    munmap (comm->shm_data, comm->shm_size);
+    close (comm->shm_fd);
+  }
+  comm->shm_data = NULL;
+  comm->shm_fd = -1;
+  comm->shm_size = 0;
+  comm->shm_head = 0;
+  comm->shm_failed = FALSE;
+  g_queue_foreach (&comm->shm_blocks, (GFunc) shm_block_free, NULL);
+  g_queue_clear (&comm->shm_blocks);
+}
+
+/* Drops the shared memory pool, e.g. when the peer went away. Blocks the
+ * peer still holds are forgotten, and a new pool is created and passed
+ * the next time a buffer is sent. On the receiving side, this unmaps the
+ * pools of the previous peer once the buffers using them are freed. Must
+ * not be called while the reader thread runs. */
+void
+gst_ipc_pipeline_comm_reset_shm_pool (GstIpcPipelineComm * comm)
+{
+  g_mutex_lock (&comm->mutex);
+  gst_ipc_pipeline_comm_reset_shm_pool_unlocked (comm);
+  g_hash_table_remove_all (comm->shm_mappings);
+  g_mutex_unlock (&comm->mutex);
+}
+
+static void
+shm_mapping_unref (GstIpcPipelineCommShmMapping * mapping)
+{
+  if (g_atomic_int_dec_and_test (&mapping->refcount)) {
+    munmap (mapping->data, mapping->size);
+    g_slice_free (GstIpcPipelineCommShmMapping, mapping);
+  }
+}
+
+static void
+gst_ipc_pipeline_comm_write_shm_release_to_fd (GstIpcPipelineComm * comm,
+    guint32 pool_id, guint64 offset)
+{
+  const unsigned char payload_type =
+      GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_RELEASE;
+  GstByteWriter bw;
+
+  g_mutex_lock (&comm->mutex);
+  gst_byte_writer_init (&bw);
+
+  /* the peer is gone along with its pool */
+  if (comm->fdout < 0)
+    goto done;
+
+  ++comm->send_id;
+  GST_TRACE_OBJECT (comm->element, "Writing shm release %u: pool %u, offset %"
+      G_GUINT64_FORMAT, comm->send_id, pool_id, offset);
+
+  if (!gst_byte_writer_put_uint8 (&bw, payload_type))
+    goto write_failed;
+  if (!gst_byte_writer_put_uint32_le (&bw, comm->send_id))
+    goto write_failed;
+  if (!gst_byte_writer_put_uint32_le (&bw, sizeof (pool_id) + sizeof (offset)))
+    goto write_failed;
+  if (!gst_byte_writer_put_uint32_le (&bw, pool_id))
+    goto write_failed;
+  if (!gst_byte_writer_put_uint64_le (&bw, offset))
+    goto write_failed;
+
+  if (!write_byte_writer_to_fd (comm, &bw))
+    goto write_failed;
+
+done:
+  g_mutex_unlock (&comm->mutex);
+  gst_byte_writer_reset (&bw);
+  return;
+
+write_failed:
+  /* this only means the peer will not reuse that part of its pool */
+  GST_WARNING_OBJECT (comm->element, "Failed to write shm release");
+  goto done;
+}
+
+static void
+shm_buffer_release (ShmBufferRelease * release)
+{
+  gst_ipc_pipeline_comm_write_shm_release_to_fd (release->comm,
+      release->pool_id, release->offset);
+  shm_mapping_unref (release->mapping);
+  gst_object_unref (release->element);
+  g_slice_free (ShmBufferRelease, release);
+}
+
+static GstBuffer *
+gst_ipc_pipeline_comm_wrap_shm (GstIpcPipelineComm * comm, guint32 pool_id,
+    guint64 offset, guint32 size)
+{
+  GstIpcPipelineCommShmMapping *mapping;
+  ShmBufferRelease *release;
+
+  mapping = g_hash_table_lookup (comm->shm_mappings,
+      GUINT_TO_POINTER (pool_id));
+  if (!mapping || offset > mapping->size || size > mapping->size - offset) {
+    GST_ERROR_OBJECT (comm->element, "Invalid shm block: pool %u, offset %"
+        G_GUINT64_FORMAT ", size %u", pool_id, offset, size);
+    /* still hand the block back */
+    gst_ipc_pipeline_comm_write_shm_release_to_fd (comm, pool_id, offset);
+    return NULL;
+  }
+
+  release = g_slice_new (ShmBufferRelease);
+  release->element = gst_object_ref (comm->element);
+  release->comm = comm;
+  release->mapping = mapping;
+  g_atomic_int_inc (&mapping->refcount);
+  release->pool_id = pool_id;
+  release->offset = offset;
+
+  return gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+      mapping->data + offset, size, 0, size, release,
+      (GDestroyNotify) shm_buffer_release);
+}
+
+static gboolean
+gst_ipc_pipeline_comm_read_shm_pool (GstIpcPipelineComm * comm, guint32 size)
+{
+  GstIpcPipelineCommShmMapping *mapping;
+  const guint8 *payload;
+  guint32 pool_id;
+  guint64 pool_size;
+  guint8 *data;
+  int fd;
+
+  /* this should not be called if we don't have enough yet */
+  g_return_val_if_fail (gst_adapter_available (comm->adapter) >= size, FALSE);
+  g_return_val_if_fail (size >= sizeof (pool_id) + sizeof (pool_size), FALSE);
+
+  payload = gst_adapter_map (comm->adapter, size);
+  if (!payload)
+    return FALSE;
+  pool_id = GST_READ_UINT32_LE (payload);
+  pool_size = GST_READ_UINT64_LE (payload + sizeof (pool_id));
+  gst_adapter_unmap (comm->adapter);
+  gst_adapter_flush (comm->adapter, size);
+
+  if (g_queue_is_empty (&comm->received_fds)) {
+    GST_ERROR_OBJECT (comm->element, "No fd was passed for shm pool %u",
+        pool_id);
+    return FALSE;
+  }
+  fd = GPOINTER_TO_INT (g_queue_pop_head (&comm->received_fds));
+
+  data = mmap (NULL, pool_size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (data == MAP_FAILED) {
+    GST_ERROR_OBJECT (comm->element, "Failed to map shm pool %u: %s", pool_id,
+        strerror (errno));
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (comm->element, "Mapped shm pool %u of %" G_GUINT64_FORMAT
+      " bytes", pool_id, pool_size);
+
+  /* The peer only uses one pool at a time, so a new one replaces the
+   * previous ones, e.g. after a reconnection or a reset. Buffers still
+   * wrapping the old pools keep their mapping alive until they are freed */
+  g_hash_table_remove_all (comm->shm_mappings);
+
+  mapping = g_slice_new (GstIpcPipelineCommShmMapping);
+  mapping->refcount = 1;
+  mapping->data = data;
+  mapping->size = pool_size;
+  g_hash_table_insert (comm->shm_mappings, GUINT_TO_POINTER (pool_id),
+      mapping);
+
+  return TRUE;
+}
+
+static gboolean
+gst_ipc_pipeline_comm_read_shm_release (GstIpcPipelineComm * comm,
+    guint32 size)
+{
+  const guint8 *payload;
+  guint32 pool_id;
+  guint64 offset;
+
+  /* this should not be called if we don't have enough yet */
+  g_return_val_if_fail (gst_adapter_available (comm->adapter) >= size, FALSE);
+  g_return_val_if_fail (size >= sizeof (pool_id) + sizeof (offset), FALSE);
+
+  payload = gst_adapter_map (comm->adapter, size);
+  if (!payload)
+    return FALSE;
+  pool_id = GST_READ_UINT32_LE (payload);
+  offset = GST_READ_UINT64_LE (payload + sizeof (pool_id));
+  gst_adapter_unmap (comm->adapter);
+  gst_adapter_flush (comm->adapter, size);
+
+  GST_TRACE_OBJECT (comm->element, "Got shm release for pool %u, offset %"
+      G_GUINT64_FORMAT, pool_id, offset);
+
+  g_mutex_lock (&comm->mutex);
+  gst_ipc_pipeline_comm_shm_release (comm, pool_id, offset);
+  g_mutex_unlock (&comm->mutex);
+
+  return TRUE;
+}
+
 static void
 gst_ipc_pipeline_comm_write_ack_to_fd (GstIpcPipelineComm * comm, guint32 id,
     guint32 ret, CommRequestType type)
@@ -500,7 +970,7 @@ GstFlowReturn
 gst_ipc_pipeline_comm_write_buffer_to_fd (GstIpcPipelineComm * comm,
     GstBuffer * buffer)
 {
-  const unsigned char payload_type = GST_IPC_PIPELINE_COMM_DATA_TYPE_BUFFER;
+  unsigned char payload_type = GST_IPC_PIPELINE_COMM_DATA_TYPE_BUFFER;
   GstMapInfo map;
   guint32 ret32 = GST_FLOW_OK;
   guint32 size, n;
@@ -508,8 +978,17 @@ gst_ipc_pipeline_comm_write_buffer_to_fd (GstIpcPipelineComm * comm,
   GstFlowReturn ret;
   MetaListRepresentation repr = { comm, 0, 4, NULL };   /* starts a 4 for n_meta */
   GstByteWriter bw;
+  gsize shm_offset = 0;
+  gboolean shm, shm_sent = FALSE;
 
   g_mutex_lock (&comm->mutex);
+
+  /* this may have to send the pool first, so before picking our id */
+  shm = gst_ipc_pipeline_comm_shm_alloc (comm, gst_buffer_get_size (buffer),
+      &shm_offset);
+  if (shm)
+    payload_type = GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_BUFFER;
+
   ++comm->send_id;
 
   GST_TRACE_OBJECT (comm->element, "Writing buffer %u: %" GST_PTR_FORMAT,
@@ -531,25 +1010,42 @@ gst_ipc_pipeline_comm_write_buffer_to_fd (GstIpcPipelineComm * comm,
     goto write_failed;
   if (!gst_byte_writer_put_uint32_le (&bw, comm->send_id))
     goto write_failed;
-  size =
-      gst_buffer_get_size (buffer) + sizeof (guint32) +
-      sizeof (CommBufferMetadata) + repr.total_bytes;
+  if (shm)
+    size = sizeof (guint32) + sizeof (guint64);
+  else
+    size = gst_buffer_get_size (buffer);
+  size += sizeof (guint32) + sizeof (CommBufferMetadata) + repr.total_bytes;
   if (!gst_byte_writer_put_uint32_le (&bw, size))
     goto write_failed;
   if (!gst_byte_writer_put_data (&bw, (const guint8 *) &meta, sizeof (meta)))
     goto write_failed;
+  if (shm) {
+    if (!gst_byte_writer_put_uint32_le (&bw, comm->shm_pool_id))
+      goto write_failed;
+    if (!gst_byte_writer_put_uint64_le (&bw, shm_offset))
+      goto write_failed;
+  }
   size = gst_buffer_get_size (buffer);
   if (!gst_byte_writer_put_uint32_le (&bw, size))
     goto write_failed;
-  if (!write_byte_writer_to_fd (comm, &bw))
-    goto write_failed;
 
-  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
-    goto map_failed;
-  ret = write_to_fd_raw (comm, map.data, map.size);
-  gst_buffer_unmap (buffer, &map);
-  if (!ret)
-    goto write_failed;
+  if (shm) {
+    /* the payload goes to the pool, only its location is sent */
+    gst_buffer_extract (buffer, 0, comm->shm_data + shm_offset, size);
+    if (!write_byte_writer_to_fd (comm, &bw))
+      goto write_failed;
+    shm_sent = TRUE;
+  } else {
+    if (!write_byte_writer_to_fd (comm, &bw))
+      goto write_failed;
+
+    if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+      goto map_failed;
+    ret = write_to_fd_raw (comm, map.data, map.size);
+    gst_buffer_unmap (buffer, &map);
+    if (!ret)
+      goto write_failed;
+  }
 
   /* meta */
   gst_byte_writer_init (&bw);
@@ -605,40 +1101,60 @@ write_failed:
   GST_ELEMENT_ERROR (comm->element, RESOURCE, WRITE, (NULL),
       ("Failed to write to socket"));
   ret = GST_FLOW_COMM_ERROR;
-  goto done;
+  goto release_shm;
 
 wait_failed:
   GST_ELEMENT_ERROR (comm->element, RESOURCE, WRITE, (NULL),
       ("Failed to wait for reply on socket"));
   ret = GST_FLOW_COMM_ERROR;
-  goto done;
+  goto release_shm;
 
 map_failed:
   GST_ELEMENT_ERROR (comm->element, RESOURCE, READ, (NULL),
       ("Failed to map buffer"));
   ret = GST_FLOW_ERROR;
+  goto release_shm;
+
+release_shm:
+  /* The peer will not release a block whose location it did not get. Once
+   * the location was sent, the peer may hold the block and release it
+   * later, so it stays allocated until then or until the pool is dropped */
+  if (shm && !shm_sent)
+    gst_ipc_pipeline_comm_shm_release (comm, comm->shm_pool_id, shm_offset);
   goto done;
 }
 
 static GstBuffer *
-gst_ipc_pipeline_comm_read_buffer (GstIpcPipelineComm * comm, guint32 size)
+gst_ipc_pipeline_comm_read_buffer (GstIpcPipelineComm * comm, guint32 size,
+    gboolean shm)
 {
   GstBuffer *buffer;
   CommBufferMetadata meta;
   guint32 n_meta, n;
   const guint8 *payload = NULL;
   guint32 mapped_size, buffer_data_size;
+  guint32 pool_id = 0;
+  guint64 shm_offset = 0;
 
   /* this should not be called if we don't have enough yet */
   g_return_val_if_fail (gst_adapter_available (comm->adapter) >= size, NULL);
   g_return_val_if_fail (size >= sizeof (CommBufferMetadata), NULL);
 
   mapped_size = sizeof (CommBufferMetadata) + sizeof (buffer_data_size);
+  if (shm)
+    mapped_size += sizeof (pool_id) + sizeof (shm_offset);
+  g_return_val_if_fail (size >= mapped_size, NULL);
   payload = gst_adapter_map (comm->adapter, mapped_size);
   if (!payload)
     return NULL;
   memcpy (&meta, payload, sizeof (CommBufferMetadata));
   payload += sizeof (CommBufferMetadata);
+  if (shm) {
+    pool_id = GST_READ_UINT32_LE (payload);
+    payload += sizeof (pool_id);
+    shm_offset = GST_READ_UINT64_LE (payload);
+    payload += sizeof (shm_offset);
+  }
   memcpy (&buffer_data_size, payload, sizeof (buffer_data_size));
   size -= mapped_size;
   gst_adapter_unmap (comm->adapter);
@@ -646,11 +1162,18 @@ gst_ipc_pipeline_comm_read_buffer (GstIpcPipelineComm * comm, guint32 size)
 
   if (buffer_data_size == 0) {
     buffer = gst_buffer_new ();
+  } else if (shm) {
+    buffer = gst_ipc_pipeline_comm_wrap_shm (comm, pool_id, shm_offset,
+        buffer_data_size);
+    if (!buffer) {
+      gst_adapter_flush (comm->adapter, size);
+      return NULL;
+    }
   } else {
     buffer = gst_adapter_get_buffer (comm->adapter, buffer_data_size);
     gst_adapter_flush (comm->adapter, buffer_data_size);
+    size -= buffer_data_size;
   }
-  size -= buffer_data_size;
 
   GST_BUFFER_PTS (buffer) = meta.pts;
   GST_BUFFER_DTS (buffer) = meta.dts;
@@ -1607,11 +2130,21 @@ gst_ipc_pipeline_comm_init (GstIpcPipelineComm * comm, GstElement * element)
   comm->adapter = gst_adapter_new ();
   comm->poll = gst_poll_new (TRUE);
   gst_poll_fd_init (&comm->pollFDin);
+  comm->shm_fd = -1;
+  g_queue_init (&comm->shm_blocks);
+  g_queue_init (&comm->received_fds);
+  comm->shm_mappings =
+      g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+      (GDestroyNotify) shm_mapping_unref);
 }
 
 void
 gst_ipc_pipeline_comm_clear (GstIpcPipelineComm * comm)
 {
+  while (!g_queue_is_empty (&comm->received_fds))
+    close (GPOINTER_TO_INT (g_queue_pop_head (&comm->received_fds)));
+  g_hash_table_destroy (comm->shm_mappings);
+  gst_ipc_pipeline_comm_reset_shm_pool_unlocked (comm);
   g_hash_table_destroy (comm->waiting_ids);
   gst_object_unref (comm->adapter);
   gst_poll_free (comm->poll);
@@ -1699,6 +2232,57 @@ gst_ipc_pipeline_comm_reply_request (GstIpcPipelineComm * comm, guint32 id,
   return TRUE;
 }
 
+/* Reads from a socket fdin, keeping the fds passed along for the chunks
+ * that refer to them */
+static ssize_t
+read_with_fds (GstIpcPipelineComm * comm, void *data, size_t size)
+{
+  union
+  {
+    struct cmsghdr hdr;
+    char buf[CMSG_SPACE (MAX_PASSED_FDS * sizeof (int))];
+  } control;
+  struct cmsghdr *cmsg;
+  struct msghdr msg;
+  struct iovec iov;
+  ssize_t sz;
+  int flags = 0;
+
+#ifdef MSG_CMSG_CLOEXEC
+  flags |= MSG_CMSG_CLOEXEC;
+#endif
+
+  memset (&msg, 0, sizeof (msg));
+  iov.iov_base = data;
+  iov.iov_len = size;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof (control.buf);
+
+  sz = recvmsg (comm->pollFDin.fd, &msg, flags);
+  if (sz <= 0)
+    return sz;
+
+  for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      guint n, n_fds = (cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (int);
+
+      for (n = 0; n < n_fds; ++n) {
+        int fd;
+
+        memcpy (&fd, CMSG_DATA (cmsg) + n * sizeof (int), sizeof (int));
+        GST_DEBUG_OBJECT (comm->element, "Received fd %d", fd);
+        g_queue_push_tail (&comm->received_fds, GINT_TO_POINTER (fd));
+      }
+    }
+  }
+  if (msg.msg_flags & MSG_CTRUNC)
+    GST_WARNING_OBJECT (comm->element, "Some passed fds were dropped");
+
+  return sz;
+}
+
 static gint
 update_adapter (GstIpcPipelineComm * comm)
 {
@@ -1722,8 +2306,12 @@ again:
       gst_poll_fd_init (&comm->pollFDin);
     }
     if (comm->fdin != -1 && GST_OBJECT_PARENT (comm->element)) {
+      struct stat st;
+
       GST_DEBUG_OBJECT (comm->element, "Start watching fd %d", comm->fdin);
       comm->pollFDin.fd = comm->fdin;
+      comm->fdin_is_socket = fstat (comm->fdin, &st) == 0
+          && S_ISSOCK (st.st_mode);
       gst_poll_add_fd (comm->poll, &comm->pollFDin);
       gst_poll_fd_ctl_read (comm->poll, &comm->pollFDin, TRUE);
     }
@@ -1745,7 +2333,10 @@ again:
       mem = gst_allocator_alloc (NULL, comm->read_chunk_size, NULL);
 
     gst_memory_map (mem, &map, GST_MAP_WRITE);
-    sz = read (comm->pollFDin.fd, map.data, map.size);
+    if (comm->fdin_is_socket)
+      sz = read_with_fds (comm, map.data, map.size);
+    else
+      sz = read (comm->pollFDin.fd, map.data, map.size);
     gst_memory_unmap (mem, &map);
 
     if (sz <= 0) {
@@ -1810,6 +2401,9 @@ read_many (GstIpcPipelineComm * comm)
           case GST_IPC_PIPELINE_COMM_DATA_TYPE_STATE_LOST:
           case GST_IPC_PIPELINE_COMM_DATA_TYPE_MESSAGE:
           case GST_IPC_PIPELINE_COMM_DATA_TYPE_GERROR_MESSAGE:
+          case GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_POOL:
+          case GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_BUFFER:
+          case GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_RELEASE:
             GST_TRACE_OBJECT (comm->element, "switching to state %s",
                 gst_ipc_pipeline_comm_data_type_get_name (type));
             comm->state = type;
@@ -1874,6 +2468,7 @@ read_many (GstIpcPipelineComm * comm)
         break;
       }
       case GST_IPC_PIPELINE_COMM_DATA_TYPE_BUFFER:
+      case GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_BUFFER:
       {
         GstBuffer *buf;
 
@@ -1881,7 +2476,8 @@ read_many (GstIpcPipelineComm * comm)
         if (available < comm->payload_length)
           goto done;
 
-        buf = gst_ipc_pipeline_comm_read_buffer (comm, comm->payload_length);
+        buf = gst_ipc_pipeline_comm_read_buffer (comm, comm->payload_length,
+            comm->state == GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_BUFFER);
         if (!buf)
           goto buffer_failed;
 
@@ -2075,6 +2671,33 @@ read_many (GstIpcPipelineComm * comm)
         comm->state = GST_IPC_PIPELINE_COMM_STATE_TYPE;
         break;
       }
+      case GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_POOL:
+      {
+        available = gst_adapter_available (comm->adapter);
+        if (available < comm->payload_length)
+          goto done;
+
+        if (!gst_ipc_pipeline_comm_read_shm_pool (comm, comm->payload_length))
+          goto shm_failed;
+
+        GST_TRACE_OBJECT (comm->element, "switching to state TYPE");
+        comm->state = GST_IPC_PIPELINE_COMM_STATE_TYPE;
+        break;
+      }
+      case GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_RELEASE:
+      {
+        available = gst_adapter_available (comm->adapter);
+        if (available < comm->payload_length)
+          goto done;
+
+        if (!gst_ipc_pipeline_comm_read_shm_release (comm,
+                comm->payload_length))
+          goto shm_failed;
+
+        GST_TRACE_OBJECT (comm->element, "switching to state TYPE");
+        comm->state = GST_IPC_PIPELINE_COMM_STATE_TYPE;
+        break;
+      }
     }
 
 done:
@@ -2130,6 +2753,13 @@ query_failed:
     ret = FALSE;
     goto done;
   }
+shm_failed:
+  {
+    GST_ELEMENT_ERROR (comm->element, STREAM, DECODE, (NULL),
+        ("could not read shared memory chunk from fd"));
+    ret = FALSE;
+    goto done;
+  }
 }
 
 static gpointer
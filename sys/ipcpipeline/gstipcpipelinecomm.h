@@ -51,8 +51,14 @@ typedef enum {
   GST_IPC_PIPELINE_COMM_DATA_TYPE_STATE_LOST,
   GST_IPC_PIPELINE_COMM_DATA_TYPE_MESSAGE,
   GST_IPC_PIPELINE_COMM_DATA_TYPE_GERROR_MESSAGE,
+  /* shared memory payload transport */
+  GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_POOL,
+  GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_BUFFER,
+  GST_IPC_PIPELINE_COMM_DATA_TYPE_SHM_RELEASE,
 } GstIpcPipelineCommDataType;
 
+typedef struct _GstIpcPipelineCommShmMapping GstIpcPipelineCommShmMapping;
+
 typedef struct
 {
   GstElement *element;
@@ -65,6 +71,7 @@ typedef struct
   GThread *reader_thread;
   GstPoll *poll;
   GstPollFD pollFDin;
+  gboolean fdin_is_socket;
 
   GstAdapter *adapter;
   guint8 state;
@@ -76,6 +83,22 @@ typedef struct
   guint read_chunk_size;
   GstClockTime ack_time;
 
+  /* sending side of the shared memory pool, buffer payloads are copied
+   * there and only their location is sent when shm_pool_size is not 0 */
+  guint shm_pool_size;
+  gboolean shm_failed;
+  gint shm_fd;
+  guint8 *shm_data;
+  guint32 shm_pool_id;
+  gsize shm_size;
+  gsize shm_head;
+  GQueue shm_blocks;
+
+  /* receiving side: fds passed along with the chunks, and the pools
+   * mapped from them */
+  GQueue received_fds;
+  GHashTable *shm_mappings;
+
   void (*on_buffer) (guint32, GstBuffer *, gpointer);
   void (*on_event) (guint32, GstEvent *, gboolean, gpointer);
   void (*on_query) (guint32, GstQuery *, gboolean, gpointer);
@@ -92,6 +115,7 @@ void gst_ipc_pipeline_comm_init (GstIpcPipelineComm *comm, GstElement *e);
 void gst_ipc_pipeline_comm_clear (GstIpcPipelineComm *comm);
 void gst_ipc_pipeline_comm_cancel (GstIpcPipelineComm * comm,
     gboolean flushing);
+void gst_ipc_pipeline_comm_reset_shm_pool (GstIpcPipelineComm * comm);
 
 void gst_ipc_pipeline_comm_write_flow_ack_to_fd (GstIpcPipelineComm * comm,
     guint32 id, GstFlowReturn ret);
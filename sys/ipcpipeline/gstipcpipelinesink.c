@@ -66,7 +66,10 @@
  * GError are serialized differently).
  *
  * Buffers are transported by writing their content directly on the socket.
- * More efficient ways for memory sharing could be implemented in the future.
+ * When #GstIpcPipelineSink:shm-pool-size is set and the socket is a UNIX
+ * socket, their content is instead copied to a shared memory pool which is
+ * passed once to ipcpipelinesrc, and only its location is written on the
+ * socket. ipcpipelinesrc then hands the memory back when the buffer is freed.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -98,11 +101,13 @@ enum
   PROP_FDOUT,
   PROP_READ_CHUNK_SIZE,
   PROP_ACK_TIME,
+  PROP_SHM_POOL_SIZE,
 };
 
 
 #define DEFAULT_READ_CHUNK_SIZE 4096
 #define DEFAULT_ACK_TIME (10 * G_TIME_SPAN_SECOND)
+#define DEFAULT_SHM_POOL_SIZE 0
 
 #define _do_init \
     GST_DEBUG_CATEGORY_INIT (gst_ipc_pipeline_sink_debug, "ipcpipelinesink", 0, "ipcpipelinesink element");
@@ -174,6 +179,13 @@ gst_ipc_pipeline_sink_class_init (GstIpcPipelineSinkClass * klass)
           "Maximum time to wait for a response to a message",
           0, G_MAXUINT64, DEFAULT_ACK_TIME,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_SHM_POOL_SIZE,
+      g_param_spec_uint ("shm-pool-size", "Shared memory pool size",
+          "Size of a shared memory pool buffer payloads are placed in, so "
+          "that only their location goes through fdout, which must then be "
+          "a UNIX socket (0 = send payloads through fdout)",
+          0, G_MAXINT, DEFAULT_SHM_POOL_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_ipc_pipeline_sink_signals[SIGNAL_DISCONNECT] =
       g_signal_new ("disconnect",
@@ -210,6 +222,7 @@ gst_ipc_pipeline_sink_init (GstIpcPipelineSink * sink)
   gst_ipc_pipeline_comm_init (&sink->comm, GST_ELEMENT (sink));
   sink->comm.read_chunk_size = DEFAULT_READ_CHUNK_SIZE;
   sink->comm.ack_time = DEFAULT_ACK_TIME;
+  sink->comm.shm_pool_size = DEFAULT_SHM_POOL_SIZE;
   sink->comm.fdin = -1;
   sink->comm.fdout = -1;
   sink->threads = g_thread_pool_new (pusher, sink, -1, FALSE, NULL);
@@ -271,6 +284,11 @@ gst_ipc_pipeline_sink_set_property (GObject * object, guint prop_id,
     case PROP_ACK_TIME:
       sink->comm.ack_time = g_value_get_uint64 (value);
       break;
+    case PROP_SHM_POOL_SIZE:
+      g_mutex_lock (&sink->comm.mutex);
+      sink->comm.shm_pool_size = g_value_get_uint (value);
+      g_mutex_unlock (&sink->comm.mutex);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -296,6 +314,9 @@ gst_ipc_pipeline_sink_get_property (GObject * object, guint prop_id,
     case PROP_ACK_TIME:
       g_value_set_uint64 (value, sink->comm.ack_time);
       break;
+    case PROP_SHM_POOL_SIZE:
+      g_value_set_uint (value, sink->comm.shm_pool_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -577,6 +598,7 @@ gst_ipc_pipeline_sink_disconnect (GstIpcPipelineSink * sink)
   sink->comm.fdin = -1;
   sink->comm.fdout = -1;
   gst_ipc_pipeline_comm_cancel (&sink->comm, FALSE);
+  gst_ipc_pipeline_comm_reset_shm_pool (&sink->comm);
   gst_ipc_pipeline_sink_start_reader_thread (sink);
 }
 
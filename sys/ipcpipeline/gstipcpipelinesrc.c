@@ -919,6 +919,7 @@ gst_ipc_pipeline_src_disconnect (GstIpcPipelineSrc * src)
   src->comm.fdin = -1;
   src->comm.fdout = -1;
   gst_ipc_pipeline_comm_cancel (&src->comm, FALSE);
+  gst_ipc_pipeline_comm_reset_shm_pool (&src->comm);
   gst_ipc_pipeline_src_start_reader_thread (src);
 }
 
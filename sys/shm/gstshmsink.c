@@ -31,16 +31,30 @@
  * ! shmsink socket-path=/tmp/blah shm-size=2000000
  * ]| Send video to shm buffers.
  *
+ * Buffers backed by a memfd or a dmabuf are passed to the shmsrc elements
+ * which have #GstShmSrc:use-fd-passing set without being copied into the
+ * shared memory area. With #GstShmSink:use-memfd, upstream is proposed an
+ * allocator which creates such buffers.
  */
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE             /* memfd_create */
+#endif
+
 #include "gstshmsink.h"
 
 #include <gst/gst.h>
+#include <gst/allocators/allocators.h>
 
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#ifdef HAVE_MEMFD_CREATE
+#include <sys/mman.h>
+#endif
 
 /* signals */
 enum
@@ -58,7 +72,9 @@ enum
   PROP_PERMS,
   PROP_SHM_SIZE,
   PROP_WAIT_FOR_CONNECTION,
-  PROP_BUFFER_TIME
+  PROP_BUFFER_TIME,
+  PROP_MAX_SHM_SIZE,
+  PROP_USE_MEMFD
 };
 
 struct GstShmClient
@@ -69,6 +85,8 @@ struct GstShmClient
 
 #define DEFAULT_SIZE ( 64 * 1024 * 1024 )
 #define DEFAULT_WAIT_FOR_CONNECTION (TRUE)
+#define DEFAULT_MAX_SIZE (0)
+#define DEFAULT_USE_MEMFD (FALSE)
 /* Default is user read/write, group read */
 #define DEFAULT_PERMS ( S_IRUSR | S_IWUSR | S_IRGRP )
 
@@ -101,6 +119,7 @@ static gboolean gst_shm_sink_propose_allocation (GstBaseSink * sink,
     GstQuery * query);
 
 static gpointer pollthread_func (gpointer data);
+static gboolean gst_shm_sink_grow_locked (GstShmSink * self, gsize needed);
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
@@ -306,6 +325,10 @@ gst_shm_sink_allocator_alloc (GstAllocator * allocator, gsize size,
 
   GST_OBJECT_LOCK (self->sink);
   memory = gst_shm_sink_allocator_alloc_locked (self, size, params);
+  if (!memory && gst_shm_sink_grow_locked (self->sink,
+          size + params->prefix + params->padding +
+          (params->align | gst_memory_alignment)))
+    memory = gst_shm_sink_allocator_alloc_locked (self, size, params);
   GST_OBJECT_UNLOCK (self->sink);
 
   if (!memory) {
@@ -343,6 +366,82 @@ gst_shm_sink_allocator_new (GstShmSink * sink)
 }
 
 
+#ifdef HAVE_MEMFD_CREATE
+/********************
+ * MEMFD ALLOCATOR  *
+ ********************/
+
+#define GST_TYPE_SHM_SINK_MEMFD_ALLOCATOR \
+  (gst_shm_sink_memfd_allocator_get_type())
+
+typedef struct _GstShmSinkMemfdAllocator
+{
+  GstFdAllocator parent;
+} GstShmSinkMemfdAllocator;
+
+typedef struct _GstShmSinkMemfdAllocatorClass
+{
+  GstFdAllocatorClass parent;
+} GstShmSinkMemfdAllocatorClass;
+
+GType gst_shm_sink_memfd_allocator_get_type (void);
+
+G_DEFINE_TYPE (GstShmSinkMemfdAllocator, gst_shm_sink_memfd_allocator,
+    GST_TYPE_FD_ALLOCATOR);
+
+/* Every memory is its own memfd, which can be passed to the readers, so
+ * this is meant to be used from a buffer pool */
+static GstMemory *
+gst_shm_sink_memfd_allocator_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+  GstMemory *memory;
+  gsize maxsize = size + params->prefix + params->padding;
+  int fd;
+
+  fd = memfd_create ("gst-shmsink", MFD_CLOEXEC);
+  if (fd < 0) {
+    GST_WARNING_OBJECT (allocator, "memfd_create() failed: %s",
+        g_strerror (errno));
+    return NULL;
+  }
+
+  if (ftruncate (fd, maxsize) < 0) {
+    GST_WARNING_OBJECT (allocator, "Could not resize memfd to %"
+        G_GSIZE_FORMAT " bytes: %s", maxsize, g_strerror (errno));
+    close (fd);
+    return NULL;
+  }
+
+  /* The memfd is zero filled, mmap() takes care of the alignment */
+  memory = gst_fd_allocator_alloc (allocator, fd, maxsize,
+      GST_FD_MEMORY_FLAG_KEEP_MAPPED);
+  if (!memory) {
+    close (fd);
+    return NULL;
+  }
+
+  gst_memory_resize (memory, params->prefix, size);
+
+  return memory;
+}
+
+static void
+gst_shm_sink_memfd_allocator_class_init (GstShmSinkMemfdAllocatorClass *
+    klass)
+{
+  GstAllocatorClass *allocator_class = GST_ALLOCATOR_CLASS (klass);
+
+  allocator_class->alloc = gst_shm_sink_memfd_allocator_alloc;
+}
+
+static void
+gst_shm_sink_memfd_allocator_init (GstShmSinkMemfdAllocator * self)
+{
+}
+#endif
+
+
 /***************
  * MAIN OBJECT *
  ***************/
@@ -354,6 +453,8 @@ gst_shm_sink_init (GstShmSink * self)
   self->size = DEFAULT_SIZE;
   self->wait_for_connection = DEFAULT_WAIT_FOR_CONNECTION;
   self->perms = DEFAULT_PERMS;
+  self->max_size = DEFAULT_MAX_SIZE;
+  self->use_memfd = DEFAULT_USE_MEMFD;
 
   gst_allocation_params_init (&self->params);
 }
@@ -416,6 +517,22 @@ gst_shm_sink_class_init (GstShmSinkClass * klass)
           -1, G_MAXINT64, -1,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_MAX_SHM_SIZE,
+      g_param_spec_uint ("max-shm-size",
+          "Maximum size of the shm area",
+          "Size up to which the shared memory area is grown when a buffer "
+          "does not fit in it (0 = never grow it)",
+          0, G_MAXUINT, DEFAULT_MAX_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_USE_MEMFD,
+      g_param_spec_boolean ("use-memfd",
+          "Propose memfd allocator",
+          "Propose an allocator creating one memfd per buffer upstream, "
+          "these buffers are passed without copy to the clients supporting "
+          "fd passing (Linux only)",
+          DEFAULT_USE_MEMFD, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   signals[SIGNAL_CLIENT_CONNECTED] = g_signal_new ("client-connected",
       GST_TYPE_SHM_SINK, G_SIGNAL_RUN_LAST, 0, NULL, NULL,
       g_cclosure_marshal_VOID__INT, G_TYPE_NONE, 1, G_TYPE_INT);
@@ -504,6 +621,16 @@ gst_shm_sink_set_property (GObject * object, guint prop_id,
       GST_OBJECT_UNLOCK (object);
       g_cond_broadcast (&self->cond);
       break;
+    case PROP_MAX_SHM_SIZE:
+      GST_OBJECT_LOCK (object);
+      self->max_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (object);
+      break;
+    case PROP_USE_MEMFD:
+      GST_OBJECT_LOCK (object);
+      self->use_memfd = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (object);
+      break;
     default:
       break;
   }
@@ -533,6 +660,12 @@ gst_shm_sink_get_property (GObject * object, guint prop_id,
     case PROP_BUFFER_TIME:
       g_value_set_int64 (value, self->buffer_time);
       break;
+    case PROP_MAX_SHM_SIZE:
+      g_value_set_uint (value, self->max_size);
+      break;
+    case PROP_USE_MEMFD:
+      g_value_set_boolean (value, self->use_memfd);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -588,6 +721,17 @@ gst_shm_sink_start (GstBaseSink * bsink)
 
   self->allocator = gst_shm_sink_allocator_new (self);
 
+#ifdef HAVE_MEMFD_CREATE
+  if (self->use_memfd) {
+    self->memfd_allocator =
+        g_object_new (GST_TYPE_SHM_SINK_MEMFD_ALLOCATOR, NULL);
+    gst_object_ref_sink (self->memfd_allocator);
+  }
+#else
+  if (self->use_memfd)
+    GST_WARNING_OBJECT (self, "memfd is not supported on this system");
+#endif
+
   return TRUE;
 
 thread_error:
@@ -615,6 +759,10 @@ gst_shm_sink_stop (GstBaseSink * bsink)
     gst_object_unref (self->allocator);
   self->allocator = NULL;
 
+  if (self->memfd_allocator)
+    gst_object_unref (self->memfd_allocator);
+  self->memfd_allocator = NULL;
+
   g_thread_join (self->pollthread);
   self->pollthread = NULL;
 
@@ -657,6 +805,34 @@ gst_shm_sink_can_render (GstShmSink * self, GstClockTime time)
   return TRUE;
 }
 
+/* Replaces the shm area by a bigger one, the current one stays around
+ * until the buffers in it are released. Called with the object lock */
+static gboolean
+gst_shm_sink_grow_locked (GstShmSink * self, gsize needed)
+{
+  guint64 new_size;
+
+  if (self->max_size <= self->size)
+    return FALSE;
+
+  new_size = MAX ((guint64) self->size * 2, needed);
+  new_size = MIN (new_size, self->max_size);
+  if (new_size < needed)
+    return FALSE;
+
+  if (sp_writer_resize (self->pipe, new_size) < 0) {
+    GST_WARNING_OBJECT (self, "Could not grow shared memory area from %u to "
+        "%" G_GUINT64_FORMAT " bytes", self->size, new_size);
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (self, "Grew shared memory area from %u to %"
+      G_GUINT64_FORMAT " bytes", self->size, new_size);
+  self->size = new_size;
+
+  return TRUE;
+}
+
 static GstFlowReturn
 gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
 {
@@ -664,6 +840,7 @@ gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
   int rv = 0;
   GstMapInfo map;
   gboolean need_new_memory = FALSE;
+  gboolean pass_fd = FALSE;
   GstFlowReturn ret = GST_FLOW_OK;
   GstMemory *memory = NULL;
   GstBuffer *sendbuf = NULL;
@@ -703,13 +880,26 @@ gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
     memory = gst_buffer_peek_memory (buf, 0);
 
     if (memory->allocator != GST_ALLOCATOR (self->allocator)) {
-      need_new_memory = TRUE;
-      GST_LOG_OBJECT (self, "Memory in buffer %p was not allocated by "
-          "%" GST_PTR_FORMAT ", will memcpy", buf, memory->allocator);
+      if (gst_is_fd_memory (memory) &&
+          sp_writer_fd_passing_supported (self->pipe)) {
+        pass_fd = TRUE;
+        GST_LOG_OBJECT (self, "Memory in buffer %p is backed by fd %d, "
+            "passing it", buf, gst_fd_memory_get_fd (memory));
+      } else {
+        need_new_memory = TRUE;
+        GST_LOG_OBJECT (self, "Memory in buffer %p was not allocated by "
+            "%" GST_PTR_FORMAT ", will memcpy", buf, memory->allocator);
+      }
     }
   }
 
   if (need_new_memory) {
+    gsize needed = gst_buffer_get_size (buf) + self->params.prefix +
+        self->params.padding + (self->params.align | gst_memory_alignment);
+
+    if (needed > sp_writer_get_max_buf_size (self->pipe))
+      gst_shm_sink_grow_locked (self, needed);
+
     if (gst_buffer_get_size (buf) > sp_writer_get_max_buf_size (self->pipe)) {
       gsize area_size = sp_writer_get_max_buf_size (self->pipe);
       GST_ELEMENT_ERROR (self, RESOURCE, NO_SPACE_LEFT, (NULL),
@@ -722,6 +912,10 @@ gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
     while ((memory =
             gst_shm_sink_allocator_alloc_locked (self->allocator,
                 gst_buffer_get_size (buf), &self->params)) == NULL) {
+      /* Rather than waiting for the clients to release buffers */
+      if (gst_shm_sink_grow_locked (self, needed))
+        continue;
+
       g_cond_wait (&self->cond, GST_OBJECT_GET_LOCK (self));
       if (self->unlock) {
         GST_OBJECT_UNLOCK (self);
@@ -772,26 +966,32 @@ gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
     sendbuf = gst_buffer_ref (buf);
   }
 
-  if (!gst_buffer_map (sendbuf, &map, GST_MAP_READ)) {
-    GST_ELEMENT_ERROR (self, STREAM, FAILED,
-        (NULL), ("Failed to map data into send buffer"));
-    goto error;
-  }
+  if (pass_fd) {
+    rv = sp_writer_send_fd_buf (self->pipe, gst_fd_memory_get_fd (memory),
+        gst_is_dmabuf_memory (memory), memory->offset, memory->size, sendbuf);
+  } else {
+    if (!gst_buffer_map (sendbuf, &map, GST_MAP_READ)) {
+      GST_ELEMENT_ERROR (self, STREAM, FAILED,
+          (NULL), ("Failed to map data into send buffer"));
+      goto error;
+    }
+
+    /* Make the memory readonly as of now as we've sent it to the other side
+     * We know it's not mapped for writing anywhere as we just mapped it for
+     * reading
+     */
+    rv = sp_writer_send_buf (self->pipe, (char *) map.data, map.size,
+        sendbuf);
+    if (rv == -1) {
+      GST_ELEMENT_ERROR (self, STREAM, FAILED,
+          (NULL), ("Failed to send data over SHM"));
+      gst_buffer_unmap (sendbuf, &map);
+      goto error;
+    }
 
-  /* Make the memory readonly as of now as we've sent it to the other side
-   * We know it's not mapped for writing anywhere as we just mapped it for
-   * reading
-   */
-  rv = sp_writer_send_buf (self->pipe, (char *) map.data, map.size, sendbuf);
-  if (rv == -1) {
-    GST_ELEMENT_ERROR (self, STREAM, FAILED,
-        (NULL), ("Failed to send data over SHM"));
     gst_buffer_unmap (sendbuf, &map);
-    goto error;
   }
 
-  gst_buffer_unmap (sendbuf, &map);
-
   GST_OBJECT_UNLOCK (self);
 
   if (rv == 0) {
@@ -918,6 +1118,22 @@ pollthread_func (gpointer data)
 
         if (rv == 0)
           gst_buffer_unref (tag);
+
+        {
+          GSList *list = NULL;
+
+          GST_OBJECT_LOCK (self);
+          rv = sp_writer_recv_ring (self->pipe, gclient->client,
+              (sp_buffer_free_callback) free_buffer_locked, (void **) &list);
+          GST_OBJECT_UNLOCK (self);
+          g_slist_free_full (list, (GDestroyNotify) gst_buffer_unref);
+
+          if (rv < 0) {
+            GST_WARNING_OBJECT (self, "One client has a corrupted ring,"
+                " closing (retval: %d)", rv);
+            goto close_client;
+          }
+        }
       }
       continue;
     close_client:
@@ -997,6 +1213,9 @@ gst_shm_sink_propose_allocation (GstBaseSink * sink, GstQuery * query)
 {
   GstShmSink *self = GST_SHM_SINK (sink);
 
+  if (self->memfd_allocator)
+    gst_query_add_allocation_param (query, self->memfd_allocator, NULL);
+
   if (self->allocator)
     gst_query_add_allocation_param (query, GST_ALLOCATOR (self->allocator),
         NULL);
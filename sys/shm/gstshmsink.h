@@ -67,8 +67,12 @@ struct _GstShmSink
   GCond cond;
 
   GstShmSinkAllocator *allocator;
+  GstAllocator *memfd_allocator;
 
   GstAllocationParams params;
+
+  guint max_size;
+  gboolean use_memfd;
 };
 
 struct _GstShmSinkClass
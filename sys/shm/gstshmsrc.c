@@ -41,8 +41,10 @@
 #include "gstshmsrc.h"
 
 #include <gst/gst.h>
+#include <gst/allocators/allocators.h>
 
 #include <string.h>
+#include <unistd.h>
 
 /* signals */
 enum
@@ -56,15 +58,24 @@ enum
   PROP_0,
   PROP_SOCKET_PATH,
   PROP_IS_LIVE,
-  PROP_SHM_AREA_NAME
+  PROP_SHM_AREA_NAME,
+  PROP_USE_RING,
+  PROP_USE_FD_PASSING
 };
 
+#define DEFAULT_USE_RING FALSE
+#define DEFAULT_USE_FD_PASSING FALSE
+
 struct GstShmBuffer
 {
   char *buf;
+  /* if buf is NULL */
+  int fd_id;
   GstShmPipe *pipe;
 };
 
+static GQuark fd_buffer_quark;
+
 
 GST_DEBUG_CATEGORY_STATIC (shmsrc_debug);
 #define GST_CAT_DEFAULT shmsrc_debug
@@ -139,6 +150,20 @@ gst_shm_src_class_init (GstShmSrcClass * klass)
           "The name of the shared memory area used to get buffers",
           NULL, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_USE_RING,
+      g_param_spec_boolean ("use-ring", "Use shared memory ring",
+          "Exchange buffers through a ring in shared memory instead of one "
+          "message on the control socket per buffer (needs a recent shmsink)",
+          DEFAULT_USE_RING,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_USE_FD_PASSING,
+      g_param_spec_boolean ("use-fd-passing", "Use fd passing",
+          "Receive the buffers backed by a memfd or a dmabuf on the shmsink "
+          "side as file descriptors instead of copies (needs a recent "
+          "shmsink)", DEFAULT_USE_FD_PASSING,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template (gstelement_class, &srctemplate);
 
   gst_element_class_set_static_metadata (gstelement_class,
@@ -148,6 +173,8 @@ gst_shm_src_class_init (GstShmSrcClass * klass)
       "Olivier Crete <olivier.crete@collabora.co.uk>");
 
   GST_DEBUG_CATEGORY_INIT (shmsrc_debug, "shmsrc", 0, "Shared Memory Source");
+
+  fd_buffer_quark = g_quark_from_static_string ("GstShmSrcFdBuffer");
 }
 
 static void
@@ -155,6 +182,10 @@ gst_shm_src_init (GstShmSrc * self)
 {
   self->poll = gst_poll_new (TRUE);
   gst_poll_fd_init (&self->pollfd);
+  self->use_ring = DEFAULT_USE_RING;
+  self->use_fd_passing = DEFAULT_USE_FD_PASSING;
+  self->fd_allocator = gst_fd_allocator_new ();
+  self->dmabuf_allocator = gst_dmabuf_allocator_new ();
 }
 
 static void
@@ -164,6 +195,8 @@ gst_shm_src_finalize (GObject * object)
 
   gst_poll_free (self->poll);
   g_free (self->socket_path);
+  gst_object_unref (self->fd_allocator);
+  gst_object_unref (self->dmabuf_allocator);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -191,6 +224,16 @@ gst_shm_src_set_property (GObject * object, guint prop_id,
       gst_base_src_set_live (GST_BASE_SRC (object),
           g_value_get_boolean (value));
       break;
+    case PROP_USE_RING:
+      GST_OBJECT_LOCK (object);
+      self->use_ring = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (object);
+      break;
+    case PROP_USE_FD_PASSING:
+      GST_OBJECT_LOCK (object);
+      self->use_fd_passing = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (object);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -218,6 +261,16 @@ gst_shm_src_get_property (GObject * object, guint prop_id,
         g_value_set_string (value, sp_get_shm_area_name (self->pipe->pipe));
       GST_OBJECT_UNLOCK (object);
       break;
+    case PROP_USE_RING:
+      GST_OBJECT_LOCK (object);
+      g_value_set_boolean (value, self->use_ring);
+      GST_OBJECT_UNLOCK (object);
+      break;
+    case PROP_USE_FD_PASSING:
+      GST_OBJECT_LOCK (object);
+      g_value_set_boolean (value, self->use_fd_passing);
+      GST_OBJECT_UNLOCK (object);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -253,6 +306,25 @@ gst_shm_src_start_reading (GstShmSrc * self)
     return FALSE;
   }
 
+  GST_OBJECT_LOCK (self);
+  if (self->use_ring && !sp_client_request_ring (gstpipe->pipe)) {
+    GST_OBJECT_UNLOCK (self);
+    GST_ELEMENT_ERROR (self, RESOURCE, OPEN_READ_WRITE,
+        ("Could not request ring on socket %s: %d %s", self->socket_path,
+            errno, strerror (errno)), (NULL));
+    gst_shm_pipe_dec (gstpipe);
+    return FALSE;
+  }
+  if (self->use_fd_passing && !sp_client_request_fd_passing (gstpipe->pipe)) {
+    GST_OBJECT_UNLOCK (self);
+    GST_ELEMENT_ERROR (self, RESOURCE, OPEN_READ_WRITE,
+        ("Could not request fd passing on socket %s: %d %s",
+            self->socket_path, errno, strerror (errno)), (NULL));
+    gst_shm_pipe_dec (gstpipe);
+    return FALSE;
+  }
+  GST_OBJECT_UNLOCK (self);
+
   self->pipe = gstpipe;
 
   gst_poll_set_flushing (self->poll, FALSE);
@@ -307,10 +379,14 @@ free_buffer (gpointer data)
   g_return_if_fail (gsb->pipe != NULL);
   g_return_if_fail (gsb->pipe->src != NULL);
 
-  GST_LOG ("Freeing buffer %p", gsb->buf);
-
   GST_OBJECT_LOCK (gsb->pipe->src);
-  sp_client_recv_finish (gsb->pipe->pipe, gsb->buf);
+  if (gsb->buf) {
+    GST_LOG ("Freeing buffer %p", gsb->buf);
+    sp_client_recv_finish (gsb->pipe->pipe, gsb->buf);
+  } else {
+    GST_LOG ("Freeing fd buffer %d", gsb->fd_id);
+    sp_client_recv_finish_fd (gsb->pipe->pipe, gsb->fd_id);
+  }
   GST_OBJECT_UNLOCK (gsb->pipe->src);
 
   gst_shm_pipe_dec (gsb->pipe);
@@ -323,10 +399,26 @@ gst_shm_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
 {
   GstShmSrc *self = GST_SHM_SRC (psrc);
   gchar *buf = NULL;
+  ShmFdBuffer fdbuf;
   int rv = 0;
   struct GstShmBuffer *gsb;
 
+  fdbuf.fd = -1;
+
   do {
+    /* Buffers coming through the ring don't make the socket readable,
+     * so always look there first */
+    GST_OBJECT_LOCK (self);
+    rv = sp_client_recv_ring (self->pipe->pipe, &buf);
+    GST_OBJECT_UNLOCK (self);
+    if (rv < 0) {
+      GST_ELEMENT_ERROR (self, RESOURCE, READ, ("Failed to read from shmsrc"),
+          ("Error reading from ring: %d", rv));
+      return GST_FLOW_ERROR;
+    }
+    if (buf != NULL)
+      break;
+
     if (gst_poll_wait (self->poll, GST_CLOCK_TIME_NONE) < 0) {
       if (errno == EBUSY)
         return GST_FLOW_FLUSHING;
@@ -354,7 +446,7 @@ gst_shm_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
       buf = NULL;
       GST_LOG_OBJECT (self, "Reading from pipe");
       GST_OBJECT_LOCK (self);
-      rv = sp_client_recv (self->pipe->pipe, &buf);
+      rv = sp_client_recv_fd (self->pipe->pipe, &buf, &fdbuf);
       GST_OBJECT_UNLOCK (self);
       if (rv < 0) {
         GST_ELEMENT_ERROR (self, RESOURCE, READ, ("Failed to read from shmsrc"),
@@ -362,15 +454,51 @@ gst_shm_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
         return GST_FLOW_ERROR;
       }
     }
-  } while (buf == NULL);
-
-  GST_LOG_OBJECT (self, "Got buffer %p of size %d", buf, rv);
+  } while (buf == NULL && fdbuf.fd < 0);
 
   gsb = g_slice_new0 (struct GstShmBuffer);
   gsb->buf = buf;
   gsb->pipe = self->pipe;
   gst_shm_pipe_inc (self->pipe);
 
+  if (fdbuf.fd >= 0) {
+    GstMemory *mem;
+    gsize size = fdbuf.offset + rv;
+
+    GST_LOG_OBJECT (self, "Got %s fd %d of size %d", fdbuf.is_dmabuf ?
+        "dmabuf" : "memory", fdbuf.fd, rv);
+
+    gsb->fd_id = fdbuf.id;
+
+    if (fdbuf.is_dmabuf)
+      mem = gst_dmabuf_allocator_alloc (self->dmabuf_allocator, fdbuf.fd,
+          size);
+    else
+      mem = gst_fd_allocator_alloc (self->fd_allocator, fdbuf.fd, size,
+          GST_FD_MEMORY_FLAG_NONE);
+
+    if (!mem) {
+      close (fdbuf.fd);
+      free_buffer (gsb);
+      GST_ELEMENT_ERROR (self, RESOURCE, READ, ("Failed to read from shmsrc"),
+          ("Could not wrap file descriptor"));
+      return GST_FLOW_ERROR;
+    }
+
+    gst_memory_resize (mem, fdbuf.offset, rv);
+    GST_MINI_OBJECT_FLAG_SET (mem, GST_MEMORY_FLAG_READONLY);
+    /* the buffer is released once the memory is, wherever it ends up */
+    gst_mini_object_set_qdata (GST_MINI_OBJECT_CAST (mem), fd_buffer_quark,
+        gsb, free_buffer);
+
+    *outbuf = gst_buffer_new ();
+    gst_buffer_append_memory (*outbuf, mem);
+
+    return GST_FLOW_OK;
+  }
+
+  GST_LOG_OBJECT (self, "Got buffer %p of size %d", buf, rv);
+
   *outbuf = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
       buf, rv, 0, rv, gsb, free_buffer);
 
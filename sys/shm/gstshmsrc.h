@@ -56,6 +56,12 @@ struct _GstShmSrc
 
   GstFlowReturn flow_return;
   gboolean unlocked;
+
+  gboolean use_ring;
+  gboolean use_fd_passing;
+
+  GstAllocator *fd_allocator;
+  GstAllocator *dmabuf_allocator;
 };
 
 struct _GstShmSrcClass
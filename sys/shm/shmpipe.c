@@ -70,6 +70,44 @@
  * Type 4 goes from the client to the server
  * The rest are from the server to the client
  * The client should never write in the SHM
+ *
+ * Optionally, the client can ask for a shared memory ring, in which case
+ * buffers and acks no longer go through the socket, which is then only
+ * used to wake up the other side when a ring goes from empty to non-empty
+ * while the other side was waiting on it.
+ *
+ * type 5: request ring
+ * No payload
+ *
+ * type 6: new ring area
+ * Same payload as type 1, the area is mapped read-write by the client
+ *
+ * type 7: ring wakeup
+ * No payload, goes in both directions
+ *
+ * type 8: ring resume
+ * No payload, the client can take buffers from the ring again
+ *
+ * type 10: request fd passing
+ * No payload
+ *
+ * type 11: fd buffer, type 12: dmabuf buffer
+ * Same payload as type 3, the offset is in the file descriptor which is
+ * attached to the message, the area id is the id of the buffer
+ *
+ * type 13: ack fd buffer
+ * No payload, the area id is the id of the buffer
+ *
+ * Types 5, 10 and 13 go from the client to the server
+ * Types 6, 8, 11 and 12 go from the server to the client
+ *
+ * The ring area contains two single producer single consumer queues of
+ * RingEntry, one with the buffers for the client (type 3 entries) and
+ * one with the acks for the server (type 4 entries). If the buffer queue
+ * is full, the server pushes an overflow marker (type 9) in the slot it
+ * always keeps free and sends the buffers through the socket until the
+ * client has consumed the whole queue, it then sends type 8 over the
+ * socket before using the queue again. This keeps the buffers in order.
  */
 
 
@@ -80,9 +118,22 @@ enum
   COMMAND_NEW_SHM_AREA = 1,
   COMMAND_CLOSE_SHM_AREA = 2,
   COMMAND_NEW_BUFFER = 3,
-  COMMAND_ACK_BUFFER = 4
+  COMMAND_ACK_BUFFER = 4,
+  COMMAND_REQUEST_RING = 5,
+  COMMAND_NEW_RING_AREA = 6,
+  COMMAND_RING_WAKEUP = 7,
+  COMMAND_RING_RESUME = 8,
+  COMMAND_RING_OVERFLOW = 9,
+  COMMAND_REQUEST_FD_PASSING = 10,
+  COMMAND_NEW_FD_BUFFER = 11,
+  COMMAND_NEW_DMABUF_BUFFER = 12,
+  COMMAND_ACK_FD_BUFFER = 13
 };
 
+/* Must be a power of two so that the indexes can wrap around */
+#define RING_NUM_ENTRIES 256
+#define RING_CACHELINE_SIZE 64
+
 typedef struct _ShmArea ShmArea;
 
 struct _ShmArea
@@ -108,9 +159,11 @@ struct _ShmBuffer
 {
   int use_count;
 
+  /* NULL for buffers passed as a file descriptor */
   ShmArea *shm_area;
   unsigned long offset;
   size_t size;
+  int fd_id;
 
   ShmAllocBlock *ablock;
 
@@ -134,6 +187,7 @@ struct _ShmPipe
   ShmArea *shm_area;
 
   int next_area_id;
+  int next_fd_buffer_id;
 
   ShmBuffer *buffers;
 
@@ -141,12 +195,21 @@ struct _ShmPipe
   ShmClient *clients;
 
   mode_t perms;
+
+  /* Client side ring */
+  ShmArea *ring_area;
+  int ring_overflow;
 };
 
 struct _ShmClient
 {
   int fd;
 
+  ShmArea *ring_area;
+  int ring_overflow;
+
+  int fd_passing;
+
   ShmClient *next;
 };
 
@@ -182,7 +245,37 @@ struct CommandBuffer
   } payload;
 };
 
+struct RingEntry
+{
+  unsigned int type;
+  int area_id;
+  unsigned long offset;
+  unsigned long size;
+};
+
+/* head is only written by the producer, tail and waiting only by the
+ * consumer, except that the producer clears waiting when it wakes up the
+ * consumer. They are kept on separate cache lines. */
+struct RingQueue
+{
+  unsigned int head;
+  char padding1[RING_CACHELINE_SIZE - sizeof (unsigned int)];
+  unsigned int tail;
+  char padding2[RING_CACHELINE_SIZE - sizeof (unsigned int)];
+  unsigned int waiting;
+  char padding3[RING_CACHELINE_SIZE - sizeof (unsigned int)];
+  struct RingEntry entries[RING_NUM_ENTRIES];
+};
+
+struct RingControl
+{
+  struct RingQueue buffers;     /* server to client */
+  struct RingQueue acks;        /* client to server */
+};
+
 static ShmArea *sp_open_shm (char *path, int id, mode_t perms, size_t size);
+static ShmArea *sp_open_shm_full (char *path, int id, mode_t perms,
+    size_t size, int is_ring);
 static void sp_close_shm (ShmArea * area);
 static int sp_shmbuf_dec (ShmPipe * self, ShmBuffer * buf,
     ShmBuffer * prev_buf, ShmClient * client, void **tag);
@@ -273,6 +366,18 @@ sp_writer_create (const char *path, size_t size, mode_t perms)
 
 static ShmArea *
 sp_open_shm (char *path, int id, mode_t perms, size_t size)
+{
+  return sp_open_shm_full (path, id, perms, size, 0);
+}
+
+/**
+ * sp_open_shm_full:
+ * @is_ring: Whether this is a ring area, which the reader also writes to
+ *  and from which the writer never allocates blocks
+ */
+
+static ShmArea *
+sp_open_shm_full (char *path, int id, mode_t perms, size_t size, int is_ring)
 {
   ShmArea *area = spalloc_new (ShmArea);
   char tmppath[32];
@@ -291,7 +396,7 @@ sp_open_shm (char *path, int id, mode_t perms, size_t size)
 
 
   if (path)
-    flags = O_RDONLY;
+    flags = is_ring ? O_RDWR : O_RDONLY;
   else
 #ifdef HAVE_OSX
     flags = O_RDWR | O_CREAT | O_EXCL;
@@ -324,7 +429,7 @@ sp_open_shm (char *path, int id, mode_t perms, size_t size)
     prot = PROT_READ | PROT_WRITE;
   } else {
     area->shm_area_name = strdup (path);
-    prot = PROT_READ;
+    prot = is_ring ? (PROT_READ | PROT_WRITE) : PROT_READ;
   }
 
   area->shm_area_buf = mmap (NULL, size, prot, MAP_SHARED, area->shm_fd, 0);
@@ -334,7 +439,7 @@ sp_open_shm (char *path, int id, mode_t perms, size_t size)
 
   area->id = id;
 
-  if (!path)
+  if (!path && !is_ring)
     area->allocspace = shm_alloc_space_new (area->shm_area_len);
 
   return area;
@@ -342,6 +447,72 @@ sp_open_shm (char *path, int id, mode_t perms, size_t size)
 
 #undef RETURN_ERROR
 
+static void
+sp_close_ring (ShmArea * area)
+{
+  area->use_count--;
+  sp_close_shm (area);
+}
+
+/* Returns 1 if the entry was queued and 0 if the queue is full, keeping
+ * @reserve slots free. Sets @wakeup if the consumer was waiting for the
+ * queue to become non-empty. */
+static int
+ring_queue_push (struct RingQueue *q, const struct RingEntry *entry,
+    unsigned int reserve, int *wakeup)
+{
+  unsigned int head = __atomic_load_n (&q->head, __ATOMIC_RELAXED);
+  unsigned int tail = __atomic_load_n (&q->tail, __ATOMIC_ACQUIRE);
+
+  if (head - tail >= RING_NUM_ENTRIES - reserve)
+    return 0;
+
+  q->entries[head % RING_NUM_ENTRIES] = *entry;
+  __atomic_store_n (&q->head, head + 1, __ATOMIC_RELEASE);
+
+  /* Pairs with the fence in ring_queue_pop(), either the consumer sees the
+   * new head or we see that it is waiting */
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+  if (__atomic_load_n (&q->waiting, __ATOMIC_RELAXED))
+    *wakeup = __atomic_exchange_n (&q->waiting, 0, __ATOMIC_RELAXED);
+
+  return 1;
+}
+
+/* Returns 1 if an entry was dequeued, 0 if the queue is empty (the
+ * producer will then send a wakeup on the next push) and -1 if the queue
+ * is corrupted */
+static int
+ring_queue_pop (struct RingQueue *q, struct RingEntry *entry)
+{
+  unsigned int tail = __atomic_load_n (&q->tail, __ATOMIC_RELAXED);
+  unsigned int head = __atomic_load_n (&q->head, __ATOMIC_ACQUIRE);
+
+  if (head == tail) {
+    __atomic_store_n (&q->waiting, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    head = __atomic_load_n (&q->head, __ATOMIC_ACQUIRE);
+    if (head == tail)
+      return 0;
+    __atomic_store_n (&q->waiting, 0, __ATOMIC_RELAXED);
+  }
+
+  if (head - tail > RING_NUM_ENTRIES)
+    return -1;
+
+  *entry = q->entries[tail % RING_NUM_ENTRIES];
+  __atomic_store_n (&q->tail, tail + 1, __ATOMIC_RELEASE);
+
+  return 1;
+}
+
+static int
+ring_queue_is_empty (struct RingQueue *q)
+{
+  return __atomic_load_n (&q->head, __ATOMIC_ACQUIRE) ==
+      __atomic_load_n (&q->tail, __ATOMIC_ACQUIRE);
+}
+
 static void
 sp_close_shm (ShmArea * area)
 {
@@ -446,6 +617,11 @@ sp_writer_close (ShmPipe * self, sp_buffer_free_callback callback,
   while (self->clients)
     sp_writer_close_client (self, self->clients, callback, user_data);
 
+  if (self->ring_area) {
+    sp_close_ring (self->ring_area);
+    self->ring_area = NULL;
+  }
+
   sp_dec (self);
 }
 
@@ -461,11 +637,16 @@ sp_writer_setperms_shm (ShmPipe * self, mode_t perms)
 {
   int ret = 0;
   ShmArea *area;
+  ShmClient *client;
 
   self->perms = perms;
   for (area = self->shm_area; area; area = area->next)
     ret |= fchmod (area->shm_fd, perms);
 
+  for (client = self->clients; client; client = client->next)
+    if (client->ring_area)
+      ret |= fchmod (client->ring_area->shm_fd, perms);
+
   ret |= chmod (self->socket_path, perms);
 
   return ret;
@@ -485,6 +666,39 @@ send_command (int fd, struct CommandBuffer *cb, unsigned short int type,
   return 1;
 }
 
+static int
+send_command_with_fd (int fd, struct CommandBuffer *cb,
+    unsigned short int type, int area_id, int passed_fd)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  char control[CMSG_SPACE (sizeof (int))];
+
+  cb->type = type;
+  cb->area_id = area_id;
+
+  memset (&msg, 0, sizeof (msg));
+  memset (control, 0, sizeof (control));
+  iov.iov_base = cb;
+  iov.iov_len = sizeof (struct CommandBuffer);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof (control);
+
+  cmsg = CMSG_FIRSTHDR (&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN (sizeof (int));
+  memcpy (CMSG_DATA (cmsg), &passed_fd, sizeof (int));
+
+  if (sendmsg (fd, &msg, MSG_NOSIGNAL) != sizeof (struct CommandBuffer))
+    return 0;
+
+  return 1;
+}
+
 int
 sp_writer_resize (ShmPipe * self, size_t size)
 {
@@ -511,6 +725,10 @@ sp_writer_resize (ShmPipe * self, size_t size)
   for (client = self->clients; client; client = client->next) {
     struct CommandBuffer cb = { 0 };
 
+    /* Ring clients must see the new area before any ring entry using it */
+    if (client->ring_area)
+      sp_writer_ring_overflow (client);
+
     if (!send_command (client->fd, &cb, COMMAND_CLOSE_SHM_AREA,
             old_current->id))
       continue;
@@ -573,6 +791,67 @@ sp_writer_free_block (ShmBlock * block)
   spalloc_free (ShmBlock, block);
 }
 
+/* Makes the client read the socket until the next resume command, so that
+ * what we send there stays in order with what was queued in the ring */
+static void
+sp_writer_ring_overflow (ShmClient * client)
+{
+  struct RingControl *ring =
+      (struct RingControl *) client->ring_area->shm_area_buf;
+  struct RingEntry entry = { 0 };
+  int wakeup = 0;
+
+  if (client->ring_overflow)
+    return;
+
+  /* The last slot is always free for the marker, the client may be waiting
+   * on the ring, but the socket message that follows wakes it up anyway */
+  entry.type = COMMAND_RING_OVERFLOW;
+  ring_queue_push (&ring->buffers, &entry, 0, &wakeup);
+  client->ring_overflow = 1;
+}
+
+/* Returns 1 if the buffer was queued in the client's ring and 0 if it has
+ * to go through the socket */
+
+static int
+sp_writer_ring_send_buf (ShmClient * client, int area_id,
+    unsigned long offset, unsigned long size)
+{
+  struct RingControl *ring =
+      (struct RingControl *) client->ring_area->shm_area_buf;
+  struct RingEntry entry = { 0 };
+  struct CommandBuffer cb = { 0 };
+  int wakeup = 0;
+
+  if (client->ring_overflow) {
+    /* Only go back to the ring once the client has seen the overflow
+     * marker, it then reads the socket until the resume command */
+    if (!ring_queue_is_empty (&ring->buffers))
+      return 0;
+    if (!send_command (client->fd, &cb, COMMAND_RING_RESUME, 0))
+      return 0;
+    client->ring_overflow = 0;
+  }
+
+  entry.type = COMMAND_NEW_BUFFER;
+  entry.area_id = area_id;
+  entry.offset = offset;
+  entry.size = size;
+
+  /* Always keep one slot free for the overflow marker */
+  if (!ring_queue_push (&ring->buffers, &entry, 1, &wakeup)) {
+    sp_writer_ring_overflow (client);
+    return 0;
+  }
+
+  /* If this fails, the client is gone and will be closed from its fd */
+  if (wakeup)
+    send_command (client->fd, &cb, COMMAND_RING_WAKEUP, 0);
+
+  return 1;
+}
+
 /* Returns the number of client this has successfully been sent to */
 
 int
@@ -615,9 +894,17 @@ sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, void *tag)
 
   for (client = self->clients; client; client = client->next) {
     struct CommandBuffer cb = { 0 };
+
+    if (client->ring_area &&
+        sp_writer_ring_send_buf (client, area->id, offset, bsize)) {
+      sb->clients[i++] = client->fd;
+      c++;
+      continue;
+    }
+
     cb.payload.buffer.offset = offset;
     cb.payload.buffer.size = bsize;
-    if (!send_command (client->fd, &cb, COMMAND_NEW_BUFFER, self->shm_area->id))
+    if (!send_command (client->fd, &cb, COMMAND_NEW_BUFFER, area->id))
       continue;
     sb->clients[i++] = client->fd;
     c++;
@@ -639,6 +926,134 @@ sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, void *tag)
   return c;
 }
 
+int
+sp_writer_fd_passing_supported (ShmPipe * self)
+{
+  ShmClient *client;
+
+  if (self->num_clients == 0)
+    return 0;
+
+  for (client = self->clients; client; client = client->next)
+    if (!client->fd_passing)
+      return 0;
+
+  return 1;
+}
+
+/* Returns the number of client this has successfully been sent to, only
+ * clients which requested fd passing are considered */
+
+int
+sp_writer_send_fd_buf (ShmPipe * self, int fd, int is_dmabuf,
+    size_t offset, size_t size, void *tag)
+{
+  ShmBuffer *sb;
+  ShmClient *client = NULL;
+  int i = 0;
+  int c = 0;
+
+  if (self->num_clients == 0)
+    return 0;
+
+  sb = spalloc_alloc (sizeof (ShmBuffer) + sizeof (int) * self->num_clients);
+  memset (sb, 0, sizeof (ShmBuffer));
+  memset (sb->clients, -1, sizeof (int) * self->num_clients);
+  sb->offset = offset;
+  sb->size = size;
+  sb->num_clients = self->num_clients;
+  sb->tag = tag;
+
+  /* The id goes in the area_id field of the command, keep it positive */
+  if (self->next_fd_buffer_id <= 0 || self->next_fd_buffer_id == INT_MAX)
+    self->next_fd_buffer_id = 1;
+  sb->fd_id = self->next_fd_buffer_id++;
+
+  for (client = self->clients; client; client = client->next) {
+    struct CommandBuffer cb = { 0 };
+
+    if (!client->fd_passing)
+      continue;
+
+    if (client->ring_area)
+      sp_writer_ring_overflow (client);
+
+    cb.payload.buffer.offset = offset;
+    cb.payload.buffer.size = size;
+    if (!send_command_with_fd (client->fd, &cb,
+            is_dmabuf ? COMMAND_NEW_DMABUF_BUFFER : COMMAND_NEW_FD_BUFFER,
+            sb->fd_id, fd))
+      continue;
+    sb->clients[i++] = client->fd;
+    c++;
+  }
+
+  if (c == 0) {
+    spalloc_free1 (sizeof (ShmBuffer) + sizeof (int) * sb->num_clients, sb);
+    return 0;
+  }
+
+  sb->use_count = c;
+
+  sb->next = self->buffers;
+  self->buffers = sb;
+
+  return c;
+}
+
+/* If @passed_fd is NULL, any file descriptor attached to the command is
+ * closed */
+static int
+recv_command_with_fd (int fd, struct CommandBuffer *cb, int *passed_fd)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  char control[CMSG_SPACE (sizeof (int))];
+  int flags = MSG_DONTWAIT;
+  int retval;
+
+  if (passed_fd)
+    *passed_fd = -1;
+
+  memset (&msg, 0, sizeof (msg));
+  iov.iov_base = cb;
+  iov.iov_len = sizeof (struct CommandBuffer);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof (control);
+
+#ifdef MSG_CMSG_CLOEXEC
+  flags |= MSG_CMSG_CLOEXEC;
+#endif
+
+  retval = recvmsg (fd, &msg, flags);
+
+  for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+        cmsg->cmsg_len == CMSG_LEN (sizeof (int))) {
+      int received_fd;
+
+      memcpy (&received_fd, CMSG_DATA (cmsg), sizeof (int));
+      if (passed_fd && *passed_fd < 0)
+        *passed_fd = received_fd;
+      else
+        close (received_fd);
+    }
+  }
+
+  if (retval == sizeof (struct CommandBuffer)) {
+    return 1;
+  } else {
+    if (passed_fd && *passed_fd >= 0) {
+      close (*passed_fd);
+      *passed_fd = -1;
+    }
+    return 0;
+  }
+}
+
 static int
 recv_command (int fd, struct CommandBuffer *cb)
 {
@@ -654,16 +1069,43 @@ recv_command (int fd, struct CommandBuffer *cb)
 
 long int
 sp_client_recv (ShmPipe * self, char **buf)
+{
+  ShmFdBuffer fdbuf;
+  long int ret;
+
+  ret = sp_client_recv_fd (self, buf, &fdbuf);
+
+  /* We never asked for these, but don't leak them */
+  if (ret >= 0 && fdbuf.fd >= 0) {
+    close (fdbuf.fd);
+    sp_client_recv_finish_fd (self, fdbuf.id);
+    return 0;
+  }
+
+  return ret;
+}
+
+long int
+sp_client_recv_fd (ShmPipe * self, char **buf, ShmFdBuffer * fdbuf)
 {
   char *area_name = NULL;
   ShmArea *newarea;
   ShmArea *area;
   struct CommandBuffer cb;
+  int passed_fd = -1;
   int retval;
 
-  if (!recv_command (self->main_socket, &cb))
+  fdbuf->fd = -1;
+
+  if (!recv_command_with_fd (self->main_socket, &cb, &passed_fd))
     return -1;
 
+  if (passed_fd >= 0 && cb.type != COMMAND_NEW_FD_BUFFER &&
+      cb.type != COMMAND_NEW_DMABUF_BUFFER) {
+    close (passed_fd);
+    passed_fd = -1;
+  }
+
   switch (cb.type) {
     case COMMAND_NEW_SHM_AREA:
       assert (cb.payload.new_shm_area.path_size > 0);
@@ -689,6 +1131,39 @@ sp_client_recv (ShmPipe * self, char **buf)
       self->shm_area = newarea;
       break;
 
+    case COMMAND_NEW_RING_AREA:
+      if (cb.payload.new_shm_area.path_size == 0 ||
+          cb.payload.new_shm_area.size != sizeof (struct RingControl))
+        return -5;
+
+      area_name = malloc (cb.payload.new_shm_area.path_size + 1);
+      retval = recv (self->main_socket, area_name,
+          cb.payload.new_shm_area.path_size, 0);
+      if (retval != cb.payload.new_shm_area.path_size) {
+        free (area_name);
+        return -3;
+      }
+      area_name[retval] = 0;
+
+      newarea = sp_open_shm_full (area_name, cb.area_id, 0,
+          cb.payload.new_shm_area.size, 1);
+      free (area_name);
+      if (!newarea)
+        return -4;
+
+      if (self->ring_area)
+        sp_close_ring (self->ring_area);
+      self->ring_area = newarea;
+      self->ring_overflow = 0;
+      break;
+
+    case COMMAND_RING_WAKEUP:
+      break;
+
+    case COMMAND_RING_RESUME:
+      self->ring_overflow = 0;
+      break;
+
     case COMMAND_CLOSE_SHM_AREA:
       for (area = self->shm_area; area; area = area->next) {
         if (area->id == cb.area_id) {
@@ -709,13 +1184,149 @@ sp_client_recv (ShmPipe * self, char **buf)
       }
       return -23;
 
+    case COMMAND_NEW_FD_BUFFER:
+    case COMMAND_NEW_DMABUF_BUFFER:
+      if (passed_fd < 0)
+        return -25;
+      fdbuf->fd = passed_fd;
+      fdbuf->is_dmabuf = (cb.type == COMMAND_NEW_DMABUF_BUFFER);
+      fdbuf->offset = cb.payload.buffer.offset;
+      fdbuf->id = cb.area_id;
+      return cb.payload.buffer.size;
+
+    default:
+      return -99;
+  }
+
+  return 0;
+}
+
+long int
+sp_client_recv_ring (ShmPipe * self, char **buf)
+{
+  struct RingControl *ring;
+  struct RingEntry entry;
+  ShmArea *area;
+  int ret;
+
+  if (!self->ring_area || self->ring_overflow)
+    return 0;
+
+  ring = (struct RingControl *) self->ring_area->shm_area_buf;
+
+  ret = ring_queue_pop (&ring->buffers, &entry);
+  if (ret < 0)
+    return -6;
+  else if (ret == 0)
+    return 0;
+
+  switch (entry.type) {
+    case COMMAND_RING_OVERFLOW:
+      self->ring_overflow = 1;
+      return 0;
+
+    case COMMAND_NEW_BUFFER:
+      assert (buf);
+      for (area = self->shm_area; area; area = area->next) {
+        if (area->id == entry.area_id) {
+          if (entry.offset >= area->shm_area_len ||
+              entry.size > area->shm_area_len - entry.offset)
+            return -24;
+          *buf = area->shm_area_buf + entry.offset;
+          sp_shm_area_inc (area);
+          return entry.size;
+        }
+      }
+      return -23;
+
     default:
       return -99;
   }
+}
+
+int
+sp_client_request_fd_passing (ShmPipe * self)
+{
+  struct CommandBuffer cb = { 0 };
+
+  return send_command (self->main_socket, &cb, COMMAND_REQUEST_FD_PASSING, 0);
+}
+
+int
+sp_client_request_ring (ShmPipe * self)
+{
+  struct CommandBuffer cb = { 0 };
+
+  return send_command (self->main_socket, &cb, COMMAND_REQUEST_RING, 0);
+}
+
+static int
+sp_writer_setup_ring (ShmPipe * self, ShmClient * client)
+{
+  struct CommandBuffer cb = { 0 };
+  struct RingControl *ring;
+  ShmArea *area;
+  int pathlen;
+
+  if (client->ring_area)
+    return 0;
+
+  area = sp_open_shm_full (NULL, ++self->next_area_id, self->perms,
+      sizeof (struct RingControl), 1);
+  if (!area)
+    return -1;
+
+  /* The area is zeroed by ftruncate(), so both queues start empty, we want
+   * to be woken up for the first ack */
+  ring = (struct RingControl *) area->shm_area_buf;
+  ring->acks.waiting = 1;
+
+  pathlen = strlen (area->shm_area_name) + 1;
+  cb.payload.new_shm_area.size = area->shm_area_len;
+  cb.payload.new_shm_area.path_size = pathlen;
+  if (!send_command (client->fd, &cb, COMMAND_NEW_RING_AREA, area->id) ||
+      send (client->fd, area->shm_area_name, pathlen, MSG_NOSIGNAL) !=
+      pathlen) {
+    sp_close_ring (area);
+    return -1;
+  }
+
+  client->ring_area = area;
+  client->ring_overflow = 0;
 
   return 0;
 }
 
+/* Finds the buffer a client acknowledges with a command of type @type */
+static ShmBuffer *
+sp_writer_find_buffer (ShmPipe * self, ShmClient * client, unsigned int type,
+    int area_id, unsigned long offset, ShmBuffer ** prev_buf)
+{
+  ShmBuffer *buf;
+  int i;
+
+  *prev_buf = NULL;
+
+  for (buf = self->buffers; buf; buf = buf->next) {
+    int match;
+
+    if (type == COMMAND_ACK_FD_BUFFER)
+      match = (buf->shm_area == NULL && buf->fd_id == area_id);
+    else
+      match = (buf->shm_area != NULL && buf->shm_area->id == area_id &&
+          buf->offset == offset);
+
+    if (match) {
+      for (i = 0; i < buf->num_clients; i++)
+        if (buf->clients[i] == client->fd)
+          return buf;
+    }
+    *prev_buf = buf;
+  }
+
+  return NULL;
+}
+
 int
 sp_writer_recv (ShmPipe * self, ShmClient * client, void **tag)
 {
@@ -727,16 +1338,22 @@ sp_writer_recv (ShmPipe * self, ShmClient * client, void **tag)
 
   switch (cb.type) {
     case COMMAND_ACK_BUFFER:
-
-      for (buf = self->buffers; buf; buf = buf->next) {
-        if (buf->shm_area->id == cb.area_id &&
-            buf->offset == cb.payload.ack_buffer.offset) {
-          return sp_shmbuf_dec (self, buf, prev_buf, client, tag);
-        }
-        prev_buf = buf;
-      }
+    case COMMAND_ACK_FD_BUFFER:
+      buf = sp_writer_find_buffer (self, client, cb.type, cb.area_id,
+          cb.payload.ack_buffer.offset, &prev_buf);
+      if (buf)
+        return sp_shmbuf_dec (self, buf, prev_buf, client, tag);
 
       return -2;
+    case COMMAND_REQUEST_FD_PASSING:
+      client->fd_passing = 1;
+      return 1;
+    case COMMAND_REQUEST_RING:
+      if (sp_writer_setup_ring (self, client) < 0)
+        return -3;
+      return 1;
+    case COMMAND_RING_WAKEUP:
+      return 1;
     default:
       return -99;
   }
@@ -744,11 +1361,50 @@ sp_writer_recv (ShmPipe * self, ShmClient * client, void **tag)
   return 0;
 }
 
+int
+sp_writer_recv_ring (ShmPipe * self, ShmClient * client,
+    sp_buffer_free_callback callback, void *user_data)
+{
+  struct RingControl *ring;
+  struct RingEntry entry;
+  int count = 0;
+  int ret;
+
+  if (!client->ring_area)
+    return 0;
+
+  ring = (struct RingControl *) client->ring_area->shm_area_buf;
+
+  while ((ret = ring_queue_pop (&ring->acks, &entry)) > 0) {
+    ShmBuffer *buf = NULL, *prev_buf = NULL;
+    void *tag = NULL;
+
+    if (entry.type != COMMAND_ACK_BUFFER &&
+        entry.type != COMMAND_ACK_FD_BUFFER)
+      return -99;
+
+    buf = sp_writer_find_buffer (self, client, entry.type, entry.area_id,
+        entry.offset, &prev_buf);
+    if (!buf)
+      return -2;
+
+    if (!sp_shmbuf_dec (self, buf, prev_buf, client, &tag) && callback)
+      callback (tag, user_data);
+    count++;
+  }
+
+  if (ret < 0)
+    return -6;
+
+  return count;
+}
+
 int
 sp_client_recv_finish (ShmPipe * self, char *buf)
 {
   ShmArea *shm_area = NULL;
   unsigned long offset;
+  int area_id;
   struct CommandBuffer cb = { 0 };
 
   for (shm_area = self->shm_area; shm_area; shm_area = shm_area->next) {
@@ -760,12 +1416,55 @@ sp_client_recv_finish (ShmPipe * self, char *buf)
   assert (shm_area);
 
   offset = buf - shm_area->shm_area_buf;
+  /* The area may be gone after this, so remember its id */
+  area_id = shm_area->id;
 
   sp_shm_area_dec (self, shm_area);
 
+  if (self->ring_area) {
+    struct RingControl *ring =
+        (struct RingControl *) self->ring_area->shm_area_buf;
+    struct RingEntry entry = { 0 };
+    int wakeup = 0;
+
+    entry.type = COMMAND_ACK_BUFFER;
+    entry.area_id = area_id;
+    entry.offset = offset;
+
+    /* If the queue is full, the ack just goes through the socket */
+    if (ring_queue_push (&ring->acks, &entry, 0, &wakeup)) {
+      if (wakeup)
+        return send_command (self->main_socket, &cb, COMMAND_RING_WAKEUP, 0);
+      return 1;
+    }
+  }
+
   cb.payload.ack_buffer.offset = offset;
-  return send_command (self->main_socket, &cb, COMMAND_ACK_BUFFER,
-      self->shm_area->id);
+  return send_command (self->main_socket, &cb, COMMAND_ACK_BUFFER, area_id);
+}
+
+int
+sp_client_recv_finish_fd (ShmPipe * self, int id)
+{
+  struct CommandBuffer cb = { 0 };
+
+  if (self->ring_area) {
+    struct RingControl *ring =
+        (struct RingControl *) self->ring_area->shm_area_buf;
+    struct RingEntry entry = { 0 };
+    int wakeup = 0;
+
+    entry.type = COMMAND_ACK_FD_BUFFER;
+    entry.area_id = id;
+
+    if (ring_queue_push (&ring->acks, &entry, 0, &wakeup)) {
+      if (wakeup)
+        return send_command (self->main_socket, &cb, COMMAND_RING_WAKEUP, 0);
+      return 1;
+    }
+  }
+
+  return send_command (self->main_socket, &cb, COMMAND_ACK_FD_BUFFER, id);
 }
 
 ShmPipe *
@@ -836,6 +1535,9 @@ sp_writer_accept_client (ShmPipe * self)
 
   client = spalloc_new (ShmClient);
   client->fd = fd;
+  client->ring_area = NULL;
+  client->ring_overflow = 0;
+  client->fd_passing = 0;
 
   /* Prepend ot linked list */
   client->next = self->clients;
@@ -883,8 +1585,10 @@ sp_shmbuf_dec (ShmPipe * self, ShmBuffer * buf, ShmBuffer * prev_buf,
 
     if (tag)
       *tag = buf->tag;
-    shm_alloc_space_block_dec (buf->ablock);
-    sp_shm_area_dec (self, buf->shm_area);
+    if (buf->shm_area) {
+      shm_alloc_space_block_dec (buf->ablock);
+      sp_shm_area_dec (self, buf->shm_area);
+    }
     spalloc_free1 (sizeof (ShmBuffer) + sizeof (int) * buf->num_clients, buf);
     return 0;
   }
@@ -901,6 +1605,11 @@ sp_writer_close_client (ShmPipe * self, ShmClient * client,
   shutdown (client->fd, SHUT_RDWR);
   close (client->fd);
 
+  if (client->ring_area) {
+    sp_close_ring (client->ring_area);
+    client->ring_area = NULL;
+  }
+
 again:
   for (buffer = self->buffers; buffer; buffer = buffer->next) {
     int i;
@@ -56,6 +56,21 @@
  * buffers are no longer valid. If was valid buffer was received, the
  * client must release it with sp_client_recv_finish() when it is done
  * reading from it.
+ *
+ * To avoid a round trip over the socket for every buffer, the reader can
+ * ask for a shared memory ring with sp_client_request_ring() right after
+ * connecting. It must then call sp_client_recv_ring() before every
+ * select(), which returns buffers like sp_client_recv() and 0 if there is
+ * none, in which case the socket will become readable when there is one.
+ * On the writer side, sp_writer_recv_ring() must be called after
+ * sp_writer_recv() to release the buffers acknowledged through the ring.
+ *
+ * Buffers which are not in the shm area, but backed by a file descriptor
+ * (memfd, dmabuf), can be passed as is with sp_writer_send_fd_buf() to the
+ * readers which called sp_client_request_fd_passing(). Those readers must
+ * use sp_client_recv_fd(), which fills a ShmFdBuffer instead of returning
+ * a pointer for these buffers. The reader owns the received fd and must
+ * release the buffer with sp_client_recv_finish_fd().
  */
 
 
@@ -80,6 +95,16 @@ typedef struct _ShmBuffer ShmBuffer;
 
 typedef void (*sp_buffer_free_callback) (void * tag, void * user_data);
 
+typedef struct _ShmFdBuffer ShmFdBuffer;
+
+struct _ShmFdBuffer
+{
+  int fd;
+  int is_dmabuf;
+  unsigned long offset;
+  int id;
+};
+
 ShmPipe *sp_writer_create (const char *path, size_t size, mode_t perms);
 const char *sp_writer_get_path (ShmPipe *pipe);
 void sp_writer_close (ShmPipe * self, sp_buffer_free_callback callback,
@@ -97,6 +122,9 @@ int sp_writer_get_client_fd (ShmClient * client);
 ShmBlock *sp_writer_alloc_block (ShmPipe * self, size_t size);
 void sp_writer_free_block (ShmBlock *block);
 int sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, void * tag);
+int sp_writer_fd_passing_supported (ShmPipe * self);
+int sp_writer_send_fd_buf (ShmPipe * self, int fd, int is_dmabuf,
+    size_t offset, size_t size, void * tag);
 char *sp_writer_block_get_buf (ShmBlock *block);
 ShmPipe *sp_writer_block_get_pipe (ShmBlock *block);
 size_t sp_writer_get_max_buf_size (ShmPipe * self);
@@ -105,6 +133,8 @@ ShmClient * sp_writer_accept_client (ShmPipe * self);
 void sp_writer_close_client (ShmPipe *self, ShmClient * client,
     sp_buffer_free_callback callback, void * user_data);
 int sp_writer_recv (ShmPipe * self, ShmClient * client, void ** tag);
+int sp_writer_recv_ring (ShmPipe * self, ShmClient * client,
+    sp_buffer_free_callback callback, void * user_data);
 
 int sp_writer_pending_writes (ShmPipe * self);
 
@@ -114,6 +144,11 @@ void *sp_writer_buf_get_tag (ShmBuffer * buffer);
 
 ShmPipe *sp_client_open (const char *path);
 long int sp_client_recv (ShmPipe * self, char **buf);
+int sp_client_request_ring (ShmPipe * self);
+long int sp_client_recv_ring (ShmPipe * self, char **buf);
+int sp_client_request_fd_passing (ShmPipe * self);
+long int sp_client_recv_fd (ShmPipe * self, char **buf, ShmFdBuffer * fdbuf);
+int sp_client_recv_finish_fd (ShmPipe * self, int id);
 int sp_client_recv_finish (ShmPipe * self, char *buf);
 void sp_client_close (ShmPipe * self);
 
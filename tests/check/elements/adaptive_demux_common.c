@@ -74,6 +74,11 @@ gst_adaptive_demux_test_case_clear (GstAdaptiveDemuxTestCase * testData)
   testData->threshold_for_seek = 0;
   gst_event_replace (&testData->seek_event, NULL);
   testData->signal_context = NULL;
+  if (testData->startup_message) {
+    gst_structure_free (testData->startup_message);
+    testData->startup_message = NULL;
+  }
+  testData->startup_message_count = 0;
 }
 
 
@@ -504,6 +509,43 @@ void gst_adaptive_demux_test_download_error_size_of_received_data
   }
 }
 
+/* called synchronously from the thread posting the message */
+static void
+testFastStartOnElementMessage (GstBus * bus, GstMessage * msg,
+    gpointer user_data)
+{
+  GstAdaptiveDemuxTestCase *testData = GST_ADAPTIVE_DEMUX_TEST_CASE (user_data);
+  const GstStructure *s = gst_message_get_structure (msg);
+
+  if (!gst_structure_has_name (s, "adaptive-streaming-startup"))
+    return;
+
+  GST_DEBUG ("startup message %" GST_PTR_FORMAT, s);
+
+  g_mutex_lock (&testData->test_task_state_lock);
+  if (testData->startup_message)
+    gst_structure_free (testData->startup_message);
+  testData->startup_message = gst_structure_copy (s);
+  testData->startup_message_count++;
+  g_mutex_unlock (&testData->test_task_state_lock);
+}
+
+void
+gst_adaptive_demux_test_enable_fast_start (GstAdaptiveDemuxTestEngine *
+    engine, gpointer user_data)
+{
+  GstAdaptiveDemuxTestCase *testData = GST_ADAPTIVE_DEMUX_TEST_CASE (user_data);
+  GstBus *bus;
+
+  g_object_set (engine->demux, "fast-start", TRUE, NULL);
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (engine->pipeline));
+  gst_bus_enable_sync_message_emission (bus);
+  g_signal_connect (bus, "sync-message::element",
+      G_CALLBACK (testFastStartOnElementMessage), testData);
+  gst_object_unref (bus);
+}
+
 void
 gst_adaptive_demux_test_seek (const gchar * element_name,
     const gchar * manifest_uri, GstAdaptiveDemuxTestCase * testData)
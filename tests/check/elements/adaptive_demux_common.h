@@ -116,6 +116,11 @@ typedef struct _GstAdaptiveDemuxTestCase
   gboolean seeked;
 
   gpointer signal_context;
+
+  /* the last adaptive-streaming-startup message posted by the demux and
+   * the number of such messages, protected by test_task_state_lock */
+  GstStructure *startup_message;
+  guint startup_message_count;
 } GstAdaptiveDemuxTestCase;
 
 /* high-level unit test functions */
@@ -152,6 +157,19 @@ void gst_adaptive_demux_test_seek (const gchar * element_name,
 
 /* Utility functions for use within a unit test */
 
+/**
+ * gst_adaptive_demux_test_enable_fast_start:
+ * @engine: The #GstAdaptiveDemuxTestEngine that caused this callback
+ * @user_data: A pointer to a #GstAdaptiveDemuxTestCase object
+ *
+ * This function can be used as a pre_test callback. It enables the
+ * fast-start mode of the demux element and records the
+ * adaptive-streaming-startup messages it posts in
+ * GstAdaptiveDemuxTestCase::startup_message.
+ */
+void gst_adaptive_demux_test_enable_fast_start (GstAdaptiveDemuxTestEngine *
+    engine, gpointer user_data);
+
 /**
  * gst_adaptive_demux_test_unexpected_eos:
  * @engine: The #GstAdaptiveDemuxTestEngine that caused this callback
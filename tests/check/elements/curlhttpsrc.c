@@ -0,0 +1,343 @@
+/*
+ * Unittest for curlhttpsrc
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gio/gio.h>
+#include <string.h>
+
+#define BODY_SIZE (10 * 1024 + 123)
+
+static guint8 body[BODY_SIZE];
+static GSocketService *service;
+static guint16 server_port;
+static volatile gint n_connections;
+static volatile gint n_requests;
+
+/* With stall_size set, the server sends that much of the body and only sends
+ * the rest once the client pushed a buffer, or after a timeout */
+#define STALL_TIMEOUT (5 * G_TIME_SPAN_SECOND)
+static gsize stall_size;
+static gboolean stall_released;
+static gboolean stall_timed_out;
+static GMutex stall_lock;
+static GCond stall_cond;
+
+/*
+ * Minimal HTTP/1.1 server answering every request on a connection with the
+ * same body, keeping the connection alive until the client closes it.
+ */
+static gboolean
+server_run_cb (GThreadedSocketService * service,
+    GSocketConnection * connection, GObject * source_object,
+    gpointer user_data)
+{
+  GDataInputStream *in;
+  GOutputStream *out;
+  gchar *line, *header;
+
+  g_atomic_int_inc (&n_connections);
+
+  in = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM
+          (connection)));
+  g_data_input_stream_set_newline_type (in,
+      G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+  out = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+
+  for (;;) {
+    gboolean have_request = FALSE;
+
+    while ((line = g_data_input_stream_read_line (in, NULL, NULL, NULL))) {
+      have_request = line[0] == '\0';
+      g_free (line);
+      if (have_request)
+        break;
+    }
+    if (!have_request)
+      break;
+
+    g_atomic_int_inc (&n_requests);
+
+    header = g_strdup_printf ("HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/octet-stream\r\n"
+        "Content-Length: %u\r\n\r\n", BODY_SIZE);
+    if (!g_output_stream_write_all (out, header, strlen (header), NULL, NULL,
+            NULL)) {
+      g_free (header);
+      break;
+    }
+    g_free (header);
+
+    if (stall_size > 0) {
+      gint64 end_time = g_get_monotonic_time () + STALL_TIMEOUT;
+
+      if (!g_output_stream_write_all (out, body, stall_size, NULL, NULL, NULL)
+          || !g_output_stream_flush (out, NULL, NULL))
+        break;
+
+      g_mutex_lock (&stall_lock);
+      while (!stall_released && !stall_timed_out)
+        stall_timed_out = !g_cond_wait_until (&stall_cond, &stall_lock,
+            end_time);
+      g_mutex_unlock (&stall_lock);
+    }
+
+    if (!g_output_stream_write_all (out, body + stall_size,
+            BODY_SIZE - stall_size, NULL, NULL, NULL))
+      break;
+  }
+
+  g_object_unref (in);
+
+  return TRUE;
+}
+
+static void
+start_server (void)
+{
+  guint i;
+
+  for (i = 0; i < BODY_SIZE; i++)
+    body[i] = i % 251;
+
+  n_connections = 0;
+  n_requests = 0;
+  stall_size = 0;
+  stall_released = FALSE;
+  stall_timed_out = FALSE;
+
+  service = g_threaded_socket_service_new (-1);
+  server_port = g_socket_listener_add_any_inet_port (G_SOCKET_LISTENER
+      (service), NULL, NULL);
+  fail_unless (server_port != 0);
+  g_signal_connect (service, "run", G_CALLBACK (server_run_cb), NULL);
+  g_socket_service_start (service);
+}
+
+static void
+stop_server (void)
+{
+  g_socket_service_stop (service);
+  g_socket_listener_close (G_SOCKET_LISTENER (service));
+  g_object_unref (service);
+  service = NULL;
+}
+
+static GstPadProbeReturn
+_buffer_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GArray *buffers = user_data;
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+
+  g_array_append_val (buffers, buffer);
+  gst_buffer_ref (buffer);
+
+  g_mutex_lock (&stall_lock);
+  stall_released = TRUE;
+  g_cond_signal (&stall_cond);
+  g_mutex_unlock (&stall_lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/*
+ * Download the body with a new curlhttpsrc, store the buffers it produced
+ * and return the statistics it posted for the request.
+ */
+static GstStructure *
+run_download (guint blocksize, GArray * buffers)
+{
+  GstElement *pipeline, *src, *sink;
+  GstStructure *stats = NULL, *prop_stats = NULL;
+  gboolean have_eos = FALSE;
+  GstMessage *msg;
+  GstBus *bus;
+  GstPad *pad;
+  gchar *uri;
+
+  pipeline = gst_pipeline_new (NULL);
+  src = gst_element_factory_make ("curlhttpsrc", NULL);
+  fail_unless (src != NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  fail_unless (sink != NULL);
+  gst_bin_add_many (GST_BIN (pipeline), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  uri = g_strdup_printf ("http://127.0.0.1:%u/body", server_port);
+  g_object_set (src, "location", uri, "blocksize", blocksize, NULL);
+  gst_util_set_object_arg (G_OBJECT (src), "http-version", "1.1");
+  g_free (uri);
+
+  pad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER, _buffer_probe, buffers,
+      NULL);
+  gst_object_unref (pad);
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+
+  bus = gst_element_get_bus (pipeline);
+  while (!have_eos || stats == NULL) {
+    msg = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+        GST_MESSAGE_EOS | GST_MESSAGE_ERROR | GST_MESSAGE_ELEMENT);
+    fail_unless (msg != NULL, "Timeout waiting for the download");
+    fail_unless (GST_MESSAGE_TYPE (msg) != GST_MESSAGE_ERROR);
+
+    if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS) {
+      have_eos = TRUE;
+    } else if (gst_message_has_name (msg, "curlhttpsrc-stats")) {
+      fail_unless (GST_MESSAGE_SRC (msg) == GST_OBJECT (src));
+      fail_unless (stats == NULL);
+      stats = gst_structure_copy (gst_message_get_structure (msg));
+    }
+    gst_message_unref (msg);
+  }
+  gst_object_unref (bus);
+
+  /* The property reports the same as the message */
+  g_object_get (src, "stats", &prop_stats, NULL);
+  fail_unless (prop_stats != NULL);
+  fail_unless (gst_structure_is_equal (prop_stats, stats));
+  gst_structure_free (prop_stats);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return stats;
+}
+
+static void
+check_body (GArray * buffers, guint blocksize)
+{
+  guint i, offset = 0;
+
+  for (i = 0; i < buffers->len; i++) {
+    GstBuffer *buffer = g_array_index (buffers, GstBuffer *, i);
+    gsize size = gst_buffer_get_size (buffer);
+
+    /* Partially filled blocks are pushed when no full one is waiting */
+    fail_unless (size > 0 && size <= blocksize);
+    fail_unless (offset + size <= BODY_SIZE);
+    fail_unless (gst_buffer_memcmp (buffer, 0, body + offset, size) == 0);
+    offset += size;
+  }
+  fail_unless_equals_int (offset, BODY_SIZE);
+  fail_unless (buffers->len >= (BODY_SIZE + blocksize - 1) / blocksize);
+}
+
+static void
+clear_buffers (GArray * buffers)
+{
+  guint i;
+
+  for (i = 0; i < buffers->len; i++)
+    gst_buffer_unref (g_array_index (buffers, GstBuffer *, i));
+  g_array_set_size (buffers, 0);
+}
+
+GST_START_TEST (test_pooled_blocks)
+{
+  GArray *buffers = g_array_new (FALSE, FALSE, sizeof (GstBuffer *));
+  GstStructure *stats;
+
+  start_server ();
+
+  /* The body spans several blocks and doesn't end on a block boundary */
+  stats = run_download (1024, buffers);
+  check_body (buffers, 1024);
+  gst_structure_free (stats);
+  clear_buffers (buffers);
+
+  /* The default is curl's own receive buffer size */
+  stats = run_download (16384, buffers);
+  check_body (buffers, 16384);
+  gst_structure_free (stats);
+  clear_buffers (buffers);
+
+  g_array_free (buffers, TRUE);
+  stop_server ();
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_shared_connection)
+{
+  GArray *buffers = g_array_new (FALSE, FALSE, sizeof (GstBuffer *));
+  GstStructure *stats;
+  gboolean reused;
+  guint64 bytes;
+
+  start_server ();
+
+  stats = run_download (4096, buffers);
+  check_body (buffers, 4096);
+  clear_buffers (buffers);
+  fail_unless_equals_string (gst_structure_get_string (stats, "http-version"),
+      "1.1");
+  fail_unless (gst_structure_get_boolean (stats, "connection-reused",
+          &reused));
+  fail_unless (!reused);
+  fail_unless (gst_structure_get_uint64 (stats, "bytes-received", &bytes));
+  fail_unless_equals_uint64 (bytes, BODY_SIZE);
+  gst_structure_free (stats);
+
+  /* A second element goes through the same multi handle and picks up the
+   * connection the first one left open */
+  stats = run_download (4096, buffers);
+  check_body (buffers, 4096);
+  clear_buffers (buffers);
+  fail_unless (gst_structure_get_boolean (stats, "connection-reused",
+          &reused));
+  fail_unless (reused);
+  gst_structure_free (stats);
+
+  fail_unless_equals_int (g_atomic_int_get (&n_requests), 2);
+  fail_unless_equals_int (g_atomic_int_get (&n_connections), 1);
+
+  g_array_free (buffers, TRUE);
+  stop_server ();
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_slow_response)
+{
+  GArray *buffers = g_array_new (FALSE, FALSE, sizeof (GstBuffer *));
+  GstStructure *stats;
+
+  start_server ();
+
+  /* The first part of the body doesn't fill a block, it has to be pushed
+   * while the server waits before sending the rest */
+  stall_size = 1000;
+  stats = run_download (16384, buffers);
+  fail_if (stall_timed_out);
+  fail_unless (buffers->len >= 2);
+  fail_unless (gst_buffer_get_size (g_array_index (buffers, GstBuffer *,
+              0)) <= stall_size);
+  check_body (buffers, 16384);
+  gst_structure_free (stats);
+  clear_buffers (buffers);
+
+  g_array_free (buffers, TRUE);
+  stop_server ();
+}
+
+GST_END_TEST;
+
+static Suite *
+curlhttpsrc_suite (void)
+{
+  Suite *s = suite_create ("curlhttpsrc");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_set_timeout (tc_chain, 20);
+  tcase_add_test (tc_chain, test_pooled_blocks);
+  tcase_add_test (tc_chain, test_shared_connection);
+  tcase_add_test (tc_chain, test_slow_response);
+
+  return s;
+}
+
+GST_CHECK_MAIN (curlhttpsrc);
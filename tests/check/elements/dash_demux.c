@@ -1516,6 +1516,452 @@ GST_START_TEST (testContentProtection)
 
 GST_END_TEST;
 
+#define FAST_START_URI_PREFIX "http://unit.test/"
+
+static GMutex fast_start_lock;
+
+/* counts the requests per file and makes the first request of the file
+ * named by "fail-once" fail. Prefetches run concurrently on the thread
+ * pool of the demux, hence the lock */
+static gboolean
+testFastStartSrcStart (GstTestHTTPSrc * src,
+    const gchar * uri, GstTestHTTPSrcInput * input_data, gpointer user_data)
+{
+  const GstTestHTTPSrcTestData *test_case =
+      (const GstTestHTTPSrcTestData *) user_data;
+  const gchar *name;
+  const gchar *fail_once;
+  guint count = 0;
+
+  fail_unless (g_str_has_prefix (uri, FAST_START_URI_PREFIX));
+  name = uri + strlen (FAST_START_URI_PREFIX);
+
+  g_mutex_lock (&fast_start_lock);
+  gst_structure_get_uint (test_case->data, name, &count);
+  count++;
+  gst_structure_set (test_case->data, name, G_TYPE_UINT, count, NULL);
+  fail_once = gst_structure_get_string (test_case->data, "fail-once");
+  g_mutex_unlock (&fast_start_lock);
+
+  if (count == 1 && g_strcmp0 (fail_once, name) == 0) {
+    GST_DEBUG ("failing first request of %s", uri);
+    return FALSE;
+  }
+
+  return gst_dashdemux_http_src_start (src, uri, input_data, user_data);
+}
+
+static void
+run_fast_start_test (const gchar * fail_once, guint fragment_requests)
+{
+  const gchar *mpd =
+      "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+      "<MPD xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\""
+      "     xmlns=\"urn:mpeg:DASH:schema:MPD:2011\""
+      "     xsi:schemaLocation=\"urn:mpeg:DASH:schema:MPD:2011 DASH-MPD.xsd\""
+      "     profiles=\"urn:mpeg:dash:profile:isoff-on-demand:2011\""
+      "     type=\"static\""
+      "     minBufferTime=\"PT1.500S\""
+      "     mediaPresentationDuration=\"PT2S\">"
+      "  <Period>"
+      "    <AdaptationSet mimeType=\"audio/webm\">"
+      "      <SegmentTemplate timescale=\"48000\" "
+      "          initialization=\"init-$RepresentationID$.webm\" "
+      "          media=\"$RepresentationID$-$Number$.webm\" "
+      "          startNumber=\"1\">"
+      "        <SegmentTimeline>"
+      "          <S t=\"0\" d=\"48000\" /> "
+      "          <S d=\"48000\" /> "
+      "        </SegmentTimeline>"
+      "      </SegmentTemplate>"
+      "      <Representation id=\"audio\" bandwidth=\"128000\" "
+      "          codecs=\"vorbis\" audioSamplingRate=\"48000\"> "
+      "    </Representation></AdaptationSet></Period></MPD>";
+
+  GstDashDemuxTestInputData inputTestData[] = {
+    {"http://unit.test/test.mpd", (guint8 *) mpd, 0},
+    {"http://unit.test/init-audio.webm", NULL, 1000},
+    {"http://unit.test/audio-1.webm", NULL, 5000},
+    {"http://unit.test/audio-2.webm", NULL, 5000},
+    {NULL, NULL, 0},
+  };
+  GstAdaptiveDemuxTestExpectedOutput outputTestData[] = {
+    {"audio_00", 11000, NULL},
+  };
+  GstTestHTTPSrcCallbacks http_src_callbacks = { 0 };
+  GstTestHTTPSrcTestData http_src_test_data = { 0 };
+  GstAdaptiveDemuxTestCallbacks test_callbacks = { 0 };
+  GstAdaptiveDemuxTestCase *engineTestData;
+  GstDashDemuxTestCase *testData;
+  GstClockTime first_fragment_time = GST_CLOCK_TIME_NONE;
+  GstClockTime header_time = GST_CLOCK_TIME_NONE;
+  GstClockTime fragment_time = GST_CLOCK_TIME_NONE;
+  guint count = 0;
+
+  http_src_callbacks.src_start = testFastStartSrcStart;
+  http_src_callbacks.src_create = gst_dashdemux_http_src_create;
+  http_src_test_data.input = inputTestData;
+  http_src_test_data.data = gst_structure_new_empty (__FUNCTION__);
+  if (fail_once)
+    gst_structure_set (http_src_test_data.data, "fail-once", G_TYPE_STRING,
+        fail_once, NULL);
+  gst_test_http_src_install_callbacks (&http_src_callbacks,
+      &http_src_test_data);
+
+  test_callbacks.pre_test = gst_adaptive_demux_test_enable_fast_start;
+  test_callbacks.appsink_received_data =
+      gst_adaptive_demux_test_check_received_data;
+  test_callbacks.appsink_eos =
+      gst_adaptive_demux_test_check_size_of_received_data;
+
+  testData = gst_dash_demux_test_case_new ();
+  COPY_OUTPUT_TEST_DATA (outputTestData, testData);
+
+  gst_adaptive_demux_test_run (DEMUX_ELEMENT_NAME, "http://unit.test/test.mpd",
+      &test_callbacks, testData);
+
+  /* the header and the first fragment are prefetched. A hit is served without
+   * another request, a failed prefetch falls back to the source element */
+  fail_unless (gst_structure_get_uint (http_src_test_data.data,
+          "init-audio.webm", &count));
+  assert_equals_uint64 (count, 1);
+  fail_unless (gst_structure_get_uint (http_src_test_data.data,
+          "audio-1.webm", &count));
+  assert_equals_uint64 (count, fragment_requests);
+  fail_unless (gst_structure_get_uint (http_src_test_data.data,
+          "audio-2.webm", &count));
+  assert_equals_uint64 (count, 1);
+
+  /* the stream reports how long it took to get its first fragment */
+  engineTestData = GST_ADAPTIVE_DEMUX_TEST_CASE (testData);
+  assert_equals_uint64 (engineTestData->startup_message_count, 1);
+  fail_unless (engineTestData->startup_message != NULL);
+  fail_unless_equals_string (gst_structure_get_string
+      (engineTestData->startup_message, "stream"), "audio_00");
+  fail_unless (gst_structure_get_clock_time (engineTestData->startup_message,
+          "first-fragment-time", &first_fragment_time));
+  fail_unless (gst_structure_get_clock_time (engineTestData->startup_message,
+          "header-download-time", &header_time));
+  fail_unless (gst_structure_get_clock_time (engineTestData->startup_message,
+          "fragment-download-time", &fragment_time));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (first_fragment_time));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (header_time));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (fragment_time));
+  fail_unless (fragment_time <= first_fragment_time);
+
+  g_object_unref (testData);
+  if (http_src_test_data.data)
+    gst_structure_free (http_src_test_data.data);
+}
+
+/*
+ * Test fast-start mode: the header and the first fragment are served from
+ * the prefetches and the startup message is posted
+ */
+GST_START_TEST (testFastStart)
+{
+  run_fast_start_test (NULL, 1);
+}
+
+GST_END_TEST;
+
+/*
+ * Test fast-start mode with a failing prefetch of the first fragment, it has
+ * to be downloaded again through the source element
+ */
+GST_START_TEST (testFastStartPrefetchFailure)
+{
+  run_fast_start_test ("audio-1.webm", 2);
+}
+
+GST_END_TEST;
+
+/* An isoff-on-demand video file with a SIDX and subsegments made of one moof
+ * and one mdat. The samples of each subsegment only have their sizes in the
+ * trun, so that the SIDX is the only thing saying that the first one of them
+ * is a keyframe. The keyframe of subsegment n is filled with
+ * KEY_UNITS_KEYFRAME_BYTE + n, all other samples with
+ * KEY_UNITS_DELTA_FRAME_BYTE. None of these values appear in the boxes */
+#define KEY_UNITS_SUBSEGMENTS 4
+#define KEY_UNITS_SAMPLES 4
+#define KEY_UNITS_SAMPLE_SIZE 4096
+#define KEY_UNITS_KEYFRAME_BYTE 0xA0
+#define KEY_UNITS_DELTA_FRAME_BYTE 0xDD
+#define KEY_UNITS_INIT_SIZE 24
+#define KEY_UNITS_SIDX_SIZE (32 + 12 * KEY_UNITS_SUBSEGMENTS)
+#define KEY_UNITS_MOOF_SIZE 84
+#define KEY_UNITS_SUBSEGMENT_SIZE \
+  (KEY_UNITS_MOOF_SIZE + 8 + KEY_UNITS_SAMPLES * KEY_UNITS_SAMPLE_SIZE)
+#define KEY_UNITS_FILE_SIZE (KEY_UNITS_INIT_SIZE + KEY_UNITS_SIDX_SIZE + \
+    KEY_UNITS_SUBSEGMENTS * KEY_UNITS_SUBSEGMENT_SIZE)
+
+static guint8 key_units_file[KEY_UNITS_FILE_SIZE];
+
+static struct
+{
+  GstAdaptiveDemuxTestEngine *engine;
+  GstAdaptiveDemuxTestCase *test_case;
+  gboolean seek_scheduled;
+  gint last_keyframe;
+  guint keyframe_bytes[KEY_UNITS_SUBSEGMENTS];
+} key_units_state;
+
+static guint8 *
+key_units_write_box_header (guint8 * data, guint32 size, const gchar * fourcc)
+{
+  GST_WRITE_UINT32_BE (data, size);
+  memcpy (data + 4, fourcc, 4);
+  return data + 8;
+}
+
+static guint8 *
+key_units_write_uint32 (guint8 * data, guint32 value)
+{
+  GST_WRITE_UINT32_BE (data, value);
+  return data + 4;
+}
+
+static void
+key_units_create_file (void)
+{
+  guint8 *data = key_units_file;
+  guint i, j;
+
+  memset (key_units_file, 0, sizeof (key_units_file));
+
+  /* ftyp and an empty moov */
+  data = key_units_write_box_header (data, 16, "ftyp");
+  memcpy (data, "iso6", 4);
+  data += 8;
+  data = key_units_write_box_header (data, 8, "moov");
+
+  /* sidx, version 0, timescale 1000 */
+  data = key_units_write_box_header (data, KEY_UNITS_SIDX_SIZE, "sidx");
+  data = key_units_write_uint32 (data, 0);
+  data = key_units_write_uint32 (data, 1);
+  data = key_units_write_uint32 (data, 1000);
+  data = key_units_write_uint32 (data, 0);
+  data = key_units_write_uint32 (data, 0);
+  GST_WRITE_UINT16_BE (data + 2, KEY_UNITS_SUBSEGMENTS);
+  data += 4;
+  for (i = 0; i < KEY_UNITS_SUBSEGMENTS; i++) {
+    data = key_units_write_uint32 (data, KEY_UNITS_SUBSEGMENT_SIZE);
+    data = key_units_write_uint32 (data, 1000);
+    /* starts with SAP of type 1 */
+    data = key_units_write_uint32 (data, (1u << 31) | (1 << 28));
+  }
+
+  for (i = 0; i < KEY_UNITS_SUBSEGMENTS; i++) {
+    data = key_units_write_box_header (data, KEY_UNITS_MOOF_SIZE, "moof");
+    data = key_units_write_box_header (data, 16, "mfhd");
+    data = key_units_write_uint32 (data, 0);
+    data = key_units_write_uint32 (data, i + 1);
+    data = key_units_write_box_header (data, 60, "traf");
+    /* default-base-is-moof */
+    data = key_units_write_box_header (data, 16, "tfhd");
+    data = key_units_write_uint32 (data, 0x020000);
+    data = key_units_write_uint32 (data, 1);
+    /* data-offset and sample-size present */
+    data = key_units_write_box_header (data, 20 + 4 * KEY_UNITS_SAMPLES,
+        "trun");
+    data = key_units_write_uint32 (data, 0x000201);
+    data = key_units_write_uint32 (data, KEY_UNITS_SAMPLES);
+    data = key_units_write_uint32 (data, KEY_UNITS_MOOF_SIZE + 8);
+    for (j = 0; j < KEY_UNITS_SAMPLES; j++)
+      data = key_units_write_uint32 (data, KEY_UNITS_SAMPLE_SIZE);
+
+    data = key_units_write_box_header (data,
+        8 + KEY_UNITS_SAMPLES * KEY_UNITS_SAMPLE_SIZE, "mdat");
+    memset (data, KEY_UNITS_KEYFRAME_BYTE + i, KEY_UNITS_SAMPLE_SIZE);
+    memset (data + KEY_UNITS_SAMPLE_SIZE, KEY_UNITS_DELTA_FRAME_BYTE,
+        (KEY_UNITS_SAMPLES - 1) * KEY_UNITS_SAMPLE_SIZE);
+    data += KEY_UNITS_SAMPLES * KEY_UNITS_SAMPLE_SIZE;
+  }
+
+  fail_unless_equals_int (data - key_units_file, KEY_UNITS_FILE_SIZE);
+}
+
+static gboolean
+testKeyUnitsSendSeek (gpointer user_data)
+{
+  GstAdaptiveDemuxTestCase *testData = key_units_state.test_case;
+
+  fail_unless (gst_element_send_event (key_units_state.engine->pipeline,
+          gst_event_ref (testData->seek_event)));
+
+  return G_SOURCE_REMOVE;
+}
+
+/* requests the trick mode seek once data is flowing, afterwards checks that
+ * only keyframes are pushed and that they are pushed in order */
+static gboolean
+testKeyUnitsCheckReceivedData (GstAdaptiveDemuxTestEngine * engine,
+    GstAdaptiveDemuxTestOutputStream * stream,
+    GstBuffer * buffer, gpointer user_data)
+{
+  GstAdaptiveDemuxTestCase *testData = GST_ADAPTIVE_DEMUX_TEST_CASE (user_data);
+  GstMapInfo info;
+  gsize i;
+
+  if (!key_units_state.seek_scheduled) {
+    key_units_state.engine = engine;
+    key_units_state.test_case = testData;
+    key_units_state.seek_scheduled = TRUE;
+    g_idle_add (testKeyUnitsSendSeek, NULL);
+  }
+
+  if (!testData->seeked)
+    return TRUE;
+
+  fail_unless (gst_buffer_map (buffer, &info, GST_MAP_READ));
+  for (i = 0; i < info.size; i++) {
+    gint keyframe;
+
+    fail_if (info.data[i] == KEY_UNITS_DELTA_FRAME_BYTE,
+        "Received a non-keyframe sample");
+
+    if (info.data[i] < KEY_UNITS_KEYFRAME_BYTE ||
+        info.data[i] >= KEY_UNITS_KEYFRAME_BYTE + KEY_UNITS_SUBSEGMENTS)
+      continue;
+
+    keyframe = info.data[i] - KEY_UNITS_KEYFRAME_BYTE;
+    fail_unless (keyframe >= key_units_state.last_keyframe);
+    key_units_state.last_keyframe = keyframe;
+    key_units_state.keyframe_bytes[keyframe]++;
+  }
+  gst_buffer_unmap (buffer, &info);
+
+  return TRUE;
+}
+
+static void
+testKeyUnitsCheckEvent (GstAdaptiveDemuxTestEngine * engine,
+    GstAdaptiveDemuxTestOutputStream * stream,
+    GstEvent * event, gpointer user_data)
+{
+  GstAdaptiveDemuxTestCase *testData = GST_ADAPTIVE_DEMUX_TEST_CASE (user_data);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT &&
+      gst_event_get_seqnum (event) ==
+      gst_event_get_seqnum (testData->seek_event)) {
+    const GstSegment *segment;
+
+    gst_event_parse_segment (event, &segment);
+    fail_unless (segment->flags & GST_SEGMENT_FLAG_TRICKMODE_KEY_UNITS);
+    testData->seeked = TRUE;
+  }
+}
+
+static void
+testKeyUnitsCheckEos (GstAdaptiveDemuxTestEngine * engine,
+    GstAdaptiveDemuxTestOutputStream * stream, gpointer user_data)
+{
+  GstAdaptiveDemuxTestCase *testData = GST_ADAPTIVE_DEMUX_TEST_CASE (user_data);
+  guint i, keyframes = 0;
+
+  /* the stream may end before the seek was handled */
+  if (!testData->seeked)
+    return;
+
+  /* keyframes are downloaded whole or not at all, starting with the one
+   * at the seek position */
+  for (i = 0; i < KEY_UNITS_SUBSEGMENTS; i++) {
+    if (key_units_state.keyframe_bytes[i] == 0)
+      continue;
+    fail_unless_equals_int (key_units_state.keyframe_bytes[i],
+        KEY_UNITS_SAMPLE_SIZE);
+    keyframes++;
+  }
+  fail_unless (key_units_state.keyframe_bytes[0] != 0);
+  fail_unless (keyframes >= 2);
+
+  g_main_loop_quit (engine->loop);
+}
+
+/*
+ * Test a key-unit trick mode seek on an isoff-on-demand stream where only the
+ * SIDX tells which samples are keyframes. Only the keyframes are downloaded
+ * and pushed after the seek
+ */
+GST_START_TEST (testSeekKeyUnitsTrickMode)
+{
+  gchar *mpd;
+  GstDashDemuxTestInputData inputTestData[] = {
+    {"http://unit.test/test.mpd", NULL, 0},
+    {"http://unit.test/video.mp4", key_units_file, KEY_UNITS_FILE_SIZE},
+    {NULL, NULL, 0},
+  };
+  GstAdaptiveDemuxTestExpectedOutput outputTestData[] = {
+    {"video_00", KEY_UNITS_FILE_SIZE, NULL},
+  };
+  GstTestHTTPSrcCallbacks http_src_callbacks = { 0 };
+  GstTestHTTPSrcTestData http_src_test_data = { 0 };
+  GstAdaptiveDemuxTestCallbacks test_callbacks = { 0 };
+  GstAdaptiveDemuxTestCase *engineTestData;
+  GstDashDemuxTestCase *testData;
+
+  key_units_create_file ();
+  memset (&key_units_state, 0, sizeof (key_units_state));
+
+  mpd = g_strdup_printf ("<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+      "<MPD xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\""
+      "     xmlns=\"urn:mpeg:DASH:schema:MPD:2011\""
+      "     xsi:schemaLocation=\"urn:mpeg:DASH:schema:MPD:2011 DASH-MPD.xsd\""
+      "     profiles=\"urn:mpeg:dash:profile:isoff-on-demand:2011\""
+      "     type=\"static\""
+      "     minBufferTime=\"PT1.500S\""
+      "     mediaPresentationDuration=\"PT%uS\">"
+      "  <Period>"
+      "    <AdaptationSet mimeType=\"video/mp4\""
+      "                   subsegmentAlignment=\"true\""
+      "                   subsegmentStartsWithSAP=\"1\">"
+      "      <Representation id=\"1\""
+      "                      codecs=\"avc1.42c01e\""
+      "                      width=\"320\""
+      "                      height=\"240\""
+      "                      bandwidth=\"131072\">"
+      "        <BaseURL>video.mp4</BaseURL>"
+      "        <SegmentBase indexRange=\"%u-%u\""
+      "                     indexRangeExact=\"true\">"
+      "          <Initialization range=\"0-%u\" />"
+      "        </SegmentBase>"
+      "      </Representation></AdaptationSet></Period></MPD>",
+      KEY_UNITS_SUBSEGMENTS, KEY_UNITS_INIT_SIZE,
+      KEY_UNITS_INIT_SIZE + KEY_UNITS_SIDX_SIZE - 1, KEY_UNITS_INIT_SIZE - 1);
+  inputTestData[0].payload = (guint8 *) mpd;
+
+  http_src_callbacks.src_start = gst_dashdemux_http_src_start;
+  http_src_callbacks.src_create = gst_dashdemux_http_src_create;
+  http_src_test_data.input = inputTestData;
+  gst_test_http_src_install_callbacks (&http_src_callbacks,
+      &http_src_test_data);
+
+  test_callbacks.appsink_received_data = testKeyUnitsCheckReceivedData;
+  test_callbacks.appsink_event = testKeyUnitsCheckEvent;
+  test_callbacks.appsink_eos = testKeyUnitsCheckEos;
+
+  testData = gst_dash_demux_test_case_new ();
+  COPY_OUTPUT_TEST_DATA (outputTestData, testData);
+  engineTestData = GST_ADAPTIVE_DEMUX_TEST_CASE (testData);
+  engineTestData->seek_event =
+      gst_event_new_seek (1.0, GST_FORMAT_TIME,
+      GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_TRICKMODE |
+      GST_SEEK_FLAG_TRICKMODE_KEY_UNITS, GST_SEEK_TYPE_SET, 0,
+      GST_SEEK_TYPE_NONE, 0);
+
+  gst_adaptive_demux_test_run (DEMUX_ELEMENT_NAME,
+      "http://unit.test/test.mpd", &test_callbacks, testData);
+
+  fail_unless (engineTestData->seeked);
+
+  g_object_unref (testData);
+  if (http_src_test_data.data)
+    gst_structure_free (http_src_test_data.data);
+  g_free (mpd);
+}
+
+GST_END_TEST;
+
 static Suite *
 dash_demux_suite (void)
 {
@@ -1527,6 +1973,7 @@ dash_demux_suite (void)
   tcase_add_test (tc_basicTest, testParameters);
   tcase_add_test (tc_basicTest, testSeek);
   tcase_add_test (tc_basicTest, testSeekKeyUnitPosition);
+  tcase_add_test (tc_basicTest, testSeekKeyUnitsTrickMode);
   tcase_add_test (tc_basicTest, testSeekPosition);
   tcase_add_test (tc_basicTest, testSeekUpdateStopPosition);
   tcase_add_test (tc_basicTest, testSeekSnapBeforePosition);
@@ -1541,6 +1988,8 @@ dash_demux_suite (void)
   tcase_add_test (tc_basicTest, testMediaDownloadErrorMiddleFragment);
   tcase_add_test (tc_basicTest, testQuery);
   tcase_add_test (tc_basicTest, testContentProtection);
+  tcase_add_test (tc_basicTest, testFastStart);
+  tcase_add_test (tc_basicTest, testFastStartPrefetchFailure);
 
   tcase_add_unchecked_fixture (tc_basicTest, gst_adaptive_demux_test_setup,
       gst_adaptive_demux_test_teardown);
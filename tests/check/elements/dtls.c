@@ -74,12 +74,12 @@ static gchar data[] = {
   0x00, 0x01, 0x02, 0x03,
 };
 
-GST_START_TEST (test_data_transfer)
+static void
+_create_server_and_client (const gchar * server_id, const gchar * client_id,
+    GstHarness ** server, GstHarness ** client)
 {
-  GstHarness *server, *client;
   GstElement *s_enc, *s_dec, *c_enc, *c_dec, *s_bin, *c_bin;
   GstPad *target, *ghost;
-  GstBuffer *buffer, *buf2;
 
   /* setup a server and client for dtls negotiation */
   s_bin = gst_bin_new (NULL);
@@ -93,28 +93,28 @@ GST_START_TEST (test_data_transfer)
    * associated decoder receives any data and calls gst_dtls_connection_process().
    */
   s_dec = gst_element_factory_make ("dtlsdec", "server_dec");
-  g_object_set (s_dec, "connection-id", "server", NULL);
+  g_object_set (s_dec, "connection-id", server_id, NULL);
   g_signal_connect (s_dec, "on-key-received", G_CALLBACK (_on_key_received),
       NULL);
   gst_element_set_state (s_dec, GST_STATE_PAUSED);
   gst_bin_add (GST_BIN (s_bin), s_dec);
 
   s_enc = gst_element_factory_make ("dtlsenc", "server_enc");
-  g_object_set (s_enc, "connection-id", "server", NULL);
+  g_object_set (s_enc, "connection-id", server_id, NULL);
   g_signal_connect (s_enc, "on-key-received", G_CALLBACK (_on_key_received),
       NULL);
   gst_element_set_state (s_enc, GST_STATE_PAUSED);
   gst_bin_add (GST_BIN (c_bin), s_enc);
 
   c_dec = gst_element_factory_make ("dtlsdec", "client_dec");
-  g_object_set (c_dec, "connection-id", "client", NULL);
+  g_object_set (c_dec, "connection-id", client_id, NULL);
   g_signal_connect (c_dec, "on-key-received", G_CALLBACK (_on_key_received),
       NULL);
   gst_element_set_state (c_dec, GST_STATE_PAUSED);
   gst_bin_add (GST_BIN (c_bin), c_dec);
 
   c_enc = gst_element_factory_make ("dtlsenc", "client_enc");
-  g_object_set (c_enc, "connection-id", "client", "is-client", TRUE, NULL);
+  g_object_set (c_enc, "connection-id", client_id, "is-client", TRUE, NULL);
   g_signal_connect (c_enc, "on-key-received", G_CALLBACK (_on_key_received),
       NULL);
   gst_element_set_state (c_enc, GST_STATE_PAUSED);
@@ -143,11 +143,26 @@ GST_START_TEST (test_data_transfer)
   gst_element_add_pad (c_bin, ghost);
   gst_object_unref (target);
 
-  server = gst_harness_new_with_element (s_bin, "sink", "src");
-  client = gst_harness_new_with_element (c_bin, "sink", "src");
+  *server = gst_harness_new_with_element (s_bin, "sink", "src");
+  *client = gst_harness_new_with_element (c_bin, "sink", "src");
+
+  gst_object_unref (s_bin);
+  gst_object_unref (c_bin);
+
+  gst_harness_set_src_caps_str (*server, "application/data");
+  gst_harness_set_src_caps_str (*client, "application/data");
+}
+
+GST_START_TEST (test_data_transfer)
+{
+  GstHarness *server, *client;
+  GstBuffer *buffer, *buf2;
+
+  g_mutex_lock (&key_lock);
+  key_count = 0;
+  g_mutex_unlock (&key_lock);
 
-  gst_harness_set_src_caps_str (server, "application/data");
-  gst_harness_set_src_caps_str (client, "application/data");
+  _create_server_and_client ("server", "client", &server, &client);
 
   _wait_for_key_count_to_reach (4);
 
@@ -166,9 +181,6 @@ GST_START_TEST (test_data_transfer)
           G_N_ELEMENTS (data)));
   gst_buffer_unref (buf2);
 
-  gst_object_unref (s_bin);
-  gst_object_unref (c_bin);
-
   gst_buffer_unref (buffer);
   gst_harness_teardown (server);
   gst_harness_teardown (client);
@@ -176,6 +188,90 @@ GST_START_TEST (test_data_transfer)
 
 GST_END_TEST;
 
+#define N_HANDSHAKES 20
+
+/* Runs a number of handshakes back to back and reports the rate, with
+ * distinct connection ids every handshake is a full one, reusing the ids
+ * lets the client resume the session of the previous round. */
+static gdouble
+_measure_handshake_rate (gboolean reuse_ids)
+{
+  GstHarness *server, *client;
+  gint64 start;
+  gint i;
+
+  g_mutex_lock (&key_lock);
+  key_count = 0;
+  g_mutex_unlock (&key_lock);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < N_HANDSHAKES; i++) {
+    gchar *server_id, *client_id;
+
+    if (reuse_ids) {
+      server_id = g_strdup ("rate_server");
+      client_id = g_strdup ("rate_client");
+    } else {
+      server_id = g_strdup_printf ("rate_server_%d", i);
+      client_id = g_strdup_printf ("rate_client_%d", i);
+    }
+
+    _create_server_and_client (server_id, client_id, &server, &client);
+    _wait_for_key_count_to_reach (4 * (i + 1));
+
+    gst_harness_teardown (server);
+    gst_harness_teardown (client);
+    g_free (server_id);
+    g_free (client_id);
+  }
+
+  return N_HANDSHAKES * G_USEC_PER_SEC /
+      (gdouble) (g_get_monotonic_time () - start);
+}
+
+#ifndef GST_DISABLE_GST_DEBUG
+static gint n_resumed;
+
+/* the connection logs each handshake that resumed a session */
+static void
+_count_resumed_sessions (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line, GObject * object,
+    GstDebugMessage * message, gpointer user_data)
+{
+  if (g_strcmp0 (gst_debug_category_get_name (category), "dtlsconnection") == 0
+      && g_strcmp0 (gst_debug_message_get (message), "session resumed") == 0)
+    g_atomic_int_inc (&n_resumed);
+}
+#endif
+
+GST_START_TEST (test_handshake_rate)
+{
+  gdouble full, resumed;
+
+#ifndef GST_DISABLE_GST_DEBUG
+  gst_debug_set_threshold_for_name ("dtlsconnection", GST_LEVEL_INFO);
+  gst_debug_add_log_function (_count_resumed_sessions, NULL, NULL);
+#endif
+
+  full = _measure_handshake_rate (FALSE);
+#ifndef GST_DISABLE_GST_DEBUG
+  fail_unless_equals_int (g_atomic_int_get (&n_resumed), 0);
+#endif
+
+  resumed = _measure_handshake_rate (TRUE);
+#ifndef GST_DISABLE_GST_DEBUG
+  /* all but the first round resume the session, on both sides */
+  fail_unless (g_atomic_int_get (&n_resumed) >= N_HANDSHAKES - 1);
+  gst_debug_remove_log_function (_count_resumed_sessions);
+#endif
+
+  GST_INFO ("full handshakes: %.1f/s, resumed handshakes: %.1f/s", full,
+      resumed);
+  fail_unless (full > 0 && resumed > 0);
+}
+
+GST_END_TEST;
+
 static Suite *
 dtls_suite (void)
 {
@@ -185,6 +281,7 @@ dtls_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_create_and_unref);
   tcase_add_test (tc_chain, test_data_transfer);
+  tcase_add_test (tc_chain, test_handshake_rate);
 
   return s;
 }
@@ -19,6 +19,7 @@
  */
 
 #include <gst/check/gstcheck.h>
+#include <gst/uridownloader/gsturidownloader.h>
 #include "adaptive_demux_common.h"
 
 #define DEMUX_ELEMENT_NAME "hlsdemux"
@@ -724,6 +725,282 @@ GST_START_TEST (testFragmentDownloadError)
 
 GST_END_TEST;
 
+/* test that duplicate fetches are served by the shared downloader cache */
+GST_START_TEST (testSharedDownloaderCache)
+{
+  const gchar *media_playlist =
+      "#EXTM3U \n"
+      "#EXT-X-TARGETDURATION:1\n"
+      "#EXTINF:1,Test\n" "001.ts\n" "#EXT-X-ENDLIST\n";
+  GstHlsDemuxTestInputData inputTestData[] = {
+    {"http://unit.test/media.m3u8", (guint8 *) media_playlist, 0},
+    {NULL, NULL, 0},
+  };
+  GstAdaptiveDemuxTestExpectedOutput outputTestData[] = {
+    {NULL, 0, NULL}
+  };
+  GstUriDownloader *downloader1, *downloader2;
+  GstFragment *download;
+  GstStructure *stats;
+  const GValue *requests;
+  guint64 hits, misses;
+  TESTCASE_INIT_BOILERPLATE (0);
+
+  http_src_callbacks.src_start = gst_hlsdemux_test_src_start;
+  http_src_callbacks.src_create = gst_hlsdemux_test_src_create;
+  gst_test_http_src_install_callbacks (&http_src_callbacks, &hlsTestCase);
+
+  gst_uri_downloader_cache_clear ();
+  gst_uri_downloader_cache_set_max_size (1024 * 1024);
+  downloader1 = gst_uri_downloader_new ();
+  downloader2 = gst_uri_downloader_new ();
+
+  download = gst_uri_downloader_fetch_uri (downloader1, inputTestData[0].uri,
+      NULL, FALSE, FALSE, TRUE, NULL);
+  fail_unless (download != NULL);
+  g_object_unref (download);
+
+  /* second instance gets the cached copy */
+  download = gst_uri_downloader_fetch_uri (downloader2, inputTestData[0].uri,
+      NULL, FALSE, FALSE, TRUE, NULL);
+  fail_unless (download != NULL);
+  fail_unless (download->completed);
+  fail_unless_equals_string (download->uri, inputTestData[0].uri);
+  g_object_unref (download);
+
+  /* without a Cache-Control lifetime refreshes must go to the server */
+  download = gst_uri_downloader_fetch_uri (downloader2, inputTestData[0].uri,
+      NULL, FALSE, TRUE, TRUE, NULL);
+  fail_unless (download != NULL);
+  g_object_unref (download);
+
+  requests = gst_structure_get_value (hlsTestCase.state, "requests");
+  fail_unless (requests != NULL);
+  assert_equals_uint64 (gst_value_array_get_size (requests), 2);
+
+  stats = gst_uri_downloader_cache_get_stats ();
+  fail_unless (gst_structure_get_uint64 (stats, "hits", &hits));
+  fail_unless (gst_structure_get_uint64 (stats, "misses", &misses));
+  assert_equals_uint64 (hits, 1);
+  assert_equals_uint64 (misses, 2);
+  gst_structure_free (stats);
+
+  gst_uri_downloader_cache_set_max_size (0);
+  gst_uri_downloader_cache_clear ();
+  gst_object_unref (downloader1);
+  gst_object_unref (downloader2);
+
+  TESTCASE_UNREF_BOILERPLATE;
+}
+
+GST_END_TEST;
+
+/* fails the first request of the file with the "failure-suffix" */
+static gboolean
+hlsdemux_test_fail_once_src_start (GstTestHTTPSrc * src,
+    const gchar * uri, GstTestHTTPSrcInput * input_data, gpointer user_data)
+{
+  const GstHlsDemuxTestCase *test_case =
+      (const GstHlsDemuxTestCase *) user_data;
+  const gchar *failure_suffix;
+  guint fail_count = 0;
+
+  failure_suffix =
+      gst_structure_get_string (test_case->state, "failure-suffix");
+  gst_structure_get_uint (test_case->state, "failure-count", &fail_count);
+  if (fail_count == 0 && failure_suffix
+      && g_str_has_suffix (uri, failure_suffix)) {
+    GST_DEBUG ("failing first request of %s", uri);
+    gst_structure_set (test_case->state, "failure-count", G_TYPE_UINT, 1,
+        NULL);
+    return FALSE;
+  }
+  return gst_hlsdemux_test_src_start (src, uri, input_data, user_data);
+}
+
+static void
+run_fast_start_test (const gchar * failure_suffix)
+{
+  const guint segment_size = 30 * TS_PACKET_LEN;
+  const gchar *media_playlist =
+      "#EXTM3U \n"
+      "#EXT-X-TARGETDURATION:1\n"
+      "#EXTINF:1,Test\n" "001.ts\n"
+      "#EXTINF:1,Test\n" "002.ts\n" "#EXT-X-ENDLIST\n";
+  GstHlsDemuxTestInputData inputTestData[] = {
+    {"http://unit.test/media.m3u8", (guint8 *) media_playlist, 0},
+    {"http://unit.test/001.ts", NULL, segment_size},
+    {"http://unit.test/002.ts", NULL, segment_size},
+    {NULL, NULL, 0},
+  };
+  GstAdaptiveDemuxTestExpectedOutput outputTestData[] = {
+    {"src_0", 2 * segment_size, NULL},
+    {NULL, 0, NULL}
+  };
+  GstClockTime first_fragment_time = GST_CLOCK_TIME_NONE;
+  GstClockTime fragment_time = GST_CLOCK_TIME_NONE;
+  GstClockTime manifest_time = GST_CLOCK_TIME_NONE;
+  const GValue *requests;
+  guint fail_count = 0;
+  guint i;
+  TESTCASE_INIT_BOILERPLATE (segment_size);
+
+  if (failure_suffix)
+    gst_structure_set (hlsTestCase.state,
+        "failure-suffix", G_TYPE_STRING, failure_suffix, NULL);
+  http_src_callbacks.src_start = hlsdemux_test_fail_once_src_start;
+  http_src_callbacks.src_create = gst_hlsdemux_test_src_create;
+  engine_callbacks.pre_test = gst_adaptive_demux_test_enable_fast_start;
+  engine_callbacks.appsink_received_data =
+      gst_adaptive_demux_test_check_received_data;
+  engine_callbacks.appsink_eos =
+      gst_adaptive_demux_test_check_size_of_received_data;
+
+  gst_test_http_src_install_callbacks (&http_src_callbacks, &hlsTestCase);
+  gst_adaptive_demux_test_run (DEMUX_ELEMENT_NAME,
+      inputTestData[0].uri, &engine_callbacks, engineTestData);
+
+  /* a prefetch hit is served without another request, a failed prefetch
+   * falls back to the source element. Either way every file is opened
+   * successfully once */
+  gst_structure_get_uint (hlsTestCase.state, "failure-count", &fail_count);
+  assert_equals_uint64 (fail_count, failure_suffix ? 1 : 0);
+  requests = gst_structure_get_value (hlsTestCase.state, "requests");
+  fail_unless (requests != NULL);
+  assert_equals_uint64 (gst_value_array_get_size (requests),
+      sizeof (inputTestData) / sizeof (inputTestData[0]) - 1);
+  for (i = 0; inputTestData[i].uri; ++i) {
+    const GValue *uri;
+    uri = gst_value_array_get_value (requests, i);
+    fail_unless (uri != NULL);
+    assert_equals_string (inputTestData[i].uri, g_value_get_string (uri));
+  }
+
+  /* the stream reports how long it took to get its first fragment */
+  assert_equals_uint64 (engineTestData->startup_message_count, 1);
+  fail_unless (engineTestData->startup_message != NULL);
+  fail_unless_equals_string (gst_structure_get_string
+      (engineTestData->startup_message, "stream"), "src_0");
+  fail_unless (gst_structure_get_clock_time (engineTestData->startup_message,
+          "manifest-time", &manifest_time));
+  fail_unless (gst_structure_get_clock_time (engineTestData->startup_message,
+          "fragment-download-time", &fragment_time));
+  fail_unless (gst_structure_get_clock_time (engineTestData->startup_message,
+          "first-fragment-time", &first_fragment_time));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (manifest_time));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (fragment_time));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (first_fragment_time));
+  fail_unless (manifest_time <= first_fragment_time);
+
+  TESTCASE_UNREF_BOILERPLATE;
+}
+
+/*
+ * Test fast-start mode: the first fragment is served from the prefetch and
+ * the startup message is posted
+ */
+GST_START_TEST (testFastStart)
+{
+  run_fast_start_test (NULL);
+}
+
+GST_END_TEST;
+
+/*
+ * Test fast-start mode with a failing prefetch of the first fragment, it has
+ * to be downloaded again through the source element
+ */
+GST_START_TEST (testFastStartPrefetchFailure)
+{
+  run_fast_start_test ("001.ts");
+}
+
+GST_END_TEST;
+
+/* AES-128 encrypted segment and the key it was encrypted with, the
+ * plaintext is generate_transport_stream (200 * TS_PACKET_LEN) */
+#define AES128_SEGMENT_FILE GST_TEST_FILES_PATH G_DIR_SEPARATOR_S "hls-aes128.ts"
+#define AES128_SEGMENT_SIZE (200 * TS_PACKET_LEN)
+#define AES128_N_FRAGMENTS 32
+
+static const guint8 aes128_key[16] = {
+  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+  0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+};
+
+/*
+ * Test decryption of AES-128 encrypted fragments and report the throughput
+ * of the download and decryption path
+ */
+GST_START_TEST (testDecryption)
+{
+  GstHlsDemuxTestInputData inputTestData[] = {
+    {"http://unit.test/media.m3u8", NULL, 0},
+    {"http://unit.test/key.bin", aes128_key, sizeof (aes128_key)},
+    {"http://unit.test/001.ts", NULL, 0},
+    {NULL, NULL, 0},
+  };
+  GstAdaptiveDemuxTestExpectedOutput outputTestData[] = {
+    {"src_0", AES128_SEGMENT_SIZE * AES128_N_FRAGMENTS, NULL},
+    {NULL, 0, NULL}
+  };
+  GByteArray *plaintext, *expected;
+  GString *manifest;
+  gchar *encrypted;
+  gsize encrypted_size;
+  gint64 start, elapsed;
+  guint i;
+  TESTCASE_INIT_BOILERPLATE (0);
+
+  fail_unless (g_file_get_contents (AES128_SEGMENT_FILE, &encrypted,
+          &encrypted_size, NULL));
+  fail_unless_equals_int (encrypted_size, AES128_SEGMENT_SIZE + 16);
+
+  manifest = g_string_new ("#EXTM3U \n"
+      "#EXT-X-TARGETDURATION:1\n"
+      "#EXT-X-KEY:METHOD=AES-128,URI=\"key.bin\","
+      "IV=0x000102030405060708090a0b0c0d0e0f\n");
+  plaintext = generate_transport_stream (AES128_SEGMENT_SIZE);
+  expected = g_byte_array_sized_new (outputTestData[0].expected_size);
+  for (i = 0; i < AES128_N_FRAGMENTS; i++) {
+    g_string_append (manifest, "#EXTINF:1,Test\n001.ts\n");
+    g_byte_array_append (expected, plaintext->data, plaintext->len);
+  }
+  g_string_append (manifest, "#EXT-X-ENDLIST\n");
+
+  inputTestData[0].payload = (guint8 *) manifest->str;
+  inputTestData[2].payload = (guint8 *) encrypted;
+  inputTestData[2].size = encrypted_size;
+  outputTestData[0].expected_data = expected->data;
+  engineTestData->output_streams =
+      g_list_append (engineTestData->output_streams, &outputTestData[0]);
+
+  http_src_callbacks.src_start = gst_hlsdemux_test_src_start;
+  http_src_callbacks.src_create = gst_hlsdemux_test_src_create;
+  engine_callbacks.appsink_received_data =
+      gst_adaptive_demux_test_check_received_data;
+  engine_callbacks.appsink_eos =
+      gst_adaptive_demux_test_check_size_of_received_data;
+
+  gst_test_http_src_install_callbacks (&http_src_callbacks, &hlsTestCase);
+  start = g_get_monotonic_time ();
+  gst_adaptive_demux_test_run (DEMUX_ELEMENT_NAME,
+      inputTestData[0].uri, &engine_callbacks, engineTestData);
+  elapsed = MAX (g_get_monotonic_time () - start, 1);
+
+  GST_INFO ("Decrypted %" G_GUINT64_FORMAT " bytes in %" G_GINT64_FORMAT
+      " us, %.1f MB/s", outputTestData[0].expected_size, elapsed,
+      (gdouble) outputTestData[0].expected_size / elapsed);
+
+  g_byte_array_free (expected, TRUE);
+  g_byte_array_free (plaintext, TRUE);
+  g_string_free (manifest, TRUE);
+  g_free (encrypted);
+  TESTCASE_UNREF_BOILERPLATE;
+}
+
+GST_END_TEST;
+
 static Suite *
 hls_demux_suite (void)
 {
@@ -743,6 +1020,10 @@ hls_demux_suite (void)
   tcase_add_test (tc_basicTest, testSeekSnapAfterPosition);
   tcase_add_test (tc_basicTest, testReverseSeekSnapBeforePosition);
   tcase_add_test (tc_basicTest, testReverseSeekSnapAfterPosition);
+  tcase_add_test (tc_basicTest, testSharedDownloaderCache);
+  tcase_add_test (tc_basicTest, testDecryption);
+  tcase_add_test (tc_basicTest, testFastStart);
+  tcase_add_test (tc_basicTest, testFastStartPrefetchFailure);
 
   tcase_add_unchecked_fixture (tc_basicTest, gst_adaptive_demux_test_setup,
       gst_adaptive_demux_test_teardown);
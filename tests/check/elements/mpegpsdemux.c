@@ -0,0 +1,417 @@
+/* GStreamer
+ *
+ * unit test for mpegpsdemux
+ *
+ * Copyright (C) 2026 GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <string.h>
+
+#define CLOCK_FREQ 90000
+#define PACK_SIZE 2048
+#define N_PACKS 2000
+#define FIRST_SCR CLOCK_FREQ
+/* in units of 50 bytes/s */
+#define MUX_RATE 1024
+/* the pack seeked to, its SCR is 181 seconds */
+#define TARGET_PACK 900
+/* a pack with a SCR going 10 seconds backwards */
+#define BACKWARD_PACK 1900
+#define BACKWARD_SCR (pack_scr (BACKWARD_PACK) - 10 * CLOCK_FREQ)
+
+static GstPad *mysrcpad, *mysinkpad;
+static guint8 *ps_data;
+static gsize ps_size;
+
+static GMutex lock;
+static GCond cond;
+static guint n_pulls;
+static gboolean have_eos;
+static gboolean stop_after_first;
+static GstClockTime first_pts;
+
+static GstStaticPadTemplate mysrctemplate =
+GST_STATIC_PAD_TEMPLATE ("src", GST_PAD_SRC, GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/mpeg, systemstream = (boolean) true"));
+
+static GstStaticPadTemplate mysinktemplate =
+GST_STATIC_PAD_TEMPLATE ("sink", GST_PAD_SINK, GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+/* The SCR grows quadratically with the offset, so interpolating between
+ * two packs never lands on the requested one right away and an unindexed
+ * seek has to pull several blocks */
+static guint64
+pack_scr (guint i)
+{
+  return FIRST_SCR + 20 * (guint64) i * i;
+}
+
+static void
+write_pack (guint8 * data, guint64 scr, guint64 pts)
+{
+  /* MPEG-2 pack header without stuffing */
+  GST_WRITE_UINT32_BE (data, 0x000001ba);
+  data[4] = 0x44 | ((scr >> 27) & 0x38) | ((scr >> 28) & 0x03);
+  data[5] = (scr >> 20) & 0xff;
+  data[6] = 0x04 | ((scr >> 12) & 0xf8) | ((scr >> 13) & 0x03);
+  data[7] = (scr >> 5) & 0xff;
+  data[8] = 0x04 | ((scr << 3) & 0xf8);
+  data[9] = 0x01;
+  data[10] = (MUX_RATE >> 14) & 0xff;
+  data[11] = (MUX_RATE >> 6) & 0xff;
+  data[12] = ((MUX_RATE << 2) & 0xfc) | 0x03;
+  data[13] = 0xf8;
+
+  /* a video PES packet with a PTS filling the rest of the pack */
+  GST_WRITE_UINT32_BE (data + 14, 0x000001e0);
+  GST_WRITE_UINT16_BE (data + 18, PACK_SIZE - 20);
+  data[20] = 0x80;
+  data[21] = 0x80;
+  data[22] = 0x05;
+  data[23] = 0x21 | ((pts >> 29) & 0x0e);
+  data[24] = (pts >> 22) & 0xff;
+  data[25] = 0x01 | ((pts >> 14) & 0xfe);
+  data[26] = (pts >> 7) & 0xff;
+  data[27] = 0x01 | ((pts << 1) & 0xfe);
+}
+
+static void
+create_ps_data (void)
+{
+  guint i;
+
+  ps_size = N_PACKS * PACK_SIZE;
+  ps_data = g_malloc0 (ps_size);
+
+  for (i = 0; i < N_PACKS; i++) {
+    guint64 scr = pack_scr (i);
+
+    write_pack (ps_data + i * PACK_SIZE,
+        i == BACKWARD_PACK ? BACKWARD_SCR : scr, scr);
+  }
+}
+
+static GstFlowReturn
+_src_getrange (GstPad * pad, GstObject * parent, guint64 offset, guint length,
+    GstBuffer ** buffer)
+{
+  if (offset >= ps_size)
+    return GST_FLOW_EOS;
+  length = MIN (length, ps_size - offset);
+
+  g_mutex_lock (&lock);
+  n_pulls++;
+  g_mutex_unlock (&lock);
+
+  *buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+      ps_data + offset, length, 0, length, NULL, NULL);
+  GST_BUFFER_OFFSET (*buffer) = offset;
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  gboolean res = FALSE;
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_DURATION:{
+      GstFormat fmt;
+
+      gst_query_parse_duration (query, &fmt, NULL);
+      if (fmt != GST_FORMAT_BYTES)
+        break;
+
+      gst_query_set_duration (query, fmt, ps_size);
+      res = TRUE;
+      break;
+    }
+    case GST_QUERY_SCHEDULING:{
+      gst_query_set_scheduling (query, GST_SCHEDULING_FLAG_SEEKABLE, 1, -1, 0);
+      gst_query_add_scheduling_mode (query, GST_PAD_MODE_PULL);
+      res = TRUE;
+      break;
+    }
+    default:
+      GST_DEBUG_OBJECT (pad, "unhandled %s query", GST_QUERY_TYPE_NAME (query));
+      break;
+  }
+
+  return res;
+}
+
+static GstFlowReturn
+_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  g_mutex_lock (&lock);
+  if (!GST_CLOCK_TIME_IS_VALID (first_pts))
+    first_pts = GST_BUFFER_PTS (buffer);
+  /* makes the demuxer pause after the first buffer following a seek */
+  if (stop_after_first)
+    ret = GST_FLOW_EOS;
+  g_mutex_unlock (&lock);
+
+  gst_buffer_unref (buffer);
+
+  return ret;
+}
+
+static gboolean
+_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS) {
+    g_mutex_lock (&lock);
+    have_eos = TRUE;
+    g_cond_signal (&cond);
+    g_mutex_unlock (&lock);
+  }
+
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static void
+_pad_added (GstElement * element, GstPad * pad, gpointer user_data)
+{
+  fail_unless (gst_pad_link (pad, mysinkpad) == GST_PAD_LINK_OK);
+}
+
+static void
+wait_for_eos (void)
+{
+  g_mutex_lock (&lock);
+  while (!have_eos)
+    g_cond_wait (&cond, &lock);
+  g_mutex_unlock (&lock);
+}
+
+static GstElement *
+setup_psdemux (void)
+{
+  GstElement *psdemux;
+  GstPad *sinkpad;
+
+  create_ps_data ();
+  n_pulls = 0;
+  have_eos = FALSE;
+  stop_after_first = TRUE;
+  first_pts = GST_CLOCK_TIME_NONE;
+
+  psdemux = gst_element_factory_make ("mpegpsdemux", NULL);
+  fail_unless (psdemux != NULL);
+  g_signal_connect (psdemux, "pad-added", G_CALLBACK (_pad_added), NULL);
+
+  mysinkpad = gst_pad_new_from_static_template (&mysinktemplate, "sink");
+  gst_pad_set_chain_function (mysinkpad, _sink_chain);
+  gst_pad_set_event_function (mysinkpad, _sink_event);
+  mysrcpad = gst_pad_new_from_static_template (&mysrctemplate, "src");
+  gst_pad_set_getrange_function (mysrcpad, _src_getrange);
+  gst_pad_set_query_function (mysrcpad, _src_query);
+
+  sinkpad = gst_element_get_static_pad (psdemux, "sink");
+  fail_unless (gst_pad_link (mysrcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+
+  gst_pad_set_active (mysinkpad, TRUE);
+  gst_pad_set_active (mysrcpad, TRUE);
+
+  fail_unless_equals_int (gst_element_set_state (psdemux, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_SUCCESS);
+  wait_for_eos ();
+
+  /* playback starts at the first pack */
+  fail_unless_equals_uint64 (first_pts,
+      gst_util_uint64_scale (pack_scr (0), GST_SECOND, CLOCK_FREQ));
+
+  return psdemux;
+}
+
+static void
+cleanup_psdemux (GstElement * psdemux)
+{
+  gst_element_set_state (psdemux, GST_STATE_NULL);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_pad_set_active (mysrcpad, FALSE);
+
+  gst_object_unref (psdemux);
+  gst_object_unref (mysinkpad);
+  gst_object_unref (mysrcpad);
+  g_free (ps_data);
+  ps_data = NULL;
+}
+
+/* Seeks to the pack with the given SCR and returns the number of pulls
+ * needed until the demuxer paused again after the first buffer */
+static guint
+seek_to_scr (guint64 scr)
+{
+  GstClockTime position =
+      gst_util_uint64_scale (scr - FIRST_SCR, GST_SECOND, CLOCK_FREQ);
+  GstEvent *event;
+  guint pulls;
+
+  g_mutex_lock (&lock);
+  n_pulls = 0;
+  have_eos = FALSE;
+  first_pts = GST_CLOCK_TIME_NONE;
+  g_mutex_unlock (&lock);
+
+  event = gst_event_new_seek (1.0, GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH,
+      GST_SEEK_TYPE_SET, position, GST_SEEK_TYPE_NONE, -1);
+  fail_unless (gst_pad_push_event (mysinkpad, event));
+  wait_for_eos ();
+
+  g_mutex_lock (&lock);
+  pulls = n_pulls;
+  g_mutex_unlock (&lock);
+
+  return pulls;
+}
+
+GST_START_TEST (test_pull_seek_index)
+{
+  GstElement *psdemux;
+  GstClockTime expected;
+  guint first_pulls, second_pulls;
+
+  psdemux = setup_psdemux ();
+  expected = gst_util_uint64_scale (pack_scr (TARGET_PACK), GST_SECOND,
+      CLOCK_FREQ);
+
+  first_pulls = seek_to_scr (pack_scr (TARGET_PACK));
+  fail_unless_equals_uint64 (first_pts, expected);
+
+  /* The packs found by the first seek are indexed, so the second one
+   * starts right next to the target */
+  second_pulls = seek_to_scr (pack_scr (TARGET_PACK));
+  fail_unless_equals_uint64 (first_pts, expected);
+
+  GST_INFO ("%u pulls for the first seek, %u for the second", first_pulls,
+      second_pulls);
+  fail_unless (second_pulls < first_pulls);
+
+  cleanup_psdemux (psdemux);
+}
+
+GST_END_TEST;
+
+#ifndef GST_DISABLE_GST_DEBUG
+typedef struct
+{
+  guint64 scr;
+  guint64 offset;
+} IndexEntry;
+
+static GArray *indexed;
+
+/* Collects the "indexing SCR" log lines of the demuxer */
+static void
+_index_log_func (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line, GObject * object,
+    GstDebugMessage * message, gpointer user_data)
+{
+  IndexEntry entry;
+
+  if (strcmp (gst_debug_category_get_name (category), "mpegpsdemux") != 0 ||
+      strcmp (function, "gst_ps_demux_index_add") != 0)
+    return;
+
+  fail_unless (sscanf (gst_debug_message_get (message),
+          "indexing SCR %" G_GUINT64_FORMAT " at offset %" G_GUINT64_FORMAT,
+          &entry.scr, &entry.offset) == 2);
+
+  g_mutex_lock (&lock);
+  g_array_append_val (indexed, entry);
+  g_mutex_unlock (&lock);
+}
+
+static gint
+compare_offsets (gconstpointer a, gconstpointer b)
+{
+  const IndexEntry *ea = a, *eb = b;
+
+  return ea->offset < eb->offset ? -1 : (ea->offset > eb->offset ? 1 : 0);
+}
+
+GST_START_TEST (test_pull_index_backward_scr)
+{
+  GstElement *psdemux;
+  guint64 last_scr = 0;
+  gboolean after_backward = FALSE;
+  guint i;
+
+  indexed = g_array_new (FALSE, FALSE, sizeof (IndexEntry));
+  gst_debug_remove_log_function (gst_debug_log_default);
+  gst_debug_add_log_function (_index_log_func, NULL, NULL);
+  gst_debug_set_threshold_for_name ("mpegpsdemux", GST_LEVEL_LOG);
+
+  psdemux = setup_psdemux ();
+
+  /* index every pack of the stream */
+  g_mutex_lock (&lock);
+  stop_after_first = FALSE;
+  g_mutex_unlock (&lock);
+  seek_to_scr (FIRST_SCR);
+
+  gst_debug_unset_threshold_for_name ("mpegpsdemux");
+  gst_debug_remove_log_function (_index_log_func);
+  gst_debug_add_log_function (gst_debug_log_default, NULL, NULL);
+
+  /* The SCRs of the index have to increase with the offset, the pack going
+   * backwards is left out while the following ones are indexed again */
+  g_array_sort (indexed, compare_offsets);
+  for (i = 0; i < indexed->len; i++) {
+    IndexEntry *entry = &g_array_index (indexed, IndexEntry, i);
+
+    fail_unless (entry->scr > last_scr);
+    fail_if (entry->offset == BACKWARD_PACK * PACK_SIZE);
+    if (entry->offset > BACKWARD_PACK * PACK_SIZE)
+      after_backward = TRUE;
+    last_scr = entry->scr;
+  }
+  fail_unless (after_backward);
+
+  cleanup_psdemux (psdemux);
+  g_array_free (indexed, TRUE);
+}
+
+GST_END_TEST;
+#endif
+
+static Suite *
+mpegpsdemux_suite (void)
+{
+  Suite *s = suite_create ("mpegpsdemux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_pull_seek_index);
+#ifndef GST_DISABLE_GST_DEBUG
+  tcase_add_test (tc_chain, test_pull_index_backward_scr);
+#endif
+
+  return s;
+}
+
+GST_CHECK_MAIN (mpegpsdemux);
@@ -22,12 +22,15 @@
 
 #include <gst/check/gstcheck.h>
 #include <string.h>
+#include <glib/gstdio.h>
 #include "mxfdemux.h"
 
 static GstPad *mysrcpad, *mysinkpad;
 static GMainLoop *loop = NULL;
 static gboolean have_eos = FALSE;
 static gboolean have_data = FALSE;
+static guint n_pulls = 0;
+static GstStructure *tag_structure = NULL;
 
 static GstStaticPadTemplate mysrctemplate =
 GST_STATIC_PAD_TEMPLATE ("src", GST_PAD_SRC, GST_PAD_ALWAYS,
@@ -102,6 +105,20 @@ _sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       _sink_check_caps (pad, caps);
       break;
     }
+    case GST_EVENT_TAG:
+    {
+      GstTagList *tags;
+      const GValue *value;
+
+      gst_event_parse_tag (event, &tags);
+      value = gst_tag_list_get_value_index (tags, "mxf-structure", 0);
+      if (value) {
+        if (tag_structure)
+          gst_structure_free (tag_structure);
+        tag_structure = gst_structure_copy (gst_value_get_structure (value));
+      }
+      break;
+    }
     default:
       break;
   }
@@ -137,6 +154,8 @@ _src_getrange (GstPad * pad, GstObject * parent, guint64 offset, guint length,
   if (offset + length > sizeof (mxf_file))
     return GST_FLOW_EOS;
 
+  n_pulls++;
+
   *buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
       (guint8 *) (mxf_file + offset), length, 0, length, NULL, NULL);
 
@@ -184,19 +203,25 @@ _create_src_pad_pull (void)
   return mysrcpad;
 }
 
-GST_START_TEST (test_pull)
+static void
+run_pull (guint read_ahead_size, GstStructure ** structure)
 {
   GstStateChangeReturn sret;
   GstElement *mxfdemux;
   GstPad *sinkpad;
+  GstBus *bus;
 
   have_eos = FALSE;
   have_data = FALSE;
+  n_pulls = 0;
   loop = g_main_loop_new (NULL, FALSE);
 
   mxfdemux = gst_element_factory_make ("mxfdemux", NULL);
   fail_unless (mxfdemux != NULL);
+  g_object_set (mxfdemux, "read-ahead-size", read_ahead_size, NULL);
   g_signal_connect (mxfdemux, "pad-added", G_CALLBACK (_pad_added), NULL);
+  bus = gst_bus_new ();
+  gst_element_set_bus (mxfdemux, bus);
   sinkpad = gst_element_get_static_pad (mxfdemux, "sink");
   fail_unless (sinkpad != NULL);
 
@@ -219,7 +244,32 @@ GST_START_TEST (test_pull)
   fail_unless (have_eos == TRUE);
   fail_unless (have_data == TRUE);
 
+  if (structure) {
+    GstMessage *msg;
+
+    g_object_get (mxfdemux, "structure", structure, NULL);
+
+    /* Descriptive metadata is only parsed when the structure is requested,
+     * the updated tag is then posted */
+    msg = gst_bus_pop_filtered (bus, GST_MESSAGE_TAG);
+    if (msg) {
+      GstTagList *tags;
+      const GValue *value;
+
+      gst_message_parse_tag (msg, &tags);
+      value = gst_tag_list_get_value_index (tags, "mxf-structure", 0);
+      fail_unless (value != NULL);
+      if (tag_structure)
+        gst_structure_free (tag_structure);
+      tag_structure = gst_structure_copy (gst_value_get_structure (value));
+      gst_tag_list_unref (tags);
+      gst_message_unref (msg);
+    }
+  }
+
   gst_element_set_state (mxfdemux, GST_STATE_NULL);
+  gst_element_set_bus (mxfdemux, NULL);
+  gst_object_unref (bus);
   gst_pad_set_active (mysinkpad, FALSE);
   gst_pad_set_active (mysrcpad, FALSE);
 
@@ -230,6 +280,151 @@ GST_START_TEST (test_pull)
   loop = NULL;
 }
 
+GST_START_TEST (test_pull)
+{
+  run_pull (0, NULL);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pull_read_ahead)
+{
+  guint pulls_without;
+
+  run_pull (0, NULL);
+  pulls_without = n_pulls;
+
+  /* the whole file fits into a single window */
+  run_pull (4 * 1024 * 1024, NULL);
+  GST_INFO ("%u pulls without read-ahead, %u with", pulls_without, n_pulls);
+  fail_unless (n_pulls < pulls_without / 2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pull_structure)
+{
+  GstStructure *structure = NULL;
+
+  run_pull (0, &structure);
+
+  /* The tag is built once the references are resolved and posted again
+   * when reading the property parsed the descriptive metadata. The last
+   * tag and the property have to contain the same metadata */
+  fail_unless (tag_structure != NULL);
+  fail_unless (structure != NULL);
+  fail_unless (gst_structure_has_name (tag_structure,
+          gst_structure_get_name (structure)));
+  fail_unless (gst_structure_is_equal (tag_structure, structure));
+
+  gst_structure_free (structure);
+  gst_structure_free (tag_structure);
+  tag_structure = NULL;
+}
+
+GST_END_TEST;
+
+static GstPadProbeReturn
+_seek_buffer_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GstClockTime *first_pts = user_data;
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+
+  if (!GST_CLOCK_TIME_IS_VALID (*first_pts))
+    *first_pts = GST_BUFFER_PTS (buffer);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+seek_and_check (GstElement * pipeline, GstClockTime * first_pts, guint frame)
+{
+  GstClockTime expected = gst_util_uint64_scale (frame, GST_SECOND, 25);
+  gint64 position;
+
+  *first_pts = GST_CLOCK_TIME_NONE;
+  fail_unless (gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE, expected));
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE), GST_STATE_CHANGE_SUCCESS);
+
+  /* The content package offset comes from the index table and the essence
+   * track position is looked up from that offset, so the first buffer has
+   * to be exactly the requested frame */
+  fail_unless_equals_uint64 (*first_pts, expected);
+  fail_unless (gst_element_query_position (pipeline, GST_FORMAT_TIME,
+          &position));
+  fail_unless_equals_uint64 (position, expected);
+}
+
+GST_START_TEST (test_pull_seek_index)
+{
+  GstElement *pipeline, *sink;
+  GstMessage *msg;
+  GstBus *bus;
+  GstPad *pad;
+  GstClockTime first_pts = GST_CLOCK_TIME_NONE;
+  gchar *tmp, *tmpfile, *desc;
+
+  if (!gst_registry_check_feature_version (gst_registry_get (), "mxfmux", 1,
+          0, 0)
+      || !gst_registry_check_feature_version (gst_registry_get (),
+          "videotestsrc", 1, 0, 0))
+    return;
+
+  tmp = g_strdup_printf ("gst-check-mxfdemux-seek-%d.mxf", g_random_int ());
+  tmpfile = g_build_filename (g_get_tmp_dir (), tmp, NULL);
+  g_free (tmp);
+
+  /* Raw video, so every edit unit is a keyframe with an index entry */
+  desc = g_strdup_printf ("videotestsrc num-buffers=50 ! "
+      "video/x-raw,format=(string)v308,width=64,height=48,framerate=25/1 ! "
+      "mxfmux ! filesink location=%s", tmpfile);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  desc = g_strdup_printf ("filesrc location=%s ! mxfdemux ! "
+      "fakesink name=sink", tmpfile);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  pad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER, _seek_buffer_probe,
+      &first_pts, NULL);
+  gst_object_unref (pad);
+  gst_object_unref (sink);
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PAUSED) != GST_STATE_CHANGE_FAILURE);
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE), GST_STATE_CHANGE_SUCCESS);
+  fail_unless_equals_uint64 (first_pts, 0);
+
+  /* Forward, then backward into the part already read */
+  seek_and_check (pipeline, &first_pts, 37);
+  seek_and_check (pipeline, &first_pts, 12);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  g_unlink (tmpfile);
+  g_free (tmpfile);
+}
+
 GST_END_TEST;
 
 GST_START_TEST (test_push)
@@ -301,6 +496,9 @@ mxfdemux_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_set_timeout (tc_chain, 180);
   tcase_add_test (tc_chain, test_pull);
+  tcase_add_test (tc_chain, test_pull_read_ahead);
+  tcase_add_test (tc_chain, test_pull_structure);
+  tcase_add_test (tc_chain, test_pull_seek_index);
   tcase_add_test (tc_chain, test_push);
 
   return s;
@@ -22,6 +22,7 @@
 
 #include <gst/check/gstcheck.h>
 #include <string.h>
+#include <glib/gstdio.h>
 
 static const gchar *
 get_mpeg2enc_element_name (void)
@@ -142,6 +143,151 @@ GST_START_TEST (test_raw_video_raw_audio)
 
 GST_END_TEST;
 
+static const guint8 partition_pack_key[] = {
+  0x06, 0x0e, 0x2b, 0x34, 0x02, 0x05, 0x01, 0x01,
+  0x0d, 0x01, 0x02, 0x01, 0x01
+};
+
+static const guint8 random_index_pack_key[] = {
+  0x06, 0x0e, 0x2b, 0x34, 0x02, 0x05, 0x01, 0x01,
+  0x0d, 0x01, 0x02, 0x01, 0x01, 0x11, 0x01, 0x00
+};
+
+/* Returns the offset of the value of the KLV packet at offset and stores
+ * its length, or 0 if there is no complete packet */
+static gsize
+read_klv (const guint8 * data, gsize size, gsize offset, guint64 * length)
+{
+  guint i, n;
+
+  if (offset + 17 > size)
+    return 0;
+
+  offset += 16;
+  if (data[offset] < 0x80) {
+    *length = data[offset];
+    offset++;
+  } else {
+    n = data[offset] & 0x7f;
+    offset++;
+    if (n == 0 || n > 8 || offset + n > size)
+      return 0;
+    *length = 0;
+    for (i = 0; i < n; i++)
+      *length = (*length << 8) | data[offset++];
+  }
+
+  if (*length > size - offset)
+    return 0;
+
+  return offset;
+}
+
+GST_START_TEST (test_raw_video_raw_audio_partitions)
+{
+  gchar *pipeline;
+  gchar *tmp, *tmpfile;
+  guint8 *data;
+  gsize size, offset, value_offset;
+  guint64 length;
+  GArray *body_partitions;
+  guint n_header = 0, n_footer = 0, n_entries, i;
+  gsize rip_offset = 0, footer_offset = 0;
+
+  tmp = g_strdup_printf ("gst-check-mxfmux-partitions-%d.mxf",
+      g_random_int ());
+  tmpfile = g_build_filename (g_get_tmp_dir (), tmp, NULL);
+  g_free (tmp);
+
+  pipeline = g_strdup_printf ("videotestsrc num-buffers=250 ! "
+      "video/x-raw,format=(string)v308,width=1920,height=1080,framerate=25/1 ! "
+      "mxfmux name=mux partition-interval=2000000000 ! "
+      "filesink location=%s  "
+      "audiotestsrc num-buffers=250 ! "
+      "audioconvert ! " "audio/x-raw,rate=48000,channels=2 ! " "mux. ",
+      tmpfile);
+
+  run_test (pipeline);
+  g_free (pipeline);
+
+  fail_unless (g_file_get_contents (tmpfile, (gchar **) & data, &size, NULL));
+
+  /* Walk all KLV packets and collect the partition packs */
+  body_partitions = g_array_new (FALSE, FALSE, sizeof (gsize));
+  offset = 0;
+  while (offset < size) {
+    value_offset = read_klv (data, size, offset, &length);
+    fail_unless (value_offset != 0, "Invalid KLV packet at offset %"
+        G_GSIZE_FORMAT, offset);
+
+    if (memcmp (data + offset, partition_pack_key,
+            sizeof (partition_pack_key)) == 0) {
+      switch (data[offset + 13]) {
+        case 0x02:
+          fail_unless_equals_int (offset, 0);
+          n_header++;
+          break;
+        case 0x03:
+          g_array_append_val (body_partitions, offset);
+          break;
+        case 0x04:
+          footer_offset = offset;
+          n_footer++;
+          break;
+        default:
+          break;
+      }
+    } else if (memcmp (data + offset, random_index_pack_key,
+            sizeof (random_index_pack_key)) == 0) {
+      rip_offset = offset;
+    }
+
+    offset = value_offset + length;
+  }
+
+  fail_unless_equals_int (n_header, 1);
+  fail_unless_equals_int (n_footer, 1);
+  /* 10 seconds of content with a partition every 2 seconds */
+  fail_unless (body_partitions->len >= 4);
+
+  /* The random index pack is the last packet and lists the header, every
+   * body partition and the footer */
+  fail_unless (rip_offset > footer_offset);
+  value_offset = read_klv (data, size, rip_offset, &length);
+  fail_unless_equals_uint64 (value_offset + length, size);
+  fail_unless_equals_int (GST_READ_UINT32_BE (data + size - 4),
+      size - rip_offset);
+  fail_unless_equals_int ((length - 4) % 12, 0);
+  n_entries = (length - 4) / 12;
+  fail_unless_equals_int (n_entries, body_partitions->len + 2);
+
+  fail_unless_equals_uint64 (GST_READ_UINT64_BE (data + value_offset + 4), 0);
+  for (i = 0; i < body_partitions->len; i++) {
+    const guint8 *entry = data + value_offset + (i + 1) * 12;
+
+    fail_unless (GST_READ_UINT32_BE (entry) != 0);
+    fail_unless_equals_uint64 (GST_READ_UINT64_BE (entry + 4),
+        g_array_index (body_partitions, gsize, i));
+  }
+  fail_unless_equals_uint64 (GST_READ_UINT64_BE (data + value_offset +
+          (n_entries - 1) * 12 + 4), footer_offset);
+
+  g_array_free (body_partitions, TRUE);
+  g_free (data);
+
+  /* And check that the file can be demuxed again */
+  pipeline = g_strdup_printf ("filesrc location=%s ! mxfdemux name=demux "
+      "demux. ! queue ! fakesink  demux. ! queue ! fakesink", tmpfile);
+
+  run_test (pipeline);
+  g_free (pipeline);
+
+  g_unlink (tmpfile);
+  g_free (tmpfile);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_raw_video_stride_transform)
 {
   gchar *pipeline;
@@ -276,6 +422,7 @@ mxfmux_suite (void)
 
   tcase_add_test (tc_chain, test_mpeg2);
   tcase_add_test (tc_chain, test_raw_video_raw_audio);
+  tcase_add_test (tc_chain, test_raw_video_raw_audio_partitions);
   tcase_add_test (tc_chain, test_raw_video_stride_transform);
   tcase_add_test (tc_chain, test_jpeg2000_alaw);
   tcase_add_test (tc_chain, test_dnxhd_mp3);
@@ -1,6 +1,8 @@
 #include <gst/check/gstharness.h>
 #include <gst/check/gstcheck.h>
 
+#include <string.h>
+
 GST_START_TEST (netsim_stress)
 {
   GstHarness *h = gst_harness_new ("netsim");
@@ -49,6 +51,116 @@ GST_START_TEST (netsim_stress_delayed)
 
 GST_END_TEST;
 
+static GArray *
+run_seeded (const gchar * launch)
+{
+  GstHarness *h = gst_harness_new_parse (launch);
+  GArray *passed = g_array_new (FALSE, FALSE, sizeof (guint64));
+  GstBuffer *buf;
+  guint64 i;
+
+  gst_harness_set_src_caps_str (h, "mycaps");
+
+  for (i = 0; i < 200; i++) {
+    buf = gst_harness_create_buffer (h, 100);
+    GST_BUFFER_OFFSET (buf) = i;
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h, buf));
+  }
+
+  while ((buf = gst_harness_try_pull (h))) {
+    g_array_append_val (passed, GST_BUFFER_OFFSET (buf));
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (h);
+
+  return passed;
+}
+
+GST_START_TEST (netsim_seed_is_reproducible)
+{
+  const gchar *launch = "netsim seed=1234 drop-probability=0.1 "
+      "duplicate-probability=0.1 burst-enter-probability=0.05 "
+      "burst-exit-probability=0.3";
+  GArray *first, *second;
+
+  first = run_seeded (launch);
+  second = run_seeded (launch);
+
+  /* something was dropped, but not everything */
+  fail_unless (first->len > 0);
+  fail_unless (first->len != 200);
+
+  fail_unless_equals_int (first->len, second->len);
+  fail_unless (memcmp (first->data, second->data,
+          first->len * sizeof (guint64)) == 0);
+
+  g_array_free (first, TRUE);
+  g_array_free (second, TRUE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (netsim_burst_loss)
+{
+  GArray *passed;
+  guint i, gaps = 0, lost = 0;
+  guint64 expected = 0;
+
+  /* no loss in the good state and full loss in the bad one, so every loss
+   * event is a burst with a mean length of 1 / 0.25 packets */
+  passed = run_seeded ("netsim seed=42 burst-enter-probability=0.05 "
+      "burst-exit-probability=0.25");
+
+  for (i = 0; i < passed->len; i++) {
+    guint64 offset = g_array_index (passed, guint64, i);
+
+    if (offset != expected) {
+      gaps++;
+      lost += offset - expected;
+    }
+    expected = offset + 1;
+  }
+
+  fail_unless (gaps > 0);
+  fail_unless (lost > gaps);
+
+  g_array_free (passed, TRUE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (netsim_link_queue)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  guint i, received = 0;
+
+  /* 1000 bytes at 80 kbps take 100ms to send, with room for 250ms of
+   * queueing only the first three buffers of a burst make it through */
+  h = gst_harness_new_parse ("netsim max-kbps=80 max-queue-delay=250");
+  gst_harness_set_src_caps_str (h, "mycaps");
+
+  for (i = 0; i < 10; i++)
+    fail_unless_equals_int (GST_FLOW_OK,
+        gst_harness_push (h, gst_harness_create_buffer (h, 1000)));
+
+  for (i = 0; i < 3; i++) {
+    buf = gst_harness_pull (h);
+    fail_unless (buf != NULL);
+    gst_buffer_unref (buf);
+    received++;
+  }
+
+  g_usleep (G_USEC_PER_SEC / 2);
+  fail_unless (gst_harness_try_pull (h) == NULL);
+  fail_unless_equals_int (received, 3);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 netsim_suite (void)
 {
@@ -58,6 +170,9 @@ netsim_suite (void)
   suite_add_tcase (s, (tc_chain = tcase_create ("general")));
   tcase_add_test (tc_chain, netsim_stress);
   tcase_add_test (tc_chain, netsim_stress_delayed);
+  tcase_add_test (tc_chain, netsim_seed_is_reproducible);
+  tcase_add_test (tc_chain, netsim_burst_loss);
+  tcase_add_test (tc_chain, netsim_link_queue);
 
   return s;
 }
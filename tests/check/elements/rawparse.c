@@ -0,0 +1,200 @@
+/* GStreamer
+ *
+ * unit test for videoparse and audioparse
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <glib/gstdio.h>
+
+#define VIDEO_WIDTH 16
+#define VIDEO_HEIGHT 16
+#define VIDEO_FRAME_SIZE (VIDEO_WIDTH * VIDEO_HEIGHT)
+#define VIDEO_FRAMES 10
+#define VIDEO_FPS 25
+
+#define AUDIO_RATE 8000
+#define AUDIO_SAMPLES 8000
+
+/* Keeps the first buffer after the last flush */
+static GstPadProbeReturn
+_first_buffer_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GstBuffer **first = user_data;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    if (*first == NULL)
+      *first = gst_buffer_ref (GST_PAD_PROBE_INFO_BUFFER (info));
+  } else if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) ==
+      GST_EVENT_FLUSH_STOP) {
+    gst_buffer_replace (first, NULL);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+/*
+ * Writes @data to a file, plays it through filesrc ! @parse ! fakesink,
+ * which makes the parser work in pull mode, and checks the duration and
+ * seeking queries in GST_FORMAT_DEFAULT. Then seeks to @target in
+ * GST_FORMAT_DEFAULT and returns the first buffer prerolled afterwards.
+ */
+static GstBuffer *
+seek_in_default_format (GstElement * parse, const guint8 * data, gsize size,
+    gint64 total, gint64 target)
+{
+  GstElement *pipeline, *src, *sink;
+  GstBuffer *first = NULL, *buffer;
+  GstQuery *query;
+  GstFormat format;
+  gboolean seekable;
+  gint64 duration, start, stop;
+  gchar *tmp, *tmpfile;
+  GstPad *pad;
+
+  tmp = g_strdup_printf ("gst-check-rawparse-%d.raw", g_random_int ());
+  tmpfile = g_build_filename (g_get_tmp_dir (), tmp, NULL);
+  g_free (tmp);
+  fail_unless (g_file_set_contents (tmpfile, (const gchar *) data, size,
+          NULL));
+
+  pipeline = gst_pipeline_new (NULL);
+  src = gst_element_factory_make ("filesrc", NULL);
+  fail_unless (src != NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  fail_unless (sink != NULL);
+  g_object_set (src, "location", tmpfile, NULL);
+  gst_bin_add_many (GST_BIN (pipeline), src, parse, sink, NULL);
+  fail_unless (gst_element_link_many (src, parse, sink, NULL));
+
+  pad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_add_probe (pad,
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_FLUSH,
+      _first_buffer_probe, &first, NULL);
+  gst_object_unref (pad);
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PAUSED) != GST_STATE_CHANGE_FAILURE);
+  fail_unless (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_SUCCESS);
+
+  fail_unless (gst_element_query_duration (pipeline, GST_FORMAT_DEFAULT,
+          &duration));
+  fail_unless_equals_int64 (duration, total);
+
+  query = gst_query_new_seeking (GST_FORMAT_DEFAULT);
+  fail_unless (gst_element_query (pipeline, query));
+  gst_query_parse_seeking (query, &format, &seekable, &start, &stop);
+  fail_unless_equals_int (format, GST_FORMAT_DEFAULT);
+  fail_unless (seekable);
+  fail_unless_equals_int64 (start, 0);
+  fail_unless_equals_int64 (stop, total);
+  gst_query_unref (query);
+
+  fail_unless (gst_element_seek (pipeline, 1.0, GST_FORMAT_DEFAULT,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE, GST_SEEK_TYPE_SET,
+          target, GST_SEEK_TYPE_NONE, -1));
+  fail_unless (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_SUCCESS);
+
+  fail_unless (first != NULL);
+  buffer = gst_buffer_ref (first);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+  gst_buffer_replace (&first, NULL);
+
+  g_unlink (tmpfile);
+  g_free (tmpfile);
+
+  return buffer;
+}
+
+GST_START_TEST (test_videoparse_seek_frames)
+{
+  guint8 data[VIDEO_FRAMES * VIDEO_FRAME_SIZE];
+  GstElement *parse;
+  GstBuffer *buffer;
+  guint8 first_byte;
+  guint i;
+
+  /* every byte of a frame is its frame number */
+  for (i = 0; i < VIDEO_FRAMES; i++)
+    memset (data + i * VIDEO_FRAME_SIZE, i, VIDEO_FRAME_SIZE);
+
+  parse = gst_element_factory_make ("videoparse", NULL);
+  fail_unless (parse != NULL);
+  gst_util_set_object_arg (G_OBJECT (parse), "format", "gray8");
+  g_object_set (parse, "width", VIDEO_WIDTH, "height", VIDEO_HEIGHT,
+      "framerate", VIDEO_FPS, 1, NULL);
+
+  buffer = seek_in_default_format (parse, data, sizeof (data), VIDEO_FRAMES,
+      7);
+
+  fail_unless_equals_int (gst_buffer_get_size (buffer), VIDEO_FRAME_SIZE);
+  fail_unless_equals_int (gst_buffer_extract (buffer, 0, &first_byte, 1), 1);
+  fail_unless_equals_int (first_byte, 7);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), 7 * GST_SECOND /
+      VIDEO_FPS);
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_audioparse_seek_samples)
+{
+  guint8 data[AUDIO_SAMPLES * 2];
+  GstElement *parse;
+  GstBuffer *buffer;
+  guint8 first_sample[2];
+  guint i;
+
+  /* every sample is its sample number */
+  for (i = 0; i < AUDIO_SAMPLES; i++)
+    GST_WRITE_UINT16_LE (data + i * 2, i);
+
+  parse = gst_element_factory_make ("audioparse", NULL);
+  fail_unless (parse != NULL);
+  gst_util_set_object_arg (G_OBJECT (parse), "raw-format", "s16le");
+  g_object_set (parse, "rate", AUDIO_RATE, "channels", 1, NULL);
+
+  buffer = seek_in_default_format (parse, data, sizeof (data), AUDIO_SAMPLES,
+      4000);
+
+  fail_unless_equals_int (gst_buffer_extract (buffer, 0, first_sample, 2), 2);
+  fail_unless_equals_int (GST_READ_UINT16_LE (first_sample), 4000);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), 4000 * GST_SECOND /
+      AUDIO_RATE);
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+static Suite *
+rawparse_suite (void)
+{
+  Suite *s = suite_create ("rawparse");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_videoparse_seek_frames);
+  tcase_add_test (tc_chain, test_audioparse_seek_samples);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rawparse);
@@ -42,7 +42,7 @@ GstElement *src, *sink;
 GstPad *sinkpad, *srcpad;
 
 static void
-setup_shm (void)
+setup_shm_full (gboolean use_ring, gboolean use_fds)
 {
   gchar *socket_path = NULL;
 
@@ -52,14 +52,16 @@ setup_shm (void)
   srcpad = gst_check_setup_src_pad (sink, &src_template);
   sinkpad = gst_check_setup_sink_pad (src, &sink_template);
 
-  g_object_set (sink, "socket-path", "shm-unit-test", NULL);
+  g_object_set (sink, "socket-path", "shm-unit-test", "use-memfd", use_fds,
+      NULL);
 
   fail_unless (gst_element_set_state (sink, GST_STATE_PLAYING) ==
       GST_STATE_CHANGE_ASYNC);
 
   g_object_get (sink, "socket-path", &socket_path, NULL);
   fail_unless (socket_path != NULL);
-  g_object_set (src, "socket-path", socket_path, NULL);
+  g_object_set (src, "socket-path", socket_path, "use-ring", use_ring,
+      "use-fd-passing", use_fds, NULL);
   g_free (socket_path);
 
   gst_pad_set_active (srcpad, TRUE);
@@ -69,6 +71,26 @@ setup_shm (void)
       GST_STATE_CHANGE_SUCCESS);
 }
 
+static void
+setup_shm (void)
+{
+  setup_shm_full (FALSE, FALSE);
+}
+
+static void
+setup_shm_ring (void)
+{
+  setup_shm_full (TRUE, FALSE);
+}
+
+#ifdef HAVE_MEMFD_CREATE
+static void
+setup_shm_fds (void)
+{
+  setup_shm_full (TRUE, TRUE);
+}
+#endif
+
 static void
 teardown_shm (void)
 {
@@ -169,6 +191,167 @@ GST_START_TEST (test_shm_alloc)
 
 GST_END_TEST;
 
+#define NUM_RING_BUFFERS 600
+
+GST_START_TEST (test_shm_ring_order)
+{
+  GstBuffer *buf;
+  GstSegment segment;
+  GList *l;
+  guint32 i;
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  /* More buffers than fit in the ring, so that some may go through the
+   * socket if the reader falls behind, the order must be kept anyway */
+  for (i = 0; i < NUM_RING_BUFFERS; i++) {
+    buf = gst_buffer_new_allocate (NULL, sizeof (guint32), NULL);
+    gst_buffer_fill (buf, 0, &i, sizeof (guint32));
+    fail_unless (gst_pad_push (srcpad, buf) == GST_FLOW_OK);
+  }
+
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < NUM_RING_BUFFERS)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+
+  for (i = 0, l = buffers; l; i++, l = l->next) {
+    guint32 val;
+
+    fail_unless (gst_buffer_get_size (l->data) == sizeof (guint32));
+    gst_buffer_extract (l->data, 0, &val, sizeof (guint32));
+    fail_unless_equals_int (val, i);
+  }
+
+  gst_check_drop_buffers ();
+  teardown_shm ();
+}
+
+GST_END_TEST;
+
+#define NUM_GROW_BUFFERS 64
+
+GST_START_TEST (test_shm_ring_grow)
+{
+  GstBuffer *buf;
+  GstSegment segment;
+  GList *l;
+  guint32 i;
+
+  /* Start small so that the area gets replaced a few times while buffers
+   * are queued in the ring */
+  g_object_set (sink, "shm-size", 4096, "max-shm-size", 4 * 1024 * 1024,
+      NULL);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  for (i = 0; i < NUM_GROW_BUFFERS; i++) {
+    gsize size = 1024 * (i + 1);
+
+    buf = gst_buffer_new_allocate (NULL, size, NULL);
+    gst_buffer_memset (buf, 0, i & 0xff, size);
+    gst_buffer_fill (buf, 0, &i, sizeof (guint32));
+    fail_unless (gst_pad_push (srcpad, buf) == GST_FLOW_OK);
+  }
+
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < NUM_GROW_BUFFERS)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+
+  for (i = 0, l = buffers; l; i++, l = l->next) {
+    gsize size = gst_buffer_get_size (l->data);
+    guint32 val;
+    guint8 last;
+
+    fail_unless_equals_int (size, 1024 * (i + 1));
+    gst_buffer_extract (l->data, 0, &val, sizeof (guint32));
+    fail_unless_equals_int (val, i);
+    gst_buffer_extract (l->data, size - 1, &last, 1);
+    fail_unless_equals_int (last, i & 0xff);
+  }
+
+  gst_check_drop_buffers ();
+  teardown_shm ();
+}
+
+GST_END_TEST;
+
+#ifdef HAVE_MEMFD_CREATE
+GST_START_TEST (test_shm_fd_passing)
+{
+  GstBuffer *buf;
+  GstQuery *query;
+  GstCaps *caps = gst_caps_new_empty_simple ("application/x-test");
+  GstAllocator *alloc;
+  GstAllocationParams params;
+  GstMemory *mem;
+  GstSegment segment;
+  guint i, attempts;
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (srcpad, gst_event_new_caps (caps));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  query = gst_query_new_allocation (caps, FALSE);
+  gst_caps_unref (caps);
+
+  fail_unless (gst_pad_peer_query (srcpad, query));
+  fail_unless (gst_query_get_n_allocation_params (query) == 2);
+
+  /* the memfd allocator comes first */
+  gst_query_parse_nth_allocation_param (query, 0, &alloc, &params);
+  fail_unless (alloc != NULL);
+  gst_query_unref (query);
+
+  buf = gst_buffer_new_allocate (alloc, 8192, &params);
+  gst_object_unref (alloc);
+  for (i = 0; i < 8192; i++)
+    gst_buffer_memset (buf, i, i & 0xff, 1);
+
+  /* shmsink may not have seen the fd passing request yet, in which case
+   * the buffer is copied into the shm area */
+  for (attempts = 0; attempts < 100; attempts++) {
+    fail_unless (gst_pad_push (srcpad, gst_buffer_ref (buf)) == GST_FLOW_OK);
+
+    g_mutex_lock (&check_mutex);
+    while (buffers == NULL)
+      g_cond_wait (&check_cond, &check_mutex);
+    g_mutex_unlock (&check_mutex);
+
+    mem = gst_buffer_peek_memory (buffers->data, 0);
+    if (gst_memory_is_type (mem, "fd"))
+      break;
+
+    gst_check_drop_buffers ();
+    g_usleep (G_USEC_PER_SEC / 100);
+  }
+
+  gst_buffer_unref (buf);
+
+  fail_unless (attempts < 100);
+  fail_unless (g_list_length (buffers) == 1);
+  buf = buffers->data;
+  fail_unless (gst_buffer_get_size (buf) == 8192);
+  for (i = 0; i < 8192; i += 1000) {
+    guint8 val;
+
+    gst_buffer_extract (buf, i, &val, 1);
+    fail_unless_equals_int (val, i & 0xff);
+  }
+
+  gst_check_drop_buffers ();
+  teardown_shm ();
+}
+
+GST_END_TEST;
+#endif
+
 static Suite *
 shm_suite (void)
 {
@@ -181,6 +364,20 @@ shm_suite (void)
   tcase_add_test (tc, test_shm_alloc);
   suite_add_tcase (s, tc);
 
+  tc = tcase_create ("shm-ring");
+  tcase_add_checked_fixture (tc, setup_shm_ring, NULL);
+  tcase_add_test (tc, test_shm_sysmem_alloc);
+  tcase_add_test (tc, test_shm_ring_order);
+  tcase_add_test (tc, test_shm_ring_grow);
+  suite_add_tcase (s, tc);
+
+#ifdef HAVE_MEMFD_CREATE
+  tc = tcase_create ("shm-fds");
+  tcase_add_checked_fixture (tc, setup_shm_fds, NULL);
+  tcase_add_test (tc, test_shm_fd_passing);
+  suite_add_tcase (s, tc);
+#endif
+
   return s;
 }
 
@@ -207,6 +207,193 @@ GST_START_TEST (test_roc)
 
 GST_END_TEST;
 
+#define TEST_SSRC 1356955624
+#define TEST_KEY "012345678901234567890123456789012345678901234567890123456789"
+#define TEST_PAYLOAD_SIZE 160
+/* bigger than any SRTP trailer */
+#define TEST_PADDING 256
+
+static GstBuffer *
+create_rtp_buffer (guint16 seqnum, gsize padding)
+{
+  GstAllocationParams params;
+  GstBuffer *buf;
+  GstMapInfo map;
+  guint i;
+
+  gst_allocation_params_init (&params);
+  params.padding = padding;
+  buf = gst_buffer_new_allocate (NULL, 12 + TEST_PAYLOAD_SIZE, &params);
+
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  map.data[0] = 0x80;
+  map.data[1] = 8;
+  GST_WRITE_UINT16_BE (map.data + 2, seqnum);
+  GST_WRITE_UINT32_BE (map.data + 4, seqnum * TEST_PAYLOAD_SIZE);
+  GST_WRITE_UINT32_BE (map.data + 8, TEST_SSRC);
+  for (i = 0; i < TEST_PAYLOAD_SIZE; i++)
+    map.data[12 + i] = (seqnum + i) & 0xff;
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static GstHarness *
+create_enc_harness (void)
+{
+  GstHarness *h;
+
+  h = gst_harness_new_with_padnames ("srtpenc", "rtp_sink_0", "rtp_src_0");
+  gst_util_set_object_arg (G_OBJECT (h->element), "key", TEST_KEY);
+  gst_harness_set_src_caps_str (h,
+      "application/x-rtp, payload=(int)8, ssrc=(uint)1356955624");
+
+  return h;
+}
+
+static GstHarness *
+create_dec_harness (void)
+{
+  GstHarness *h;
+
+  h = gst_harness_new_with_padnames ("srtpdec", "rtp_sink", "rtp_src");
+  gst_harness_set_src_caps_str (h,
+      "application/x-srtp, payload=(int)8, ssrc=(uint)1356955624, "
+      "srtp-key=(buffer)" TEST_KEY ", srtp-cipher=(string)aes-128-icm, "
+      "srtp-auth=(string)hmac-sha1-80, srtcp-cipher=(string)aes-128-icm, "
+      "srtcp-auth=(string)hmac-sha1-80");
+
+  return h;
+}
+
+GST_START_TEST (test_protect_in_place)
+{
+  GstHarness *h = create_enc_harness ();
+  GstBuffer *buf;
+  gsize offset, maxsize, size;
+
+  /* room for the trailer after the packet, so it is protected in place */
+  fail_unless_equals_int (gst_harness_push (h, create_rtp_buffer (0,
+              TEST_PADDING)), GST_FLOW_OK);
+  buf = gst_harness_pull (h);
+  size = gst_buffer_get_sizes (buf, &offset, &maxsize);
+  fail_unless (size > 12 + TEST_PAYLOAD_SIZE);
+  fail_unless_equals_int (offset + maxsize, 12 + TEST_PAYLOAD_SIZE +
+      TEST_PADDING);
+  gst_buffer_unref (buf);
+
+  /* no room, gets copied */
+  fail_unless_equals_int (gst_harness_push (h, create_rtp_buffer (1, 0)),
+      GST_FLOW_OK);
+  buf = gst_harness_pull (h);
+  size = gst_buffer_get_sizes (buf, &offset, &maxsize);
+  fail_unless (size > 12 + TEST_PAYLOAD_SIZE);
+  fail_unless (offset + maxsize != 12 + TEST_PAYLOAD_SIZE);
+  gst_buffer_unref (buf);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static GstBufferList *
+pull_list (GstHarness * h, guint n)
+{
+  GstBufferList *list = gst_buffer_list_new_sized (n);
+  guint i;
+
+  for (i = 0; i < n; i++)
+    gst_buffer_list_add (list, gst_harness_pull (h));
+
+  return list;
+}
+
+GST_START_TEST (test_list_roundtrip)
+{
+  GstHarness *enc = create_enc_harness ();
+  GstHarness *dec = create_dec_harness ();
+  GstBufferList *list;
+  guint i;
+
+  /* mixed buffers with and without room for the trailer */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 16; i++)
+    gst_buffer_list_add (list, create_rtp_buffer (i, i % 2 ? TEST_PADDING : 0));
+  fail_unless_equals_int (gst_pad_push_list (enc->srcpad, list), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (enc), 16);
+
+  fail_unless_equals_int (gst_pad_push_list (dec->srcpad, pull_list (enc, 16)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (dec), 16);
+
+  for (i = 0; i < 16; i++) {
+    GstBuffer *expected = create_rtp_buffer (i, 0);
+    GstBuffer *buf = gst_harness_pull (dec);
+    GstMapInfo map;
+
+    gst_buffer_map (expected, &map, GST_MAP_READ);
+    fail_unless_equals_int (gst_buffer_get_size (buf), map.size);
+    fail_unless (gst_buffer_memcmp (buf, 0, map.data, map.size) == 0);
+    gst_buffer_unmap (expected, &map);
+
+    gst_buffer_unref (expected);
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (enc);
+  gst_harness_teardown (dec);
+}
+
+GST_END_TEST;
+
+#define BENCHMARK_PACKETS 65536
+#define BENCHMARK_LIST_SIZE 64
+
+GST_START_TEST (test_benchmark_lists)
+{
+  GstHarness *enc = create_enc_harness ();
+  GstHarness *dec = create_dec_harness ();
+  GstBufferList *lists[BENCHMARK_PACKETS / BENCHMARK_LIST_SIZE];
+  gint64 enc_time = 0, dec_time = 0, start;
+  guint i, j, n_lists = G_N_ELEMENTS (lists);
+
+  for (i = 0; i < n_lists; i++) {
+    lists[i] = gst_buffer_list_new_sized (BENCHMARK_LIST_SIZE);
+    for (j = 0; j < BENCHMARK_LIST_SIZE; j++)
+      gst_buffer_list_add (lists[i],
+          create_rtp_buffer (i * BENCHMARK_LIST_SIZE + j, TEST_PADDING));
+  }
+
+  for (i = 0; i < n_lists; i++) {
+    start = g_get_monotonic_time ();
+    fail_unless_equals_int (gst_pad_push_list (enc->srcpad, lists[i]),
+        GST_FLOW_OK);
+    enc_time += g_get_monotonic_time () - start;
+    lists[i] = pull_list (enc, BENCHMARK_LIST_SIZE);
+  }
+
+  for (i = 0; i < n_lists; i++) {
+    start = g_get_monotonic_time ();
+    fail_unless_equals_int (gst_pad_push_list (dec->srcpad, lists[i]),
+        GST_FLOW_OK);
+    dec_time += g_get_monotonic_time () - start;
+    for (j = 0; j < BENCHMARK_LIST_SIZE; j++)
+      gst_buffer_unref (gst_harness_pull (dec));
+  }
+
+  GST_INFO ("srtpenc: %d packets in %" G_GINT64_FORMAT " us, %.0f packets/s",
+      BENCHMARK_PACKETS, enc_time,
+      BENCHMARK_PACKETS * (gdouble) G_USEC_PER_SEC / MAX (enc_time, 1));
+  GST_INFO ("srtpdec: %d packets in %" G_GINT64_FORMAT " us, %.0f packets/s",
+      BENCHMARK_PACKETS, dec_time,
+      BENCHMARK_PACKETS * (gdouble) G_USEC_PER_SEC / MAX (dec_time, 1));
+
+  gst_harness_teardown (enc);
+  gst_harness_teardown (dec);
+}
+
+GST_END_TEST;
+
 static Suite *
 srtp_suite (void)
 {
@@ -218,6 +405,9 @@ srtp_suite (void)
   tcase_add_test (tc_chain, test_create_and_unref);
   tcase_add_test (tc_chain, test_play);
   tcase_add_test (tc_chain, test_roc);
+  tcase_add_test (tc_chain, test_protect_in_place);
+  tcase_add_test (tc_chain, test_list_roundtrip);
+  tcase_add_test (tc_chain, test_benchmark_lists);
 
   return s;
 }
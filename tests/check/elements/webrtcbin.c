@@ -1342,17 +1342,128 @@ GST_START_TEST (test_recvonly_sendonly)
 
 GST_END_TEST;
 
+static void
+on_sdp_bundle (struct test_webrtc *t, GstElement * element,
+    GstWebRTCSessionDescription * desc, gpointer user_data)
+{
+  const gchar *group = NULL, *ufrag = NULL;
+  gchar **mids;
+  int i;
+
+  for (i = 0; i < gst_sdp_message_attributes_len (desc->sdp); i++) {
+    const GstSDPAttribute *attr = gst_sdp_message_get_attribute (desc->sdp, i);
+
+    if (g_strcmp0 (attr->key, "group") == 0) {
+      fail_unless (group == NULL, "multiple groups");
+      group = attr->value;
+    }
+  }
+  fail_unless (group != NULL, "no group attribute");
+  fail_unless (g_str_has_prefix (group, "BUNDLE "));
+
+  mids = g_strsplit (&group[7], " ", -1);
+  fail_unless_equals_int (g_strv_length (mids),
+      gst_sdp_message_medias_len (desc->sdp));
+
+  for (i = 0; i < gst_sdp_message_medias_len (desc->sdp); i++) {
+    const GstSDPMedia *media = gst_sdp_message_get_media (desc->sdp, i);
+    const gchar *media_ufrag;
+
+    /* the m-lines are listed in order and all share one ICE transport
+     * with rtcp-mux */
+    fail_unless_equals_string (gst_sdp_media_get_attribute_val (media, "mid"),
+        mids[i]);
+    fail_unless (gst_sdp_media_get_attribute_val (media, "rtcp-mux") != NULL);
+    media_ufrag = gst_sdp_media_get_attribute_val (media, "ice-ufrag");
+    fail_unless (media_ufrag != NULL);
+    if (ufrag)
+      fail_unless_equals_string (ufrag, media_ufrag);
+    ufrag = media_ufrag;
+  }
+
+  g_strfreev (mids);
+}
+
+GST_START_TEST (test_bundle_audio_video_max_bundle)
+{
+  struct test_webrtc *t = test_webrtc_new ();
+  struct validate_sdp offer = { on_sdp_bundle, NULL };
+  struct validate_sdp answer = { on_sdp_bundle, NULL };
+  GstHarness *h;
+
+  /* check that with bundling both media are offered and answered in a single
+   * BUNDLE group sharing the ICE credentials */
+
+  gst_util_set_object_arg (G_OBJECT (t->webrtc1), "bundle-policy",
+      "max-bundle");
+  gst_util_set_object_arg (G_OBJECT (t->webrtc2), "bundle-policy",
+      "max-bundle");
+
+  t->on_negotiation_needed = NULL;
+  t->on_pad_added = _pad_added_fakesink;
+  t->offer_data = &offer;
+  t->on_offer_created = validate_sdp;
+  t->answer_data = &answer;
+  t->on_answer_created = validate_sdp;
+  t->on_ice_candidate = NULL;
+
+  h = gst_harness_new_with_element (t->webrtc1, "sink_0", NULL);
+  add_fake_audio_src_harness (h, 96);
+  t->harnesses = g_list_prepend (t->harnesses, h);
+
+  h = gst_harness_new_with_element (t->webrtc1, "sink_1", NULL);
+  add_fake_video_src_harness (h, 97);
+  t->harnesses = g_list_prepend (t->harnesses, h);
+
+  test_webrtc_create_offer (t, t->webrtc1);
+
+  test_webrtc_wait_for_answer_error_eos (t);
+  fail_unless_equals_int (STATE_ANSWER_CREATED, t->state);
+  test_webrtc_free (t);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_worker_pool)
+{
+  struct test_webrtc *t = create_audio_test ();
+  guint pool_size;
+
+  /* check that two peers running their operations on the shared worker pool
+   * complete an offer/answer exchange */
+
+  g_object_set (t->webrtc1, "worker-pool-size", 2, NULL);
+  g_object_set (t->webrtc2, "worker-pool-size", 2, NULL);
+  g_object_get (t->webrtc1, "worker-pool-size", &pool_size, NULL);
+  fail_unless_equals_int (pool_size, 2);
+
+  t->offer_data = GUINT_TO_POINTER (1);
+  t->on_offer_created = _count_num_sdp_media;
+  t->answer_data = GUINT_TO_POINTER (1);
+  t->on_answer_created = _count_num_sdp_media;
+  t->on_ice_candidate = NULL;
+
+  test_webrtc_create_offer (t, t->webrtc1);
+
+  test_webrtc_wait_for_answer_error_eos (t);
+  fail_unless_equals_int (STATE_ANSWER_CREATED, t->state);
+  test_webrtc_free (t);
+}
+
+GST_END_TEST;
+
 static Suite *
 webrtcbin_suite (void)
 {
   Suite *s = suite_create ("webrtcbin");
   TCase *tc = tcase_create ("general");
-  GstPluginFeature *nicesrc, *nicesink;
+  GstPluginFeature *nicesrc, *nicesink, *rtpfunnel;
   GstRegistry *registry;
 
   registry = gst_registry_get ();
   nicesrc = gst_registry_lookup_feature (registry, "nicesrc");
   nicesink = gst_registry_lookup_feature (registry, "nicesink");
+  rtpfunnel = gst_registry_lookup_feature (registry, "rtpfunnel");
 
   tcase_add_test (tc, test_sdp_no_media);
   tcase_add_test (tc, test_no_nice_elements_request_pad);
@@ -1367,12 +1478,17 @@ webrtcbin_suite (void)
     tcase_add_test (tc, test_get_transceivers);
     tcase_add_test (tc, test_add_recvonly_transceiver);
     tcase_add_test (tc, test_recvonly_sendonly);
+    tcase_add_test (tc, test_worker_pool);
+    if (rtpfunnel)
+      tcase_add_test (tc, test_bundle_audio_video_max_bundle);
   }
 
   if (nicesrc)
     gst_object_unref (nicesrc);
   if (nicesink)
     gst_object_unref (nicesink);
+  if (rtpfunnel)
+    gst_object_unref (rtpfunnel);
 
   suite_add_tcase (s, tc);
 
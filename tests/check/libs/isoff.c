@@ -245,6 +245,186 @@ GST_START_TEST (isoff_moof_parse_with_tfdt)
 
 GST_END_TEST;
 
+GST_START_TEST (isoff_moof_parser_chunked)
+{
+  GstMoofParser parser;
+  GstIsoffParserResult res = GST_ISOFF_PARSER_OK;
+  GstIsoffSampleTable *table;
+  guint pos = 0, avail = 0;
+  guint64 offset;
+  guint i;
+
+  gst_isoff_moof_parser_init (&parser);
+
+  /* Feed the moof in small chunks, keeping the unconsumed data around */
+  while (res == GST_ISOFF_PARSER_OK) {
+    GstByteReader reader;
+    guint consumed;
+
+    fail_unless (avail < sizeof (seg_2_m4f));
+    avail = MIN (avail + 7, sizeof (seg_2_m4f));
+    gst_byte_reader_init (&reader, seg_2_m4f + pos, avail - pos);
+    res = gst_isoff_moof_parser_parse (&parser, &reader, &consumed);
+    pos += consumed;
+
+    /* Samples become available before the end of the moof */
+    if (res == GST_ISOFF_PARSER_OK && parser.tables && parser.tables->len) {
+      table = &g_array_index (parser.tables, GstIsoffSampleTable, 0);
+      fail_unless (table->sizes->len < 129);
+    }
+  }
+
+  fail_unless_equals_int (res, GST_ISOFF_PARSER_DONE);
+  fail_unless_equals_int (pos, seg_2_m4f_len);
+  fail_unless_equals_int (parser.sequence_number, 4);
+  fail_unless_equals_int (parser.tables->len, 1);
+
+  table = &g_array_index (parser.tables, GstIsoffSampleTable, 0);
+  fail_unless_equals_int (table->track_id, 2);
+  fail_unless_equals_uint64 (table->decode_time, 132096);
+  fail_if (table->absolute_offsets);
+  fail_if (table->trex_sizes);
+  fail_if (table->trex_durations);
+  fail_unless_equals_int (table->sizes->len, 129);
+
+  /* Samples start right after the moof and the mdat header */
+  offset = seg_2_m4f_len + 8;
+  for (i = 0; i < 129; i++) {
+    fail_unless_equals_uint64 (g_array_index (table->offsets, guint64, i),
+        offset);
+    fail_unless_equals_int (g_array_index (table->sizes, guint32, i),
+        seg_2_sample_sizes[i]);
+    fail_unless_equals_int (g_array_index (table->durations, guint32, i),
+        seg_sample_duration);
+    /* neither the trun nor the tfhd carry sample flags */
+    fail_unless_equals_int (g_array_index (table->flags, guint32, i),
+        GST_ISOFF_SAMPLE_FLAGS_FROM_TREX);
+    offset += seg_2_sample_sizes[i];
+  }
+
+  gst_isoff_moof_parser_clear (&parser);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (isoff_moof_parser_matches_moof_parse)
+{
+  GstByteReader reader = GST_BYTE_READER_INIT (moof1, sizeof (moof1));
+  GstMoofParser parser;
+  GstMoofBox *moof;
+  GstTrunBox *trun;
+  GstIsoffSampleTable *table;
+  guint consumed;
+  guint i;
+
+  gst_isoff_moof_parser_init (&parser);
+  fail_unless_equals_int (gst_isoff_moof_parser_parse (&parser, &reader,
+          &consumed), GST_ISOFF_PARSER_DONE);
+  fail_unless_equals_int (consumed, sizeof (moof1));
+
+  gst_byte_reader_init (&reader, moof1 + 8, sizeof (moof1) - 8);
+  moof = gst_isoff_moof_box_parse (&reader);
+  fail_unless (moof != NULL);
+  trun = &g_array_index (g_array_index (moof->traf, GstTrafBox, 0).trun,
+      GstTrunBox, 0);
+
+  fail_unless_equals_int (parser.tables->len, 1);
+  table = &g_array_index (parser.tables, GstIsoffSampleTable, 0);
+  fail_unless_equals_int (table->track_id, 1);
+  fail_unless_equals_uint64 (table->decode_time, G_MAXUINT64);
+  fail_unless_equals_int (table->sizes->len, trun->samples->len);
+
+  for (i = 0; i < trun->samples->len; i++) {
+    GstTrunSample *sample = &g_array_index (trun->samples, GstTrunSample, i);
+
+    /* the default sample duration of the tfhd is filled in */
+    fail_unless_equals_int (g_array_index (table->durations, guint32, i), 8);
+    fail_unless_equals_int (g_array_index (table->sizes, guint32, i),
+        sample->sample_size);
+    fail_unless_equals_int (g_array_index (table->flags, guint32, i),
+        sample->sample_flags);
+    fail_unless_equals_int (g_array_index (table->composition_offsets, gint32,
+            i), sample->sample_composition_time_offset.s);
+  }
+
+  gst_isoff_moof_box_free (moof);
+  gst_isoff_moof_parser_clear (&parser);
+}
+
+GST_END_TEST;
+
+/* Two trafs, the first with an explicit base data offset of 1000 and the
+ * second continuing where the data of the first ended */
+static const guint8 moof_two_trafs[] = {
+  0x00, 0x00, 0x00, 0x80, 'm', 'o', 'o', 'f',
+  0x00, 0x00, 0x00, 0x10, 'm', 'f', 'h', 'd',
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+  0x00, 0x00, 0x00, 0x38, 't', 'r', 'a', 'f',
+  0x00, 0x00, 0x00, 0x18, 't', 'f', 'h', 'd',
+  0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xe8,
+  0x00, 0x00, 0x00, 0x18, 't', 'r', 'u', 'n',
+  0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x02,
+  0x00, 0x00, 0x00, 0x64, 0x00, 0x00, 0x00, 0xc8,
+  0x00, 0x00, 0x00, 0x30, 't', 'r', 'a', 'f',
+  0x00, 0x00, 0x00, 0x10, 't', 'f', 'h', 'd',
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+  0x00, 0x00, 0x00, 0x18, 't', 'r', 'u', 'n',
+  0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x02,
+  0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x14,
+};
+
+GST_START_TEST (isoff_moof_parser_continued_base)
+{
+  GstByteReader reader =
+      GST_BYTE_READER_INIT (moof_two_trafs, sizeof (moof_two_trafs));
+  GstMoofParser parser;
+  GstIsoffSampleTable *table;
+  guint consumed;
+
+  gst_isoff_moof_parser_init (&parser);
+  fail_unless_equals_int (gst_isoff_moof_parser_parse (&parser, &reader,
+          &consumed), GST_ISOFF_PARSER_DONE);
+  fail_unless_equals_int (consumed, sizeof (moof_two_trafs));
+  fail_unless_equals_int (parser.tables->len, 2);
+
+  table = &g_array_index (parser.tables, GstIsoffSampleTable, 0);
+  fail_unless (table->absolute_offsets);
+  fail_unless_equals_uint64 (g_array_index (table->offsets, guint64, 0), 1000);
+  fail_unless_equals_uint64 (g_array_index (table->offsets, guint64, 1), 1100);
+
+  /* the second traf continues from an absolute offset */
+  table = &g_array_index (parser.tables, GstIsoffSampleTable, 1);
+  fail_unless_equals_int (table->track_id, 2);
+  fail_unless (table->absolute_offsets);
+  fail_unless_equals_uint64 (g_array_index (table->offsets, guint64, 0), 1300);
+  fail_unless_equals_uint64 (g_array_index (table->offsets, guint64, 1), 1310);
+
+  gst_isoff_moof_parser_clear (&parser);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (isoff_moof_parser_trun_version)
+{
+  guint8 data[sizeof (moof_two_trafs)];
+  GstByteReader reader = GST_BYTE_READER_INIT (data, sizeof (data));
+  GstMoofParser parser;
+  guint consumed;
+
+  /* make the first trun version 2 */
+  memcpy (data, moof_two_trafs, sizeof (data));
+  data[64] = 2;
+
+  gst_isoff_moof_parser_init (&parser);
+  fail_unless_equals_int (gst_isoff_moof_parser_parse (&parser, &reader,
+          &consumed), GST_ISOFF_PARSER_ERROR);
+  fail_unless_equals_int (consumed, 56);
+  gst_isoff_moof_parser_clear (&parser);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (isoff_moof_parse_with_tfxd_tfrf)
 {
   GstByteReader reader =
@@ -356,6 +536,10 @@ dash_isoff_suite (void)
   tcase_add_test (tc_moof, isoff_moof_parse);
   tcase_add_test (tc_moof, isoff_moof_parse_with_tfdt);
   tcase_add_test (tc_moof, isoff_moof_parse_with_tfxd_tfrf);
+  tcase_add_test (tc_moof, isoff_moof_parser_chunked);
+  tcase_add_test (tc_moof, isoff_moof_parser_matches_moof_parse);
+  tcase_add_test (tc_moof, isoff_moof_parser_continued_base);
+  tcase_add_test (tc_moof, isoff_moof_parser_trun_version);
   suite_add_tcase (s, tc_moof);
 
   tcase_add_test (tc_moov, isoff_moov_parse);
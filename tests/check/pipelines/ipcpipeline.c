@@ -5804,6 +5804,112 @@ GST_START_TEST (test_wavparse_master_process_crash)
 
 GST_END_TEST;
 
+/**** shm payload test ****/
+
+/* This one runs both pipelines in the same process, over a UNIX socket
+ * so that the pool fd can be passed */
+
+#define SHM_NUM_BUFFERS 100
+#define SHM_BUFFER_SIZE 4096
+/* small enough for the pool to be reused a few times */
+#define SHM_POOL_SIZE (16 * SHM_BUFFER_SIZE)
+
+typedef struct
+{
+  gint n_buffers;
+  gint n_bad_buffers;
+  gint n_readonly_buffers;
+} shm_data;
+
+static void
+shm_handoff (GstElement * fakesink, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  shm_data *sd = user_data;
+  GstMapInfo map;
+  gsize i;
+  gboolean ok = TRUE;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ)) {
+    g_atomic_int_inc (&sd->n_bad_buffers);
+    return;
+  }
+  if (map.size != SHM_BUFFER_SIZE)
+    ok = FALSE;
+  for (i = 0; ok && i < map.size; i++)
+    ok = map.data[i] == (i & 0xff);
+  gst_buffer_unmap (buffer, &map);
+
+  if (!ok)
+    g_atomic_int_inc (&sd->n_bad_buffers);
+  if (GST_MEMORY_IS_READONLY (gst_buffer_peek_memory (buffer, 0)))
+    g_atomic_int_inc (&sd->n_readonly_buffers);
+  g_atomic_int_inc (&sd->n_buffers);
+}
+
+GST_START_TEST (test_shm_payload)
+{
+  GstElement *master, *slave, *fakesrc, *ipcpipelinesink, *ipcpipelinesrc;
+  GstElement *fakesink;
+  GstMessage *msg;
+  shm_data sd = { 0, 0, 0 };
+  int sockets[2];
+
+  fail_if (socketpair (PF_UNIX, SOCK_STREAM, 0, sockets) < 0);
+
+  master = gst_pipeline_new (NULL);
+  fakesrc = gst_element_factory_make ("fakesrc", NULL);
+  g_object_set (fakesrc, "num-buffers", SHM_NUM_BUFFERS, "sizemax",
+      SHM_BUFFER_SIZE, NULL);
+  gst_util_set_object_arg (G_OBJECT (fakesrc), "sizetype", "fixed");
+  gst_util_set_object_arg (G_OBJECT (fakesrc), "filltype", "pattern");
+  ipcpipelinesink = gst_element_factory_make ("ipcpipelinesink", NULL);
+  g_object_set (ipcpipelinesink, "fdin", sockets[0], "fdout", sockets[0],
+      "shm-pool-size", SHM_POOL_SIZE, NULL);
+  gst_bin_add_many (GST_BIN (master), fakesrc, ipcpipelinesink, NULL);
+  fail_unless (gst_element_link (fakesrc, ipcpipelinesink));
+
+  slave = gst_element_factory_make ("ipcslavepipeline", NULL);
+  ipcpipelinesrc = gst_element_factory_make ("ipcpipelinesrc", NULL);
+  g_object_set (ipcpipelinesrc, "fdin", sockets[1], "fdout", sockets[1],
+      NULL);
+  fakesink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (fakesink, "sync", FALSE, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (fakesink, "handoff", G_CALLBACK (shm_handoff), &sd);
+  gst_bin_add_many (GST_BIN (slave), ipcpipelinesrc, fakesink, NULL);
+  fail_unless (gst_element_link (ipcpipelinesrc, fakesink));
+
+  /* the slave follows the state of the master */
+  fail_if (gst_element_set_state (master, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE);
+
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (master), 30 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (msg != NULL);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  fail_unless_equals_int (g_atomic_int_get (&sd.n_buffers), SHM_NUM_BUFFERS);
+  fail_unless_equals_int (g_atomic_int_get (&sd.n_bad_buffers), 0);
+#ifdef HAVE_MEMFD_CREATE
+  /* payloads that went through the pool are wrapped read only */
+  fail_unless (g_atomic_int_get (&sd.n_readonly_buffers) > 0);
+#endif
+
+  fail_unless_equals_int (gst_element_set_state (master, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+  g_signal_emit_by_name (ipcpipelinesink, "disconnect", NULL);
+  g_signal_emit_by_name (ipcpipelinesrc, "disconnect", NULL);
+  gst_element_set_state (slave, GST_STATE_NULL);
+  gst_object_unref (master);
+  gst_object_unref (slave);
+
+  close (sockets[0]);
+  close (sockets[1]);
+}
+
+GST_END_TEST;
+
 static Suite *
 ipcpipeline_suite (void)
 {
@@ -6061,6 +6167,10 @@ ipcpipeline_suite (void)
      with the master pipeline. */
   tcase_add_test (tc_chain, test_wavparse_master_process_crash);
 
+  /* shm_payload checks that buffer payloads passed through the shared
+     memory pool arrive intact, including when the pool wraps around. */
+  tcase_add_test (tc_chain, test_shm_payload);
+
   return s;
 }
 
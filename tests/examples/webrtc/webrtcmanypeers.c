@@ -0,0 +1,288 @@
+/* Runs many local send/receive webrtcbin pairs with a fixed audio profile
+ * and reports how many peers a single core can sustain.
+ *
+ *   webrtcmanypeers --peers=200 --workers=4 --duration=30
+ *
+ * With --workers=0 every webrtcbin uses its own threads.
+ */
+#include <gst/gst.h>
+#include <gst/sdp/sdp.h>
+#include <gst/webrtc/webrtc.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+typedef struct
+{
+  guint idx;
+  GstElement *pipe;
+  GstElement *send;
+  GstElement *recv;
+} PeerPair;
+
+static GMainLoop *loop;
+static gint n_peers = 50;
+static gint n_workers = 4;
+static gint duration = 20;
+static gint n_connected = 0;
+
+static GOptionEntry entries[] = {
+  {"peers", 'p', 0, G_OPTION_ARG_INT, &n_peers,
+      "Number of send/receive pairs", "N"},
+  {"workers", 'w', 0, G_OPTION_ARG_INT, &n_workers,
+      "Size of the shared worker pool (0 = dedicated threads)", "N"},
+  {"duration", 'd', 0, G_OPTION_ARG_INT, &duration,
+      "Seconds to measure for once all peers are started", "SECONDS"},
+  {NULL}
+};
+
+static gboolean
+_bus_watch (GstBus * bus, GstMessage * msg, PeerPair * pair)
+{
+  switch (GST_MESSAGE_TYPE (msg)) {
+    case GST_MESSAGE_ERROR:{
+      GError *err = NULL;
+      gchar *dbg_info = NULL;
+
+      gst_message_parse_error (msg, &err, &dbg_info);
+      g_printerr ("ERROR from element %s in pair %u: %s\n",
+          GST_OBJECT_NAME (msg->src), pair->idx, err->message);
+      g_printerr ("Debugging info: %s\n", (dbg_info) ? dbg_info : "none");
+      g_error_free (err);
+      g_free (dbg_info);
+      g_main_loop_quit (loop);
+      break;
+    }
+    default:
+      break;
+  }
+
+  return TRUE;
+}
+
+static void
+_webrtc_pad_added (GstElement * webrtc, GstPad * new_pad, PeerPair * pair)
+{
+  GstElement *out;
+  GstPad *sink;
+
+  if (GST_PAD_DIRECTION (new_pad) != GST_PAD_SRC)
+    return;
+
+  out = gst_parse_bin_from_description ("rtpopusdepay ! opusdec ! "
+      "fakesink sync=false", TRUE, NULL);
+  gst_bin_add (GST_BIN (pair->pipe), out);
+  gst_element_sync_state_with_parent (out);
+
+  sink = out->sinkpads->data;
+
+  gst_pad_link (new_pad, sink);
+
+  g_atomic_int_inc (&n_connected);
+}
+
+static void
+_on_answer_received (GstPromise * promise, PeerPair * pair)
+{
+  GstWebRTCSessionDescription *answer = NULL;
+  const GstStructure *reply;
+
+  g_assert (gst_promise_wait (promise) == GST_PROMISE_RESULT_REPLIED);
+  reply = gst_promise_get_reply (promise);
+  gst_structure_get (reply, "answer",
+      GST_TYPE_WEBRTC_SESSION_DESCRIPTION, &answer, NULL);
+  gst_promise_unref (promise);
+
+  g_signal_emit_by_name (pair->send, "set-remote-description", answer, NULL);
+  g_signal_emit_by_name (pair->recv, "set-local-description", answer, NULL);
+
+  gst_webrtc_session_description_free (answer);
+}
+
+static void
+_on_offer_received (GstPromise * promise, PeerPair * pair)
+{
+  GstWebRTCSessionDescription *offer = NULL;
+  const GstStructure *reply;
+
+  g_assert (gst_promise_wait (promise) == GST_PROMISE_RESULT_REPLIED);
+  reply = gst_promise_get_reply (promise);
+  gst_structure_get (reply, "offer",
+      GST_TYPE_WEBRTC_SESSION_DESCRIPTION, &offer, NULL);
+  gst_promise_unref (promise);
+
+  g_signal_emit_by_name (pair->send, "set-local-description", offer, NULL);
+  g_signal_emit_by_name (pair->recv, "set-remote-description", offer, NULL);
+
+  promise = gst_promise_new_with_change_func ((GstPromiseChangeFunc)
+      _on_answer_received, pair, NULL);
+  g_signal_emit_by_name (pair->recv, "create-answer", NULL, promise);
+
+  gst_webrtc_session_description_free (offer);
+}
+
+static void
+_on_negotiation_needed (GstElement * element, PeerPair * pair)
+{
+  GstPromise *promise;
+
+  promise = gst_promise_new_with_change_func ((GstPromiseChangeFunc)
+      _on_offer_received, pair, NULL);
+  g_signal_emit_by_name (pair->send, "create-offer", NULL, promise);
+}
+
+static void
+_on_ice_candidate (GstElement * webrtc, guint mlineindex, gchar * candidate,
+    GstElement * other)
+{
+  g_signal_emit_by_name (other, "add-ice-candidate", mlineindex, candidate);
+}
+
+static PeerPair *
+_create_pair (guint idx)
+{
+  PeerPair *pair = g_new0 (PeerPair, 1);
+  GstBus *bus;
+  gchar *desc;
+
+  desc = g_strdup_printf ("audiotestsrc is-live=true wave=red-noise ! "
+      "audio/x-raw,rate=48000,channels=2 ! queue ! opusenc bitrate=32000 ! "
+      "rtpopuspay ! queue ! "
+      "application/x-rtp,media=audio,payload=97,encoding-name=OPUS ! "
+      "webrtcbin name=send worker-pool-size=%d "
+      "webrtcbin name=recv worker-pool-size=%d", n_workers, n_workers);
+
+  pair->idx = idx;
+  pair->pipe = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  g_assert (pair->pipe);
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pair->pipe));
+  gst_bus_add_watch (bus, (GstBusFunc) _bus_watch, pair);
+  gst_object_unref (bus);
+
+  pair->send = gst_bin_get_by_name (GST_BIN (pair->pipe), "send");
+  pair->recv = gst_bin_get_by_name (GST_BIN (pair->pipe), "recv");
+  g_signal_connect (pair->send, "on-negotiation-needed",
+      G_CALLBACK (_on_negotiation_needed), pair);
+  g_signal_connect (pair->recv, "pad-added", G_CALLBACK (_webrtc_pad_added),
+      pair);
+  g_signal_connect (pair->send, "on-ice-candidate",
+      G_CALLBACK (_on_ice_candidate), pair->recv);
+  g_signal_connect (pair->recv, "on-ice-candidate",
+      G_CALLBACK (_on_ice_candidate), pair->send);
+
+  gst_element_set_state (pair->pipe, GST_STATE_PLAYING);
+
+  return pair;
+}
+
+static void
+_free_pair (PeerPair * pair)
+{
+  GstBus *bus;
+
+  gst_element_set_state (pair->pipe, GST_STATE_NULL);
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pair->pipe));
+  gst_bus_remove_watch (bus);
+  gst_object_unref (bus);
+  gst_object_unref (pair->send);
+  gst_object_unref (pair->recv);
+  gst_object_unref (pair->pipe);
+  g_free (pair);
+}
+
+static gdouble
+_cpu_time (void)
+{
+  struct rusage usage;
+
+  getrusage (RUSAGE_SELF, &usage);
+
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+      usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+static gint
+_thread_count (void)
+{
+  gchar *contents = NULL, *line;
+  gint threads = -1;
+
+  if (!g_file_get_contents ("/proc/self/status", &contents, NULL, NULL))
+    return -1;
+
+  line = strstr (contents, "Threads:");
+  if (line)
+    threads = atoi (line + strlen ("Threads:"));
+  g_free (contents);
+
+  return threads;
+}
+
+static gboolean
+_measure_done (gpointer user_data)
+{
+  g_main_loop_quit (loop);
+  return G_SOURCE_REMOVE;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GPtrArray *pairs;
+  gdouble cpu_start, cpu_used, wall_start, wall_used, cores;
+  gint threads, i;
+
+  context = g_option_context_new ("- webrtcbin many peers benchmark");
+  g_option_context_add_main_entries (context, entries, NULL);
+  g_option_context_add_group (context, gst_init_get_option_group ());
+  if (!g_option_context_parse (context, &argc, &argv, &error)) {
+    g_printerr ("Error initializing: %s\n", error->message);
+    g_clear_error (&error);
+    g_option_context_free (context);
+    return 1;
+  }
+  g_option_context_free (context);
+
+  loop = g_main_loop_new (NULL, FALSE);
+  pairs = g_ptr_array_new_with_free_func ((GDestroyNotify) _free_pair);
+
+  g_print ("Starting %d peer pairs with %s\n", n_peers,
+      n_workers > 0 ? "shared workers" : "dedicated threads");
+  for (i = 0; i < n_peers; i++)
+    g_ptr_array_add (pairs, _create_pair (i));
+
+  /* let negotiation and ICE settle before measuring */
+  g_timeout_add_seconds (5, _measure_done, NULL);
+  g_main_loop_run (loop);
+
+  g_print ("%d of %d pairs receiving media\n", g_atomic_int_get (&n_connected),
+      n_peers);
+
+  cpu_start = _cpu_time ();
+  wall_start = g_get_monotonic_time () / 1e6;
+  g_timeout_add_seconds (duration, _measure_done, NULL);
+  g_main_loop_run (loop);
+  wall_used = g_get_monotonic_time () / 1e6 - wall_start;
+  cpu_used = _cpu_time () - cpu_start;
+  threads = _thread_count ();
+
+  cores = cpu_used / wall_used;
+  g_print ("workers: %d, peers: %d, threads: %d\n", n_workers, n_peers * 2,
+      threads);
+  g_print ("cpu: %.2f cores over %.1f s\n", cores, wall_used);
+  if (cores > 0)
+    g_print ("peers per core: %.1f\n", n_peers * 2 / cores);
+
+  g_ptr_array_free (pairs, TRUE);
+  g_main_loop_unref (loop);
+
+  gst_deinit ();
+
+  return 0;
+}